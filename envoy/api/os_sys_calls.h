@@ -234,6 +234,17 @@ public:
   virtual SysCallIntResult linkat(os_fd_t olddirfd, const char* oldpath, os_fd_t newdirfd,
                                   const char* newpath, int flags) const PURE;
 
+  /**
+   * Replaces newpath with oldpath atomically, if newpath exists.
+   * @see man 2 rename
+   */
+  virtual SysCallIntResult rename(const char* oldpath, const char* newpath) const PURE;
+
+  /**
+   * @see man 2 fsync
+   */
+  virtual SysCallIntResult fsync(os_fd_t fd) const PURE;
+
   /**
    * @see man 2 mkstemp
    */
@@ -90,6 +90,23 @@ public:
    */
   virtual ArenaWrappedProto<Protobuf::Message> decodeResource(const Protobuf::Any& resource) PURE;
 
+  /**
+   * Like decodeResource(), but without the unknown, deprecated and work-in-progress field checks
+   * that are reported to the validation visitor. Unlike decodeResource(), this may be called from
+   * any thread. The skipped checks are run by checkUnexpectedFields().
+   * @param resource some opaque resource (Protobuf::Any).
+   * @return ProtobufTypes::MessagePtr decoded protobuf message in the opaque resource.
+   */
+  virtual ArenaWrappedProto<Protobuf::Message>
+  decodeResourceWithoutFieldChecks(const Protobuf::Any& resource) PURE;
+
+  /**
+   * Runs the field checks skipped by decodeResourceWithoutFieldChecks(). This must be called from
+   * the main thread.
+   * @param resource a message returned by decodeResourceWithoutFieldChecks().
+   */
+  virtual void checkUnexpectedFields(const Protobuf::Message& resource) PURE;
+
   /**
    * @param resource some opaque resource (Protobuf::Message).
    * @return std::String the resource name in a Protobuf::Message returned by decodeResource(), e.g.
@@ -34,6 +34,13 @@ public:
    */
   virtual void postIncNumConnections() PURE;
 
+  /**
+   * @return the recent utilization of the event loop of the worker running this handler, in parts
+   *         per million. Only tracked for balancers that return true from
+   *         usesEventLoopUtilization(), 0 otherwise. May be called from any thread.
+   */
+  virtual uint32_t eventLoopUtilization() const { return 0; }
+
   /**
    * Post a connected socket to this connection handler. This is used for cross-thread connection
    * transfer during the balancing process.
@@ -82,6 +89,12 @@ public:
    */
   virtual BalancedConnectionHandler&
   pickTargetHandler(BalancedConnectionHandler& current_handler) PURE;
+
+  /**
+   * @return true if the balancer uses the event loop utilization of the handlers, in which case
+   *         handlers track it while they are registered.
+   */
+  virtual bool usesEventLoopUtilization() const { return false; }
 };
 
 using ConnectionBalancerSharedPtr = std::shared_ptr<ConnectionBalancer>;
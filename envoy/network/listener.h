@@ -358,6 +358,14 @@ public:
    * @param connections_accepted number of connections accepted.
    */
   virtual void recordConnectionsAcceptedOnSocketEvent(uint32_t connections_accepted) PURE;
+
+  /**
+   * Called for each accepted connection when the listen socket steers connections to workers by
+   * CPU, before the connection is passed to onAccept().
+   * @param local true if the kernel processed the connection on the CPU the accepting worker runs
+   *        on, false if it was handed off from another CPU.
+   */
+  virtual void recordIncomingCpuLocality(bool local) PURE;
 };
 
 /**
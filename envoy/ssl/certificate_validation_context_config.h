@@ -110,6 +110,14 @@ public:
    */
   virtual bool suppressClientCaList() const PURE;
 
+  /**
+   * @return the configuration of the cache of successfully verified certificate chains, or
+   * nullopt if verification results must not be cached.
+   */
+  virtual const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                                  CertificateValidationContext::VerificationCache>&
+  verificationCache() const PURE;
+
   // SECURITY NOTE
   //
   // When adding or changing this interface, it is likely that a change is needed to
@@ -124,6 +124,11 @@ public:
   virtual std::optional<
       envoy::extensions::transport_sockets::tls::v3::TlsParameters::CompliancePolicy>
   compliancePolicy() const PURE;
+
+  /**
+   * @return true if record protection should be offloaded to the kernel after the handshake.
+   */
+  virtual bool kernelTlsEnabled() const PURE;
 };
 
 class ClientContextConfig : public virtual ContextConfig {
@@ -7,6 +7,7 @@
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstdio>
 #include <string>
 
 #if defined(__linux__)
@@ -323,6 +324,16 @@ SysCallIntResult OsSysCallsImpl::linkat(os_fd_t olddirfd, const char* oldpath, o
   return {rc, rc != -1 ? 0 : errno};
 }
 
+SysCallIntResult OsSysCallsImpl::rename(const char* oldpath, const char* newpath) const {
+  const int rc = ::rename(oldpath, newpath);
+  return {rc, rc != -1 ? 0 : errno};
+}
+
+SysCallIntResult OsSysCallsImpl::fsync(os_fd_t fd) const {
+  const int rc = ::fsync(fd);
+  return {rc, rc != -1 ? 0 : errno};
+}
+
 SysCallIntResult OsSysCallsImpl::mkstemp(char* tmplate) const {
   const int rc = ::mkstemp(tmplate);
   return {rc, rc != -1 ? 0 : errno};
@@ -56,6 +56,8 @@ public:
   SysCallIntResult unlink(const char* pathname) const override;
   SysCallIntResult linkat(os_fd_t olddirfd, const char* oldpath, os_fd_t newdirfd,
                           const char* newpath, int flags) const override;
+  SysCallIntResult rename(const char* oldpath, const char* newpath) const override;
+  SysCallIntResult fsync(os_fd_t fd) const override;
   SysCallIntResult mkstemp(char* tmplate) const override;
   bool supportsAllPosixFileOperations() const override;
   SysCallIntResult shutdown(os_fd_t sockfd, int how) override;
@@ -22,5 +22,10 @@ SysCallIntResult LinuxOsSysCallsImpl::setns(int fd, int nstype) const {
   return {rc, errno};
 }
 
+SysCallIntResult LinuxOsSysCallsImpl::sched_getcpu() const {
+  const int rc = ::sched_getcpu();
+  return {rc, errno};
+}
+
 } // namespace Api
 } // namespace Envoy
@@ -16,6 +16,7 @@ public:
   // Api::LinuxOsSysCalls
   SysCallIntResult sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask) override;
   SysCallIntResult setns(int fd, int nstype) const override;
+  SysCallIntResult sched_getcpu() const override;
 };
 
 using LinuxOsSysCallsSingleton = ThreadSafeSingleton<LinuxOsSysCallsImpl>;
@@ -330,6 +330,19 @@ SysCallIntResult OsSysCallsImpl::linkat(os_fd_t olddirfd, const char* oldpath, o
   PANIC("not implemented");
 }
 
+SysCallIntResult OsSysCallsImpl::rename(const char* oldpath, const char* newpath) const {
+  // Unlike ::rename on Windows, replaces newpath if it exists.
+  if (!::MoveFileExA(oldpath, newpath, MOVEFILE_REPLACE_EXISTING)) {
+    return {-1, static_cast<int>(::GetLastError())};
+  }
+  return {0, 0};
+}
+
+SysCallIntResult OsSysCallsImpl::fsync(os_fd_t fd) const {
+  const int rc = ::_commit(fd);
+  return {rc, rc != -1 ? 0 : errno};
+}
+
 SysCallIntResult OsSysCallsImpl::mkstemp(char* tmplate) const { PANIC("not implemented"); }
 
 bool OsSysCallsImpl::supportsAllPosixFileOperations() const { return false; }
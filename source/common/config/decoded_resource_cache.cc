@@ -0,0 +1,114 @@
+#include "source/common/config/decoded_resource_cache.h"
+
+#include "envoy/common/exception.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "source/common/config/decoded_resource_impl.h"
+#include "source/common/config/resource_decode_pool.h"
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+// A cached resource, handed out with the version of the response it was last received in.
+class CachedDecodedResource : public DecodedResource {
+public:
+  CachedDecodedResource(std::shared_ptr<const DecodedResource> resource, const std::string& version)
+      : resource_(std::move(resource)), version_(version) {}
+
+  // Config::DecodedResource
+  const std::string& name() const override { return resource_->name(); }
+  const std::vector<std::string>& aliases() const override { return resource_->aliases(); }
+  const std::string& version() const override { return version_; }
+  const Protobuf::Message& resource() const override { return resource_->resource(); }
+  bool hasResource() const override { return resource_->hasResource(); }
+  std::optional<std::chrono::milliseconds> ttl() const override { return resource_->ttl(); }
+  const OptRef<const envoy::config::core::v3::Metadata> metadata() const override {
+    return resource_->metadata();
+  }
+
+private:
+  const std::shared_ptr<const DecodedResource> resource_;
+  const std::string version_;
+};
+
+} // namespace
+
+std::vector<DecodedResourcePtr>
+DecodedResourceCache::decode(const OpaqueResourceDecoderSharedPtr& resource_decoder,
+                             const Protobuf::RepeatedPtrField<Protobuf::Any>& resources,
+                             const std::string& version) {
+  if (resource_decoder != resource_decoder_) {
+    clear();
+  }
+
+  std::vector<DecodedResourcePtr> decoded(resources.size());
+  std::vector<std::shared_ptr<const DecodedResource>> cached(resources.size());
+  std::vector<size_t> misses;
+  for (int i = 0; i < resources.size(); ++i) {
+    const Protobuf::Any& resource = resources[i];
+    if (resource.Is<envoy::service::discovery::v3::Resource>()) {
+      misses.push_back(i);
+      continue;
+    }
+    const auto it = resources_.find(resource.value());
+    if (it != resources_.end()) {
+      // Decoding ran the field checks, but their outcome depends on the runtime, which may have
+      // changed since.
+      resource_decoder->checkUnexpectedFields(it->second->resource());
+      cached[i] = it->second;
+    } else {
+      misses.push_back(i);
+    }
+  }
+
+  std::vector<const Protobuf::Any*> missed_resources;
+  missed_resources.reserve(misses.size());
+  for (const size_t i : misses) {
+    missed_resources.push_back(&resources[i]);
+  }
+  std::vector<DecodedResourcePtr> missed_decoded;
+  if (ResourceDecodePool::shouldDecodeInParallel(missed_resources.size())) {
+    missed_decoded = ResourceDecodePool::get().decode(*resource_decoder, missed_resources, version);
+  } else {
+    missed_decoded.reserve(missed_resources.size());
+    for (const Protobuf::Any* resource : missed_resources) {
+      missed_decoded.emplace_back(THROW_OR_RETURN_VALUE(
+          DecodedResourceImpl::fromResource(*resource_decoder, *resource, version),
+          DecodedResourceImplPtr));
+    }
+  }
+  for (size_t j = 0; j < misses.size(); ++j) {
+    const size_t i = misses[j];
+    if (resources[i].Is<envoy::service::discovery::v3::Resource>()) {
+      decoded[i] = std::move(missed_decoded[j]);
+    } else {
+      cached[i] = std::move(missed_decoded[j]);
+    }
+  }
+
+  // Every resource decoded, so the cache moves on to this response. Resources that are no longer
+  // sent are dropped.
+  absl::flat_hash_map<std::string, std::shared_ptr<const DecodedResource>> next_resources;
+  next_resources.reserve(resources.size());
+  for (int i = 0; i < resources.size(); ++i) {
+    if (cached[i] == nullptr) {
+      continue;
+    }
+    next_resources.try_emplace(resources[i].value(), cached[i]);
+    decoded[i] = std::make_unique<CachedDecodedResource>(std::move(cached[i]), version);
+  }
+  ENVOY_LOG(debug, "reused {} of {} decoded resources at version {}",
+            resources.size() - misses.size(), resources.size(), version);
+  resource_decoder_ = resource_decoder;
+  resources_ = std::move(next_resources);
+  return decoded;
+}
+
+void DecodedResourceCache::clear() {
+  resource_decoder_.reset();
+  resources_.clear();
+}
+
+} // namespace Config
+} // namespace Envoy
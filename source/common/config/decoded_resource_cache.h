@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/subscription.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/protobuf/protobuf.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * Keeps the decoded resources of the last state-of-the-world response of a type, keyed by their
+ * serialized bytes. Control planes resend every resource on each SotW update even when only a few
+ * of them changed, and the resources whose bytes are unchanged are handed back without being
+ * unpacked and validated again. The unknown, deprecated and work-in-progress field checks depend on
+ * the runtime and are run again on every update. Keeping the bytes costs a copy of each serialized
+ * resource, on top of the decoded one.
+ *
+ * Only resources that are sent as plain Anys are reused. Resources wrapped in a
+ * discovery.v3.Resource carry a TTL and metadata of their own and are always decoded.
+ */
+class DecodedResourceCache : Logger::Loggable<Logger::Id::config> {
+public:
+  /**
+   * Decodes the resources of a SotW response, like DecodedResourceImpl::fromResource does for
+   * each of them. The resources that are not in the cache are decoded on the ResourceDecodePool
+   * when there are enough of them. The cache is replaced with the resources of this response once
+   * they have all been decoded, and is left as it was if one of them is invalid.
+   * @throw EnvoyException with the error of the first resource that is invalid.
+   */
+  std::vector<DecodedResourcePtr> decode(const OpaqueResourceDecoderSharedPtr& resource_decoder,
+                                         const Protobuf::RepeatedPtrField<Protobuf::Any>& resources,
+                                         const std::string& version);
+
+  void clear();
+
+  size_t size() const { return resources_.size(); }
+
+private:
+  // The decoder the cached resources were decoded with. Resources decoded by another one may not
+  // be of the same message type, or may not have passed its validation.
+  OpaqueResourceDecoderSharedPtr resource_decoder_;
+  // Keyed by the serialized bytes rather than a hash of them, so that a hit can't hand back another
+  // resource.
+  absl::flat_hash_map<std::string, std::shared_ptr<const DecodedResource>> resources_;
+};
+
+} // namespace Config
+} // namespace Envoy
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/config/core/v3/base.pb.h"
 #include "envoy/config/typed_metadata.h"
@@ -10,10 +12,15 @@
 #include "envoy/singleton/manager.h"
 #include "envoy/type/metadata/v3/metadata.pb.h"
 
+#include "source/common/common/macros.h"
 #include "source/common/protobuf/protobuf.h"
+#include "source/common/protobuf/utility.h"
 #include "source/common/shared_pool/shared_pool.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Config {
@@ -162,6 +169,93 @@ template <class FactoryClass> struct MetadataPack {
 template <class FactoryClass> using MetadataPackPtr = std::unique_ptr<MetadataPack<FactoryClass>>;
 template <class FactoryClass>
 using MetadataPackSharedPtr = std::shared_ptr<MetadataPack<FactoryClass>>;
+template <class FactoryClass>
+using MetadataPackConstSharedPtr = std::shared_ptr<const MetadataPack<FactoryClass>>;
+
+/**
+ * Shares the MetadataPacks of identical metadata process wide, so that the routes and virtual hosts
+ * that have the same metadata hold a single copy of the proto and of the typed metadata parsed from
+ * it. Packs are keyed by the deterministic hash of their proto and are dropped from the table when
+ * their last holder releases them. Unlike SharedPool::ObjectSharedPool, this can be used and
+ * released from any thread.
+ */
+template <class FactoryClass> class MetadataPackInterner {
+public:
+  /**
+   * @return the pack of metadata, shared with every other holder of identical metadata.
+   */
+  static MetadataPackConstSharedPtr<FactoryClass>
+  get(const envoy::config::core::v3::Metadata& metadata) {
+    return instance().intern(metadata);
+  }
+
+  /**
+   * @return the number of packs in the table.
+   */
+  static size_t size() { return instance().packCount(); }
+
+private:
+  using Pack = MetadataPack<FactoryClass>;
+
+  // Leaked, so that packs released during static destruction can still find the table.
+  static MetadataPackInterner& instance() { MUTABLE_CONSTRUCT_ON_FIRST_USE(MetadataPackInterner); }
+
+  MetadataPackConstSharedPtr<FactoryClass>
+  intern(const envoy::config::core::v3::Metadata& metadata) {
+    const size_t hash = MessageUtil::hash(metadata);
+    // Packs locked while searching are released after the mutex, as releasing the last reference
+    // to one takes the mutex.
+    std::vector<MetadataPackConstSharedPtr<FactoryClass>> candidates;
+    absl::MutexLock lock(mutex_);
+    if (auto it = packs_.find(hash); it != packs_.end()) {
+      for (const std::weak_ptr<const Pack>& entry : it->second) {
+        candidates.push_back(entry.lock());
+        if (candidates.back() != nullptr &&
+            Protobuf::util::MessageDifferencer::Equals(candidates.back()->proto_metadata_,
+                                                       metadata)) {
+          return candidates.back();
+        }
+      }
+    }
+    // The typed metadata factories may throw, which leaves the table unchanged.
+    MetadataPackConstSharedPtr<FactoryClass> pack(
+        new Pack(metadata), [this, hash](const Pack* pack) { release(hash, pack); });
+    packs_[hash].push_back(pack);
+    return pack;
+  }
+
+  void release(size_t hash, const Pack* pack) {
+    {
+      absl::MutexLock lock(mutex_);
+      auto it = packs_.find(hash);
+      if (it != packs_.end()) {
+        auto& bucket = it->second;
+        bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                                    [](const std::weak_ptr<const Pack>& entry) {
+                                      return entry.expired();
+                                    }),
+                     bucket.end());
+        if (bucket.empty()) {
+          packs_.erase(it);
+        }
+      }
+    }
+    delete pack;
+  }
+
+  size_t packCount() {
+    absl::MutexLock lock(mutex_);
+    size_t count = 0;
+    for (const auto& [hash, bucket] : packs_) {
+      count += bucket.size();
+    }
+    return count;
+  }
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<size_t, absl::InlinedVector<std::weak_ptr<const Pack>, 1>>
+      packs_ ABSL_GUARDED_BY(mutex_);
+};
 
 } // namespace Config
 } // namespace Envoy
@@ -3,6 +3,7 @@
 #include "envoy/config/subscription.h"
 
 #include "source/common/protobuf/arena_wrapped_proto.h"
+#include "source/common/protobuf/message_validator_impl.h"
 #include "source/common/protobuf/utility.h"
 
 namespace Envoy {
@@ -25,6 +26,23 @@ public:
     return typed_message;
   }
 
+  ArenaWrappedProto<Protobuf::Message>
+  decodeResourceWithoutFieldChecks(const Protobuf::Any& resource) override {
+    ArenaWrappedProto<Current> typed_message;
+    if (!resource.type_url().empty()) {
+      // The null visitor skips the field checks, leaving the Duration and PGV validation.
+      MessageUtil::anyConvertAndValidate<Current>(resource, *typed_message,
+                                                  ProtobufMessage::getNullValidationVisitor());
+    }
+    return typed_message;
+  }
+
+  void checkUnexpectedFields(const Protobuf::Message& resource) override {
+    if (!validation_visitor_.skipValidation()) {
+      MessageUtil::checkForUnexpectedFields(resource, validation_visitor_);
+    }
+  }
+
   std::string resourceName(const Protobuf::Message& resource) override {
     return MessageUtil::getStringField(resource, name_field_);
   }
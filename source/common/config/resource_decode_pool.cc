@@ -0,0 +1,203 @@
+#include "source/common/config/resource_decode_pool.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/common/lock_guard.h"
+#include "source/common/common/macros.h"
+#include "source/common/common/thread.h"
+#include "source/common/config/decoded_resource_impl.h"
+#include "source/common/runtime/runtime_features.h"
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+// Decodes with the decoder it wraps, leaving out the field checks that are not thread safe.
+class WithoutFieldChecksDecoder : public OpaqueResourceDecoder {
+public:
+  explicit WithoutFieldChecksDecoder(OpaqueResourceDecoder& decoder) : decoder_(decoder) {}
+
+  // Config::OpaqueResourceDecoder
+  ArenaWrappedProto<Protobuf::Message> decodeResource(const Protobuf::Any& resource) override {
+    return decoder_.decodeResourceWithoutFieldChecks(resource);
+  }
+  ArenaWrappedProto<Protobuf::Message>
+  decodeResourceWithoutFieldChecks(const Protobuf::Any& resource) override {
+    return decoder_.decodeResourceWithoutFieldChecks(resource);
+  }
+  void checkUnexpectedFields(const Protobuf::Message& resource) override {
+    decoder_.checkUnexpectedFields(resource);
+  }
+  std::string resourceName(const Protobuf::Message& resource) override {
+    return decoder_.resourceName(resource);
+  }
+
+private:
+  OpaqueResourceDecoder& decoder_;
+};
+
+} // namespace
+
+ResourceDecodePool::ResourceDecodePool(uint32_t threads) : threads_(threads) {}
+
+ResourceDecodePool::~ResourceDecodePool() {
+  std::vector<std::thread> workers;
+  {
+    absl::MutexLock lock(mutex_);
+    terminate_ = true;
+    workers.swap(workers_);
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+ResourceDecodePool& ResourceDecodePool::get() {
+  // The calling thread does its share of the work, so it is not counted.
+  const uint32_t cpus = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+  MUTABLE_CONSTRUCT_ON_FIRST_USE(ResourceDecodePool, std::min<uint32_t>(MaxThreads, cpus - 1));
+}
+
+bool ResourceDecodePool::shouldDecodeInParallel(size_t resource_count) {
+  return resource_count >= MinParallelResources &&
+         Runtime::runtimeFeatureEnabled("envoy.reloadable_features.xds_parallel_resource_decoding");
+}
+
+std::vector<DecodedResourcePtr>
+ResourceDecodePool::decode(OpaqueResourceDecoder& resource_decoder,
+                           const Protobuf::RepeatedPtrField<Protobuf::Any>& resources,
+                           const std::string& version) {
+  std::vector<const Protobuf::Any*> resource_ptrs;
+  resource_ptrs.reserve(resources.size());
+  for (const auto& resource : resources) {
+    resource_ptrs.push_back(&resource);
+  }
+  return decode(resource_decoder, resource_ptrs, version);
+}
+
+std::vector<DecodedResourcePtr>
+ResourceDecodePool::decode(OpaqueResourceDecoder& resource_decoder,
+                           absl::Span<const Protobuf::Any* const> resources,
+                           const std::string& version) {
+  WithoutFieldChecksDecoder decoder(resource_decoder);
+  std::vector<DecodedResourcePtr> decoded(resources.size());
+  std::vector<absl::Status> statuses(resources.size());
+  parallelFor(resources.size(), [&](size_t i) {
+    TRY_NEEDS_AUDIT {
+      auto resource_or_error = DecodedResourceImpl::fromResource(decoder, *resources[i], version);
+      if (resource_or_error.ok()) {
+        decoded[i] = std::move(resource_or_error.value());
+      } else {
+        statuses[i] = resource_or_error.status();
+      }
+    }
+    END_TRY
+    CATCH(const EnvoyException& e, { statuses[i] = absl::InvalidArgumentError(e.what()); });
+  });
+  return finish(resource_decoder, std::move(decoded), statuses);
+}
+
+std::vector<DecodedResourcePtr>
+ResourceDecodePool::decode(
+    OpaqueResourceDecoder& resource_decoder,
+    absl::Span<const envoy::service::discovery::v3::Resource* const> resources) {
+  WithoutFieldChecksDecoder decoder(resource_decoder);
+  std::vector<DecodedResourcePtr> decoded(resources.size());
+  std::vector<absl::Status> statuses(resources.size());
+  parallelFor(resources.size(), [&](size_t i) {
+    TRY_NEEDS_AUDIT { decoded[i] = std::make_unique<DecodedResourceImpl>(decoder, *resources[i]); }
+    END_TRY
+    CATCH(const EnvoyException& e, { statuses[i] = absl::InvalidArgumentError(e.what()); });
+  });
+  return finish(resource_decoder, std::move(decoded), statuses);
+}
+
+std::vector<DecodedResourcePtr>
+ResourceDecodePool::finish(OpaqueResourceDecoder& resource_decoder,
+                           std::vector<DecodedResourcePtr> decoded,
+                           const std::vector<absl::Status>& statuses) {
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    THROW_IF_NOT_OK_REF(statuses[i]);
+    resource_decoder.checkUnexpectedFields(decoded[i]->resource());
+  }
+  return decoded;
+}
+
+void ResourceDecodePool::parallelFor(size_t count, absl::FunctionRef<void(size_t)> fn) {
+  Thread::TryLockGuard job_lock(job_mutex_);
+  if (threads_ == 0 || count <= BatchSize || !job_lock.tryLock()) {
+    for (size_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  {
+    absl::MutexLock lock(mutex_);
+    if (workers_.empty()) {
+      ENVOY_LOG(debug, "starting {} xDS resource decoding threads", threads_);
+      workers_.reserve(threads_);
+      for (uint32_t i = 0; i < threads_; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+      }
+    }
+    next_.store(0);
+    fn_ = &fn;
+    count_ = count;
+    ++generation_;
+  }
+
+  work(fn, count);
+
+  // Workers that have not picked up the job yet no longer need to, the others finish the batches
+  // they claimed.
+  absl::MutexLock lock(mutex_);
+  fn_ = nullptr;
+  const auto idle = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return active_workers_ == 0;
+  };
+  mutex_.Await(absl::Condition(&idle));
+}
+
+void ResourceDecodePool::work(absl::FunctionRef<void(size_t)> fn, size_t count) {
+  for (size_t begin = next_.fetch_add(BatchSize); begin < count;
+       begin = next_.fetch_add(BatchSize)) {
+    const size_t end = std::min(begin + BatchSize, count);
+    for (size_t i = begin; i < end; ++i) {
+      fn(i);
+    }
+  }
+}
+
+void ResourceDecodePool::workerLoop() {
+  uint64_t generation = 0;
+  while (true) {
+    const absl::FunctionRef<void(size_t)>* fn;
+    size_t count;
+    {
+      absl::MutexLock lock(mutex_);
+      const auto ready = [this, generation]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return terminate_ || (fn_ != nullptr && generation_ != generation);
+      };
+      mutex_.Await(absl::Condition(&ready));
+      if (terminate_) {
+        return;
+      }
+      generation = generation_;
+      fn = fn_;
+      count = count_;
+      ++active_workers_;
+    }
+    work(*fn, count);
+    {
+      absl::MutexLock lock(mutex_);
+      --active_workers_;
+    }
+  }
+}
+
+} // namespace Config
+} // namespace Envoy
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "envoy/config/subscription.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/common/thread.h"
+
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * A small pool of threads that decodes and validates the resources of large discovery responses.
+ * The calling thread takes part in the work and the resources are handed back in the order of the
+ * response, so they are applied exactly as if they had been decoded one by one on the main thread.
+ *
+ * Only the parts of the decoding that are safe off the main thread run on the pool: unpacking the
+ * Any, and the Duration and PGV validation. The unknown, deprecated and work-in-progress field
+ * checks report to a validation visitor and runtime that are not thread safe, so they are run by
+ * the calling thread when the resources are handed back.
+ */
+class ResourceDecodePool : Logger::Loggable<Logger::Id::config> {
+public:
+  // Responses with fewer resources are decoded on the calling thread.
+  static constexpr size_t MinParallelResources = 64;
+  // The number of resources a thread claims at once.
+  static constexpr size_t BatchSize = 16;
+  // The pool threads compete with the workers for CPU, so there are only a few of them.
+  static constexpr uint32_t MaxThreads = 4;
+
+  /**
+   * @param threads the number of threads in the pool, in addition to the calling thread. They are
+   *        started on first use. With no threads, everything runs on the calling thread.
+   */
+  explicit ResourceDecodePool(uint32_t threads);
+  ~ResourceDecodePool();
+
+  /**
+   * @return the process wide pool used by the gRPC muxes.
+   */
+  static ResourceDecodePool& get();
+
+  /**
+   * @return whether a response with resource_count resources should be decoded with decode().
+   */
+  static bool shouldDecodeInParallel(size_t resource_count);
+
+  /**
+   * Decodes the resources of a state-of-the-world response, like DecodedResourceImpl::fromResource
+   * does for each of them.
+   * @throw EnvoyException with the error of the first resource that is invalid.
+   */
+  std::vector<DecodedResourcePtr>
+  decode(OpaqueResourceDecoder& resource_decoder,
+         const Protobuf::RepeatedPtrField<Protobuf::Any>& resources, const std::string& version);
+  std::vector<DecodedResourcePtr> decode(OpaqueResourceDecoder& resource_decoder,
+                                         absl::Span<const Protobuf::Any* const> resources,
+                                         const std::string& version);
+
+  /**
+   * Decodes the resources of a delta response, like the DecodedResourceImpl constructor does for
+   * each of them.
+   * @throw EnvoyException with the error of the first resource that is invalid.
+   */
+  std::vector<DecodedResourcePtr>
+  decode(OpaqueResourceDecoder& resource_decoder,
+         absl::Span<const envoy::service::discovery::v3::Resource* const> resources);
+
+  /**
+   * Calls fn for every index in [0, count) on the pool threads and the calling thread, and returns
+   * once all the calls have returned. fn must not throw. Only one call runs on the pool at a time,
+   * concurrent callers run all of their calls on their own thread.
+   */
+  void parallelFor(size_t count, absl::FunctionRef<void(size_t)> fn);
+
+  uint32_t threads() const { return threads_; }
+
+private:
+  void workerLoop();
+  void work(absl::FunctionRef<void(size_t)> fn, size_t count);
+  // Runs the field checks on the decoded resources in order, and throws the first error.
+  static std::vector<DecodedResourcePtr> finish(OpaqueResourceDecoder& resource_decoder,
+                                                std::vector<DecodedResourcePtr> decoded,
+                                                const std::vector<absl::Status>& statuses);
+
+  const uint32_t threads_;
+  // Held by the thread that runs a job on the pool.
+  Thread::MutexBasicLockable job_mutex_;
+  absl::Mutex mutex_;
+  std::vector<std::thread> workers_ ABSL_GUARDED_BY(mutex_);
+  const absl::FunctionRef<void(size_t)>* fn_ ABSL_GUARDED_BY(mutex_){};
+  size_t count_ ABSL_GUARDED_BY(mutex_){};
+  uint64_t generation_ ABSL_GUARDED_BY(mutex_){};
+  uint32_t active_workers_ ABSL_GUARDED_BY(mutex_){};
+  bool terminate_ ABSL_GUARDED_BY(mutex_){};
+  // The next index to hand out in the current job.
+  std::atomic<size_t> next_{0};
+};
+
+} // namespace Config
+} // namespace Envoy
@@ -271,14 +271,7 @@ SignalEventPtr DispatcherImpl::listenForSignal(signal_t signal_num, SignalCb cb)
 }
 
 void DispatcherImpl::post(PostCb callback) {
-  bool do_post;
-  {
-    Thread::LockGuard lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(std::move(callback));
-  }
-
-  if (do_post) {
+  if (post_callbacks_.push(std::move(callback))) {
     post_cb_->scheduleCallbackCurrentIteration();
   }
 }
@@ -318,11 +311,7 @@ void DispatcherImpl::shutdown() {
   // callbacks and dispatcher thread deletable objects.
   ASSERT(isThreadSafe());
   auto deferred_deletables_size = current_to_delete_->size();
-  std::list<std::function<void()>>::size_type post_callbacks_size;
-  {
-    Thread::LockGuard lock(post_lock_);
-    post_callbacks_size = post_callbacks_.size();
-  }
+  const uint64_t post_callbacks_size = post_callbacks_.size();
 
   std::list<DispatcherThreadDeletableConstPtr> local_deletables;
   {
@@ -368,27 +357,18 @@ void DispatcherImpl::runPostCallbacks() {
   // objects that is being deferred deleted.
   clearDeferredDeleteList();
 
-  std::list<PostCb> callbacks;
-  {
-    // Take ownership of the callbacks under the post_lock_. The lock must be released before
-    // callbacks execute. Callbacks added after this transfer will re-arm post_cb_ and will execute
-    // later in the event loop.
-    Thread::LockGuard lock(post_lock_);
-    callbacks = std::move(post_callbacks_);
-    // post_callbacks_ should be empty after the move.
-    ASSERT(post_callbacks_.empty());
-  }
-  // It is important that the execution and deletion of the callback happen while post_lock_ is not
-  // held. Either the invocation or destructor of the callback can call post() on this dispatcher.
-  while (!callbacks.empty()) {
+  // Only run the callbacks that were posted before this pass started. Callbacks posted by the
+  // callbacks that run here re-arm post_cb_ and will execute later in the event loop.
+  uint64_t remaining = post_callbacks_.beginPass();
+  PostCb callback;
+  while (remaining-- > 0 && post_callbacks_.pop(callback)) {
     // Touch the watchdog before executing the callback to avoid spurious watchdog miss events when
     // executing a long list of callbacks.
     touchWatchdog();
     // Run the callback.
-    callbacks.front()();
-    // Pop the front so that the destructor of the callback that just executed runs before the next
-    // callback executes.
-    callbacks.pop_front();
+    callback();
+    // Destroy the callback so that its destructor runs before the next callback executes.
+    callback = nullptr;
   }
 }
 
@@ -0,0 +1,38 @@
+#include "source/common/event/event_loop_utilization.h"
+
+namespace Envoy {
+namespace Event {
+
+EventLoopUtilizationTracker::EventLoopUtilizationTracker(std::chrono::milliseconds window)
+    : window_(window) {}
+
+void EventLoopUtilizationTracker::onPrepare(MonotonicTime prepare_time,
+                                            std::optional<MonotonicTime::duration>) {
+  // The loop has been running events since it last returned from polling.
+  if (last_check_.has_value()) {
+    busy_ += prepare_time - *last_check_;
+  }
+  last_prepare_ = prepare_time;
+
+  const MonotonicTime::duration total = busy_ + idle_;
+  if (total < window_) {
+    return;
+  }
+  const int64_t sample = static_cast<int64_t>(
+      static_cast<double>(busy_.count()) / total.count() * FullUtilization);
+  const int64_t previous = utilization_.load(std::memory_order_relaxed);
+  // Weigh the new window by a quarter so a single busy window does not swing the average.
+  utilization_.store(static_cast<uint32_t>(previous + (sample - previous) / 4),
+                     std::memory_order_relaxed);
+  busy_ = idle_ = MonotonicTime::duration::zero();
+}
+
+void EventLoopUtilizationTracker::onCheck(MonotonicTime check_time) {
+  if (last_prepare_.has_value()) {
+    idle_ += check_time - *last_prepare_;
+  }
+  last_check_ = check_time;
+}
+
+} // namespace Event
+} // namespace Envoy
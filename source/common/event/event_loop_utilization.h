@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "envoy/common/time.h"
+#include "envoy/event/evwatch.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Tracks the fraction of time an event loop spends running events rather than waiting for them,
+ * as a moving average over fixed windows. The tracker must be registered as an evwatch observer
+ * of the dispatcher it measures; the published utilization may be read from any thread.
+ */
+class EventLoopUtilizationTracker : public Evwatch::Observer {
+public:
+  // Utilization is expressed in parts per million.
+  static constexpr uint32_t FullUtilization = 1000000;
+
+  explicit EventLoopUtilizationTracker(
+      std::chrono::milliseconds window = std::chrono::milliseconds(100));
+
+  /**
+   * @return the recent utilization of the event loop, between 0 and FullUtilization.
+   */
+  uint32_t utilization() const { return utilization_.load(std::memory_order_relaxed); }
+
+  // Evwatch::Observer
+  void onPrepare(MonotonicTime prepare_time,
+                 std::optional<MonotonicTime::duration> timeout) override;
+  void onCheck(MonotonicTime check_time) override;
+
+private:
+  const MonotonicTime::duration window_;
+  std::optional<MonotonicTime> last_prepare_;
+  std::optional<MonotonicTime> last_check_;
+  // Time spent running events and polling in the current window.
+  MonotonicTime::duration busy_{};
+  MonotonicTime::duration idle_{};
+  std::atomic<uint32_t> utilization_{0};
+};
+
+} // namespace Event
+} // namespace Envoy
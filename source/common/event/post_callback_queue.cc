@@ -0,0 +1,108 @@
+#include "source/common/event/post_callback_queue.h"
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Event {
+
+PostCallbackQueue::PostCallbackQueue(size_t capacity)
+    : mask_(capacity - 1), cells_(std::make_unique<Cell[]>(capacity)) {
+  ASSERT(capacity >= 2 && (capacity & mask_) == 0, "capacity must be a power of two");
+  for (size_t i = 0; i < capacity; ++i) {
+    cells_[i].sequence_.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool PostCallbackQueue::push(PostCb callback) {
+  if (overflow_active_.load(std::memory_order_acquire) || !tryPushRing(callback)) {
+    Thread::LockGuard lock(overflow_lock_);
+    overflow_active_.store(true, std::memory_order_release);
+    overflow_.push_back(std::move(callback));
+    overflow_size_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Pairs with the exchange in beginPass(): either the consumer has not started its pass yet and
+  // will see the callback, or this push observes that the consumer went idle and wakes it up.
+  return idle_.exchange(false, std::memory_order_acq_rel);
+}
+
+bool PostCallbackQueue::tryPushRing(PostCb& callback) {
+  uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Cell* cell;
+  for (;;) {
+    cell = &cells_[pos & mask_];
+    const uint64_t sequence = cell->sequence_.load(std::memory_order_acquire);
+    const int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The consumer has not freed this cell yet, the ring is full.
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->callback_ = std::move(callback);
+  cell->sequence_.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+uint64_t PostCallbackQueue::beginPass() {
+  idle_.exchange(true, std::memory_order_acq_rel);
+  return size();
+}
+
+bool PostCallbackQueue::ringHasNext() const {
+  return cells_[dequeue_pos_ & mask_].sequence_.load(std::memory_order_acquire) ==
+         dequeue_pos_ + 1;
+}
+
+bool PostCallbackQueue::tryPopRing(PostCb& callback) {
+  if (!ringHasNext()) {
+    return false;
+  }
+  Cell& cell = cells_[dequeue_pos_ & mask_];
+  callback = std::move(cell.callback_);
+  cell.callback_ = nullptr;
+  cell.sequence_.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+  ++dequeue_pos_;
+  return true;
+}
+
+bool PostCallbackQueue::pop(PostCb& callback) {
+  if (overflow_batch_.empty()) {
+    if (tryPopRing(callback)) {
+      return true;
+    }
+    if (!overflow_active_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    Thread::LockGuard lock(overflow_lock_);
+    // A thread that pushed to the overflow list may have pushed to the ring before, and its ring
+    // callback can sit behind a cell another producer has claimed but not published yet. Only
+    // hand out the overflow list once every claimed cell has been consumed. A producer that is
+    // still publishing wakes the consumer up once it is done.
+    if (enqueue_pos_.load(std::memory_order_acquire) != dequeue_pos_) {
+      return tryPopRing(callback);
+    }
+    overflow_batch_ = std::move(overflow_);
+    overflow_.clear();
+    overflow_size_.store(0, std::memory_order_relaxed);
+    overflow_active_.store(false, std::memory_order_release);
+    if (overflow_batch_.empty()) {
+      return false;
+    }
+  }
+  callback = std::move(overflow_batch_.front());
+  overflow_batch_.pop_front();
+  return true;
+}
+
+uint64_t PostCallbackQueue::size() const {
+  return enqueue_pos_.load(std::memory_order_acquire) - dequeue_pos_ +
+         overflow_size_.load(std::memory_order_relaxed) + overflow_batch_.size();
+}
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+
+#include "source/common/common/thread.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Multi-producer, single-consumer queue of callbacks posted to a dispatcher.
+ *
+ * Callbacks are stored in a bounded lock-free ring (Vyukov's bounded MPMC queue, used with a
+ * single consumer), so a post claims a slot with a CAS and moves the callback in place. Callbacks
+ * small enough for PostCb's inline storage are therefore posted without any heap allocation or
+ * lock. When the ring is full, callbacks spill into a mutex guarded overflow list. Callbacks from
+ * a given thread are always popped in the order they were pushed: once the overflow list is in
+ * use every push goes to it, and it is only handed to the consumer after the ring has drained.
+ *
+ * The queue also tracks whether the consumer needs to be woken up, so that a burst of posts
+ * results in a single wakeup of the dispatcher.
+ */
+class PostCallbackQueue {
+public:
+  static constexpr size_t DefaultCapacity = 1024;
+
+  /**
+   * @param capacity number of callbacks the lock-free ring holds. Must be a power of two.
+   */
+  explicit PostCallbackQueue(size_t capacity = DefaultCapacity);
+
+  /**
+   * Appends a callback. May be called from any thread.
+   * @return true if the consumer has to be woken up to run the callback, i.e. this is the first
+   *         push since the last call to beginPass().
+   */
+  bool push(PostCb callback);
+
+  /**
+   * Starts a consumer pass. Any push after this call reports that a wakeup is needed again.
+   * Must only be called from the consumer thread.
+   * @return the number of callbacks that were queued when the pass started.
+   */
+  uint64_t beginPass();
+
+  /**
+   * Removes the oldest callback. Must only be called from the consumer thread.
+   * @param callback receives the callback.
+   * @return false if no callback can be popped without breaking the posting order. A push that is
+   *         still in progress in that case reports that a wakeup is needed.
+   */
+  bool pop(PostCb& callback);
+
+  /**
+   * @return an approximation of the number of queued callbacks. Must only be called from the
+   *         consumer thread.
+   */
+  uint64_t size() const;
+
+private:
+  struct Cell {
+    // Equal to the position of the cell when it is free for a producer, and to the position plus
+    // one once a producer has published a callback in it.
+    std::atomic<uint64_t> sequence_;
+    PostCb callback_;
+  };
+
+  bool tryPushRing(PostCb& callback);
+  bool tryPopRing(PostCb& callback);
+  bool ringHasNext() const;
+
+  const uint64_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+  // Producers and the consumer update their positions independently, keep them on separate cache
+  // lines.
+  alignas(64) std::atomic<uint64_t> enqueue_pos_{0};
+  alignas(64) uint64_t dequeue_pos_{0};
+  // True when the consumer has not been scheduled since the last pass started.
+  alignas(64) std::atomic<bool> idle_{true};
+
+  Thread::MutexBasicLockable overflow_lock_;
+  std::list<PostCb> overflow_ ABSL_GUARDED_BY(overflow_lock_);
+  // Set while overflow_ is in use. Read without the lock on the fast path of push().
+  std::atomic<bool> overflow_active_{false};
+  std::atomic<uint64_t> overflow_size_{0};
+  // Overflow callbacks handed to the consumer, only accessed by the consumer thread.
+  std::list<PostCb> overflow_batch_;
+};
+
+} // namespace Event
+} // namespace Envoy
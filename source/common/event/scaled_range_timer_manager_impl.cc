@@ -34,7 +34,7 @@ class ScaledRangeTimerManagerImpl::RangeTimerImpl final : public Timer {
 public:
   RangeTimerImpl(ScaledTimerMinimum minimum, TimerCb callback, ScaledRangeTimerManagerImpl& manager)
       : minimum_(minimum), manager_(manager), callback_(std::move(callback)),
-        min_duration_timer_(manager.dispatcher_.createTimer([this] { onMinTimerComplete(); })) {}
+        min_duration_timer_(manager.createMinDurationTimer([this] { onMinTimerComplete(); })) {}
 
   ~RangeTimerImpl() override { disableTimer(); }
 
@@ -138,11 +138,13 @@ private:
 };
 
 ScaledRangeTimerManagerImpl::ScaledRangeTimerManagerImpl(
-    Dispatcher& dispatcher, const ScaledTimerTypeMapConstSharedPtr& timer_minimums)
+    Dispatcher& dispatcher, const ScaledTimerTypeMapConstSharedPtr& timer_minimums,
+    bool use_timer_wheel)
     : dispatcher_(dispatcher),
       timer_minimums_(timer_minimums != nullptr ? timer_minimums
                                                 : std::make_shared<ScaledTimerTypeMap>()),
-      scale_factor_(1.0) {}
+      scale_factor_(1.0),
+      timer_wheel_(use_timer_wheel ? std::make_unique<TimerWheel>(dispatcher) : nullptr) {}
 
 ScaledRangeTimerManagerImpl::~ScaledRangeTimerManagerImpl() {
   // Scaled timers created by the manager shouldn't outlive it. This is
@@ -163,6 +165,11 @@ TimerPtr ScaledRangeTimerManagerImpl::createTimer(ScaledTimerMinimum minimum, Ti
   return std::make_unique<RangeTimerImpl>(minimum, callback, *this);
 }
 
+TimerPtr ScaledRangeTimerManagerImpl::createMinDurationTimer(TimerCb callback) {
+  return timer_wheel_ != nullptr ? timer_wheel_->createTimer(callback, dispatcher_)
+                                 : dispatcher_.createTimer(callback);
+}
+
 void ScaledRangeTimerManagerImpl::setScaleFactor(UnitFloat scale_factor) {
   const MonotonicTime now = dispatcher_.approximateMonotonicTime();
   scale_factor_ = scale_factor;
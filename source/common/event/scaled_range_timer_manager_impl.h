@@ -7,6 +7,8 @@
 #include "envoy/event/scaled_range_timer_manager.h"
 #include "envoy/event/timer.h"
 
+#include "source/common/event/timer_wheel.h"
+
 #include "absl/container/flat_hash_map.h"
 
 namespace Envoy {
@@ -20,12 +22,17 @@ namespace Event {
  * expectation is that the number of (max - min) values used to enable timers is small, so the
  * number of queues is tightly bounded. The queue-based implementation depends on that expectation
  * for efficient operation.
+ *
+ * Optionally, the min duration timers, which are re-armed on every bit of activity on a
+ * connection or stream, can be kept in a TimerWheel instead of being libevent timers.
  */
 class ScaledRangeTimerManagerImpl : public ScaledRangeTimerManager {
 public:
-  // Takes a Dispatcher and a map from timer type to scaled minimum value.
+  // Takes a Dispatcher and a map from timer type to scaled minimum value. If use_timer_wheel is
+  // set, min durations are tracked with millisecond precision by a TimerWheel.
   ScaledRangeTimerManagerImpl(Dispatcher& dispatcher,
-                              const ScaledTimerTypeMapConstSharedPtr& timer_minimums = nullptr);
+                              const ScaledTimerTypeMapConstSharedPtr& timer_minimums = nullptr,
+                              bool use_timer_wheel = false);
   ~ScaledRangeTimerManagerImpl() override;
 
   // ScaledRangeTimerManager impl
@@ -114,6 +121,8 @@ private:
                                           std::chrono::milliseconds duration,
                                           UnitFloat scale_factor);
 
+  TimerPtr createMinDurationTimer(TimerCb callback);
+
   ScalingTimerHandle activateTimer(std::chrono::milliseconds duration, RangeTimerImpl& timer);
 
   void removeTimer(ScalingTimerHandle handle);
@@ -125,6 +134,8 @@ private:
   Dispatcher& dispatcher_;
   const ScaledTimerTypeMapConstSharedPtr timer_minimums_;
   UnitFloat scale_factor_;
+  // Drives the min duration timers if set.
+  const std::unique_ptr<TimerWheel> timer_wheel_;
   absl::flat_hash_set<std::unique_ptr<Queue>, Hash, Eq> queues_;
 };
 
@@ -0,0 +1,278 @@
+#include "source/common/event/timer_wheel.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/scope_tracker.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+constexpr uint64_t NoTick = std::numeric_limits<uint64_t>::max();
+
+} // namespace
+
+/**
+ * Timer armed on a TimerWheel. The timer is linked into the slot it is waiting in while it is
+ * enabled.
+ */
+class TimerWheel::WheelTimer final : public Timer, public Node {
+public:
+  WheelTimer(TimerWheel& wheel, TimerCb cb, Dispatcher& dispatcher)
+      : wheel_(wheel), cb_(std::move(cb)), dispatcher_(dispatcher) {
+    ASSERT(cb_);
+  }
+  ~WheelTimer() override { wheel_.disable(*this); }
+
+  // Timer
+  void disableTimer() override {
+    ASSERT(dispatcher_.isThreadSafe());
+    wheel_.disable(*this);
+  }
+  void enableTimer(std::chrono::milliseconds ms, const ScopeTrackedObject* object) override {
+    enableHRTimer(ms, object);
+  }
+  void enableHRTimer(std::chrono::microseconds us, const ScopeTrackedObject* object) override {
+    ASSERT(dispatcher_.isThreadSafe());
+    object_ = object;
+    wheel_.enable(*this, us);
+  }
+  bool enabled() override {
+    ASSERT(dispatcher_.isThreadSafe());
+    return linked();
+  }
+
+  void fire() {
+    if (object_ == nullptr) {
+      cb_();
+      return;
+    }
+    ScopeTrackerScopeState scope(object_, dispatcher_);
+    object_ = nullptr;
+    cb_();
+  }
+
+  // The tick at which the timer expires.
+  uint64_t expiry_tick_{0};
+
+private:
+  TimerWheel& wheel_;
+  const TimerCb cb_;
+  Dispatcher& dispatcher_;
+  const ScopeTrackedObject* object_{nullptr};
+};
+
+void TimerWheel::Node::unlink() {
+  prev_->next_ = next_;
+  next_->prev_ = prev_;
+  prev_ = next_ = this;
+}
+
+void TimerWheel::Node::pushBack(Node& node) {
+  node.prev_ = prev_;
+  node.next_ = this;
+  prev_->next_ = &node;
+  prev_ = &node;
+}
+
+void TimerWheel::Node::takeAll(Node& other) {
+  ASSERT(!linked());
+  if (!other.linked()) {
+    return;
+  }
+  next_ = other.next_;
+  prev_ = other.prev_;
+  next_->prev_ = this;
+  prev_->next_ = this;
+  other.prev_ = other.next_ = &other;
+}
+
+TimerWheel::TimerWheel(Dispatcher& dispatcher, std::chrono::milliseconds tick)
+    : dispatcher_(dispatcher), tick_(tick), origin_(dispatcher.approximateMonotonicTime()),
+      driver_(dispatcher.createTimer([this]() { onDriverTimer(); })), driver_tick_(NoTick) {
+  ASSERT(tick > std::chrono::milliseconds::zero());
+}
+
+TimerWheel::~TimerWheel() {
+  // Timers created by the wheel must not outlive it.
+  ASSERT(armed_timers_ == 0);
+}
+
+TimerPtr TimerWheel::createTimer(const TimerCb& cb, Dispatcher& dispatcher) {
+  ASSERT(&dispatcher == &dispatcher_);
+  return std::make_unique<WheelTimer>(*this, cb, dispatcher);
+}
+
+uint64_t TimerWheel::tickAt(MonotonicTime time) const {
+  return time <= origin_ ? 0 : (time - origin_) / tick_;
+}
+
+uint64_t TimerWheel::ticksCeil(MonotonicTime time) const {
+  if (time <= origin_) {
+    return 0;
+  }
+  const MonotonicTime::duration elapsed = time - origin_;
+  return (elapsed + tick_ - MonotonicTime::duration(1)) / tick_;
+}
+
+MonotonicTime TimerWheel::timeOf(uint64_t tick) const {
+  return origin_ + static_cast<MonotonicTime::duration::rep>(tick) * tick_;
+}
+
+void TimerWheel::enable(WheelTimer& timer, std::chrono::microseconds delay) {
+  disable(timer);
+  const MonotonicTime now = dispatcher_.approximateMonotonicTime();
+  if (armed_timers_ == 0) {
+    // Nothing is waiting in the wheel, so it can jump straight to the current time.
+    current_tick_ = std::max(current_tick_, tickAt(now));
+  }
+  timer.expiry_tick_ = ticksCeil(now + std::max(delay, std::chrono::microseconds::zero()));
+  const uint64_t processing_tick = insert(timer);
+  ++armed_timers_;
+  if (processing_tick < driver_tick_) {
+    scheduleDriver(processing_tick, now);
+  }
+}
+
+void TimerWheel::disable(WheelTimer& timer) {
+  if (timer.linked()) {
+    timer.unlink();
+    --armed_timers_;
+  }
+}
+
+uint64_t TimerWheel::insert(WheelTimer& timer) {
+  // A timer that is already due is processed on the next tick, the current one has been
+  // processed already.
+  const uint64_t delta = std::clamp<uint64_t>(
+      timer.expiry_tick_ > current_tick_ ? timer.expiry_tick_ - current_tick_ : 0, 1, MaxDelta);
+  const uint64_t placement = current_tick_ + delta;
+  uint32_t level = 0;
+  while (level < Levels - 1 && (delta >> (SlotBits * (level + 1))) != 0) {
+    ++level;
+  }
+  const uint32_t shift = SlotBits * level;
+  const uint64_t index = (placement >> shift) & SlotMask;
+  slots_[level][index].pushBack(timer);
+  occupied_[level][index / 64] |= uint64_t(1) << (index % 64);
+  // The slot is processed when the wheel reaches the start of the range it covers.
+  return (placement >> shift) << shift;
+}
+
+int32_t TimerWheel::findOccupied(uint32_t level, uint32_t from, uint32_t to) {
+  for (uint32_t word = from / 64; word <= to / 64; ++word) {
+    uint64_t bits = occupied_[level][word];
+    if (word == from / 64) {
+      bits &= ~uint64_t(0) << (from % 64);
+    }
+    if (word == to / 64 && to % 64 != 63) {
+      bits &= (uint64_t(1) << (to % 64 + 1)) - 1;
+    }
+    while (bits != 0) {
+      const uint32_t index = word * 64 + std::countr_zero(bits);
+      if (slots_[level][index].linked()) {
+        return index;
+      }
+      // Occupancy bits are only cleared lazily, when a slot is found to be empty.
+      occupied_[level][word] &= ~(uint64_t(1) << (index % 64));
+      bits &= bits - 1;
+    }
+  }
+  return -1;
+}
+
+uint64_t TimerWheel::nextStop() {
+  uint64_t next = NoTick;
+  for (uint32_t level = 0; level < Levels; ++level) {
+    const uint32_t shift = SlotBits * level;
+    const uint32_t current_index = (current_tick_ >> shift) & SlotMask;
+    const uint64_t rotation_start = (current_tick_ >> (shift + SlotBits)) << (shift + SlotBits);
+    const uint64_t rotation_length = SlotsPerLevel << shift;
+    int32_t index =
+        current_index < SlotMask ? findOccupied(level, current_index + 1, SlotMask) : -1;
+    if (index >= 0) {
+      next = std::min(next, rotation_start + (uint64_t(index) << shift));
+    } else if ((index = findOccupied(level, 0, current_index)) >= 0) {
+      // Slots at or before the current position are processed in the next rotation.
+      next = std::min(next, rotation_start + rotation_length + (uint64_t(index) << shift));
+    }
+  }
+  return next;
+}
+
+void TimerWheel::scheduleDriver(uint64_t tick, MonotonicTime now) {
+  driver_tick_ = tick;
+  const MonotonicTime::duration delay = timeOf(tick) - now;
+  driver_->enableHRTimer(delay <= MonotonicTime::duration::zero()
+                             ? std::chrono::microseconds::zero()
+                             : std::chrono::ceil<std::chrono::microseconds>(delay));
+}
+
+void TimerWheel::onDriverTimer() {
+  driver_tick_ = NoTick;
+  advance(tickAt(dispatcher_.approximateMonotonicTime()));
+  if (armed_timers_ == 0) {
+    return;
+  }
+  // Timers armed by the callbacks that just ran may already have scheduled the driver.
+  const uint64_t next = nextStop();
+  if (next < driver_tick_) {
+    scheduleDriver(next, dispatcher_.approximateMonotonicTime());
+  }
+}
+
+void TimerWheel::advance(uint64_t target) {
+  for (uint64_t stop = nextStop(); stop <= target; stop = nextStop()) {
+    current_tick_ = stop;
+    // Move the timers of each higher level slot that starts at this tick one level down.
+    for (uint32_t level = 1; level < Levels; ++level) {
+      if ((current_tick_ & ((uint64_t(1) << (SlotBits * level)) - 1)) != 0) {
+        break;
+      }
+      cascade(level);
+    }
+    fireCurrentSlot();
+  }
+  current_tick_ = std::max(current_tick_, target);
+}
+
+void TimerWheel::cascade(uint32_t level) {
+  Node pending;
+  pending.takeAll(slots_[level][(current_tick_ >> (SlotBits * level)) & SlotMask]);
+  while (pending.linked()) {
+    WheelTimer& timer = static_cast<WheelTimer&>(*pending.next_);
+    timer.unlink();
+    if (timer.expiry_tick_ <= current_tick_) {
+      // Expires on the tick that starts the slot, fire it along with the current level 0 slot.
+      const uint64_t index = current_tick_ & SlotMask;
+      slots_[0][index].pushBack(timer);
+      occupied_[0][index / 64] |= uint64_t(1) << (index % 64);
+      continue;
+    }
+    insert(timer);
+  }
+}
+
+void TimerWheel::fireCurrentSlot() {
+  Node pending;
+  pending.takeAll(slots_[0][current_tick_ & SlotMask]);
+  // Callbacks may enable, disable or destroy other timers in the pending list, which unlinks them
+  // from it.
+  while (pending.linked()) {
+    WheelTimer& timer = static_cast<WheelTimer&>(*pending.next_);
+    timer.unlink();
+    if (timer.expiry_tick_ > current_tick_) {
+      // Parked beyond the span of the wheel.
+      insert(timer);
+      continue;
+    }
+    --armed_timers_;
+    timer.fire();
+  }
+}
+
+} // namespace Event
+} // namespace Envoy
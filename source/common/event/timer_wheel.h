@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Hierarchical timing wheel for coarse timers that only need millisecond precision, such as idle
+ * and request timeouts that are re-armed far more often than they fire.
+ *
+ * Timers are kept in intrusive lists hanging off the wheel slots, so enabling, disabling and
+ * re-enabling a timer are constant time operations that do not touch libevent. The wheel has four
+ * levels of 256 slots each; a timer is placed on the lowest level that covers its remaining
+ * duration and moves down one level each time the level below completes a rotation. A single
+ * dispatcher timer drives the wheel, and it is only rescheduled when a timer is armed for an
+ * earlier tick than the one it is already scheduled for.
+ *
+ * Timers never fire early, but may fire up to one tick late. Timers created by the wheel must be
+ * destroyed before the wheel, and like any other timer must only be used from the dispatcher
+ * thread.
+ */
+class TimerWheel : public Scheduler {
+public:
+  explicit TimerWheel(Dispatcher& dispatcher,
+                      std::chrono::milliseconds tick = std::chrono::milliseconds(1));
+  ~TimerWheel() override;
+
+  // Scheduler
+  TimerPtr createTimer(const TimerCb& cb, Dispatcher& dispatcher) override;
+
+  /**
+   * @return the number of armed timers.
+   */
+  uint64_t armedTimers() const { return armed_timers_; }
+
+private:
+  class WheelTimer;
+
+  // Node of a circular intrusive list. A list head is a node that links to itself when empty.
+  struct Node {
+    Node() : prev_(this), next_(this) {}
+    bool linked() const { return next_ != this; }
+    void unlink();
+    void pushBack(Node& node);
+    // Moves every node of `other` into this empty list.
+    void takeAll(Node& other);
+
+    Node* prev_;
+    Node* next_;
+  };
+
+  static constexpr uint32_t SlotBits = 8;
+  static constexpr uint64_t SlotsPerLevel = 1 << SlotBits;
+  static constexpr uint64_t SlotMask = SlotsPerLevel - 1;
+  static constexpr uint32_t Levels = 4;
+  // Timers further out than the wheel spans are parked at its far end and placed again when
+  // reached.
+  static constexpr uint64_t MaxDelta = (uint64_t(1) << (SlotBits * Levels)) - 1;
+
+  uint64_t tickAt(MonotonicTime time) const;
+  uint64_t ticksCeil(MonotonicTime time) const;
+  MonotonicTime timeOf(uint64_t tick) const;
+
+  void enable(WheelTimer& timer, std::chrono::microseconds delay);
+  void disable(WheelTimer& timer);
+  // Links the timer into its slot and returns the tick at which that slot is processed.
+  uint64_t insert(WheelTimer& timer);
+  // Returns the first slot in [from, to] of the level that holds timers, or -1.
+  int32_t findOccupied(uint32_t level, uint32_t from, uint32_t to);
+  // Returns the next tick at which a slot holding timers is processed.
+  uint64_t nextStop();
+  void scheduleDriver(uint64_t tick, MonotonicTime now);
+  void onDriverTimer();
+  void advance(uint64_t target);
+  void cascade(uint32_t level);
+  void fireCurrentSlot();
+
+  Dispatcher& dispatcher_;
+  const MonotonicTime::duration tick_;
+  const MonotonicTime origin_;
+  // The last tick whose timers have been processed.
+  uint64_t current_tick_{0};
+  uint64_t armed_timers_{0};
+  std::array<std::array<Node, SlotsPerLevel>, Levels> slots_;
+  // Slots that may hold timers, used to skip over empty ticks.
+  std::array<std::array<uint64_t, SlotsPerLevel / 64>, Levels> occupied_{};
+  const TimerPtr driver_;
+  // The tick the driver timer is scheduled for, if any.
+  uint64_t driver_tick_;
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -25,7 +25,7 @@ ActiveTcpListener::ActiveTcpListener(Network::TcpConnectionHandler& parent,
           config),
       tcp_conn_handler_(parent), connection_balancer_(connection_balancer),
       listen_address_(listen_address) {
-  connection_balancer_.registerHandler(*this);
+  registerWithBalancer();
 }
 
 ActiveTcpListener::ActiveTcpListener(Network::TcpConnectionHandler& parent,
@@ -37,12 +37,15 @@ ActiveTcpListener::ActiveTcpListener(Network::TcpConnectionHandler& parent,
     : OwnedActiveStreamListenerBase(parent, parent.dispatcher(), std::move(listener), config),
       tcp_conn_handler_(parent), connection_balancer_(connection_balancer),
       listen_address_(listen_address) {
-  connection_balancer_.registerHandler(*this);
+  registerWithBalancer();
 }
 
 ActiveTcpListener::~ActiveTcpListener() {
   is_deleting_ = true;
   connection_balancer_.unregisterHandler(*this);
+  if (utilization_tracker_ != nullptr) {
+    dispatcher().unregisterEvwatchObserver(*utilization_tracker_);
+  }
 
   // Purge sockets that have not progressed to connections. This should only happen when
   // a listener filter stops iteration and never resumes.
@@ -72,6 +75,14 @@ ActiveTcpListener::~ActiveTcpListener() {
                                                      config_->name(), numConnections()));
 }
 
+void ActiveTcpListener::registerWithBalancer() {
+  if (connection_balancer_.usesEventLoopUtilization()) {
+    utilization_tracker_ = std::make_unique<Event::EventLoopUtilizationTracker>();
+    dispatcher().registerEvwatchObserver(*utilization_tracker_);
+  }
+  connection_balancer_.registerHandler(*this);
+}
+
 void ActiveTcpListener::updateListenerConfig(Network::ListenerConfig& config) {
   ENVOY_LOG(trace, "replacing listener ", config_->listenerTag(), " by ", config.listenerTag());
   config_ = &config;
@@ -106,6 +117,14 @@ void ActiveTcpListener::recordConnectionsAcceptedOnSocketEvent(uint32_t connecti
   stats_.connections_accepted_per_socket_event_.recordValue(connections_accepted);
 }
 
+void ActiveTcpListener::recordIncomingCpuLocality(bool local) {
+  if (local) {
+    stats_.downstream_cx_incoming_cpu_local_.inc();
+  } else {
+    stats_.downstream_cx_incoming_cpu_remote_.inc();
+  }
+}
+
 void ActiveTcpListener::onAcceptWorker(Network::ConnectionSocketPtr&& socket,
                                        bool hand_off_restored_destination_connections,
                                        bool rebalanced,
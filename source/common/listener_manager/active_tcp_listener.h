@@ -5,6 +5,7 @@
 #include "envoy/stream_info/stream_info.h"
 
 #include "source/common/common/linked_object.h"
+#include "source/common/event/event_loop_utilization.h"
 #include "source/common/listener_manager/active_stream_listener_base.h"
 #include "source/common/listener_manager/active_tcp_socket.h"
 #include "source/server/active_listener_base.h"
@@ -54,6 +55,7 @@ public:
   void onAccept(Network::ConnectionSocketPtr&& socket) override;
   void onReject(RejectCause) override;
   void recordConnectionsAcceptedOnSocketEvent(uint32_t connections_accepted) override;
+  void recordIncomingCpuLocality(bool local) override;
 
   // ActiveListenerImplBase
   Network::Listener* listener() override { return listener_.get(); }
@@ -70,6 +72,9 @@ public:
   uint64_t numConnections() const override { return num_listener_connections_; }
   void preIncNumConnections() override { ++num_listener_connections_; }
   void postIncNumConnections() override { config_->openConnections().inc(); }
+  uint32_t eventLoopUtilization() const override {
+    return utilization_tracker_ != nullptr ? utilization_tracker_->utilization() : 0;
+  }
 
   // ActiveStreamListenerBase
   void incNumConnections() override {
@@ -91,12 +96,17 @@ public:
    */
   void updateListenerConfig(Network::ListenerConfig& config) override;
 
+  // Registers with the connection balancer, tracking the event loop utilization if it uses it.
+  void registerWithBalancer();
+
   Network::TcpConnectionHandler& tcp_conn_handler_;
   // The number of connections currently active on this listener. This is typically used for
   // connection balancing across per-handler listeners.
   std::atomic<uint64_t> num_listener_connections_{0};
 
   Network::ConnectionBalancer& connection_balancer_;
+  // Only set if the balancer uses the event loop utilization of the worker.
+  std::unique_ptr<Event::EventLoopUtilizationTracker> utilization_tracker_;
   // This is the address this listener is listening on. It's used to get the correct listener
   // when rebalancing. The accepted socket can't be used to get the listening address, since
   // the accepted socket's remote address can be another address than the listening address.
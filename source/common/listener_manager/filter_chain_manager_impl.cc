@@ -173,8 +173,8 @@ absl::Status FilterChainManagerImpl::addFilterChains(
     FcdsClientCallbacks& fcds_callbacks) {
   Cleanup cleanup([this]() { origin_ = std::nullopt; });
   FilterChainsByMatcher filter_chains;
-  uint32_t new_filter_chain_size = 0;
   FilterChainsByName filter_chains_by_name;
+  fc_contexts_.reserve(filter_chain_span.size());
 
   for (const auto& filter_chain : filter_chain_span) {
     RETURN_IF_NOT_OK(verifyNoDuplicateMatchers(filter_chain_matcher, filter_chains, *filter_chain));
@@ -182,18 +182,29 @@ absl::Status FilterChainManagerImpl::addFilterChains(
     // Reuse created filter chain if possible.
     // FilterChainManager maintains the lifetime of FilterChainFactoryContext
     // ListenerImpl maintains the dependencies of FilterChainFactoryContext
-    auto filter_chain_impl = findExistingFilterChain(*filter_chain);
-    if (filter_chain_impl == nullptr) {
+    const FilterChainMessageKey key(*filter_chain);
+    FilterChainEntry entry;
+    if (const FilterChainEntry* existing = findExistingFilterChain(key); existing != nullptr) {
+      entry = *existing;
+      ++reused_filter_chains_;
+    } else {
       auto filter_chain_or_error =
           filter_chain_factory_builder.buildFilterChain(*filter_chain, context_creator, false);
       RETURN_IF_NOT_OK(filter_chain_or_error.status());
-      filter_chain_impl = filter_chain_or_error.value();
-      ++new_filter_chain_size;
+      entry.message_ =
+          std::make_shared<const envoy::config::listener::v3::FilterChain>(*filter_chain);
+      entry.filter_chain_ = std::move(filter_chain_or_error.value());
+      ++built_filter_chains_;
     }
 
     RETURN_IF_NOT_OK(setupFilterChainMatcher(filter_chain_matcher, filter_chains_by_name,
-                                             *filter_chain, filter_chain_impl));
-    fc_contexts_[*filter_chain] = filter_chain_impl;
+                                             *filter_chain, entry.filter_chain_));
+    // The key refers to the message owned by the entry, not to the listener config.
+    const FilterChainMessageKey owned_key(*entry.message_, key.hash_);
+    auto [it, inserted] = fc_contexts_.try_emplace(owned_key, entry);
+    if (!inserted) {
+      it->second.filter_chain_ = std::move(entry.filter_chain_);
+    }
   }
   RETURN_IF_NOT_OK(convertIPsToTries());
   RETURN_IF_NOT_OK(copyOrRebuildDefaultFilterChain(default_filter_chain,
@@ -204,15 +215,16 @@ absl::Status FilterChainManagerImpl::addFilterChains(
 
   const auto* origin = getOriginFilterChainManager();
   if (origin != nullptr) {
-    for (const auto& message_and_filter_chain : origin->fc_contexts_) {
-      if (!fc_contexts_.contains(message_and_filter_chain.first)) {
-        origin->draining_filter_chains_.push_back(message_and_filter_chain.second);
+    for (const auto& [key, entry] : origin->fc_contexts_) {
+      // Reused entries share the message, so they are found without comparing messages.
+      if (!fc_contexts_.contains(key)) {
+        origin->draining_filter_chains_.push_back(entry.filter_chain_);
       }
     }
   }
 
   ENVOY_LOG(debug, "new fc_contexts has {} filter chains, including {} newly built",
-            fc_contexts_.size(), new_filter_chain_size);
+            fc_contexts_.size(), built_filter_chains_);
   return absl::OkStatus();
 }
 
@@ -387,6 +399,7 @@ absl::Status FilterChainManagerImpl::copyOrRebuildDefaultFilterChain(
         *default_filter_chain, context_creator, false);
     RETURN_IF_NOT_OK(filter_chain_or_error.status());
     default_filter_chain_ = *filter_chain_or_error;
+    ++built_filter_chains_;
     return absl::OkStatus();
   }
 
@@ -396,11 +409,13 @@ absl::Status FilterChainManagerImpl::copyOrRebuildDefaultFilterChain(
   if (origin->default_filter_chain_message_.has_value() &&
       eq(origin->default_filter_chain_message_.value(), *default_filter_chain)) {
     default_filter_chain_ = origin->default_filter_chain_;
+    ++reused_filter_chains_;
   } else {
     auto filter_chain_or_error = filter_chain_factory_builder.buildFilterChain(
         *default_filter_chain, context_creator, false);
     RETURN_IF_NOT_OK(filter_chain_or_error.status());
     default_filter_chain_ = *filter_chain_or_error;
+    ++built_filter_chains_;
   }
   return absl::OkStatus();
 }
@@ -585,29 +600,37 @@ absl::Status FilterChainManagerImpl::addFilterChainForSourcePorts(
 
 namespace {
 
+// Returns the ranges matching any address of the IP families supported by the host, used for
+// entries without an IP requirement. Probing the families opens sockets, so it is done once per
+// index build rather than once per entry.
+absl::StatusOr<std::vector<Network::Address::CidrRange>> catchAllCidrRanges() {
+  std::vector<Network::Address::CidrRange> ranges;
+  if (Network::SocketInterfaceSingleton::get().ipFamilySupported(AF_INET)) {
+    auto range =
+        Network::Address::CidrRange::create(Network::Utility::getIpv4CidrCatchAllAddress());
+    RETURN_IF_NOT_OK_REF(range.status());
+    ranges.push_back(*range);
+  }
+  if (Network::SocketInterfaceSingleton::get().ipFamilySupported(AF_INET6)) {
+    auto range =
+        Network::Address::CidrRange::create(Network::Utility::getIpv6CidrCatchAllAddress());
+    RETURN_IF_NOT_OK_REF(range.status());
+    ranges.push_back(*range);
+  }
+  return ranges;
+}
+
 // Template function for creating a CIDR list entry for either source or destination address.
 template <class T>
 std::pair<T, std::vector<Network::Address::CidrRange>>
-makeCidrListEntry(const std::string& cidr, const T& data, absl::Status& creation_status) {
+makeCidrListEntry(const std::string& cidr, const T& data,
+                  const std::vector<Network::Address::CidrRange>& catch_all_ranges,
+                  absl::Status& creation_status) {
   std::vector<Network::Address::CidrRange> subnets;
-  absl::StatusOr<Network::Address::CidrRange> range;
   if (cidr == EMPTY_STRING) {
-    if (Network::SocketInterfaceSingleton::get().ipFamilySupported(AF_INET)) {
-      range = Network::Address::CidrRange::create(Network::Utility::getIpv4CidrCatchAllAddress());
-      creation_status = range.status();
-      if (range.status().ok()) {
-        subnets.push_back(*range);
-      }
-    }
-    if (Network::SocketInterfaceSingleton::get().ipFamilySupported(AF_INET6)) {
-      range = Network::Address::CidrRange::create(Network::Utility::getIpv6CidrCatchAllAddress());
-      creation_status = range.status();
-      if (range.status().ok()) {
-        subnets.push_back(*range);
-      }
-    }
+    subnets = catch_all_ranges;
   } else {
-    range = Network::Address::CidrRange::create(cidr);
+    absl::StatusOr<Network::Address::CidrRange> range = Network::Address::CidrRange::create(cidr);
     creation_status = range.status();
     if (range.status().ok()) {
       subnets.push_back(*range);
@@ -675,10 +698,9 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDestinatio
   }
 
   // Match on both: exact IP and wider CIDR ranges using LcTrie.
-  const auto& data = destination_ips_trie.getData(address);
-  if (!data.empty()) {
-    ASSERT(data.size() == 1);
-    return findFilterChainForServerName(*data.back(), socket);
+  const ServerNamesMap* server_names_map = destination_ips_trie.getData(address);
+  if (server_names_map != nullptr) {
+    return findFilterChainForServerName(*server_names_map, socket);
   }
 
   return nullptr;
@@ -687,7 +709,8 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDestinatio
 const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName(
     const ServerNamesMap& server_names_map, const Network::ConnectionSocket& socket) const {
   ASSERT(absl::AsciiStrToLower(socket.requestedServerName()) == socket.requestedServerName());
-  const std::string server_name(socket.requestedServerName());
+  // The maps support heterogeneous lookup, so neither the server name nor its suffixes are copied.
+  const absl::string_view server_name = socket.requestedServerName();
 
   // Match on exact server name, i.e. "www.example.com" for "www.example.com".
   const auto server_name_exact_match = server_names_map.find(server_name);
@@ -697,8 +720,8 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
 
   // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
   size_t pos = server_name.find('.', 1);
-  while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
+  while (pos < server_name.size() - 1 && pos != absl::string_view::npos) {
+    const absl::string_view wildcard = server_name.substr(pos);
     const auto server_name_wildcard_match = server_names_map.find(wildcard);
     if (server_name_wildcard_match != server_names_map.end()) {
       return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
@@ -718,7 +741,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
 const Network::FilterChain* FilterChainManagerImpl::findFilterChainForTransportProtocol(
     const TransportProtocolsMap& transport_protocols_map,
     const Network::ConnectionSocket& socket) const {
-  const std::string transport_protocol(socket.detectedTransportProtocol());
+  const absl::string_view transport_protocol = socket.detectedTransportProtocol();
 
   // Match on exact transport protocol, e.g. "tls".
   const auto transport_protocol_match = transport_protocols_map.find(transport_protocol);
@@ -763,10 +786,9 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDirectSour
     address = FilterChain::fakeAddress();
   }
 
-  const auto& data = direct_source_ips_trie.getData(address);
-  if (!data.empty()) {
-    ASSERT(data.size() == 1);
-    return findFilterChainForSourceTypes(*data.back(), socket);
+  const SourceTypesArray* source_types = direct_source_ips_trie.getData(address);
+  if (source_types != nullptr) {
+    return findFilterChainForSourceTypes(*source_types, socket);
   }
 
   return nullptr;
@@ -814,13 +836,12 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForSourceIpAn
   }
 
   // Match on both: exact IP and wider CIDR ranges using LcTrie.
-  const auto& data = source_ips_trie.getData(address);
-  if (data.empty()) {
+  const SourcePortsMap* source_ports_map_ptr = source_ips_trie.getData(address);
+  if (source_ports_map_ptr == nullptr) {
     return nullptr;
   }
 
-  ASSERT(data.size() == 1);
-  const auto& source_ports_map = *data.back();
+  const auto& source_ports_map = *source_ports_map_ptr;
   const uint32_t source_port = address->ip()->port();
   const auto port_match = source_ports_map.find(source_port);
 
@@ -841,6 +862,13 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForSourceIpAn
 }
 
 absl::Status FilterChainManagerImpl::convertIPsToTries() {
+  if (destination_ports_map_.empty()) {
+    return absl::OkStatus();
+  }
+  const absl::StatusOr<std::vector<Network::Address::CidrRange>> catch_all_ranges =
+      catchAllCidrRanges();
+  RETURN_IF_NOT_OK_REF(catch_all_ranges.status());
+
   for (auto& [destination_port, destination_ips_pair] : destination_ports_map_) {
     UNREFERENCED_PARAMETER(destination_port);
     // These variables are used as we build up the destination CIDRs used for the trie.
@@ -852,7 +880,8 @@ absl::Status FilterChainManagerImpl::convertIPsToTries() {
     for (const auto& [destination_ip, server_names_map_ptr] : destination_ips_map) {
       absl::Status creation_status = absl::OkStatus();
       destination_ips_list.push_back(
-          makeCidrListEntry(destination_ip, server_names_map_ptr, creation_status));
+          makeCidrListEntry(destination_ip, server_names_map_ptr, *catch_all_ranges,
+                            creation_status));
       RETURN_IF_NOT_OK(creation_status);
 
       // This hugely nested for loop greatly pains me, but I'm not sure how to make it better.
@@ -872,51 +901,49 @@ absl::Status FilterChainManagerImpl::convertIPsToTries() {
             direct_source_ips_list.reserve(direct_source_ips_map.size());
 
             for (auto& [direct_source_ip, source_arrays_ptr] : direct_source_ips_map) {
-              direct_source_ips_list.push_back(
-                  makeCidrListEntry(direct_source_ip, source_arrays_ptr, creation_status));
+              direct_source_ips_list.push_back(makeCidrListEntry(
+                  direct_source_ip, source_arrays_ptr, *catch_all_ranges, creation_status));
               RETURN_IF_NOT_OK(creation_status);
 
               for (auto& [source_ips_map, source_ips_trie] : *source_arrays_ptr) {
+                // Source types without filter chains are skipped on lookup.
+                if (source_ips_map.empty()) {
+                  continue;
+                }
                 std::vector<
                     std::pair<SourcePortsMapSharedPtr, std::vector<Network::Address::CidrRange>>>
                     source_ips_list;
                 source_ips_list.reserve(source_ips_map.size());
 
                 for (auto& [source_ip, source_port_map_ptr] : source_ips_map) {
-                  source_ips_list.push_back(
-                      makeCidrListEntry(source_ip, source_port_map_ptr, creation_status));
+                  source_ips_list.push_back(makeCidrListEntry(
+                      source_ip, source_port_map_ptr, *catch_all_ranges, creation_status));
                   RETURN_IF_NOT_OK(creation_status);
                 }
 
-                source_ips_trie = std::make_unique<SourceIPsTrie>(source_ips_list, true);
+                source_ips_trie = std::make_unique<SourceIPsTrie>(source_ips_list);
               }
             }
-            direct_source_ips_trie =
-                std::make_unique<DirectSourceIPsTrie>(direct_source_ips_list, true);
+            direct_source_ips_trie = std::make_unique<DirectSourceIPsTrie>(direct_source_ips_list);
           }
         }
       }
     }
 
-    destination_ips_trie = std::make_unique<DestinationIPsTrie>(destination_ips_list, true);
+    destination_ips_trie = std::make_unique<DestinationIPsTrie>(destination_ips_list);
   }
   return absl::OkStatus();
 }
 
-Network::DrainableFilterChainSharedPtr FilterChainManagerImpl::findExistingFilterChain(
-    const envoy::config::listener::v3::FilterChain& filter_chain_message) {
+const FilterChainManagerImpl::FilterChainEntry*
+FilterChainManagerImpl::findExistingFilterChain(const FilterChainMessageKey& key) {
   // Origin filter chain manager could be empty if the current is the ancestor.
   const auto* origin = getOriginFilterChainManager();
   if (origin == nullptr) {
     return nullptr;
   }
-  auto iter = origin->fc_contexts_.find(filter_chain_message);
-  if (iter != origin->fc_contexts_.end()) {
-    // copy the context to this filter chain manager.
-    fc_contexts_.emplace(filter_chain_message, iter->second);
-    return iter->second;
-  }
-  return nullptr;
+  auto iter = origin->fc_contexts_.find(key);
+  return iter != origin->fc_contexts_.end() ? &iter->second : nullptr;
 }
 
 Configuration::FilterChainFactoryContextPtr FilterChainManagerImpl::createFilterChainFactoryContext(
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <memory>
@@ -198,9 +199,32 @@ class FilterChainManagerImpl : public Network::FilterChainManager,
                                public FilterChainFactoryContextCreator,
                                Logger::Loggable<Logger::Id::config> {
 public:
-  using FcContextMap =
-      absl::flat_hash_map<envoy::config::listener::v3::FilterChain,
-                          Network::DrainableFilterChainSharedPtr, MessageUtil, MessageUtil>;
+  // A filter chain message with its hash. Hashing a filter chain message is expensive, so it is
+  // hashed once per update. The message is owned by the map entry the key belongs to, or by the
+  // caller for lookups.
+  struct FilterChainMessageKey {
+    explicit FilterChainMessageKey(const envoy::config::listener::v3::FilterChain& message)
+        : message_(&message), hash_(MessageUtil::hash(message)) {}
+    FilterChainMessageKey(const envoy::config::listener::v3::FilterChain& message, size_t hash)
+        : message_(&message), hash_(hash) {}
+
+    bool operator==(const FilterChainMessageKey& other) const {
+      return message_ == other.message_ ||
+             (hash_ == other.hash_ && MessageUtil()(*message_, *other.message_));
+    }
+    template <typename H> friend H AbslHashValue(H h, const FilterChainMessageKey& key) {
+      return H::combine(std::move(h), key.hash_);
+    }
+
+    const envoy::config::listener::v3::FilterChain* message_;
+    size_t hash_;
+  };
+  // The message is shared with the next generation of the manager when the filter chain is reused.
+  struct FilterChainEntry {
+    std::shared_ptr<const envoy::config::listener::v3::FilterChain> message_;
+    Network::DrainableFilterChainSharedPtr filter_chain_;
+  };
+  using FcContextMap = absl::flat_hash_map<FilterChainMessageKey, FilterChainEntry>;
   FilterChainManagerImpl(const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
                          Configuration::FactoryContext& factory_context,
                          Init::Manager& init_manager)
@@ -243,6 +267,11 @@ public:
     return default_filter_chain_;
   }
 
+  // The number of filter chains, including the default one, that were built by addFilterChains()
+  // and that were reused from the previous generation of the manager.
+  uint32_t builtFilterChains() const { return built_filter_chains_; }
+  uint32_t reusedFilterChains() const { return reused_filter_chains_; }
+
 private:
   absl::Status convertIPsToTries();
   const Network::FilterChain* findFilterChainUsingMatcher(const Network::ConnectionSocket& socket,
@@ -256,15 +285,62 @@ private:
       FilterChainFactoryBuilder& filter_chain_factory_builder,
       FilterChainFactoryContextCreator& context_creator);
 
+  // Matches an address against the CIDR ranges of one IP level of the index below. A level that
+  // only has the catch-all entry, which is the common case when filter chains differ by server
+  // name, matches without building an LC trie or allocating on lookup.
+  template <class Node> class CidrRangeMatcher {
+  public:
+    using Entries = std::vector<
+        std::pair<std::shared_ptr<Node>, std::vector<Network::Address::CidrRange>>>;
+
+    explicit CidrRangeMatcher(const Entries& entries) {
+      const auto is_catch_all = [](const Network::Address::CidrRange& range) {
+        return range.length() == 0;
+      };
+      if (entries.size() == 1 &&
+          std::all_of(entries[0].second.begin(), entries[0].second.end(), is_catch_all)) {
+        catch_all_ = entries[0].first;
+        for (const auto& range : entries[0].second) {
+          if (range.ip()->version() == Network::Address::IpVersion::v4) {
+            catch_all_ipv4_ = true;
+          } else {
+            catch_all_ipv6_ = true;
+          }
+        }
+        return;
+      }
+      trie_ = std::make_unique<Network::LcTrie::LcTrie<std::shared_ptr<Node>>>(entries, true);
+    }
+
+    const Node* getData(const Network::Address::InstanceConstSharedPtr& address) const {
+      if (trie_ == nullptr) {
+        const bool ipv4 = address->ip()->version() == Network::Address::IpVersion::v4;
+        return (ipv4 ? catch_all_ipv4_ : catch_all_ipv6_) ? catch_all_.get() : nullptr;
+      }
+      const auto data = trie_->getData(address);
+      if (data.empty()) {
+        return nullptr;
+      }
+      ASSERT(data.size() == 1);
+      return data.back().get();
+    }
+
+  private:
+    std::unique_ptr<Network::LcTrie::LcTrie<std::shared_ptr<Node>>> trie_;
+    std::shared_ptr<Node> catch_all_;
+    bool catch_all_ipv4_{false};
+    bool catch_all_ipv6_{false};
+  };
+
   using SourcePortsMap = absl::flat_hash_map<uint16_t, Network::FilterChainSharedPtr>;
   using SourcePortsMapSharedPtr = std::shared_ptr<SourcePortsMap>;
   using SourceIPsMap = absl::flat_hash_map<std::string, SourcePortsMapSharedPtr>;
-  using SourceIPsTrie = Network::LcTrie::LcTrie<SourcePortsMapSharedPtr>;
+  using SourceIPsTrie = CidrRangeMatcher<SourcePortsMap>;
   using SourceIPsTriePtr = std::unique_ptr<SourceIPsTrie>;
   using SourceTypesArray = std::array<std::pair<SourceIPsMap, SourceIPsTriePtr>, 3>;
   using SourceTypesArraySharedPtr = std::shared_ptr<SourceTypesArray>;
   using DirectSourceIPsMap = absl::flat_hash_map<std::string, SourceTypesArraySharedPtr>;
-  using DirectSourceIPsTrie = Network::LcTrie::LcTrie<SourceTypesArraySharedPtr>;
+  using DirectSourceIPsTrie = CidrRangeMatcher<SourceTypesArray>;
   using DirectSourceIPsTriePtr = std::unique_ptr<DirectSourceIPsTrie>;
 
   // This would nominally be a `std::pair`, but that version crashes the Windows clang_cl compiler
@@ -283,7 +359,7 @@ private:
   using ServerNamesMap = absl::flat_hash_map<std::string, TransportProtocolsMap>;
   using ServerNamesMapSharedPtr = std::shared_ptr<ServerNamesMap>;
   using DestinationIPsMap = absl::flat_hash_map<std::string, ServerNamesMapSharedPtr>;
-  using DestinationIPsTrie = Network::LcTrie::LcTrie<ServerNamesMapSharedPtr>;
+  using DestinationIPsTrie = CidrRangeMatcher<ServerNamesMap>;
   using DestinationIPsTriePtr = std::unique_ptr<DestinationIPsTrie>;
   using DestinationPortsMap =
       absl::flat_hash_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTriePtr>>;
@@ -385,13 +461,14 @@ private:
                                     const Network::ConnectionSocket& socket) const;
 
   const FilterChainManagerImpl* getOriginFilterChainManager() { return origin_.value(); }
-  // Duplicate the inherent factory context if any.
-  Network::DrainableFilterChainSharedPtr
-  findExistingFilterChain(const envoy::config::listener::v3::FilterChain& filter_chain_message);
+  // Returns the entry of the previous generation of the manager with the same message, if any.
+  const FilterChainEntry* findExistingFilterChain(const FilterChainMessageKey& key);
 
   // Mapping from filter chain message to filter chain. This is used by LDS response handler to
   // detect the filter chains in the intersection of existing listener and new listener.
   FcContextMap fc_contexts_;
+  uint32_t built_filter_chains_{0};
+  uint32_t reused_filter_chains_{0};
 
   std::optional<envoy::config::listener::v3::FilterChain> default_filter_chain_message_;
   // The optional fallback filter chain if destination_ports_map_ does not find a matched filter
@@ -981,6 +981,12 @@ ListenerImpl::buildConnectionBalancer(const envoy::config::listener::v3::Listene
                 config.connection_balance_config().extend_balance(), *listener_factory_context_));
         break;
       }
+      case envoy::config::listener::v3::Listener_ConnectionBalanceConfig::kWorkerLoadBalance:
+        connection_balancers_.emplace(
+            address.asString(),
+            std::make_shared<Network::WorkerLoadConnectionBalancerImpl>(
+                listener_factory_context_->serverFactoryContext().api().randomGenerator()));
+        break;
       case envoy::config::listener::v3::Listener_ConnectionBalanceConfig::kCpuLocalityBalance:
         // CPU locality balancing is performed by the kernel reuse port BPF program installed as a
         // listen socket option, so no user space balancer is needed and the no-op balancer is
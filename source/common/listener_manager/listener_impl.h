@@ -279,6 +279,9 @@ public:
     return listen_socket_options_list_[address_index];
   }
   const std::string& versionInfo() const { return version_info_; }
+  // The filter chains built for this listener, and reused from the listener it updates in place.
+  uint32_t builtFilterChains() const { return filter_chain_manager_->builtFilterChains(); }
+  uint32_t reusedFilterChains() const { return filter_chain_manager_->reusedFilterChains(); }
   bool reusePort() const { return reuse_port_; }
   static bool getReusePortOrDefault(Server::Instance& server,
                                     const envoy::config::listener::v3::Listener& config,
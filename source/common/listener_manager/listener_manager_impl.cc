@@ -664,6 +664,9 @@ absl::StatusOr<bool> ListenerManagerImpl::addOrUpdateListenerInternal(
     new_listener = std::move(*listener_or_error);
   }
 
+  stats_.filter_chains_built_.add(new_listener->builtFilterChains());
+  stats_.filter_chains_reused_.add(new_listener->reusedFilterChains());
+
   ListenerImpl& new_listener_ref = *new_listener;
 
   bool added = false;
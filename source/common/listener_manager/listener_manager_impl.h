@@ -150,6 +150,8 @@ using ListenerImplPtr = std::unique_ptr<ListenerImpl>;
  * All listener manager stats. @see stats_macros.h
  */
 #define ALL_LISTENER_MANAGER_STATS(COUNTER, GAUGE)                                                 \
+  COUNTER(filter_chains_built)                                                                     \
+  COUNTER(filter_chains_reused)                                                                    \
   COUNTER(listener_added)                                                                          \
   COUNTER(listener_create_failure)                                                                 \
   COUNTER(listener_create_success)                                                                 \
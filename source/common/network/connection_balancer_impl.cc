@@ -39,5 +39,62 @@ ExactConnectionBalancerImpl::pickTargetHandler(BalancedConnectionHandler&) {
   return *min_connection_handler;
 }
 
+WorkerLoadConnectionBalancerImpl::WorkerLoadConnectionBalancerImpl(
+    Random::RandomGenerator& random)
+    : random_(random) {}
+
+void WorkerLoadConnectionBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(lock_);
+  auto it = std::find(handlers_.begin(), handlers_.end(), nullptr);
+  if (it != handlers_.end()) {
+    *it = &handler;
+  } else {
+    handlers_.push_back(&handler);
+  }
+}
+
+void WorkerLoadConnectionBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  // Waits for any pick that may be using the handler, which may be destroyed once this returns.
+  absl::MutexLock lock(lock_);
+  // The slot is cleared rather than erased, so that the other handlers keep their chance of
+  // being picked, and reused by the next registration.
+  *std::find(handlers_.begin(), handlers_.end(), &handler) = nullptr;
+}
+
+bool WorkerLoadConnectionBalancerImpl::lessLoaded(const BalancedConnectionHandler& candidate,
+                                                  const BalancedConnectionHandler& current) {
+  const uint32_t candidate_utilization = candidate.eventLoopUtilization();
+  const uint32_t current_utilization = current.eventLoopUtilization();
+  if (candidate_utilization + UtilizationSlack < current_utilization) {
+    return true;
+  }
+  if (current_utilization + UtilizationSlack < candidate_utilization) {
+    return false;
+  }
+  return candidate.numConnections() < current.numConnections();
+}
+
+BalancedConnectionHandler&
+WorkerLoadConnectionBalancerImpl::pickTargetHandler(BalancedConnectionHandler& current_handler) {
+  BalancedConnectionHandler* target = &current_handler;
+  {
+    // Picks only share the lock, so that they don't contend with each other.
+    absl::ReaderMutexLock lock(lock_);
+    if (handlers_.size() > 1) {
+      // The accepting worker is the first choice, since keeping the connection there avoids a
+      // cross-thread hand off.
+      BalancedConnectionHandler* candidate = handlers_[random_.random() % handlers_.size()];
+      if (candidate != nullptr && candidate != &current_handler &&
+          lessLoaded(*candidate, current_handler)) {
+        target = candidate;
+      }
+    }
+    target->preIncNumConnections();
+  }
+
+  target->postIncNumConnections();
+  return *target;
+}
+
 } // namespace Network
 } // namespace Envoy
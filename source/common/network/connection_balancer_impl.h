@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include "envoy/common/random_generator.h"
 #include "envoy/config/listener/v3/listener.pb.h"
 #include "envoy/network/connection_balancer.h"
 #include "envoy/registry/registry.h"
@@ -44,6 +48,42 @@ private:
   std::vector<BalancedConnectionHandler*> handlers_ ABSL_GUARDED_BY(lock_);
 };
 
+/**
+ * Connection balancer that steers connections by worker load with the power of two
+ * choices: each connection goes to the less loaded of the accepting worker and one other worker
+ * picked at random. Load is the recent event loop utilization of the worker, so a few connections
+ * carrying most of the traffic are accounted for; the number of connections of the listener on
+ * each worker breaks ties between workers whose utilization is within a few percent.
+ *
+ * Picks hold a reader lock, so they only contend with the rare registrations and unregistrations,
+ * which in turn wait for in flight picks to stop using a handler before it can be destroyed. A
+ * lock-free snapshot of the handlers would not provide that wait: a pick could still increment the
+ * connection count of a handler that its worker destroyed right after unregistering it.
+ */
+class WorkerLoadConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Utilization differences below this, in parts per million, are considered noise.
+  static constexpr uint32_t UtilizationSlack = 50000;
+
+  explicit WorkerLoadConnectionBalancerImpl(Random::RandomGenerator& random);
+
+  // ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current_handler) override;
+  bool usesEventLoopUtilization() const override { return true; }
+
+private:
+  // Returns true if the candidate is strictly less loaded than the current handler.
+  static bool lessLoaded(const BalancedConnectionHandler& candidate,
+                         const BalancedConnectionHandler& current);
+
+  Random::RandomGenerator& random_;
+  absl::Mutex lock_;
+  // Slots of unregistered handlers are null until they are reused.
+  std::vector<BalancedConnectionHandler*> handlers_ ABSL_GUARDED_BY(lock_);
+};
+
 /**
  * A NOP connection balancer implementation that always continues execution after incrementing
  * the handler's connection count.
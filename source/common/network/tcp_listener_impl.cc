@@ -13,10 +13,30 @@
 #include "source/common/event/file_event_impl.h"
 #include "source/common/network/address_impl.h"
 #include "source/common/network/io_socket_handle_impl.h"
+#include "source/common/network/reuse_port_bpf_cpu_steering_option_impl.h"
 #include "source/common/runtime/runtime_keys.h"
 
+#if defined(__linux__)
+#include "source/common/api/os_sys_calls_impl_linux.h"
+#endif
+
 namespace Envoy {
 namespace Network {
+namespace {
+
+bool steersByIncomingCpu(const Socket& socket) {
+  if (socket.options() == nullptr) {
+    return false;
+  }
+  for (const auto& option : *socket.options()) {
+    if (dynamic_cast<const ReusePortBpfCpuSteeringOptionImpl*>(option.get()) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
 
 bool TcpListenerImpl::rejectCxOverGlobalLimit() const {
   // Enforce the global connection limit if necessary, immediately closing the accepted connection.
@@ -60,11 +80,36 @@ void TcpListenerImpl::releaseGlobalCxLimitResource() const {
   }
 }
 
+void TcpListenerImpl::recordIncomingCpuLocality(IoHandle& io_handle,
+                                                std::optional<int>& worker_cpu) {
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+  if (!worker_cpu.has_value()) {
+    // Workers are pinned to a single CPU when connections are steered by CPU.
+    worker_cpu = Api::LinuxOsSysCallsSingleton::get().sched_getcpu().return_value_;
+  }
+  if (*worker_cpu < 0) {
+    return;
+  }
+  int incoming_cpu = -1;
+  socklen_t incoming_cpu_len = sizeof(incoming_cpu);
+  if (io_handle.getOption(SOL_SOCKET, SO_INCOMING_CPU, &incoming_cpu, &incoming_cpu_len)
+              .return_value_ != 0 ||
+      incoming_cpu < 0) {
+    return;
+  }
+  cb_.recordIncomingCpuLocality(incoming_cpu == *worker_cpu);
+#else
+  UNREFERENCED_PARAMETER(io_handle);
+  UNREFERENCED_PARAMETER(worker_cpu);
+#endif
+}
+
 absl::Status TcpListenerImpl::onSocketEvent(short flags) {
   ASSERT(bind_to_port_);
   ASSERT(flags & (Event::FileReadyType::Read));
 
   uint32_t connections_accepted_from_kernel_count = 0;
+  std::optional<int> worker_cpu;
   for (; connections_accepted_from_kernel_count < max_connections_to_accept_per_socket_event_;
        ++connections_accepted_from_kernel_count) {
     if (!socket_->ioHandle().isOpen()) {
@@ -133,6 +178,10 @@ absl::Status TcpListenerImpl::onSocketEvent(short flags) {
       remote_address = std::move(address_or_error.value());
     }
 
+    if (track_incoming_cpu_) {
+      recordIncomingCpuLocality(*io_handle, worker_cpu);
+    }
+
     cb_.onAccept(std::make_unique<AcceptedSocketImpl>(std::move(io_handle), local_address,
                                                       remote_address, overload_state_,
                                                       track_global_cx_limit_in_overload_manager_));
@@ -160,7 +209,8 @@ TcpListenerImpl::TcpListenerImpl(Event::Dispatcher& dispatcher, Random::RandomGe
           overload_state_
               ? overload_state_->isResourceMonitorEnabled(
                     Server::OverloadProactiveResourceName::GlobalDownstreamMaxConnections)
-              : false) {
+              : false),
+      track_incoming_cpu_(bind_to_port && steersByIncomingCpu(*socket_)) {
   if (bind_to_port) {
     // Use level triggered mode to avoid potential loss of the trigger due to
     // transient accept errors or early termination due to accepting
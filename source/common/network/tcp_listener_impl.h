@@ -1,5 +1,7 @@
 #pragma once
 
+#include <optional>
+
 #include "envoy/common/random_generator.h"
 #include "envoy/runtime/runtime.h"
 
@@ -49,6 +51,10 @@ private:
   // the AcceptedSocketImpl will not be created (e.g., due to address resolution failure).
   void releaseGlobalCxLimitResource() const;
 
+  // Reports whether the kernel processed an accepted connection on the CPU of this worker. The
+  // worker CPU is resolved once per socket event into `worker_cpu`.
+  void recordIncomingCpuLocality(IoHandle& io_handle, std::optional<int>& worker_cpu);
+
   Random::RandomGenerator& random_;
   Runtime::Loader& runtime_;
   bool bind_to_port_;
@@ -59,6 +65,8 @@ private:
   Server::LoadShedPoint* listener_accept_{nullptr};
   Server::ThreadLocalOverloadStateOptRef overload_state_;
   const bool track_global_cx_limit_in_overload_manager_;
+  // True when the listen socket steers connections to workers by the CPU that received them.
+  const bool track_incoming_cpu_;
 };
 
 } // namespace Network
@@ -609,7 +609,7 @@ RouteEntryImplBase::RouteEntryImplBase(const CommonVirtualHostSharedPtr& vhost,
     response_headers_parser_ = std::move(parser_or_error.value());
   }
   if (route.has_metadata()) {
-    metadata_ = std::make_unique<RouteMetadataPack>(route.metadata());
+    metadata_ = RouteMetadataPackInterner::get(route.metadata());
   }
   if (route.route().has_metadata_match()) {
     const auto filter_it = route.route().metadata_match().filter_metadata().find(
@@ -1694,7 +1694,7 @@ CommonVirtualHostImpl::CommonVirtualHostImpl(
   }
 
   if (virtual_host.has_metadata()) {
-    metadata_ = std::make_unique<RouteMetadataPack>(virtual_host.metadata());
+    metadata_ = RouteMetadataPackInterner::get(virtual_host.metadata());
   }
 }
 
@@ -2154,7 +2154,7 @@ CommonConfigImpl::CommonConfigImpl(const envoy::config::route::v3::RouteConfigur
   }
 
   if (config.has_metadata()) {
-    metadata_ = std::make_unique<RouteMetadataPack>(config.metadata());
+    metadata_ = RouteMetadataPackInterner::get(config.metadata());
   }
 }
 
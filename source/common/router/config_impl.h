@@ -51,6 +51,10 @@ namespace Router {
 
 using RouteMetadataPack = Envoy::Config::MetadataPack<HttpRouteTypedMetadataFactory>;
 using RouteMetadataPackPtr = Envoy::Config::MetadataPackPtr<HttpRouteTypedMetadataFactory>;
+using RouteMetadataPackConstSharedPtr =
+    Envoy::Config::MetadataPackConstSharedPtr<HttpRouteTypedMetadataFactory>;
+using RouteMetadataPackInterner =
+    Envoy::Config::MetadataPackInterner<HttpRouteTypedMetadataFactory>;
 using DefaultRouteMetadataPack = ConstSingleton<RouteMetadataPack>;
 
 /**
@@ -443,7 +447,7 @@ private:
   RetryPolicyConstSharedPtr retry_policy_;
   std::unique_ptr<envoy::config::route::v3::HedgePolicy> hedge_policy_;
   std::unique_ptr<const CatchAllVirtualCluster> virtual_cluster_catch_all_;
-  RouteMetadataPackPtr metadata_;
+  RouteMetadataPackConstSharedPtr metadata_;
   const std::optional<uint32_t> per_request_buffer_limit_;
   const std::optional<uint64_t> request_body_buffer_limit_;
   // Keep small members (bools and enums) at the end of class, to reduce alignment overhead.
@@ -988,7 +992,7 @@ private:
   TlsContextMatchCriteriaConstPtr tls_context_match_criteria_;
   HeaderParserPtr request_headers_parser_;
   HeaderParserPtr response_headers_parser_;
-  RouteMetadataPackPtr metadata_;
+  RouteMetadataPackConstSharedPtr metadata_;
   const std::vector<Envoy::Matchers::MetadataMatcher> dynamic_metadata_;
   const std::vector<Envoy::Matchers::FilterStateMatcher> filter_state_;
 
@@ -1396,7 +1400,7 @@ private:
   // Cluster specifier plugins/providers.
   absl::flat_hash_map<std::string, ClusterSpecifierPluginSharedPtr> cluster_specifier_plugins_;
   std::unique_ptr<PerFilterConfigs> per_filter_configs_;
-  RouteMetadataPackPtr metadata_;
+  RouteMetadataPackConstSharedPtr metadata_;
   // Keep small members (bools and enums) at the end of class, to reduce alignment overhead.
   const uint32_t max_direct_response_body_size_bytes_;
   const bool uses_vhds_ : 1;
@@ -138,6 +138,7 @@ FALSE_RUNTIME_GUARD(envoy_reloadable_features_strip_upgrade_header_on_failed_web
 RUNTIME_GUARD(envoy_reloadable_features_tap_honor_tap_enabled);
 RUNTIME_GUARD(envoy_reloadable_features_tcp_proxy_odcds_over_ads_fix);
 RUNTIME_GUARD(envoy_reloadable_features_test_feature_true);
+RUNTIME_GUARD(envoy_reloadable_features_tls_inspector_client_hello_parser);
 RUNTIME_GUARD(envoy_reloadable_features_tls_inspector_enforce_client_tls_version);
 RUNTIME_GUARD(envoy_reloadable_features_udp_set_do_not_fragment);
 RUNTIME_GUARD(envoy_reloadable_features_uhv_allow_malformed_url_encoding);
@@ -293,6 +294,17 @@ FALSE_RUNTIME_GUARD(envoy_reloadable_features_http2_record_histograms);
 // no certificate compression.
 FALSE_RUNTIME_GUARD(envoy_reloadable_features_tls_certificate_compression_brotli);
 
+// Track the min duration of scaled timers with a per-dispatcher timing wheel instead of libevent
+// timers.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_scaled_timers_use_timer_wheel);
+
+// Decode and validate the resources of large xDS responses on a small thread pool.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_xds_parallel_resource_decoding);
+
+// Reuse the decoded resources of SotW xDS responses whose serialized bytes did not change since
+// the previous response of their type.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_xds_sotw_reuse_unchanged_resources);
+
 // DnsFilter created resolver on the worker thread which could lead to race when sharing resolvers
 // Do not turn this on if DnsFilter is used or until the race is fixed
 FALSE_RUNTIME_GUARD(envoy_restart_features_shared_cares_dns_resolver);
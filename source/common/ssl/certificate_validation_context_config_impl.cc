@@ -46,7 +46,10 @@ CertificateValidationContextConfigImpl::CertificateValidationContextConfigImpl(
                             ? std::optional<uint32_t>(config.max_verify_depth().value())
                             : std::nullopt),
       auto_sni_san_match_(auto_sni_san_match),
-      suppress_client_ca_list_(config.suppress_client_ca_list()) {}
+      suppress_client_ca_list_(config.suppress_client_ca_list()),
+      verification_cache_(config.has_verification_cache()
+                              ? std::make_optional(config.verification_cache())
+                              : std::nullopt) {}
 
 absl::StatusOr<std::unique_ptr<CertificateValidationContextConfigImpl>>
 CertificateValidationContextConfigImpl::create(
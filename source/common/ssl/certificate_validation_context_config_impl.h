@@ -63,6 +63,12 @@ public:
 
   bool suppressClientCaList() const override { return suppress_client_ca_list_; }
 
+  const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                          CertificateValidationContext::VerificationCache>&
+  verificationCache() const override {
+    return verification_cache_;
+  }
+
 protected:
   CertificateValidationContextConfigImpl(
       std::string ca_cert, std::string certificate_revocation_list,
@@ -91,6 +97,9 @@ private:
   std::optional<uint32_t> max_verify_depth_;
   const bool auto_sni_san_match_;
   const bool suppress_client_ca_list_;
+  const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                          CertificateValidationContext::VerificationCache>
+      verification_cache_;
 };
 
 } // namespace Ssl
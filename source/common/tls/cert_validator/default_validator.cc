@@ -107,6 +107,98 @@ std::shared_ptr<CrlCache> getCrlCache(Singleton::Manager& singleton_manager) {
                                               [] { return std::make_shared<CrlCache>(); });
 }
 
+VerificationCache::VerificationCache(uint32_t max_entries, std::chrono::milliseconds ttl,
+                                     bool allow_expired, TimeSource& time_source,
+                                     SslStats& stats)
+    : max_entries_(max_entries), ttl_(ttl), allow_expired_(allow_expired),
+      time_source_(time_source), stats_(stats) {}
+
+VerificationCache::Key VerificationCache::key(STACK_OF(X509)& cert_chain, bool is_server) {
+  // X509_digest() hashes the DER encoding cached by BoringSSL when the
+  // certificate was parsed, so this does not re-encode the chain.
+  bssl::ScopedEVP_MD_CTX md;
+  int rc = EVP_DigestInit_ex(md.get(), EVP_sha256(), nullptr);
+  RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  const uint8_t purpose = is_server ? 1 : 0;
+  rc = EVP_DigestUpdate(md.get(), &purpose, sizeof(purpose));
+  RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  for (const X509* cert : &cert_chain) {
+    uint8_t cert_digest[SHA256_DIGEST_LENGTH];
+    unsigned cert_digest_len = 0;
+    rc = X509_digest(cert, EVP_sha256(), cert_digest, &cert_digest_len);
+    RELEASE_ASSERT(rc == 1 && cert_digest_len == SHA256_DIGEST_LENGTH,
+                   Utility::getLastCryptoError().value_or(""));
+    rc = EVP_DigestUpdate(md.get(), cert_digest, cert_digest_len);
+    RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  }
+  Key key;
+  rc = EVP_DigestFinal_ex(md.get(), key.data(), nullptr);
+  RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  return key;
+}
+
+std::optional<std::vector<bssl::UniquePtr<X509>>> VerificationCache::lookup(const Key& key) {
+  absl::MutexLock lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    stats_.verification_cache_miss_.inc();
+    return std::nullopt;
+  }
+  if (it->second->expiry_ <= time_source_.monotonicTime()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+    stats_.verification_cache_miss_.inc();
+    return std::nullopt;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  stats_.verification_cache_hit_.inc();
+
+  std::vector<bssl::UniquePtr<X509>> chain;
+  chain.reserve(it->second->chain_.size());
+  for (const auto& cert : it->second->chain_) {
+    chain.emplace_back(bssl::UpRef(cert.get()));
+  }
+  return chain;
+}
+
+void VerificationCache::insert(const Key& key, STACK_OF(X509)* verified_chain) {
+  std::chrono::milliseconds lifetime = ttl_;
+  std::vector<bssl::UniquePtr<X509>> chain;
+  const SystemTime now = time_source_.systemTime();
+  for (X509* cert : verified_chain) {
+    if (!allow_expired_) {
+      lifetime = std::min(lifetime, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        Utility::getExpirationTime(*cert) - now));
+    }
+    chain.emplace_back(bssl::UpRef(cert));
+  }
+  if (lifetime.count() <= 0) {
+    return;
+  }
+  const MonotonicTime expiry = time_source_.monotonicTime() + lifetime;
+
+  absl::MutexLock lock(mutex_);
+  if (auto it = index_.find(key); it != index_.end()) {
+    // Another worker verified the same chain concurrently.
+    it->second->chain_ = std::move(chain);
+    it->second->expiry_ = expiry;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+  if (entries_.size() >= max_entries_) {
+    index_.erase(entries_.back().key_);
+    entries_.pop_back();
+    stats_.verification_cache_evicted_.inc();
+  }
+  entries_.push_front(Entry{key, std::move(chain), expiry});
+  index_[key] = entries_.begin();
+}
+
+size_t VerificationCache::size() const {
+  absl::MutexLock lock(mutex_);
+  return entries_.size();
+}
+
 DefaultCertValidator::DefaultCertValidator(
     const Envoy::Ssl::CertificateValidationContextConfig* config, SslStats& stats,
     Server::Configuration::CommonFactoryContext& context)
@@ -185,6 +277,14 @@ absl::StatusOr<int> DefaultCertValidator::initializeSslContexts(std::vector<SSL_
     }
   }
 
+  if (verify_trusted_ca_ && config_->verificationCache().has_value()) {
+    const auto& cache_config = config_->verificationCache().value();
+    verification_cache_ = std::make_unique<VerificationCache>(
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(cache_config, max_entries, 1024),
+        std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(cache_config, ttl, 60000)),
+        config_->allowExpiredCertificate(), context_.timeSource(), stats_);
+  }
+
   // Disallow insecure configuration.
   if (config_ != nullptr && config_->autoSniSanMatch() && !verify_trusted_ca_) {
     return absl::InvalidArgumentError(
@@ -385,7 +485,17 @@ ValidationResults DefaultCertValidator::doVerifyCertChain(
   std::vector<bssl::UniquePtr<X509>> validated_chain;
   X509* leaf_cert = sk_X509_value(&cert_chain, 0);
   ASSERT(leaf_cert);
-  if (verify_trusted_ca_) {
+  std::optional<VerificationCache::Key> cache_key;
+  if (verification_cache_ != nullptr) {
+    cache_key = VerificationCache::key(cert_chain, is_server);
+    if (auto cached_chain = verification_cache_->lookup(*cache_key); cached_chain.has_value()) {
+      validated_chain = std::move(*cached_chain);
+      detailed_status = Envoy::Ssl::ClientValidationStatus::Validated;
+    }
+  }
+  // A cache hit has already been verified against the trust chain, so only the
+  // per-connection checks below need to run.
+  if (verify_trusted_ca_ && detailed_status == Envoy::Ssl::ClientValidationStatus::NotValidated) {
     X509_STORE* verify_store = SSL_CTX_get_cert_store(&ssl_ctx);
     ASSERT(verify_store);
     bssl::UniquePtr<X509_STORE_CTX> ctx(X509_STORE_CTX_new());
@@ -422,6 +532,9 @@ ValidationResults DefaultCertValidator::doVerifyCertChain(
     }
 
     STACK_OF(X509)* verified_chain = X509_STORE_CTX_get0_chain(ctx.get());
+    if (cache_key.has_value()) {
+      verification_cache_->insert(*cache_key, verified_chain);
+    }
     for (size_t i = 0; i < sk_X509_num(verified_chain); i++) {
       X509* cert = sk_X509_value(verified_chain, i);
       validated_chain.emplace_back(bssl::UpRef(cert));
@@ -1,15 +1,19 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <deque>
 #include <functional>
+#include <list>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "envoy/common/pure.h"
+#include "envoy/common/time.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/registry/registry.h"
 #include "envoy/singleton/instance.h"
@@ -90,6 +94,61 @@ private:
 // Returns the process-wide CRL cache, creating it on first use.
 std::shared_ptr<CrlCache> getCrlCache(Singleton::Manager& singleton_manager);
 
+// Bounded LRU cache of peer certificate chains that passed X509_verify_cert(), so
+// that peers presenting the same chain on every handshake (e.g. service mesh
+// sidecars) do not pay for chain building and CRL checks each time.
+//
+// Only the trust chain verification result is cached: SAN, hash and SPKI checks
+// depend on per-connection state and are always re-evaluated by the caller.
+//
+// Each DefaultCertValidator owns its cache. A trusted CA or CRL update creates a
+// new TLS context and validator, so cached results never outlive the trust
+// anchors and CRLs they were computed against. Lookups and insertions happen on
+// worker threads and are serialized by a mutex.
+class VerificationCache {
+public:
+  using Key = std::array<uint8_t, SHA256_DIGEST_LENGTH>;
+
+  VerificationCache(uint32_t max_entries, std::chrono::milliseconds ttl, bool allow_expired,
+                    TimeSource& time_source, SslStats& stats);
+
+  // Returns the cache key for `cert_chain` as presented by the peer. The key
+  // covers the DER encoding of every certificate in the chain and whether the
+  // peer is a client, as the verification purpose differs.
+  static Key key(STACK_OF(X509)& cert_chain, bool is_server);
+
+  // Returns the verified chain cached for `key`, or nullopt if there is no
+  // entry or it has expired.
+  std::optional<std::vector<bssl::UniquePtr<X509>>> lookup(const Key& key);
+
+  // Caches `verified_chain`, the chain built by a successful X509_verify_cert().
+  // The entry expires after the configured TTL, or earlier if a certificate in
+  // the chain expires first.
+  void insert(const Key& key, STACK_OF(X509)* verified_chain);
+
+  // Number of cached chains, including expired ones not yet evicted. Exposed
+  // for testing.
+  size_t size() const;
+
+private:
+  struct Entry {
+    Key key_;
+    std::vector<bssl::UniquePtr<X509>> chain_;
+    MonotonicTime expiry_;
+  };
+  using EntryList = std::list<Entry>;
+
+  const uint32_t max_entries_;
+  const std::chrono::milliseconds ttl_;
+  const bool allow_expired_;
+  TimeSource& time_source_;
+  SslStats& stats_;
+  mutable absl::Mutex mutex_;
+  // Most recently used entries first.
+  EntryList entries_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<Key, EntryList::iterator> index_ ABSL_GUARDED_BY(mutex_);
+};
+
 class DefaultCertValidator : public CertValidator, Logger::Loggable<Logger::Id::connection> {
 public:
   DefaultCertValidator(const Envoy::Ssl::CertificateValidationContextConfig* config,
@@ -182,6 +241,8 @@ private:
   // The parsed CRLs shared with other TLS contexts that reference the same CRL.
   // This also keeps the CRL cache alive for as long as the validator uses it.
   CrlListSharedPtr shared_crl_;
+  // Only set when a trusted CA is configured and caching was requested.
+  std::unique_ptr<VerificationCache> verification_cache_;
   bool allow_untrusted_certificate_{false};
   bool verify_trusted_ca_{false};
   const bool auto_sni_san_match_{false};
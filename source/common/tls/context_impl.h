@@ -94,6 +94,12 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return true if connections should offload record protection to the kernel after the
+   * handshake.
+   */
+  bool kernelTlsEnabled() const { return kernel_tls_enabled_; }
+
   /**
    * The global SSL-library index used for storing a pointer to the SslExtendedSocketInfo
    * class in the SSL instance, for retrieval in callbacks.
@@ -185,6 +191,7 @@ protected:
   const Network::Address::IpList tls_keylog_local_;
   const Network::Address::IpList tls_keylog_remote_;
   AccessLog::AccessLogFileSharedPtr tls_keylog_file_;
+  const bool kernel_tls_enabled_;
 };
 
 using ContextImplSharedPtr = std::shared_ptr<ContextImpl>;
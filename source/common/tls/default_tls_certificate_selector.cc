@@ -12,7 +12,9 @@ DefaultTlsCertificateSelector::DefaultTlsCertificateSelector(
     : server_ctx_(dynamic_cast<ServerContextImpl&>(selector_ctx)),
       tls_contexts_(selector_ctx.getTlsContexts()), ocsp_staple_policy_(config.ocspStaplePolicy()),
       full_scan_certs_on_sni_mismatch_(config.fullScanCertsOnSNIMismatch()) {
-  for (auto& ctx : tls_contexts_) {
+  for (uint32_t i = 0; i < tls_contexts_.size(); ++i) {
+    const Ssl::TlsContext& ctx = tls_contexts_[i];
+    contexts_by_curve_[ctx.ec_group_curve_name_].push_back(i);
     if (ctx.cert_chain_ == nullptr) {
       continue;
     }
@@ -84,6 +86,20 @@ void DefaultTlsCertificateSelector::populateServerNamesMap(const Ssl::TlsContext
   }
 }
 
+const Ssl::TlsContext* DefaultTlsCertificateSelector::firstUsableContext(
+    const std::vector<uint32_t>& indices, bool client_ocsp_capable,
+    Ssl::OcspStapleAction& ocsp_staple_action) const {
+  for (const uint32_t index : indices) {
+    const Ssl::TlsContext& ctx = tls_contexts_[index];
+    auto action = ocspStapleAction(ctx, client_ocsp_capable, ocsp_staple_policy_);
+    if (action != Ssl::OcspStapleAction::Fail) {
+      ocsp_staple_action = action;
+      return &ctx;
+    }
+  }
+  return nullptr;
+}
+
 Ssl::SelectionResult
 DefaultTlsCertificateSelector::selectTlsContext(const SSL_CLIENT_HELLO& ssl_client_hello,
                                                 Ssl::CertificateSelectionCallbackPtr) {
@@ -268,11 +284,28 @@ DefaultTlsCertificateSelector::findTlsContext(absl::string_view sni,
   // it requires full_scan_certs_on_sni_mismatch is enabled.
   if (selected_ctx == nullptr) {
     candidate_ctx = nullptr;
-    // Skip loop when there is no cert compatible to key type
+    // Skip lookup when there is no cert compatible to key type
     if (client_ecdsa_capable || (!client_ecdsa_capable && has_rsa_)) {
-      for (const auto& ctx : tls_contexts_) {
-        if (selected(ctx)) {
-          break;
+      // Equivalent to scanning ``tls_contexts_`` in order: the earliest configured ECDSA cert on a
+      // curve supported by the client wins, otherwise the earliest non-ECDSA cert is used.
+      if (client_ecdsa_capable) {
+        for (const Ssl::CurveNID curve : client_ecdsa_capabilities) {
+          auto it = contexts_by_curve_.find(curve);
+          if (it == contexts_by_curve_.end()) {
+            continue;
+          }
+          Ssl::OcspStapleAction action;
+          const Ssl::TlsContext* ctx = firstUsableContext(it->second, client_ocsp_capable, action);
+          if (ctx != nullptr && (selected_ctx == nullptr || ctx < selected_ctx)) {
+            selected_ctx = ctx;
+            ocsp_staple_action = action;
+          }
+        }
+      }
+      if (selected_ctx == nullptr) {
+        auto it = contexts_by_curve_.find(Ssl::EC_CURVE_INVALID_NID);
+        if (it != contexts_by_curve_.end()) {
+          selected_ctx = firstUsableContext(it->second, client_ocsp_capable, ocsp_staple_action);
         }
       }
     }
@@ -49,11 +49,21 @@ private:
 
   void populateServerNamesMap(const Ssl::TlsContext& ctx, const int pkey_id);
 
+  // Returns the first context in `indices` (which are in configuration order) that does not
+  // violate the OCSP stapling policy, or nullptr if there is none.
+  const Ssl::TlsContext* firstUsableContext(const std::vector<uint32_t>& indices,
+                                            bool client_ocsp_capable,
+                                            Ssl::OcspStapleAction& ocsp_staple_action) const;
+
   // ServerContext own this selector, it's safe to use itself here.
   ServerContextImpl& server_ctx_;
   const std::vector<Ssl::TlsContext>& tls_contexts_;
 
   ServerNamesMap server_names_map_;
+  // Indices into ``tls_contexts_`` grouped by the EC curve of the certificate, in configuration
+  // order. Non-ECDSA certificates are grouped under ``Ssl::EC_CURVE_INVALID_NID``. Used for the
+  // full scan so that its cost does not grow with the number of configured certificates.
+  absl::flat_hash_map<Ssl::CurveNID, std::vector<uint32_t>> contexts_by_curve_;
   bool has_rsa_{false};
 
   const Ssl::ServerContextConfig::OcspStaplePolicy ocsp_staple_policy_;
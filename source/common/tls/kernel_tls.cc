@@ -0,0 +1,251 @@
+#include "source/common/tls/kernel_tls.h"
+
+#include <cstring>
+#include <vector>
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "openssl/mem.h"
+
+#if defined(__linux__)
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#endif
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+#if defined(__linux__) && defined(TLS_TX) && defined(TLS_RX)
+
+namespace {
+
+constexpr uint8_t AlertRecordType = 21;
+constexpr uint8_t AlertLevelWarning = 1;
+constexpr uint8_t CloseNotifyAlert = 0;
+constexpr size_t SequenceSize = 8;
+
+// Large enough for any of the crypto info structures used below.
+union CryptoInfo {
+  tls_crypto_info info;
+  tls12_crypto_info_aes_gcm_128 aes_gcm_128;
+  tls12_crypto_info_aes_gcm_256 aes_gcm_256;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+  tls12_crypto_info_chacha20_poly1305 chacha20_poly1305;
+#endif
+};
+
+struct CipherParams {
+  size_t key_len_;
+  // Length of the implicit part of the nonce, i.e. client_write_IV/server_write_IV in the key
+  // block.
+  size_t fixed_iv_len_;
+};
+
+absl::StatusOr<CipherParams> cipherParams(int cipher_nid) {
+  switch (cipher_nid) {
+  case NID_aes_128_gcm:
+    return CipherParams{TLS_CIPHER_AES_GCM_128_KEY_SIZE, TLS_CIPHER_AES_GCM_128_SALT_SIZE};
+  case NID_aes_256_gcm:
+    return CipherParams{TLS_CIPHER_AES_GCM_256_KEY_SIZE, TLS_CIPHER_AES_GCM_256_SALT_SIZE};
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+  case NID_chacha20_poly1305:
+    return CipherParams{TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE,
+                        TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE};
+#endif
+  default:
+    return absl::UnimplementedError("cipher is not supported by kernel TLS");
+  }
+}
+
+void storeSequence(uint64_t sequence, unsigned char* out) {
+  for (size_t i = SequenceSize; i > 0; --i) {
+    out[i - 1] = sequence & 0xff;
+    sequence >>= 8;
+  }
+}
+
+// Fills `out` with the key material for one direction and returns the size of the structure that
+// must be passed to setsockopt().
+socklen_t buildCryptoInfo(int cipher_nid, const uint8_t* key, const uint8_t* fixed_iv,
+                          uint64_t sequence, CryptoInfo& out) {
+  memset(&out, 0, sizeof(out));
+  out.info.version = TLS_1_2_VERSION;
+  switch (cipher_nid) {
+  case NID_aes_128_gcm:
+    out.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+    memcpy(out.aes_gcm_128.key, key, sizeof(out.aes_gcm_128.key));
+    memcpy(out.aes_gcm_128.salt, fixed_iv, sizeof(out.aes_gcm_128.salt));
+    // BoringSSL uses the sequence number as the explicit nonce, and the kernel advances the
+    // explicit nonce together with the sequence number.
+    storeSequence(sequence, out.aes_gcm_128.iv);
+    storeSequence(sequence, out.aes_gcm_128.rec_seq);
+    return sizeof(out.aes_gcm_128);
+  case NID_aes_256_gcm:
+    out.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+    memcpy(out.aes_gcm_256.key, key, sizeof(out.aes_gcm_256.key));
+    memcpy(out.aes_gcm_256.salt, fixed_iv, sizeof(out.aes_gcm_256.salt));
+    storeSequence(sequence, out.aes_gcm_256.iv);
+    storeSequence(sequence, out.aes_gcm_256.rec_seq);
+    return sizeof(out.aes_gcm_256);
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+  case NID_chacha20_poly1305:
+    out.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+    memcpy(out.chacha20_poly1305.key, key, sizeof(out.chacha20_poly1305.key));
+    memcpy(out.chacha20_poly1305.iv, fixed_iv, sizeof(out.chacha20_poly1305.iv));
+    storeSequence(sequence, out.chacha20_poly1305.rec_seq);
+    return sizeof(out.chacha20_poly1305);
+#endif
+  }
+  PANIC("not reached");
+}
+
+} // namespace
+
+absl::StatusOr<Offload> enable(SSL* ssl, os_fd_t fd) {
+  if (SSL_version(ssl) != TLS1_2_VERSION) {
+    return absl::UnimplementedError("kernel TLS is only supported with TLS 1.2");
+  }
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) {
+    return absl::FailedPreconditionError("no cipher negotiated");
+  }
+  const int cipher_nid = SSL_CIPHER_get_cipher_nid(cipher);
+  auto params_or_error = cipherParams(cipher_nid);
+  if (!params_or_error.ok()) {
+    return absl::UnimplementedError(
+        absl::StrCat(SSL_CIPHER_get_name(cipher), " is not supported by kernel TLS"));
+  }
+  const CipherParams& params = params_or_error.value();
+  // Bytes that BoringSSL already read past the handshake belong to records the kernel will never
+  // see, so receive offload is impossible, and without it transmit offload is refused too.
+  if (SSL_has_pending(ssl)) {
+    return absl::UnavailableError("data past the handshake was already read");
+  }
+
+  // https://www.rfc-editor.org/rfc/rfc5246#section-6.3. The MAC keys are empty for AEAD ciphers,
+  // so the key block is client_write_key, server_write_key, client_write_IV, server_write_IV.
+  const size_t key_block_len = SSL_get_key_block_len(ssl);
+  if (key_block_len != 2 * (params.key_len_ + params.fixed_iv_len_)) {
+    return absl::InternalError(absl::StrCat("unexpected key block length ", key_block_len));
+  }
+  std::vector<uint8_t> key_block(key_block_len);
+  if (!SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return absl::InternalError("failed to export the key block");
+  }
+  const uint8_t* client_key = key_block.data();
+  const uint8_t* server_key = client_key + params.key_len_;
+  const uint8_t* client_iv = server_key + params.key_len_;
+  const uint8_t* server_iv = client_iv + params.fixed_iv_len_;
+  const bool is_server = SSL_is_server(ssl);
+
+  CryptoInfo tx;
+  CryptoInfo rx;
+  const socklen_t tx_len =
+      buildCryptoInfo(cipher_nid, is_server ? server_key : client_key,
+                      is_server ? server_iv : client_iv, SSL_get_write_sequence(ssl), tx);
+  const socklen_t rx_len =
+      buildCryptoInfo(cipher_nid, is_server ? client_key : server_key,
+                      is_server ? client_iv : server_iv, SSL_get_read_sequence(ssl), rx);
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  Offload offload;
+  Api::SysCallIntResult result =
+      os_sys_calls.setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls"));
+  if (result.return_value_ == 0) {
+    // A socket with the ULP attached but no keys installed behaves like a plain TCP socket, so a
+    // failure here still leaves the connection usable through BoringSSL.
+    result = os_sys_calls.setsockopt(fd, SOL_TLS, TLS_RX, &rx, rx_len);
+  }
+  if (result.return_value_ == 0) {
+    offload.rx_ = true;
+    // Receive offload must come first: while BoringSSL still reads, it may write alerts, e.g. to
+    // refuse a renegotiation, which would reuse sequence numbers the kernel already sent. Without
+    // transmit offload, BoringSSL keeps writing records with its own, consistent, write state.
+    offload.tx_ = os_sys_calls.setsockopt(fd, SOL_TLS, TLS_TX, &tx, tx_len).return_value_ == 0;
+  }
+  OPENSSL_cleanse(&tx, sizeof(tx));
+  OPENSSL_cleanse(&rx, sizeof(rx));
+
+  if (!offload.rx_) {
+    return absl::UnavailableError(
+        absl::StrCat("kernel TLS is not available: ", errorDetails(result.errno_)));
+  }
+  return offload;
+}
+
+Api::SysCallSizeResult sendCloseNotify(os_fd_t fd) {
+  uint8_t alert[2] = {AlertLevelWarning, CloseNotifyAlert};
+  iovec iov{alert, sizeof(alert)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint8_t))] = {};
+
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = AlertRecordType;
+
+  return Api::OsSysCallsSingleton::get().sendmsg(fd, &message, MSG_DONTWAIT);
+}
+
+bool consumeCloseNotify(os_fd_t fd) {
+  uint8_t record[2] = {};
+  iovec iov{record, sizeof(record)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint8_t))] = {};
+
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().recvmsg(fd, &message, MSG_DONTWAIT);
+  if (result.return_value_ != sizeof(record)) {
+    return false;
+  }
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&message, cmsg)) {
+    if (cmsg->cmsg_level == SOL_TLS && cmsg->cmsg_type == TLS_GET_RECORD_TYPE) {
+      return *CMSG_DATA(cmsg) == AlertRecordType && record[1] == CloseNotifyAlert;
+    }
+  }
+  return false;
+}
+
+#else
+
+absl::StatusOr<Offload> enable(SSL*, os_fd_t) {
+  return absl::UnimplementedError("kernel TLS is not supported on this platform");
+}
+
+Api::SysCallSizeResult sendCloseNotify(os_fd_t) { return {-1, SOCKET_ERROR_NOT_SUP}; }
+
+bool consumeCloseNotify(os_fd_t) { return false; }
+
+#endif
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
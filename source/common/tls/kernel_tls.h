@@ -0,0 +1,55 @@
+#pragma once
+
+#include "envoy/api/os_sys_calls_common.h"
+#include "envoy/common/platform.h"
+
+#include "absl/status/statusor.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+/**
+ * The directions of a connection whose record protection has been moved into the kernel. TX is
+ * only ever offloaded together with RX, so that BoringSSL never writes once the kernel does.
+ */
+struct Offload {
+  bool tx_{false};
+  bool rx_{false};
+};
+
+/**
+ * Installs the record keys negotiated by `ssl` on the TCP socket `fd` using the Linux TLS ULP.
+ * Afterwards records read from `fd` are decrypted by the kernel and, if TX was offloaded as well,
+ * plaintext written to `fd` is encrypted by it. This must be called right after the handshake
+ * completed, before any application data was exchanged through `ssl`.
+ *
+ * Only TLS 1.2 with AES-GCM or ChaCha20-Poly1305 is supported: BoringSSL does not export TLS 1.3
+ * traffic secrets, and TLS 1.3 also relies on post-handshake messages that would have to be
+ * handled outside of BoringSSL.
+ *
+ * @return the offloaded directions, or an error if nothing was offloaded and the connection must
+ *         keep using BoringSSL for record protection.
+ */
+absl::StatusOr<Offload> enable(SSL* ssl, os_fd_t fd);
+
+/**
+ * Sends a close_notify alert on a socket with kernel TX offload.
+ */
+Api::SysCallSizeResult sendCloseNotify(os_fd_t fd);
+
+/**
+ * Consumes the control record at the head of a socket with kernel RX offload. Plain reads fail
+ * with EIO while such a record is pending.
+ * @return true if the record was a close_notify alert, false for any other record or error.
+ */
+bool consumeCloseNotify(os_fd_t fd);
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -8,6 +8,7 @@
 #include "source/common/http/headers.h"
 #include "source/common/runtime/runtime_features.h"
 #include "source/common/tls/io_handle_bio.h"
+#include "source/common/tls/kernel_tls.h"
 #include "source/common/tls/ssl_handshaker.h"
 #include "source/common/tls/utility.h"
 
@@ -118,6 +119,10 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
     }
   }
 
+  if (kernel_tls_rx_) {
+    return doKernelTlsRead(read_buffer);
+  }
+
   bool keep_reading = true;
   bool end_stream = false;
   PostIoAction action = PostIoAction::KeepOpen;
@@ -173,6 +178,49 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
   return {action, bytes_read, end_stream, detected_io_error_};
 }
 
+Network::IoResult SslSocket::doKernelTlsRead(Buffer::Instance& read_buffer) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  std::optional<Api::IoError::IoErrorCode> err = std::nullopt;
+  do {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().read(read_buffer, std::nullopt);
+
+    if (result.ok()) {
+      ENVOY_CONN_LOG(trace, "ktls read returns: {}", callbacks_->connection(),
+                     result.return_value_);
+      if (result.return_value_ == 0) {
+        // Non-graceful shutdown by closing the underlying socket.
+        end_stream = true;
+        break;
+      }
+      bytes_read += result.return_value_;
+      if (callbacks_->shouldDrainReadBuffer()) {
+        callbacks_->setTransportSocketIsReadable();
+        break;
+      }
+    } else {
+      ENVOY_CONN_LOG(trace, "ktls read error: {}, code: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails(), static_cast<int>(result.err_->getErrorCode()));
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        break;
+      }
+      // The kernel fails plain reads with EIO when the next record is not application data.
+      if (result.err_->getSystemErrorCode() == EIO &&
+          KernelTls::consumeCloseNotify(callbacks_->ioHandle().fdDoNotUse())) {
+        // Graceful shutdown using close_notify TLS alert.
+        end_stream = true;
+        break;
+      }
+      action = PostIoAction::Close;
+      err = result.err_->getErrorCode();
+      break;
+    }
+  } while (true);
+
+  return {action, bytes_read, end_stream, err};
+}
+
 void SslSocket::onPrivateKeyMethodComplete() { resumeHandshake(); }
 
 void SslSocket::resumeHandshake() {
@@ -203,6 +251,10 @@ void SslSocket::onSuccess(SSL* ssl) {
         callbacks_->connection().dispatcher().timeSource());
   }
 
+  if (ctx_->kernelTlsEnabled()) {
+    enableKernelTls(ssl);
+  }
+
   // There is at least one assertion that reads are enabled when the connected event is raised, so
   // ensure we are in the correct state. The same operation would happen in
   // `SslSocket::doHandshake()`, but it wouldn't happen until after the event was raised.
@@ -216,6 +268,29 @@ void SslSocket::onSuccess(SSL* ssl) {
 
 void SslSocket::onFailure() { drainErrorQueue(); }
 
+void SslSocket::enableKernelTls(SSL* ssl) {
+  auto offload_or_error = KernelTls::enable(ssl, callbacks_->ioHandle().fdDoNotUse());
+  if (!offload_or_error.ok()) {
+    ENVOY_CONN_LOG(debug, "kernel TLS offload unavailable: {}", callbacks_->connection(),
+                   offload_or_error.status().message());
+    ctx_->stats().kernel_tls_unavailable_.inc();
+    return;
+  }
+  kernel_tls_tx_ = offload_or_error->tx_;
+  kernel_tls_rx_ = offload_or_error->rx_;
+  // BoringSSL may write alerts while it reads, with a write state that would be stale once the
+  // kernel writes.
+  ASSERT(kernel_tls_rx_ || !kernel_tls_tx_);
+  ENVOY_CONN_LOG(debug, "kernel TLS offload enabled: tx={} rx={}", callbacks_->connection(),
+                 kernel_tls_tx_, kernel_tls_rx_);
+  if (kernel_tls_tx_) {
+    ctx_->stats().kernel_tls_tx_.inc();
+  }
+  if (kernel_tls_rx_) {
+    ctx_->stats().kernel_tls_rx_.inc();
+  }
+}
+
 PostIoAction SslSocket::doHandshake() {
   auto ret = info_->doHandshake();
   if (ret == PostIoAction::KeepOpen) {
@@ -337,6 +412,10 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (kernel_tls_tx_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
@@ -387,6 +466,33 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    // The kernel splits the plaintext into records, so the buffer can be written without
+    // linearizing it first.
+    Api::IoCallUint64Result result = callbacks_->ioHandle().write(write_buffer);
+    if (result.ok()) {
+      ENVOY_CONN_LOG(trace, "ktls write returns: {}", callbacks_->connection(),
+                     result.return_value_);
+      total_bytes_written += result.return_value_;
+    } else {
+      ENVOY_CONN_LOG(trace, "ktls write error: {}, code: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails(), static_cast<int>(result.err_->getErrorCode()));
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        break;
+      }
+      return {PostIoAction::Close, total_bytes_written, false, result.err_->getErrorCode()};
+    }
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() {
   ASSERT(info_->state() == Ssl::SocketState::HandshakeWaitingForConnectionData);
 }
@@ -397,6 +503,15 @@ void SslSocket::shutdownSsl() {
   ASSERT(info_->state() != Ssl::SocketState::HandshakeWaitingForConnectionData);
   if (info_->state() != Ssl::SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (kernel_tls_tx_) {
+      // BoringSSL no longer owns the write side, so the alert has to be sent through the kernel.
+      const Api::SysCallSizeResult result =
+          KernelTls::sendCloseNotify(callbacks_->ioHandle().fdDoNotUse());
+      ENVOY_CONN_LOG(debug, "kernel TLS shutdown: rc={}", callbacks_->connection(),
+                     result.return_value_);
+      info_->setState(Ssl::SocketState::ShutdownSent);
+      return;
+    }
     int rc = SSL_shutdown(rawSsl());
     if constexpr (Event::PlatformDefaultTriggerType == Event::FileTriggerType::EmulatedEdge) {
       // Windows operate under `EmulatedEdge`. These are level events that are artificially
@@ -96,6 +96,9 @@ private:
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
 
   Network::PostIoAction doHandshake();
+  void enableKernelTls(SSL* ssl);
+  Network::IoResult doKernelTlsRead(Buffer::Instance& read_buffer);
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
   void drainErrorQueue();
   void shutdownSsl();
   void shutdownBasic();
@@ -108,6 +111,10 @@ private:
   std::string failure_reason_;
   std::optional<Api::IoError::IoErrorCode> detected_io_error_;
   bool read_disabled_{false};
+  // Set once record protection for the respective direction has been handed over to the kernel.
+  // BoringSSL is no longer used for that direction afterwards.
+  bool kernel_tls_tx_{false};
+  bool kernel_tls_rx_{false};
 
   SslHandshakerImplSharedPtr info_;
 };
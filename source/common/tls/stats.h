@@ -20,7 +20,13 @@ namespace Tls {
   COUNTER(ocsp_staple_failed)                                                                      \
   COUNTER(ocsp_staple_omitted)                                                                     \
   COUNTER(ocsp_staple_responses)                                                                   \
-  COUNTER(ocsp_staple_requests)
+  COUNTER(ocsp_staple_requests)                                                                    \
+  COUNTER(kernel_tls_tx)                                                                           \
+  COUNTER(kernel_tls_rx)                                                                           \
+  COUNTER(kernel_tls_unavailable)                                                                  \
+  COUNTER(verification_cache_hit)                                                                  \
+  COUNTER(verification_cache_miss)                                                                 \
+  COUNTER(verification_cache_evicted)
 /**
  * Wrapper struct for SSL stats. @see stats_macros.h
  */
@@ -0,0 +1,17 @@
+#include "source/common/upstream/address_pool.h"
+
+namespace Envoy {
+namespace Upstream {
+
+SINGLETON_MANAGER_REGISTRATION(shared_address_pool);
+
+SharedAddressPoolSharedPtr AddressPool::getSharedAddressPool(Singleton::Manager& manager,
+                                                             Event::Dispatcher& dispatcher) {
+  // Creating a pinned addresses pool.
+  return manager.getTyped<SharedAddressPool>(
+      SINGLETON_MANAGER_REGISTERED_NAME(shared_address_pool),
+      [&dispatcher] { return std::make_shared<SharedAddressPool>(dispatcher); }, true);
+}
+
+} // namespace Upstream
+} // namespace Envoy
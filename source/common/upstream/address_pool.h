@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/config/core/v3/address.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/network/address.h"
+#include "envoy/singleton/manager.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/common/shared_pool/shared_pool.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * An endpoint address, resolved once and shared by the hosts of all the clusters that have it.
+ * Only the proto is hashed and compared, the resolved address is filled in by the first cluster
+ * that resolves it.
+ */
+struct SharedAddress {
+  envoy::config::core::v3::Address proto_;
+  Network::Address::InstanceConstSharedPtr address_;
+};
+
+struct SharedAddressHash {
+  size_t operator()(const SharedAddress& address) const {
+    return MessageUtil::hash(address.proto_);
+  }
+};
+
+struct SharedAddressEqualTo {
+  bool operator()(const SharedAddress& lhs, const SharedAddress& rhs) const {
+    return Protobuf::util::MessageDifferencer::Equals(lhs.proto_, rhs.proto_);
+  }
+};
+
+using SharedAddressPool =
+    SharedPool::ObjectSharedPool<SharedAddress, SharedAddressHash, SharedAddressEqualTo>;
+using SharedAddressPoolSharedPtr = std::shared_ptr<SharedAddressPool>;
+
+class AddressPool {
+public:
+  /**
+   * Returns an ObjectSharedPool to store resolved endpoint addresses
+   * @param manager used to create singleton
+   * @param dispatcher the dispatcher object reference to the thread that created the
+   * ObjectSharedPool
+   */
+  static SharedAddressPoolSharedPtr getSharedAddressPool(Singleton::Manager& manager,
+                                                         Event::Dispatcher& dispatcher);
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -1699,6 +1699,9 @@ ClusterImplBase::ClusterImplBase(const envoy::config::cluster::v3::Cluster& clus
           cluster_context.serverFactoryContext().singletonManager(),
           cluster_context.serverFactoryContext().mainThreadDispatcher())),
       const_locality_shared_pool_(LocalityPool::getConstLocalitySharedPool(
+          cluster_context.serverFactoryContext().singletonManager(),
+          cluster_context.serverFactoryContext().mainThreadDispatcher())),
+      shared_address_pool_(AddressPool::getSharedAddressPool(
           cluster_context.serverFactoryContext().singletonManager(),
           cluster_context.serverFactoryContext().mainThreadDispatcher())) {
   auto& server_context = cluster_context.serverFactoryContext();
@@ -2048,11 +2051,27 @@ void ClusterImplBase::reloadHealthyHostsHelper(const HostSharedPtr&) {
 
 absl::StatusOr<const Network::Address::InstanceConstSharedPtr>
 ClusterImplBase::resolveProtoAddress(const envoy::config::core::v3::Address& address) {
+  // Addresses resolved by the default resolver do not depend on the cluster, so the hosts of all
+  // the clusters that have the same endpoint share one instance of its address.
+  std::shared_ptr<SharedAddress> shared_address;
+  if (!address.has_socket_address() || address.socket_address().resolver_name().empty()) {
+    shared_address = shared_address_pool_->getObject(SharedAddress{address, nullptr});
+    if (shared_address->address_ != nullptr) {
+      return Network::Address::InstanceConstSharedPtr(shared_address,
+                                                      shared_address->address_.get());
+    }
+  }
+
   absl::Status resolve_status;
   TRY_ASSERT_MAIN_THREAD {
     auto address_or_error = Network::Address::resolveProtoAddress(address);
     if (address_or_error.status().ok()) {
-      return address_or_error.value();
+      if (shared_address == nullptr) {
+        return address_or_error.value();
+      }
+      shared_address->address_ = std::move(address_or_error.value());
+      return Network::Address::InstanceConstSharedPtr(shared_address,
+                                                      shared_address->address_.get());
     }
     resolve_status = address_or_error.status();
   }
@@ -0,0 +1,431 @@
+#include "source/extensions/common/async_files/async_file_context_io_uring.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/extensions/common/async_files/async_file_action.h"
+#include "source/extensions/common/async_files/async_file_context_base.h"
+#include "source/extensions/common/async_files/async_file_manager_io_uring.h"
+#include "source/extensions/common/async_files/read_mapped_file.h"
+#include "source/extensions/common/async_files/status_after_file_error.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+namespace {
+
+int32_t completionResult(Api::SysCallIntResult result) {
+  return result.return_value_ == -1 ? -result.errno_ : result.return_value_;
+}
+
+template <typename T> class AsyncFileHandleActionIoUring : public AsyncFileActionIoUring<T> {
+public:
+  explicit AsyncFileHandleActionIoUring(AsyncFileHandle handle,
+                                        absl::AnyInvocable<void(T)> on_complete)
+      : AsyncFileActionIoUring<T>(std::move(on_complete)), handle_(std::move(handle)) {}
+
+protected:
+  int& fileDescriptor() { return context()->fileDescriptor(); }
+  AsyncFileContextIoUring* context() const {
+    return static_cast<AsyncFileContextIoUring*>(handle_.get());
+  }
+
+  AsyncFileManagerIoUring& manager() const {
+    return static_cast<AsyncFileManagerIoUring&>(context()->manager());
+  }
+  Api::OsSysCalls& posix() const { return manager().posix(); }
+
+  AsyncFileHandle handle_;
+};
+
+class ActionStat : public AsyncFileHandleActionIoUring<absl::StatusOr<struct stat>> {
+public:
+  ActionStat(AsyncFileHandle handle,
+             absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete)
+      : AsyncFileHandleActionIoUring<absl::StatusOr<struct stat>>(handle, std::move(on_complete)) {
+  }
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    ASSERT(fileDescriptor() != -1);
+    if (!manager().supportsOpcode(IORING_OP_STATX)) {
+      return false;
+    }
+    io_uring_prep_statx(&sqe, fileDescriptor(), "", AT_EMPTY_PATH, STATX_BASIC_STATS, &statx_);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    synchronous_ = true;
+    return completionResult(posix().fstat(fileDescriptor(), &stat_));
+  }
+
+  absl::StatusOr<struct stat> executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    return synchronous_ ? stat_ : statFromStatx(statx_);
+  }
+
+private:
+  struct statx statx_{};
+  struct stat stat_{};
+  bool synchronous_ = false;
+};
+
+class ActionCreateHardLink : public AsyncFileHandleActionIoUring<absl::Status> {
+public:
+  ActionCreateHardLink(AsyncFileHandle handle, absl::string_view filename,
+                       absl::AnyInvocable<void(absl::Status)> on_complete)
+      : AsyncFileHandleActionIoUring<absl::Status>(handle, std::move(on_complete)),
+        filename_(filename), procfile_(absl::StrCat("/proc/self/fd/", fileDescriptor())) {}
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    if (!manager().supportsOpcode(IORING_OP_LINKAT)) {
+      return false;
+    }
+    io_uring_prep_linkat(&sqe, AT_FDCWD, procfile_.c_str(), AT_FDCWD, filename_.c_str(),
+                         AT_SYMLINK_FOLLOW);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    return completionResult(posix().linkat(fileDescriptor(), procfile_.c_str(), AT_FDCWD,
+                                           filename_.c_str(), AT_SYMLINK_FOLLOW));
+  }
+
+  absl::Status executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    return absl::OkStatus();
+  }
+
+  void onCancelledBeforeCallback() override {
+    if (result_.value().ok()) {
+      posix().unlink(filename_.c_str());
+    }
+  }
+  bool hasActionIfCancelledBeforeCallback() const override { return true; }
+
+private:
+  const std::string filename_;
+  const std::string procfile_;
+};
+
+class ActionCloseFile : public AsyncFileHandleActionIoUring<absl::Status> {
+public:
+  // Here we take a copy of the AsyncFileContext's file descriptor, because the close function
+  // sets the AsyncFileContext's file descriptor to -1. This way there will be no race of trying
+  // to use the handle again while the close is in flight.
+  explicit ActionCloseFile(AsyncFileHandle handle,
+                           absl::AnyInvocable<void(absl::Status)> on_complete)
+      : AsyncFileHandleActionIoUring<absl::Status>(handle, std::move(on_complete)),
+        file_descriptor_(fileDescriptor()) {}
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    if (!manager().supportsOpcode(IORING_OP_CLOSE)) {
+      return false;
+    }
+    io_uring_prep_close(&sqe, file_descriptor_);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    return completionResult(posix().close(file_descriptor_));
+  }
+
+  absl::Status executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    return absl::OkStatus();
+  }
+
+private:
+  const int file_descriptor_;
+};
+
+class ActionReadFile : public AsyncFileHandleActionIoUring<absl::StatusOr<Buffer::InstancePtr>> {
+public:
+  ActionReadFile(AsyncFileHandle handle, off_t offset, size_t length,
+                 absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete)
+      : AsyncFileHandleActionIoUring<absl::StatusOr<Buffer::InstancePtr>>(handle,
+                                                                          std::move(on_complete)),
+        offset_(offset), length_(length), buffer_(std::make_unique<Buffer::OwnedImpl>()) {
+    // The kernel reads directly into the buffer that is passed to the callback.
+    reservation_.emplace(buffer_->reserveSingleSlice(length_));
+  }
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    ASSERT(fileDescriptor() != -1);
+    if (!manager().supportsOpcode(IORING_OP_READ)) {
+      return false;
+    }
+    io_uring_prep_read(&sqe, fileDescriptor(), reservation_->slice().mem_, length_, offset_);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    Api::SysCallSizeResult result =
+        posix().pread(fileDescriptor(), reservation_->slice().mem_, length_, offset_);
+    return result.return_value_ == -1 ? -result.errno_ : result.return_value_;
+  }
+
+  absl::StatusOr<Buffer::InstancePtr> executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    const size_t bytes_read = completion_result_;
+    if (bytes_read != length_) {
+      return std::make_unique<Buffer::OwnedImpl>(reservation_->slice().mem_, bytes_read);
+    }
+    reservation_->commit(bytes_read);
+    return std::move(buffer_);
+  }
+
+private:
+  const off_t offset_;
+  const size_t length_;
+  Buffer::InstancePtr buffer_;
+  std::optional<Buffer::ReservationSingleSlice> reservation_;
+};
+
+// Mapping does no file I/O until the pages are accessed, so it is performed synchronously in one
+// of the manager's synchronous threads, as in AsyncFileContextThreadPool.
+class ActionReadMappedFile
+    : public AsyncFileHandleActionIoUring<absl::StatusOr<Buffer::InstancePtr>> {
+public:
+  ActionReadMappedFile(AsyncFileHandle handle, off_t offset, size_t length,
+                       absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete)
+      : AsyncFileHandleActionIoUring<absl::StatusOr<Buffer::InstancePtr>>(handle,
+                                                                          std::move(on_complete)),
+        offset_(offset), length_(length) {}
+
+  bool prepare(struct io_uring_sqe&) override { return false; }
+
+  int32_t performSynchronously() override { return 0; }
+
+  absl::StatusOr<Buffer::InstancePtr> executeImpl() override {
+    ASSERT(fileDescriptor() != -1);
+    return readMappedFile(posix(), fileDescriptor(), offset_, length_);
+  }
+
+private:
+  const off_t offset_;
+  const size_t length_;
+};
+
+class ActionWriteFile : public AsyncFileHandleActionIoUring<absl::StatusOr<size_t>> {
+public:
+  ActionWriteFile(AsyncFileHandle handle, Buffer::Instance& contents, off_t offset,
+                  absl::AnyInvocable<void(absl::StatusOr<size_t>)> on_complete)
+      : AsyncFileHandleActionIoUring<absl::StatusOr<size_t>>(handle, std::move(on_complete)),
+        offset_(offset) {
+    contents_.move(contents);
+  }
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    ASSERT(fileDescriptor() != -1);
+    Buffer::RawSliceVector slices = contents_.getRawSlices();
+    if (slices.size() > static_cast<size_t>(IOV_MAX) ||
+        !manager().supportsOpcode(IORING_OP_WRITEV)) {
+      return false;
+    }
+    iovecs_.reserve(slices.size());
+    for (const auto& slice : slices) {
+      iovecs_.push_back({slice.mem_, slice.len_});
+    }
+    io_uring_prep_writev(&sqe, fileDescriptor(), iovecs_.data(), iovecs_.size(), offset_);
+    return true;
+  }
+
+  // The whole write is performed by executeImpl.
+  int32_t performSynchronously() override { return 0; }
+
+  absl::StatusOr<size_t> executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    // A short write, which is rare for regular files, is completed with blocking writes.
+    size_t total_bytes_written = completion_result_;
+    size_t skip = total_bytes_written;
+    for (const auto& slice : contents_.getRawSlices()) {
+      if (skip >= slice.len_) {
+        skip -= slice.len_;
+        continue;
+      }
+      size_t slice_bytes_written = skip;
+      skip = 0;
+      while (slice_bytes_written < slice.len_) {
+        auto bytes_just_written =
+            posix().pwrite(fileDescriptor(), static_cast<char*>(slice.mem_) + slice_bytes_written,
+                           slice.len_ - slice_bytes_written, offset_ + total_bytes_written);
+        if (bytes_just_written.return_value_ == -1) {
+          return statusAfterFileError(bytes_just_written);
+        }
+        slice_bytes_written += bytes_just_written.return_value_;
+        total_bytes_written += bytes_just_written.return_value_;
+      }
+    }
+    return total_bytes_written;
+  }
+
+private:
+  Buffer::OwnedImpl contents_;
+  const off_t offset_;
+  std::vector<struct iovec> iovecs_;
+};
+
+class ActionTruncateFile : public AsyncFileHandleActionIoUring<absl::Status> {
+public:
+  ActionTruncateFile(AsyncFileHandle handle, size_t length,
+                     absl::AnyInvocable<void(absl::Status)> on_complete)
+      : AsyncFileHandleActionIoUring<absl::Status>(handle, std::move(on_complete)),
+        length_(length) {}
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    ASSERT(fileDescriptor() != -1);
+    // Truncating with io_uring requires kernel 6.9.
+    if (!manager().supportsOpcode(IORING_OP_FTRUNCATE)) {
+      return false;
+    }
+    io_uring_prep_ftruncate(&sqe, fileDescriptor(), length_);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    return completionResult(posix().ftruncate(fileDescriptor(), length_));
+  }
+
+  absl::Status executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    return absl::OkStatus();
+  }
+
+private:
+  const size_t length_;
+};
+
+// Duplicating a file descriptor does no I/O, so it is performed synchronously in the completion
+// thread.
+class ActionDuplicateFile
+    : public AsyncFileHandleActionIoUring<absl::StatusOr<AsyncFileHandle>> {
+public:
+  ActionDuplicateFile(AsyncFileHandle handle,
+                      absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete)
+      : AsyncFileHandleActionIoUring<absl::StatusOr<AsyncFileHandle>>(handle,
+                                                                      std::move(on_complete)) {}
+
+  bool prepare(struct io_uring_sqe&) override { return false; }
+
+  int32_t performSynchronously() override {
+    ASSERT(fileDescriptor() != -1);
+    return completionResult(posix().duplicate(fileDescriptor()));
+  }
+
+  absl::StatusOr<AsyncFileHandle> executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    return std::make_shared<AsyncFileContextIoUring>(context()->manager(), completion_result_);
+  }
+
+  void onCancelledBeforeCallback() override {
+    if (result_.value().ok()) {
+      result_.value().value()->close(nullptr, [](absl::Status) {}).IgnoreError();
+    }
+  }
+  bool hasActionIfCancelledBeforeCallback() const override { return true; }
+};
+
+} // namespace
+
+absl::StatusOr<CancelFunction> AsyncFileContextIoUring::stat(
+    Event::Dispatcher* dispatcher,
+    absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete) {
+  return checkFileAndEnqueue(dispatcher,
+                             std::make_unique<ActionStat>(handle(), std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::createHardLink(Event::Dispatcher* dispatcher, absl::string_view filename,
+                                        absl::AnyInvocable<void(absl::Status)> on_complete) {
+  return checkFileAndEnqueue(dispatcher, std::make_unique<ActionCreateHardLink>(
+                                             handle(), filename, std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::close(Event::Dispatcher* dispatcher,
+                               absl::AnyInvocable<void(absl::Status)> on_complete) {
+  auto ret = checkFileAndEnqueue(
+      dispatcher, std::make_unique<ActionCloseFile>(handle(), std::move(on_complete)));
+  fileDescriptor() = -1;
+  return ret;
+}
+
+absl::StatusOr<CancelFunction> AsyncFileContextIoUring::read(
+    Event::Dispatcher* dispatcher, off_t offset, size_t length,
+    absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) {
+  return checkFileAndEnqueue(dispatcher, std::make_unique<ActionReadFile>(handle(), offset, length,
+                                                                          std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction> AsyncFileContextIoUring::readMapped(
+    Event::Dispatcher* dispatcher, off_t offset, size_t length,
+    absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) {
+  return checkFileAndEnqueue(dispatcher, std::make_unique<ActionReadMappedFile>(
+                                             handle(), offset, length, std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::write(Event::Dispatcher* dispatcher, Buffer::Instance& contents,
+                               off_t offset,
+                               absl::AnyInvocable<void(absl::StatusOr<size_t>)> on_complete) {
+  return checkFileAndEnqueue(dispatcher, std::make_unique<ActionWriteFile>(
+                                             handle(), contents, offset, std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction> AsyncFileContextIoUring::duplicate(
+    Event::Dispatcher* dispatcher,
+    absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) {
+  return checkFileAndEnqueue(
+      dispatcher, std::make_unique<ActionDuplicateFile>(handle(), std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::truncate(Event::Dispatcher* dispatcher, size_t length,
+                                  absl::AnyInvocable<void(absl::Status)> on_complete) {
+  return checkFileAndEnqueue(
+      dispatcher, std::make_unique<ActionTruncateFile>(handle(), length, std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::checkFileAndEnqueue(Event::Dispatcher* dispatcher,
+                                             std::unique_ptr<AsyncFileAction> action) {
+  if (fileDescriptor() == -1) {
+    return absl::FailedPreconditionError("file was already closed");
+  }
+  return enqueue(dispatcher, std::move(action));
+}
+
+AsyncFileContextIoUring::AsyncFileContextIoUring(AsyncFileManager& manager, int fd)
+    : AsyncFileContextBase(manager), file_descriptor_(fd) {}
+
+AsyncFileContextIoUring::~AsyncFileContextIoUring() { ASSERT(file_descriptor_ == -1); }
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
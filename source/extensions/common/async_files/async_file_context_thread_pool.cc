@@ -10,6 +10,7 @@
 #include "source/extensions/common/async_files/async_file_action.h"
 #include "source/extensions/common/async_files/async_file_context_base.h"
 #include "source/extensions/common/async_files/async_file_manager_thread_pool.h"
+#include "source/extensions/common/async_files/read_mapped_file.h"
 #include "source/extensions/common/async_files/status_after_file_error.h"
 
 namespace Envoy {
@@ -138,6 +139,25 @@ private:
   const size_t length_;
 };
 
+class ActionReadMappedFile
+    : public AsyncFileActionThreadPool<absl::StatusOr<Buffer::InstancePtr>> {
+public:
+  ActionReadMappedFile(AsyncFileHandle handle, off_t offset, size_t length,
+                       absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete)
+      : AsyncFileActionThreadPool<absl::StatusOr<Buffer::InstancePtr>>(handle,
+                                                                       std::move(on_complete)),
+        offset_(offset), length_(length) {}
+
+  absl::StatusOr<Buffer::InstancePtr> executeImpl() override {
+    ASSERT(fileDescriptor() != -1);
+    return readMappedFile(posix(), fileDescriptor(), offset_, length_);
+  }
+
+private:
+  const off_t offset_;
+  const size_t length_;
+};
+
 class ActionWriteFile : public AsyncFileActionThreadPool<absl::StatusOr<size_t>> {
 public:
   ActionWriteFile(AsyncFileHandle handle, Buffer::Instance& contents, off_t offset,
@@ -248,6 +268,13 @@ absl::StatusOr<CancelFunction> AsyncFileContextThreadPool::read(
                                                                           std::move(on_complete)));
 }
 
+absl::StatusOr<CancelFunction> AsyncFileContextThreadPool::readMapped(
+    Event::Dispatcher* dispatcher, off_t offset, size_t length,
+    absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) {
+  return checkFileAndEnqueue(dispatcher, std::make_unique<ActionReadMappedFile>(
+                                             handle(), offset, length, std::move(on_complete)));
+}
+
 absl::StatusOr<CancelFunction>
 AsyncFileContextThreadPool::write(Event::Dispatcher* dispatcher, Buffer::Instance& contents,
                                   off_t offset,
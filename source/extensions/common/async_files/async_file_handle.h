@@ -52,6 +52,17 @@ public:
   read(Event::Dispatcher* dispatcher, off_t offset, size_t length,
        absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) PURE;
 
+  // Like read, but maps the requested range of the file into memory rather than copying it into
+  // the buffer, so the kernel's page cache backs the buffer directly. The mapping is released
+  // when the buffer drains it. If the range extends past the end of the file, only the part
+  // within the file is mapped.
+  //
+  // The file must not be truncated below the end of the mapped range while the buffer is alive,
+  // as accessing a page that is no longer backed by the file raises SIGBUS.
+  virtual absl::StatusOr<CancelFunction>
+  readMapped(Event::Dispatcher* dispatcher, off_t offset, size_t length,
+             absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) PURE;
+
   // Enqueues an action to write to the currently open file, at position offset, the bytes contained
   // by contents. It is an error to call write on an AsyncFileContext that does not have a file
   // open.
@@ -0,0 +1,547 @@
+#include "source/extensions/common/async_files/async_file_manager_io_uring.h"
+
+#include <fcntl.h>
+#include <sys/sysmacros.h>
+
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "source/common/common/utility.h"
+#include "source/extensions/common/async_files/async_file_action.h"
+#include "source/extensions/common/async_files/async_file_context_io_uring.h"
+#include "source/extensions/common/async_files/status_after_file_error.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+namespace {
+
+constexpr uint32_t DefaultIoUringSize = 256;
+// Synchronous operations are rare, and only fall back to blocking system calls for want of an
+// opcode, so a few threads keep one slow operation from holding up the others.
+constexpr size_t SynchronousThreadCount = 4;
+
+struct timespec timespecFromStatx(const struct statx_timestamp& ts) {
+  struct timespec ret;
+  ret.tv_sec = ts.tv_sec;
+  ret.tv_nsec = ts.tv_nsec;
+  return ret;
+}
+
+} // namespace
+
+struct stat statFromStatx(const struct statx& stx) {
+  struct stat ret{};
+  ret.st_dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+  ret.st_ino = stx.stx_ino;
+  ret.st_mode = stx.stx_mode;
+  ret.st_nlink = stx.stx_nlink;
+  ret.st_uid = stx.stx_uid;
+  ret.st_gid = stx.stx_gid;
+  ret.st_rdev = makedev(stx.stx_rdev_major, stx.stx_rdev_minor);
+  ret.st_size = stx.stx_size;
+  ret.st_blksize = stx.stx_blksize;
+  ret.st_blocks = stx.stx_blocks;
+  ret.st_atim = timespecFromStatx(stx.stx_atime);
+  ret.st_mtim = timespecFromStatx(stx.stx_mtime);
+  ret.st_ctim = timespecFromStatx(stx.stx_ctime);
+  return ret;
+}
+
+AsyncFileManagerIoUring::AsyncFileManagerIoUring(
+    const envoy::extensions::common::async_files::v3::AsyncFileManagerConfig& config,
+    Api::OsSysCalls& posix)
+    : io_uring_size_(config.io_uring().io_uring_size() == 0 ? DefaultIoUringSize
+                                                            : config.io_uring().io_uring_size()),
+      posix_(posix) {
+  // Operations the kernel can't perform with io_uring fall back to posix file operations.
+  if (!posix.supportsAllPosixFileOperations()) {
+    throw EnvoyException("AsyncFileManagerIoUring not supported");
+  }
+  struct io_uring_params params{};
+  // Size the completion queue at twice the submission queue to reduce the chance of overflow.
+  params.flags |= IORING_SETUP_CQSIZE;
+  params.cq_entries = io_uring_size_ * 2;
+  const int ret = io_uring_queue_init_params(io_uring_size_, &ring_, &params);
+  if (ret != 0) {
+    throw EnvoyException(
+        fmt::format("AsyncFileManagerIoUring failed to set up io_uring: {}", errorDetails(-ret)));
+  }
+  // The kernel may round the size of the completion queue up.
+  cq_entries_ = params.cq_entries;
+  struct io_uring_probe* probe = io_uring_get_probe_ring(&ring_);
+  // Without a probe, which requires kernel 5.6, every operation is performed synchronously.
+  if (probe != nullptr) {
+    for (int op = 0; op < IORING_OP_LAST; op++) {
+      supported_opcodes_[op] = io_uring_opcode_supported(probe, op);
+    }
+    io_uring_free_probe(probe);
+  }
+  ENVOY_LOG(info, fmt::format("AsyncFileManagerIoUring created with id '{}', with io_uring size {}",
+                              config.id(), io_uring_size_));
+  completion_thread_ = std::thread([this]() { reapCompletions(); });
+  for (size_t i = 0; i < SynchronousThreadCount; i++) {
+    synchronous_threads_.emplace_back([this]() { performSynchronousOperations(); });
+  }
+}
+
+AsyncFileManagerIoUring::~AsyncFileManagerIoUring() ABSL_LOCKS_EXCLUDED(mutex_) {
+  {
+    absl::MutexLock lock(mutex_);
+    // This destructor will be blocked until all submitted file actions are complete.
+    const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+      return in_flight_ == 0;
+    };
+    mutex_.Await(absl::Condition(&condition));
+    terminating_ = true;
+  }
+  {
+    absl::MutexLock lock(ring_mutex_);
+    // A no-op without a submission tells the completion thread to exit. Nothing is in the ring,
+    // so there is room for it.
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    io_uring_prep_nop(sqe);
+    io_uring_sqe_set_data(sqe, nullptr);
+    io_uring_submit(&ring_);
+  }
+  completion_thread_.join();
+  for (std::thread& thread : synchronous_threads_) {
+    thread.join();
+  }
+  io_uring_queue_exit(&ring_);
+}
+
+std::string AsyncFileManagerIoUring::describe() const {
+  return absl::StrCat("io_uring_size = ", io_uring_size_);
+}
+
+void AsyncFileManagerIoUring::waitForIdle() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return in_flight_ == 0;
+  };
+  absl::MutexLock lock(mutex_);
+  mutex_.Await(absl::Condition(&condition));
+}
+
+CancelFunction AsyncFileManagerIoUring::enqueue(Event::Dispatcher* dispatcher,
+                                                std::unique_ptr<AsyncFileAction> action) {
+  auto* operation = dynamic_cast<IoUringFileOperation*>(action.get());
+  ASSERT(operation != nullptr);
+  auto submission =
+      std::make_unique<Submission>(Submission{{std::move(action), dispatcher}, operation});
+  // The operation is handed to the kernel right away, so there is no queued state in which a
+  // cancel could prevent it from being performed.
+  submission->queued_.state_->store(QueuedAction::State::Executing);
+  auto cancel_func = [dispatcher, state = submission->queued_.state_]() {
+    ASSERT(dispatcher == nullptr || dispatcher->isThreadSafe());
+    state->store(QueuedAction::State::Cancelled);
+  };
+  submit(std::move(submission));
+  return cancel_func;
+}
+
+void AsyncFileManagerIoUring::postCancelledActionForCleanup(
+    std::unique_ptr<AsyncFileAction> action) {
+  submit(std::make_unique<Submission>(Submission{{std::move(action), nullptr}, nullptr}));
+}
+
+void AsyncFileManagerIoUring::submit(std::unique_ptr<Submission> submission) {
+  // Preparing the entry outside of the lock leaves only the copy into the submission queue to the
+  // submitting thread.
+  const bool in_ring =
+      submission->operation_ != nullptr && submission->operation_->prepare(submission->sqe_);
+  {
+    absl::MutexLock lock(mutex_);
+    in_flight_++;
+    if (!in_ring) {
+      synchronous_.push(std::move(submission));
+      return;
+    }
+    backlog_.push_back(std::move(submission));
+  }
+  submitBacklog();
+}
+
+void AsyncFileManagerIoUring::submitBacklog() {
+  while (true) {
+    // A thread that finds another submitting leaves its submissions in the backlog, which the
+    // submitting thread checks again after releasing the submission queue, so none are stranded.
+    if (!ring_mutex_.TryLock()) {
+      return;
+    }
+    const bool submitted_all = submitBatch();
+    ring_mutex_.Unlock();
+    if (!submitted_all) {
+      // The completion thread retries once it has reaped some completions.
+      return;
+    }
+    absl::MutexLock lock(mutex_);
+    if (backlog_.empty() || in_ring_ >= cq_entries_) {
+      return;
+    }
+  }
+}
+
+bool AsyncFileManagerIoUring::submitBatch() {
+  std::vector<std::unique_ptr<Submission>> batch;
+  {
+    absl::MutexLock lock(mutex_);
+    // Each operation in the ring ends with a completion, so keeping no more operations in the
+    // ring than the completion queue holds ensures that completions never overflow, whereas free
+    // submission queue entries say nothing of the completions not yet reaped.
+    while (!backlog_.empty() && in_ring_ < cq_entries_) {
+      batch.push_back(std::move(backlog_.front()));
+      backlog_.pop_front();
+      in_ring_++;
+    }
+  }
+  size_t queued = 0;
+  for (; queued < batch.size(); queued++) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    if (sqe == nullptr) {
+      // The submission queue is full of entries that a previous submit failed to hand to the
+      // kernel.
+      break;
+    }
+    *sqe = batch[queued]->sqe_;
+    io_uring_sqe_set_data(sqe, batch[queued].release());
+  }
+  if (queued < batch.size()) {
+    absl::MutexLock lock(mutex_);
+    for (size_t i = batch.size(); i > queued; i--) {
+      backlog_.push_front(std::move(batch[i - 1]));
+      in_ring_--;
+    }
+  }
+  if (io_uring_sq_ready(&ring_) > 0) {
+    // A failure here, e.g. EAGAIN while the kernel is short of memory, leaves the entries in the
+    // submission queue to be submitted by the next call.
+    const int ret = io_uring_submit(&ring_);
+    if (ret < 0 && ret != -EBUSY && ret != -EAGAIN && ret != -EINTR) {
+      ENVOY_LOG(warn, "AsyncFileManagerIoUring failed to submit: {}", errorDetails(-ret));
+    }
+  }
+  return queued == batch.size();
+}
+
+void AsyncFileManagerIoUring::reapCompletions() {
+  while (true) {
+    struct io_uring_cqe* cqe;
+    const int ret = io_uring_wait_cqe(&ring_, &cqe);
+    if (ret == -EINTR) {
+      continue;
+    }
+    RELEASE_ASSERT(ret == 0, fmt::format("io_uring_wait_cqe failed: {}", errorDetails(-ret)));
+    std::unique_ptr<Submission> submission{static_cast<Submission*>(io_uring_cqe_get_data(cqe))};
+    const int32_t result = cqe->res;
+    io_uring_cqe_seen(&ring_, cqe);
+    if (submission == nullptr) {
+      return;
+    }
+    complete(*submission, result);
+    {
+      absl::MutexLock lock(mutex_);
+      in_ring_--;
+      in_flight_--;
+    }
+    submitBacklog();
+  }
+}
+
+void AsyncFileManagerIoUring::performSynchronousOperations() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return terminating_ || !synchronous_.empty();
+  };
+  while (true) {
+    std::unique_ptr<Submission> submission;
+    {
+      absl::MutexLock lock(mutex_);
+      mutex_.Await(absl::Condition(&condition));
+      if (synchronous_.empty()) {
+        return;
+      }
+      submission = std::move(synchronous_.front());
+      synchronous_.pop();
+    }
+    const int32_t result =
+        submission->operation_ == nullptr ? 0 : submission->operation_->performSynchronously();
+    complete(*submission, result);
+    absl::MutexLock lock(mutex_);
+    in_flight_--;
+  }
+}
+
+void AsyncFileManagerIoUring::complete(Submission& submission, int32_t result) {
+  using State = QueuedAction::State;
+  std::unique_ptr<AsyncFileAction> action = std::move(submission.queued_.action_);
+  if (submission.operation_ == nullptr) {
+    action->onCancelledBeforeCallback();
+    return;
+  }
+  submission.operation_->setCompletionResult(result);
+  action->execute();
+  std::shared_ptr<std::atomic<State>> state = std::move(submission.queued_.state_);
+  State expected = State::Executing;
+  if (!state->compare_exchange_strong(expected, State::InCallback)) {
+    ASSERT(expected == State::Cancelled);
+    action->onCancelledBeforeCallback();
+    return;
+  }
+  if (submission.queued_.dispatcher_ == nullptr) {
+    // No need to bother arranging the callback, because a dispatcher was not provided.
+    return;
+  }
+  // As in AsyncFileManagerThreadPool, the manager is only captured if the action has something
+  // to undo should it be cancelled after the callback is posted.
+  std::shared_ptr<AsyncFileManagerIoUring> manager;
+  if (action->hasActionIfCancelledBeforeCallback()) {
+    manager = shared_from_this();
+  }
+  submission.queued_.dispatcher_->post([manager = std::move(manager), action = std::move(action),
+                                        state = std::move(state)]() mutable {
+    // This callback runs on the caller's thread.
+    State expected = State::InCallback;
+    if (state->compare_exchange_strong(expected, State::Done)) {
+      action->onComplete();
+      return;
+    }
+    ASSERT(expected == State::Cancelled);
+    if (manager == nullptr) {
+      return;
+    }
+    // The side-effects of the cancelled action are undone in a synchronous thread.
+    manager->postCancelledActionForCleanup(std::move(action));
+  });
+}
+
+namespace {
+
+class ActionWithFileResult : public AsyncFileActionIoUring<absl::StatusOr<AsyncFileHandle>> {
+public:
+  ActionWithFileResult(AsyncFileManagerIoUring& manager,
+                       absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete)
+      : AsyncFileActionIoUring(std::move(on_complete)), manager_(manager) {}
+
+protected:
+  void onCancelledBeforeCallback() override {
+    if (result_.value().ok()) {
+      result_.value().value()->close(nullptr, [](absl::Status) {}).IgnoreError();
+    }
+  }
+  bool hasActionIfCancelledBeforeCallback() const override { return true; }
+
+  absl::StatusOr<AsyncFileHandle> fileFromCompletion() {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    return std::make_shared<AsyncFileContextIoUring>(manager_, completion_result_);
+  }
+
+  AsyncFileManagerIoUring& manager_;
+  Api::OsSysCalls& posix() { return manager_.posix(); }
+};
+
+class ActionCreateAnonymousFile : public ActionWithFileResult {
+public:
+  ActionCreateAnonymousFile(AsyncFileManagerIoUring& manager, absl::string_view path,
+                            absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete)
+      : ActionWithFileResult(manager, std::move(on_complete)), path_(path) {}
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    if (manager_.o_tmpfile_unsupported_ || !manager_.supportsOpcode(IORING_OP_OPENAT)) {
+      return false;
+    }
+    io_uring_prep_openat(&sqe, AT_FDCWD, path_.c_str(), O_TMPFILE | O_RDWR, S_IRUSR | S_IWUSR);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    if (manager_.o_tmpfile_unsupported_) {
+      return -EOPNOTSUPP;
+    }
+    Api::SysCallIntResult result =
+        posix().open(path_.c_str(), O_TMPFILE | O_RDWR, S_IRUSR | S_IWUSR);
+    return result.return_value_ == -1 ? -result.errno_ : result.return_value_;
+  }
+
+  absl::StatusOr<AsyncFileHandle> executeImpl() override {
+    // These are the errors open reports if the kernel or the file system does not support
+    // O_TMPFILE.
+    if (completion_result_ == -EOPNOTSUPP || completion_result_ == -EISDIR) {
+      manager_.o_tmpfile_unsupported_ = true;
+      return createNamedAndUnlink();
+    }
+    return fileFromCompletion();
+  }
+
+private:
+  // Falls back to creating a named file and unlinking it.
+  absl::StatusOr<AsyncFileHandle> createNamedAndUnlink() {
+    // Using C-style functions here because `mkstemp` requires a writable char buffer.
+    char filename[4096];
+    static const char file_suffix[] = "/buffer.XXXXXX";
+    if (path_.size() + sizeof(file_suffix) > sizeof(filename)) {
+      return absl::InvalidArgumentError(
+          "AsyncFileManagerIoUring::createAnonymousFile: pathname too long for tmpfile");
+    }
+    snprintf(filename, sizeof(filename), "%s%s", path_.c_str(), file_suffix);
+    Api::SysCallIntResult open_result = posix().mkstemp(filename);
+    if (open_result.return_value_ == -1) {
+      return statusAfterFileError(open_result);
+    }
+    if (posix().unlink(filename).return_value_ != 0) {
+      // As in AsyncFileManagerThreadPool, a file that can't be unlinked while open would be left
+      // behind, so it is removed and an error reported.
+      posix().close(open_result.return_value_);
+      posix().unlink(filename);
+      return absl::UnimplementedError(
+          "AsyncFileManagerIoUring::createAnonymousFile: not supported for "
+          "target filesystem (failed to unlink an open file)");
+    }
+    return std::make_shared<AsyncFileContextIoUring>(manager_, open_result.return_value_);
+  }
+
+  const std::string path_;
+};
+
+class ActionOpenExistingFile : public ActionWithFileResult {
+public:
+  ActionOpenExistingFile(AsyncFileManagerIoUring& manager, absl::string_view filename,
+                         AsyncFileManager::Mode mode,
+                         absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete)
+      : ActionWithFileResult(manager, std::move(on_complete)), filename_(filename), mode_(mode) {}
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    if (!manager_.supportsOpcode(IORING_OP_OPENAT)) {
+      return false;
+    }
+    io_uring_prep_openat(&sqe, AT_FDCWD, filename_.c_str(), openFlags(), 0);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    Api::SysCallIntResult result = posix().open(filename_.c_str(), openFlags());
+    return result.return_value_ == -1 ? -result.errno_ : result.return_value_;
+  }
+
+  absl::StatusOr<AsyncFileHandle> executeImpl() override { return fileFromCompletion(); }
+
+private:
+  int openFlags() const {
+    switch (mode_) {
+    case AsyncFileManager::Mode::ReadOnly:
+      return O_RDONLY;
+    case AsyncFileManager::Mode::WriteOnly:
+      return O_WRONLY;
+    case AsyncFileManager::Mode::ReadWrite:
+      return O_RDWR;
+    }
+    PANIC_DUE_TO_CORRUPT_ENUM;
+  }
+  const std::string filename_;
+  const AsyncFileManager::Mode mode_;
+};
+
+class ActionStat : public AsyncFileActionIoUring<absl::StatusOr<struct stat>> {
+public:
+  ActionStat(AsyncFileManagerIoUring& manager, absl::string_view filename,
+             absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete)
+      : AsyncFileActionIoUring(std::move(on_complete)), manager_(manager), filename_(filename) {}
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    if (!manager_.supportsOpcode(IORING_OP_STATX)) {
+      return false;
+    }
+    io_uring_prep_statx(&sqe, AT_FDCWD, filename_.c_str(), 0, STATX_BASIC_STATS, &statx_);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    synchronous_ = true;
+    Api::SysCallIntResult result = manager_.posix().stat(filename_.c_str(), &stat_);
+    return result.return_value_ == -1 ? -result.errno_ : 0;
+  }
+
+  absl::StatusOr<struct stat> executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    return synchronous_ ? stat_ : statFromStatx(statx_);
+  }
+
+private:
+  AsyncFileManagerIoUring& manager_;
+  const std::string filename_;
+  struct statx statx_{};
+  struct stat stat_{};
+  bool synchronous_ = false;
+};
+
+class ActionUnlink : public AsyncFileActionIoUring<absl::Status> {
+public:
+  ActionUnlink(AsyncFileManagerIoUring& manager, absl::string_view filename,
+               absl::AnyInvocable<void(absl::Status)> on_complete)
+      : AsyncFileActionIoUring(std::move(on_complete)), manager_(manager), filename_(filename) {}
+
+  bool prepare(struct io_uring_sqe& sqe) override {
+    if (!manager_.supportsOpcode(IORING_OP_UNLINKAT)) {
+      return false;
+    }
+    io_uring_prep_unlinkat(&sqe, AT_FDCWD, filename_.c_str(), 0);
+    return true;
+  }
+
+  int32_t performSynchronously() override {
+    Api::SysCallIntResult result = manager_.posix().unlink(filename_.c_str());
+    return result.return_value_ == -1 ? -result.errno_ : 0;
+  }
+
+  absl::Status executeImpl() override {
+    if (completion_result_ < 0) {
+      return statusAfterFileError(-completion_result_);
+    }
+    return absl::OkStatus();
+  }
+
+private:
+  AsyncFileManagerIoUring& manager_;
+  const std::string filename_;
+};
+
+} // namespace
+
+CancelFunction AsyncFileManagerIoUring::createAnonymousFile(
+    Event::Dispatcher* dispatcher, absl::string_view path,
+    absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) {
+  return enqueue(dispatcher,
+                 std::make_unique<ActionCreateAnonymousFile>(*this, path, std::move(on_complete)));
+}
+
+CancelFunction AsyncFileManagerIoUring::openExistingFile(
+    Event::Dispatcher* dispatcher, absl::string_view filename, Mode mode,
+    absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) {
+  return enqueue(dispatcher, std::make_unique<ActionOpenExistingFile>(*this, filename, mode,
+                                                                      std::move(on_complete)));
+}
+
+CancelFunction
+AsyncFileManagerIoUring::stat(Event::Dispatcher* dispatcher, absl::string_view filename,
+                              absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete) {
+  return enqueue(dispatcher, std::make_unique<ActionStat>(*this, filename, std::move(on_complete)));
+}
+
+CancelFunction AsyncFileManagerIoUring::unlink(Event::Dispatcher* dispatcher,
+                                               absl::string_view filename,
+                                               absl::AnyInvocable<void(absl::Status)> on_complete) {
+  return enqueue(dispatcher,
+                 std::make_unique<ActionUnlink>(*this, filename, std::move(on_complete)));
+}
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <sys/stat.h>
+
+#include <atomic>
+#include <bitset>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/extensions/common/async_files/v3/async_file_manager.pb.h"
+
+#include "source/common/common/logger.h"
+#include "source/extensions/common/async_files/async_file_action.h"
+#include "source/extensions/common/async_files/async_file_handle.h"
+#include "source/extensions/common/async_files/async_file_manager.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "liburing.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+// The part of an action that is specific to AsyncFileManagerIoUring. Every action enqueued with
+// an AsyncFileManagerIoUring is also an IoUringFileOperation.
+class IoUringFileOperation {
+public:
+  virtual ~IoUringFileOperation() = default;
+
+  // Fills in the submission queue entry for the operation, when it is enqueued. Returns false
+  // if the kernel has no io_uring opcode for the operation, in which case performSynchronously
+  // is called instead.
+  virtual bool prepare(struct io_uring_sqe& sqe) PURE;
+
+  // Performs the operation with blocking system calls, in one of the manager's synchronous
+  // threads.
+  // Returns the result in the same form as a completion - the result of the system call on
+  // success, or a negated errno on failure.
+  virtual int32_t performSynchronously() PURE;
+
+  // Captures the result of the operation, which `execute` then turns into the result passed to
+  // the callback.
+  void setCompletionResult(int32_t result) { completion_result_ = result; }
+
+protected:
+  int32_t completion_result_ = 0;
+};
+
+template <typename T>
+class AsyncFileActionIoUring : public AsyncFileActionWithResult<T>, public IoUringFileOperation {
+public:
+  using AsyncFileActionWithResult<T>::AsyncFileActionWithResult;
+};
+
+// Converts the result of an io_uring statx operation to the struct stat that AsyncFileManager
+// callbacks receive.
+struct stat statFromStatx(const struct statx& stx);
+
+// An AsyncFileManager which submits file operations to an io_uring, rather than performing
+// blocking system calls in a thread pool.
+// Operations are submitted by the threads that enqueue them, in batches: whichever thread holds
+// the submission queue submits everything queued so far, and the others return without waiting
+// for its system call. A single completion thread reaps the completions and posts the callbacks
+// to the dispatchers the operations were enqueued with, so an operation costs no context switch
+// to a pool thread and back, and the number of operations in flight is not limited by the number
+// of threads.
+// Operations that the kernel has no io_uring opcode for, those that do no I/O, such as mapping a
+// file, and the cleanup of cancelled actions are performed synchronously in a small pool of
+// threads, so that they do not hold up the completions of the operations in the ring.
+class AsyncFileManagerIoUring : public AsyncFileManager,
+                                public std::enable_shared_from_this<AsyncFileManagerIoUring>,
+                                protected Logger::Loggable<Logger::Id::main> {
+public:
+  explicit AsyncFileManagerIoUring(
+      const envoy::extensions::common::async_files::v3::AsyncFileManagerConfig& config,
+      Api::OsSysCalls& posix);
+  ~AsyncFileManagerIoUring() ABSL_LOCKS_EXCLUDED(mutex_) override;
+  CancelFunction createAnonymousFile(
+      Event::Dispatcher* dispatcher, absl::string_view path,
+      absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) override;
+  CancelFunction
+  openExistingFile(Event::Dispatcher* dispatcher, absl::string_view filename, Mode mode,
+                   absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) override;
+  CancelFunction stat(Event::Dispatcher* dispatcher, absl::string_view filename,
+                      absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete) override;
+  CancelFunction unlink(Event::Dispatcher* dispatcher, absl::string_view filename,
+                        absl::AnyInvocable<void(absl::Status)> on_complete) override;
+  std::string describe() const override;
+  void waitForIdle() ABSL_LOCKS_EXCLUDED(mutex_) override;
+  Api::OsSysCalls& posix() const { return posix_; }
+
+  // Whether the running kernel supports an io_uring opcode.
+  bool supportsOpcode(uint8_t opcode) const { return supported_opcodes_.test(opcode); }
+
+  // Set once opening an anonymous file with O_TMPFILE has proven unsupported, after which
+  // anonymous files are created with mkstemp and unlinked.
+  std::atomic<bool> o_tmpfile_unsupported_{false};
+
+private:
+  struct Submission {
+    QueuedAction queued_;
+    // Null for the cleanup of a cancelled action, which is performed in a synchronous thread.
+    IoUringFileOperation* operation_;
+    // Prepared when the operation is enqueued, and copied into the submission queue.
+    struct io_uring_sqe sqe_{};
+  };
+
+  CancelFunction enqueue(Event::Dispatcher* dispatcher, std::unique_ptr<AsyncFileAction> action)
+      ABSL_LOCKS_EXCLUDED(mutex_) override;
+  void postCancelledActionForCleanup(std::unique_ptr<AsyncFileAction> action)
+      ABSL_LOCKS_EXCLUDED(mutex_) override;
+  void submit(std::unique_ptr<Submission> submission) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Submits the backlog unless another thread is already submitting, in which case that thread
+  // submits it.
+  void submitBacklog() ABSL_LOCKS_EXCLUDED(mutex_, ring_mutex_);
+  // Moves queued submissions into the submission queue, while the completion queue has room for
+  // their completions, and submits them. Returns false if the submission queue was full.
+  bool submitBatch() ABSL_EXCLUSIVE_LOCKS_REQUIRED(ring_mutex_) ABSL_LOCKS_EXCLUDED(mutex_);
+  void reapCompletions() ABSL_LOCKS_EXCLUDED(mutex_);
+  void performSynchronousOperations() ABSL_LOCKS_EXCLUDED(mutex_);
+  void complete(Submission& submission, int32_t result);
+
+  struct io_uring ring_;
+  const uint32_t io_uring_size_;
+  uint32_t cq_entries_;
+  std::bitset<IORING_OP_LAST> supported_opcodes_;
+
+  // Serializes access to the submission queue, and is held across io_uring_submit but never
+  // waited for by enqueuing threads. Acquired before mutex_.
+  absl::Mutex ring_mutex_;
+  absl::Mutex mutex_;
+  // Submissions not yet in the submission queue, which are submitted in batches, as completions
+  // make room.
+  std::deque<std::unique_ptr<Submission>> backlog_ ABSL_GUARDED_BY(mutex_);
+  // Submissions performed by synchronous_threads_ rather than by the kernel.
+  std::queue<std::unique_ptr<Submission>> synchronous_ ABSL_GUARDED_BY(mutex_);
+  // Set by the destructor to tell synchronous_threads_ to exit.
+  bool terminating_ ABSL_GUARDED_BY(mutex_) = false;
+  // Submissions whose callbacks have not yet been posted, including those in backlog_ and
+  // synchronous_.
+  uint64_t in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Submissions handed to the ring whose completions have not yet been reaped, which is at most
+  // cq_entries_.
+  uint64_t in_ring_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  std::thread completion_thread_;
+  std::vector<std::thread> synchronous_threads_;
+  Api::OsSysCalls& posix_;
+};
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,52 @@
+#include "source/extensions/common/async_files/read_mapped_file.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/extensions/common/async_files/status_after_file_error.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+absl::StatusOr<Buffer::InstancePtr> readMappedFile(Api::OsSysCalls& posix, int fd, off_t offset,
+                                                   size_t length) {
+  struct stat stat_result;
+  auto stat_status = posix.fstat(fd, &stat_result);
+  if (stat_status.return_value_ != 0) {
+    return statusAfterFileError(stat_status);
+  }
+  auto result = std::make_unique<Buffer::OwnedImpl>();
+  // Pages past the end of the file can't be accessed, so the range is clamped to the file.
+  if (offset >= stat_result.st_size) {
+    return result;
+  }
+  length = std::min<size_t>(length, stat_result.st_size - offset);
+  // mmap requires the offset to be a multiple of the page size.
+  static const off_t page_size = sysconf(_SC_PAGESIZE);
+  const off_t map_offset = offset - offset % page_size;
+  const size_t map_length = length + (offset - map_offset);
+  auto mapped = posix.mmap(nullptr, map_length, PROT_READ, MAP_SHARED, fd, map_offset);
+  if (mapped.return_value_ == MAP_FAILED) {
+    return statusAfterFileError(mapped);
+  }
+  char* const map_start = static_cast<char*>(mapped.return_value_);
+  result->addBufferFragment(*new Buffer::BufferFragmentImpl(
+      map_start + (offset - map_offset), length,
+      [map_start, map_length](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+        ::munmap(map_start, map_length);
+        delete fragment;
+      }));
+  return result;
+}
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
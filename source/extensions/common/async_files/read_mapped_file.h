@@ -0,0 +1,30 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/buffer/buffer.h"
+
+#include "absl/status/statusor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+/**
+ * Maps a range of an open file into a buffer, which unmaps it when the buffer is released. The
+ * range is clamped to the end of the file, as pages past the end can't be accessed. Performs no
+ * file I/O until the buffer is read, which is why both AsyncFileManager implementations do it
+ * with a blocking call.
+ * @return the mapped buffer, or the error from fstat or mmap.
+ */
+absl::StatusOr<Buffer::InstancePtr> readMappedFile(Api::OsSysCalls& posix, int fd, off_t offset,
+                                                   size_t length);
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
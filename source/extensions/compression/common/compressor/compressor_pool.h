@@ -0,0 +1,118 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/compression/compressor/compressor.h"
+#include "envoy/thread/thread.h"
+#include "envoy/thread_local/thread_local.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Common {
+namespace Compressor {
+
+/**
+ * Per-worker pools of compressors of one configuration, so that starting a new stream costs a
+ * reset of a compressor's context rather than allocating and initializing a new one.
+ * CompressorType must implement Envoy::Compression::Compressor::Compressor, and a reset() which
+ * discards the state of the current stream but keeps the context and its parameters.
+ */
+template <class CompressorType> class CompressorPool {
+public:
+  using CompressorTypePtr = std::unique_ptr<CompressorType>;
+  using CreateCompressorCb = std::function<CompressorTypePtr()>;
+
+  /**
+   * @param max_idle_per_worker the maximum number of compressors kept for reuse by each worker,
+   *        once their streams have ended.
+   * @param create_compressor creates and initializes a new compressor when a worker has none to
+   *        reuse.
+   */
+  CompressorPool(ThreadLocal::SlotAllocator& tls, Thread::ThreadFactory& thread_factory,
+                 uint32_t max_idle_per_worker, CreateCompressorCb create_compressor)
+      : thread_factory_(thread_factory), max_idle_per_worker_(max_idle_per_worker),
+        create_compressor_(std::move(create_compressor)),
+        tls_slot_(ThreadLocal::TypedSlot<ThreadLocalPool>::makeUnique(tls)) {
+    tls_slot_->set([&thread_factory](Event::Dispatcher&) {
+      return std::make_shared<ThreadLocalPool>(thread_factory.currentThreadId());
+    });
+  }
+
+  /**
+   * @return a compressor for a new stream, which returns to the current worker's pool when it is
+   *         destroyed. Compressors are not pooled on threads without thread local storage.
+   */
+  Envoy::Compression::Compressor::CompressorPtr acquire() {
+    if (!tls_slot_->currentThreadRegistered()) {
+      return create_compressor_();
+    }
+    ThreadLocalPool& pool = tls_slot_->get().ref();
+    std::vector<CompressorTypePtr>& idle = *pool.idle_;
+    CompressorTypePtr compressor;
+    if (idle.empty()) {
+      compressor = create_compressor_();
+    } else {
+      compressor = std::move(idle.back());
+      idle.pop_back();
+    }
+    return std::make_unique<PooledCompressor>(std::move(compressor), pool, thread_factory_,
+                                              max_idle_per_worker_);
+  }
+
+private:
+  struct ThreadLocalPool : public ThreadLocal::ThreadLocalObject {
+    explicit ThreadLocalPool(Thread::ThreadId thread_id) : thread_id_(thread_id) {}
+
+    const Thread::ThreadId thread_id_;
+    // Shared with the compressors in use, which may outlive the pool.
+    const std::shared_ptr<std::vector<CompressorTypePtr>> idle_{
+        std::make_shared<std::vector<CompressorTypePtr>>()};
+  };
+
+  class PooledCompressor : public Envoy::Compression::Compressor::Compressor {
+  public:
+    PooledCompressor(CompressorTypePtr compressor, const ThreadLocalPool& pool,
+                     Thread::ThreadFactory& thread_factory, uint32_t max_idle)
+        : compressor_(std::move(compressor)), idle_(pool.idle_), thread_id_(pool.thread_id_),
+          thread_factory_(thread_factory), max_idle_(max_idle) {}
+
+    ~PooledCompressor() override {
+      // A compressor may end up being destroyed on another thread, e.g. when it was handed to a
+      // thread pool, in which case it is not returned to its worker's pool.
+      if (thread_factory_.currentThreadId() != thread_id_) {
+        return;
+      }
+      std::shared_ptr<std::vector<CompressorTypePtr>> idle = idle_.lock();
+      if (idle != nullptr && idle->size() < max_idle_) {
+        compressor_->reset();
+        idle->push_back(std::move(compressor_));
+      }
+    }
+
+    // Envoy::Compression::Compressor::Compressor
+    void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override {
+      compressor_->compress(buffer, state);
+    }
+
+  private:
+    CompressorTypePtr compressor_;
+    const std::weak_ptr<std::vector<CompressorTypePtr>> idle_;
+    const Thread::ThreadId thread_id_;
+    Thread::ThreadFactory& thread_factory_;
+    const uint32_t max_idle_;
+  };
+
+  Thread::ThreadFactory& thread_factory_;
+  const uint32_t max_idle_per_worker_;
+  const CreateCompressorCb create_compressor_;
+  const ThreadLocal::TypedSlotPtr<ThreadLocalPool> tls_slot_;
+};
+
+} // namespace Compressor
+} // namespace Common
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
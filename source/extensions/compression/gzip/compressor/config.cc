@@ -7,13 +7,20 @@ namespace Gzip {
 namespace Compressor {
 
 GzipCompressorFactory::GzipCompressorFactory(
-    const envoy::extensions::compression::gzip::compressor::v3::Gzip& gzip)
+    const envoy::extensions::compression::gzip::compressor::v3::Gzip& gzip, Api::Api& api,
+    ThreadLocal::SlotAllocator& tls)
     : compression_level_(compressionLevelEnum(gzip.compression_level())),
       compression_strategy_(compressionStrategyEnum(gzip.compression_strategy())),
       memory_level_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, memory_level, DefaultMemoryLevel)),
       window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, window_bits, DefaultWindowBits) |
                    GzipHeaderValue),
-      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, chunk_size, DefaultChunkSize)) {}
+      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, chunk_size, DefaultChunkSize)) {
+  if (gzip.max_idle_compressors_per_worker() > 0) {
+    pool_ = std::make_unique<Compression::Common::Compressor::CompressorPool<ZlibCompressorImpl>>(
+        tls, api.threadFactory(), gzip.max_idle_compressors_per_worker(),
+        [this]() { return newCompressor(); });
+  }
+}
 
 ZlibCompressorImpl::CompressionLevel GzipCompressorFactory::compressionLevelEnum(
     envoy::extensions::compression::gzip::compressor::v3::Gzip::CompressionLevel
@@ -60,6 +67,13 @@ ZlibCompressorImpl::CompressionStrategy GzipCompressorFactory::compressionStrate
 }
 
 Envoy::Compression::Compressor::CompressorPtr GzipCompressorFactory::createCompressor() {
+  if (pool_ != nullptr) {
+    return pool_->acquire();
+  }
+  return newCompressor();
+}
+
+std::unique_ptr<ZlibCompressorImpl> GzipCompressorFactory::newCompressor() {
   auto compressor = std::make_unique<ZlibCompressorImpl>(chunk_size_);
   compressor->init(compression_level_, compression_strategy_, window_bits_, memory_level_);
   return compressor;
@@ -68,8 +82,10 @@ Envoy::Compression::Compressor::CompressorPtr GzipCompressorFactory::createCompr
 Envoy::Compression::Compressor::CompressorFactoryPtr
 GzipCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
     const envoy::extensions::compression::gzip::compressor::v3::Gzip& proto_config,
-    Server::Configuration::GenericFactoryContext&) {
-  return std::make_unique<GzipCompressorFactory>(proto_config);
+    Server::Configuration::GenericFactoryContext& context) {
+  auto& server_context = context.serverFactoryContext();
+  return std::make_unique<GzipCompressorFactory>(proto_config, server_context.api(),
+                                                 server_context.threadLocal());
 }
 
 /**
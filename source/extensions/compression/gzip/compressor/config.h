@@ -5,6 +5,7 @@
 #include "envoy/extensions/compression/gzip/compressor/v3/gzip.pb.validate.h"
 
 #include "source/common/http/headers.h"
+#include "source/extensions/compression/common/compressor/compressor_pool.h"
 #include "source/extensions/compression/common/compressor/factory_base.h"
 #include "source/extensions/compression/gzip/compressor/zlib_compressor_impl.h"
 
@@ -38,7 +39,8 @@ const std::string& gzipExtensionName() {
 
 class GzipCompressorFactory : public Envoy::Compression::Compressor::CompressorFactory {
 public:
-  GzipCompressorFactory(const envoy::extensions::compression::gzip::compressor::v3::Gzip& gzip);
+  GzipCompressorFactory(const envoy::extensions::compression::gzip::compressor::v3::Gzip& gzip,
+                        Api::Api& api, ThreadLocal::SlotAllocator& tls);
 
   // Envoy::Compression::Compressor::CompressorFactory
   Envoy::Compression::Compressor::CompressorPtr createCompressor() override;
@@ -48,6 +50,7 @@ public:
   }
 
 private:
+  std::unique_ptr<ZlibCompressorImpl> newCompressor();
   static ZlibCompressorImpl::CompressionLevel
   compressionLevelEnum(envoy::extensions::compression::gzip::compressor::v3::Gzip::CompressionLevel
                            compression_level);
@@ -60,6 +63,8 @@ private:
   const int32_t memory_level_;
   const int32_t window_bits_;
   const uint32_t chunk_size_;
+  // Only set if compressors are reused.
+  std::unique_ptr<Compression::Common::Compressor::CompressorPool<ZlibCompressorImpl>> pool_;
 };
 
 class GzipCompressorLibraryFactory
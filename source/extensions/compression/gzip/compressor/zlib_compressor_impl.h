@@ -82,6 +82,12 @@ public:
   void init(CompressionLevel level, CompressionStrategy strategy, int64_t window_bits,
             uint64_t memory_level);
 
+  /**
+   * Discards the state of the current stream, so that the compressor can be used for a new one
+   * with the parameters it was initialized with, without allocating a new zlib context.
+   */
+  void reset();
+
   // Compression::Compressor::Compressor
   void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override;
 
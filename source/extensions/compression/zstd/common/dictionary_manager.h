@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <deque>
 #include <functional>
 
 #include "envoy/event/dispatcher.h"
@@ -7,6 +9,7 @@
 
 #include "source/common/config/datasource.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "zstd.h"
 
 namespace Envoy {
@@ -40,6 +43,7 @@ public:
       // If id == 0, the dictionary is not conform to Zstd specification, or empty.
       RELEASE_ASSERT(id != 0, "Illegal Zstd dictionary");
       dictionary_map->emplace(id, std::move(dictionary));
+      configured_ids_.insert(id);
       if (source.specifier_case() ==
           envoy::config::core::v3::DataSource::SpecifierCase::kFilename) {
         is_watch_added = true;
@@ -84,6 +88,33 @@ public:
 
   T* getFirstDictionary() { return getDictionary(true, 0); };
 
+  // Unlike getFirstDictionary(), keeps the dictionary alive after it is replaced.
+  std::shared_ptr<T> getFirstDictionaryShared() {
+    auto dictionary_map = tls_slot_->get();
+    if (dictionary_map->empty()) {
+      return nullptr;
+    }
+    return dictionary_map->begin()->second;
+  }
+
+  /**
+   * Replaces all the dictionaries with one built from data. Must be called on the main thread.
+   * @return the ID of the new dictionary, or 0 if data is not a legal dictionary, in which case
+   *         the dictionaries are left unchanged.
+   */
+  unsigned setDictionary(const std::string& data) {
+    auto dictionary = DictionarySharedPtr(builder_(data.data(), data.length()));
+    auto id = getDictId(dictionary.get());
+    if (id != 0) {
+      tls_slot_->runOnAllThreads([dictionary = std::move(dictionary),
+                                  id](OptRef<DictionaryThreadLocalMap> dictionary_map) {
+        dictionary_map->clear();
+        dictionary_map->emplace(id, dictionary);
+      });
+    }
+    return id;
+  }
+
 private:
   class DictionarySharedPtr : public std::shared_ptr<T> {
   public:
@@ -92,6 +123,11 @@ private:
   class DictionaryThreadLocalMap : public absl::flat_hash_map<unsigned, DictionarySharedPtr>,
                                    public ThreadLocal::ThreadLocalObject {};
 
+  // Without replace mode, the dictionaries loaded from updated files are kept so that bodies
+  // compressed with an earlier one can still be decompressed, but only this many of them, besides
+  // the configured ones, so that a file replaced periodically doesn't grow the maps forever.
+  static constexpr size_t MaxUpdatedDictionaries = 8;
+
   void onDictionaryUpdate(unsigned origin_id, const std::string& filename) {
     auto file_or_error = api_.fileSystem().fileReadToEnd(filename);
     THROW_IF_NOT_OK_REF(file_or_error.status());
@@ -101,14 +137,25 @@ private:
       auto id = getDictId(dictionary.get());
       // Keep origin dictionary if the new is illegal
       if (id != 0) {
-        tls_slot_->runOnAllThreads(
-            [dictionary = std::move(dictionary), id, origin_id,
-             replace_mode = replace_mode_](OptRef<DictionaryThreadLocalMap> dictionary_map) {
-              if (replace_mode) {
-                dictionary_map->erase(origin_id);
-              }
-              dictionary_map->emplace(id, dictionary);
-            });
+        // 0 is never the ID of a dictionary, so erasing it erases nothing.
+        unsigned evicted_id = 0;
+        if (!replace_mode_ && !configured_ids_.contains(id) &&
+            std::find(updated_ids_.begin(), updated_ids_.end(), id) == updated_ids_.end()) {
+          updated_ids_.push_back(id);
+          if (updated_ids_.size() > MaxUpdatedDictionaries) {
+            evicted_id = updated_ids_.front();
+            updated_ids_.pop_front();
+          }
+        }
+        tls_slot_->runOnAllThreads([dictionary = std::move(dictionary), id, origin_id, evicted_id,
+                                    replace_mode = replace_mode_](
+                                       OptRef<DictionaryThreadLocalMap> dictionary_map) {
+          if (replace_mode) {
+            dictionary_map->erase(origin_id);
+          }
+          dictionary_map->erase(evicted_id);
+          dictionary_map->emplace(id, dictionary);
+        });
       }
     }
   }
@@ -118,6 +165,10 @@ private:
   bool replace_mode_;
   DictionaryBuilder builder_;
   std::unique_ptr<Filesystem::Watcher> watcher_;
+  absl::flat_hash_set<unsigned> configured_ids_;
+  // The IDs of the dictionaries loaded from updated files, oldest first. Only used without replace
+  // mode, on the main thread.
+  std::deque<unsigned> updated_ids_;
 };
 
 } // namespace Common
@@ -8,25 +8,49 @@ namespace Compressor {
 
 ZstdCompressorFactory::ZstdCompressorFactory(
     const envoy::extensions::compression::zstd::compressor::v3::Zstd& zstd,
-    Event::Dispatcher& dispatcher, Api::Api& api, ThreadLocal::SlotAllocator& tls)
+    Event::Dispatcher& dispatcher, Api::Api& api, ThreadLocal::SlotAllocator& tls,
+    Stats::Scope& scope, DictionaryTrainingThreadSharedPtr training_thread)
     : compression_level_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, compression_level, ZSTD_CLEVEL_DEFAULT)),
       enable_checksum_(zstd.enable_checksum()), strategy_(zstd.strategy()),
       chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, chunk_size, ZSTD_CStreamOutSize())) {
-  if (zstd.has_dictionary()) {
+  if (zstd.has_dictionary() || zstd.has_dictionary_training()) {
+    // Without a configured dictionary, there is none until the first one is trained.
     Protobuf::RepeatedPtrField<envoy::config::core::v3::DataSource> dictionaries;
-    dictionaries.Add()->CopyFrom(zstd.dictionary());
+    if (zstd.has_dictionary()) {
+      dictionaries.Add()->CopyFrom(zstd.dictionary());
+    }
     cdict_manager_ = std::make_unique<ZstdCDictManager>(
         dictionaries, dispatcher, api, tls, true,
         [this](const void* dict_buffer, size_t dict_size) -> ZSTD_CDict* {
           return ZSTD_createCDict(dict_buffer, dict_size, compression_level_);
         });
   }
+  if (zstd.has_dictionary_training()) {
+    trainer_ = std::make_shared<DictionaryTrainer>(
+        zstd.dictionary_training(), scope, dispatcher, api, std::move(training_thread),
+        [this](const std::string& dictionary) {
+          return cdict_manager_->setDictionary(dictionary);
+        });
+  }
+  if (zstd.max_idle_compressors_per_worker() > 0) {
+    pool_ = std::make_unique<Compression::Common::Compressor::CompressorPool<ZstdCompressorImpl>>(
+        tls, api.threadFactory(), zstd.max_idle_compressors_per_worker(),
+        [this]() { return newCompressor(); });
+  }
 }
 
 Envoy::Compression::Compressor::CompressorPtr ZstdCompressorFactory::createCompressor() {
+  if (pool_ != nullptr) {
+    return pool_->acquire();
+  }
+  return newCompressor();
+}
+
+std::unique_ptr<ZstdCompressorImpl> ZstdCompressorFactory::newCompressor() {
   return std::make_unique<ZstdCompressorImpl>(compression_level_, enable_checksum_, strategy_,
-                                              cdict_manager_, chunk_size_);
+                                              cdict_manager_, chunk_size_,
+                                              trainer_ ? trainer_->sampleSink() : nullptr);
 }
 
 Envoy::Compression::Compressor::CompressorFactoryPtr
@@ -36,7 +60,9 @@ ZstdCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
   auto& server_context = context.serverFactoryContext();
   return std::make_unique<ZstdCompressorFactory>(
       proto_config, server_context.mainThreadDispatcher(), server_context.api(),
-      server_context.threadLocal());
+      server_context.threadLocal(), context.scope(),
+      proto_config.has_dictionary_training() ? DictionaryTrainingThread::singleton(server_context)
+                                             : nullptr);
 }
 
 /**
@@ -5,7 +5,9 @@
 #include "envoy/extensions/compression/zstd/compressor/v3/zstd.pb.validate.h"
 
 #include "source/common/http/headers.h"
+#include "source/extensions/compression/common/compressor/compressor_pool.h"
 #include "source/extensions/compression/common/compressor/factory_base.h"
+#include "source/extensions/compression/zstd/compressor/dictionary_trainer.h"
 #include "source/extensions/compression/zstd/compressor/zstd_compressor_impl.h"
 
 namespace Envoy {
@@ -27,7 +29,8 @@ class ZstdCompressorFactory : public Envoy::Compression::Compressor::CompressorF
 public:
   ZstdCompressorFactory(const envoy::extensions::compression::zstd::compressor::v3::Zstd& zstd,
                         Event::Dispatcher& dispatcher, Api::Api& api,
-                        ThreadLocal::SlotAllocator& tls);
+                        ThreadLocal::SlotAllocator& tls, Stats::Scope& scope,
+                        DictionaryTrainingThreadSharedPtr training_thread);
 
   // Envoy::Compression::Compressor::CompressorFactory
   Envoy::Compression::Compressor::CompressorPtr createCompressor() override;
@@ -37,11 +40,17 @@ public:
   }
 
 private:
+  std::unique_ptr<ZstdCompressorImpl> newCompressor();
+
   const uint32_t compression_level_;
   const bool enable_checksum_;
   const uint32_t strategy_;
   const uint32_t chunk_size_;
   ZstdCDictManagerPtr cdict_manager_{nullptr};
+  // Only set if dictionaries are trained.
+  DictionaryTrainerSharedPtr trainer_;
+  // Only set if compressors are reused.
+  std::unique_ptr<Compression::Common::Compressor::CompressorPool<ZstdCompressorImpl>> pool_;
 };
 
 class ZstdCompressorLibraryFactory
@@ -0,0 +1,230 @@
+#include "source/extensions/compression/zstd/compressor/dictionary_trainer.h"
+
+#include <utility>
+
+#include "envoy/filesystem/filesystem.h"
+#include "envoy/singleton/manager.h"
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/common/utility.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "zdict.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+namespace {
+
+constexpr uint64_t DefaultTrainingIntervalMs = 10 * 60 * 1000;
+constexpr uint32_t DefaultMaxSamples = 1000;
+constexpr uint32_t DefaultMaxSampleSize = 16 * 1024;
+constexpr uint32_t DefaultDictionarySize = 32 * 1024;
+// Training needs a handful of samples to be worthwhile, or to succeed at all.
+constexpr size_t MinSamples = 10;
+
+} // namespace
+
+SINGLETON_MANAGER_REGISTRATION(zstd_dictionary_training_thread);
+
+std::shared_ptr<DictionaryTrainingThread>
+DictionaryTrainingThread::singleton(Server::Configuration::ServerFactoryContext& context) {
+  // Pinned, so that the last trainer being destroyed doesn't wait for a dictionary being trained.
+  // The server destroys its singletons before its main thread dispatcher, to which jobs post.
+  return context.singletonManager().getTyped<DictionaryTrainingThread>(
+      SINGLETON_MANAGER_REGISTERED_NAME(zstd_dictionary_training_thread),
+      [&context] {
+        return std::make_shared<DictionaryTrainingThread>(context.api().threadFactory());
+      },
+      true);
+}
+
+DictionaryTrainingThread::DictionaryTrainingThread(Thread::ThreadFactory& thread_factory) {
+  thread_ = thread_factory.createThread([this]() { run(); }, Thread::Options{"zstd_dict"});
+}
+
+DictionaryTrainingThread::~DictionaryTrainingThread() {
+  {
+    absl::MutexLock lock(mu_);
+    terminate_ = true;
+  }
+  thread_->join();
+}
+
+void DictionaryTrainingThread::post(Job job) {
+  absl::MutexLock lock(mu_);
+  jobs_.push(std::move(job));
+}
+
+void DictionaryTrainingThread::run() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return terminate_ || !jobs_.empty();
+  };
+  while (true) {
+    Job job;
+    {
+      absl::MutexLock lock(mu_);
+      mu_.Await(absl::Condition(&condition));
+      if (terminate_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop();
+    }
+    job();
+  }
+}
+
+DictionaryTrainer::DictionaryTrainer(
+    const envoy::extensions::compression::zstd::compressor::v3::Zstd::DictionaryTraining& config,
+    Stats::Scope& scope, Event::Dispatcher& main_thread_dispatcher, Api::Api& api,
+    DictionaryTrainingThreadSharedPtr training_thread, DictionaryCb on_dictionary)
+    : training_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, training_interval,
+                                                    DefaultTrainingIntervalMs)),
+      dictionary_size_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, dictionary_size, DefaultDictionarySize)),
+      dictionary_path_(config.dictionary_path()),
+      stats_{ALL_ZSTD_DICTIONARY_TRAINER_STATS(
+          POOL_COUNTER_PREFIX(scope, "zstd.dictionary_training."),
+          POOL_GAUGE_PREFIX(scope, "zstd.dictionary_training."))},
+      main_thread_dispatcher_(main_thread_dispatcher), api_(api),
+      training_thread_(std::move(training_thread)), on_dictionary_(std::move(on_dictionary)),
+      sample_sink_(std::make_shared<DictionarySampleSink>(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_samples, DefaultMaxSamples),
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_sample_size, DefaultMaxSampleSize))) {
+  training_timer_ = main_thread_dispatcher_.createTimer([this]() {
+    onTrainingTimer();
+    training_timer_->enableTimer(training_interval_);
+  });
+  training_timer_->enableTimer(training_interval_);
+}
+
+void DictionarySampleSink::addSample(std::string sample) {
+  absl::MutexLock lock(mu_);
+  if (samples_.size() >= max_samples_) {
+    return;
+  }
+  samples_.push_back(std::move(sample));
+  added_samples_.fetch_add(1, std::memory_order_relaxed);
+  if (samples_.size() >= max_samples_) {
+    collecting_samples_.store(false, std::memory_order_relaxed);
+  }
+}
+
+std::vector<std::string> DictionarySampleSink::takeSamples(size_t min_samples) {
+  absl::MutexLock lock(mu_);
+  if (samples_.size() < min_samples) {
+    return {};
+  }
+  std::vector<std::string> samples = std::move(samples_);
+  samples_.clear();
+  collecting_samples_.store(true, std::memory_order_relaxed);
+  return samples;
+}
+
+void DictionaryTrainer::onTrainingTimer() {
+  // The sink can't count its samples itself, as it may outlive the stats scope.
+  stats_.samples_.add(sample_sink_->takeAddedSampleCount());
+  // If the previous dictionary is still being trained, this one is trained from more samples.
+  if (training_) {
+    return;
+  }
+  std::vector<std::string> samples = sample_sink_->takeSamples(MinSamples);
+  if (samples.empty()) {
+    return;
+  }
+  training_ = true;
+  // The job only refers to the trainer weakly, so that the trainer can be destroyed while its
+  // dictionary is being trained.
+  training_thread_->post([samples = std::move(samples), dictionary_size = dictionary_size_,
+                          path = dictionary_path_, &api = api_,
+                          &dispatcher = main_thread_dispatcher_,
+                          weak_trainer = weak_from_this()]() {
+    std::string dictionary = train(samples, dictionary_size);
+    if (!dictionary.empty()) {
+      publish(api, path, dictionary);
+    }
+    dispatcher.post([weak_trainer, dictionary = std::move(dictionary)]() {
+      if (std::shared_ptr<DictionaryTrainer> trainer = weak_trainer.lock()) {
+        trainer->onTrained(dictionary);
+      }
+    });
+  });
+}
+
+std::string DictionaryTrainer::train(const std::vector<std::string>& samples,
+                                     uint32_t dictionary_size) {
+  std::string samples_buffer;
+  std::vector<size_t> sample_sizes;
+  sample_sizes.reserve(samples.size());
+  for (const std::string& sample : samples) {
+    samples_buffer.append(sample);
+    sample_sizes.push_back(sample.size());
+  }
+  std::string dictionary(dictionary_size, '\0');
+  const size_t result =
+      ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples_buffer.data(),
+                            sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+  if (ZDICT_isError(result)) {
+    ENVOY_LOG(debug, "failed to train a zstd dictionary from {} samples: {}", samples.size(),
+              ZDICT_getErrorName(result));
+    return "";
+  }
+  dictionary.resize(result);
+  return dictionary;
+}
+
+void DictionaryTrainer::publish(Api::Api& api, const std::string& path,
+                                const std::string& dictionary) {
+  if (path.empty()) {
+    return;
+  }
+  // Replacing the file atomically ensures that decompressors watching it never load part of a
+  // dictionary.
+  static constexpr Filesystem::FlagSet Flags{1 << Filesystem::File::Operation::Write |
+                                             1 << Filesystem::File::Operation::Create};
+  const std::string tmp_path = absl::StrCat(path, ".tmp");
+  Filesystem::FilePtr file = api.fileSystem().createFile(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, tmp_path});
+  if (!file || !file->open(Flags).return_value_) {
+    ENVOY_LOG(error, "failed to write zstd dictionary to {}", tmp_path);
+    return;
+  }
+  const bool written =
+      file->write(dictionary).return_value_ == static_cast<ssize_t>(dictionary.size());
+  file->close();
+  Api::OsSysCalls& os_sys_calls = Api::OsSysCallsSingleton::get();
+  if (!written) {
+    ENVOY_LOG(error, "failed to write zstd dictionary to {}", tmp_path);
+    os_sys_calls.unlink(tmp_path.c_str());
+    return;
+  }
+  const Api::SysCallIntResult result = os_sys_calls.rename(tmp_path.c_str(), path.c_str());
+  if (result.return_value_ != 0) {
+    ENVOY_LOG(error, "failed to replace zstd dictionary {}: {}", path,
+              errorDetails(result.errno_));
+    os_sys_calls.unlink(tmp_path.c_str());
+  }
+}
+
+void DictionaryTrainer::onTrained(const std::string& dictionary) {
+  training_ = false;
+  const unsigned id = dictionary.empty() ? 0 : on_dictionary_(dictionary);
+  if (id == 0) {
+    stats_.training_failed_.inc();
+    return;
+  }
+  ENVOY_LOG(debug, "trained zstd dictionary {} of {} bytes", id, dictionary.size());
+  stats_.dictionaries_trained_.inc();
+  stats_.dictionary_id_.set(id);
+}
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
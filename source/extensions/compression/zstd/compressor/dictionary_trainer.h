@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/extensions/compression/zstd/compressor/v3/zstd.pb.h"
+#include "envoy/server/factory_context.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+/**
+ * All zstd dictionary training stats. @see stats_macros.h
+ */
+#define ALL_ZSTD_DICTIONARY_TRAINER_STATS(COUNTER, GAUGE)                                          \
+  COUNTER(samples)                                                                                 \
+  COUNTER(dictionaries_trained)                                                                    \
+  COUNTER(training_failed)                                                                         \
+  GAUGE(dictionary_id, NeverImport)
+
+/**
+ * Struct definition for zstd dictionary training stats. @see stats_macros.h
+ */
+struct ZstdDictionaryTrainerStats {
+  ALL_ZSTD_DICTIONARY_TRAINER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * The thread on which the dictionary trainers of a server train their dictionaries. Training
+ * can't be interrupted and can take seconds, so the thread is shared and pinned for the lifetime
+ * of the server, rather than owned by a trainer that would have to wait for it when destroyed.
+ */
+class DictionaryTrainingThread : public Singleton::Instance {
+public:
+  using Job = absl::AnyInvocable<void()>;
+
+  static std::shared_ptr<DictionaryTrainingThread>
+  singleton(Server::Configuration::ServerFactoryContext& context);
+
+  explicit DictionaryTrainingThread(Thread::ThreadFactory& thread_factory);
+  // Waits for the job being run, and drops the queued ones.
+  ~DictionaryTrainingThread() override;
+
+  /**
+   * Runs a job on the thread, after the jobs posted before it.
+   */
+  void post(Job job) ABSL_LOCKS_EXCLUDED(mu_);
+
+private:
+  void run() ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Mutex mu_;
+  std::queue<Job> jobs_ ABSL_GUARDED_BY(mu_);
+  bool terminate_ ABSL_GUARDED_BY(mu_) = false;
+  Thread::ThreadPtr thread_;
+};
+
+using DictionaryTrainingThreadSharedPtr = std::shared_ptr<DictionaryTrainingThread>;
+
+/**
+ * Collects bodies sampled by the compressors of one configuration for its DictionaryTrainer.
+ * Compressors hold it, and may release it last on any thread, so it holds nothing that belongs to
+ * the main thread or to a stats scope.
+ */
+class DictionarySampleSink {
+public:
+  DictionarySampleSink(uint32_t max_samples, uint64_t max_sample_size)
+      : max_samples_(max_samples), max_sample_size_(max_sample_size) {}
+
+  /**
+   * @return whether compressors should sample the bodies of new streams. Can be called from any
+   *         thread.
+   */
+  bool collectingSamples() const { return collecting_samples_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the size of the largest body that is sampled.
+   */
+  uint64_t maxSampleSize() const { return max_sample_size_; }
+
+  /**
+   * Adds a complete body to the samples for the next dictionary. Can be called from any thread.
+   */
+  void addSample(std::string sample) ABSL_LOCKS_EXCLUDED(mu_);
+
+  /**
+   * Takes the samples collected so far, and starts collecting the samples for the next
+   * dictionary, unless there are fewer than min_samples, which are then kept.
+   * @return the samples taken, if any.
+   */
+  std::vector<std::string> takeSamples(size_t min_samples) ABSL_LOCKS_EXCLUDED(mu_);
+
+  /**
+   * @return the number of samples added since the last call.
+   */
+  uint64_t takeAddedSampleCount() { return added_samples_.exchange(0, std::memory_order_relaxed); }
+
+private:
+  const uint32_t max_samples_;
+  const uint64_t max_sample_size_;
+  std::atomic<bool> collecting_samples_{true};
+  std::atomic<uint64_t> added_samples_{0};
+
+  absl::Mutex mu_;
+  std::vector<std::string> samples_ ABSL_GUARDED_BY(mu_);
+};
+
+using DictionarySampleSinkSharedPtr = std::shared_ptr<DictionarySampleSink>;
+
+/**
+ * Periodically trains a dictionary from the samples of its DictionarySampleSink on a
+ * DictionaryTrainingThread. Must be created and destroyed on the main thread, which the
+ * dictionary being trained doesn't hold up: it is dropped once trained.
+ */
+class DictionaryTrainer : public std::enable_shared_from_this<DictionaryTrainer>,
+                          public Logger::Loggable<Logger::Id::compression> {
+public:
+  /**
+   * Called on the main thread with each trained dictionary.
+   * @return the ID of the dictionary, or 0 if it could not be used.
+   */
+  using DictionaryCb = std::function<unsigned(const std::string& dictionary)>;
+
+  DictionaryTrainer(
+      const envoy::extensions::compression::zstd::compressor::v3::Zstd::DictionaryTraining&
+          config,
+      Stats::Scope& scope, Event::Dispatcher& main_thread_dispatcher, Api::Api& api,
+      DictionaryTrainingThreadSharedPtr training_thread, DictionaryCb on_dictionary);
+
+  /**
+   * @return the sink that the compressors add their samples to.
+   */
+  const DictionarySampleSinkSharedPtr& sampleSink() const { return sample_sink_; }
+
+  const ZstdDictionaryTrainerStats& stats() const { return stats_; }
+
+  // Hands the samples collected so far to the training thread, as the training timer does.
+  void trainForTest() { onTrainingTimer(); }
+
+private:
+  void onTrainingTimer();
+  // Called on the training thread, so these only use what outlives the trainer. Returns an empty
+  // dictionary if training fails.
+  static std::string train(const std::vector<std::string>& samples, uint32_t dictionary_size);
+  static void publish(Api::Api& api, const std::string& path, const std::string& dictionary);
+  // Called on the main thread with the result of train().
+  void onTrained(const std::string& dictionary);
+
+  const std::chrono::milliseconds training_interval_;
+  const uint32_t dictionary_size_;
+  const std::string dictionary_path_;
+  ZstdDictionaryTrainerStats stats_;
+  Event::Dispatcher& main_thread_dispatcher_;
+  Api::Api& api_;
+  const DictionaryTrainingThreadSharedPtr training_thread_;
+  const DictionaryCb on_dictionary_;
+  const DictionarySampleSinkSharedPtr sample_sink_;
+  // Whether a dictionary is being trained. Only used on the main thread.
+  bool training_ = false;
+
+  Event::TimerPtr training_timer_;
+};
+
+using DictionaryTrainerSharedPtr = std::shared_ptr<DictionaryTrainer>;
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
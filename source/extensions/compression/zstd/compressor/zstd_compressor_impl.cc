@@ -1,5 +1,7 @@
 #include "source/extensions/compression/zstd/compressor/zstd_compressor_impl.h"
 
+#include <utility>
+
 namespace Envoy {
 namespace Extensions {
 namespace Compression {
@@ -8,21 +10,65 @@ namespace Compressor {
 
 ZstdCompressorImpl::ZstdCompressorImpl(uint32_t compression_level, bool enable_checksum,
                                        uint32_t strategy, const ZstdCDictManagerPtr& cdict_manager,
-                                       uint32_t chunk_size)
+                                       uint32_t chunk_size,
+                                       DictionarySampleSinkSharedPtr sample_sink)
     : ZstdCompressorImplBase(compression_level, enable_checksum, strategy, chunk_size),
-      cdict_manager_(cdict_manager) {
-  size_t result;
-  if (cdict_manager_) {
-    ZSTD_CDict* cdict = cdict_manager_->getFirstDictionary();
-    result = ZSTD_CCtx_refCDict(cctx_.get(), cdict);
-  } else {
-    result = ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_compressionLevel, compression_level_);
+      cdict_manager_(cdict_manager), sample_sink_(std::move(sample_sink)) {
+  // The level applies until there is a dictionary, e.g. before the first one is trained.
+  const size_t result =
+      ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_compressionLevel, compression_level_);
+  RELEASE_ASSERT(!ZSTD_isError(result), "");
+  useCurrentDictionary();
+  startSampling();
+}
+
+void ZstdCompressorImpl::reset() {
+  const size_t result = ZSTD_CCtx_reset(cctx_.get(), ZSTD_reset_session_only);
+  RELEASE_ASSERT(!ZSTD_isError(result), "");
+  output_.pos = 0;
+  input_ = {nullptr, 0, 0};
+  useCurrentDictionary();
+  startSampling();
+}
+
+void ZstdCompressorImpl::useCurrentDictionary() {
+  if (!cdict_manager_) {
+    return;
   }
+  cdict_ = cdict_manager_->getFirstDictionaryShared();
+  const size_t result = ZSTD_CCtx_refCDict(cctx_.get(), cdict_.get());
   RELEASE_ASSERT(!ZSTD_isError(result), "");
 }
 
-void ZstdCompressorImpl::compressPreprocess(Buffer::Instance&,
-                                            Envoy::Compression::Compressor::State) {}
+void ZstdCompressorImpl::startSampling() {
+  sample_.clear();
+  sampling_ = false;
+  if (sample_sink_ != nullptr) {
+    sampling_ = sample_sink_->collectingSamples();
+    max_sample_size_ = sample_sink_->maxSampleSize();
+  }
+}
+
+void ZstdCompressorImpl::compressPreprocess(Buffer::Instance& buffer,
+                                            Envoy::Compression::Compressor::State state) {
+  if (!sampling_) {
+    return;
+  }
+  if (sample_.size() + buffer.length() > max_sample_size_) {
+    // Only small bodies are sampled, as they benefit the most from a dictionary.
+    sampling_ = false;
+    sample_.clear();
+    return;
+  }
+  sample_.append(buffer.toString());
+  if (state == Envoy::Compression::Compressor::State::Finish) {
+    sampling_ = false;
+    if (!sample_.empty()) {
+      sample_sink_->addSample(std::move(sample_));
+    }
+    sample_.clear();
+  }
+}
 
 void ZstdCompressorImpl::compressProcess(const Buffer::Instance&,
                                          const Buffer::RawSlice& input_slice,
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include "envoy/compression/compressor/compressor.h"
 
 #include "source/common/compression/zstd/common/base.h"
 #include "source/common/compression/zstd/compressor/zstd_compressor_impl_base.h"
 #include "source/extensions/compression/zstd/common/dictionary_manager.h"
+#include "source/extensions/compression/zstd/compressor/dictionary_trainer.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -22,7 +26,15 @@ using ZstdCDictManagerPtr = std::unique_ptr<ZstdCDictManager>;
 class ZstdCompressorImpl : public Envoy::Compression::Zstd::Compressor::ZstdCompressorImplBase {
 public:
   ZstdCompressorImpl(uint32_t compression_level, bool enable_checksum, uint32_t strategy,
-                     const ZstdCDictManagerPtr& cdict_manager, uint32_t chunk_size);
+                     const ZstdCDictManagerPtr& cdict_manager, uint32_t chunk_size,
+                     DictionarySampleSinkSharedPtr sample_sink = nullptr);
+
+  /**
+   * Discards the state of the current stream, so that the compressor can be used for a new one
+   * with the same parameters, without allocating a new context. The new stream uses the current
+   * dictionary, which may have been replaced since the compressor was created.
+   */
+  void reset();
 
 private:
   void compressPreprocess(Buffer::Instance& buffer,
@@ -33,7 +45,19 @@ private:
 
   void compressPostprocess(Buffer::Instance& accumulation_buffer) override;
 
+  void useCurrentDictionary();
+  void startSampling();
+
   const ZstdCDictManagerPtr& cdict_manager_;
+  // Held so that the dictionary outlives the stream when it is replaced.
+  std::shared_ptr<ZSTD_CDict> cdict_;
+  // The sink rather than its trainer, whose timer belongs to the main thread, so that releasing
+  // the last compressor on a worker doesn't destroy the trainer there.
+  const DictionarySampleSinkSharedPtr sample_sink_;
+  // Whether the body of the current stream is being sampled for the trainer.
+  bool sampling_{false};
+  uint64_t max_sample_size_{0};
+  std::string sample_;
 };
 
 } // namespace Compressor
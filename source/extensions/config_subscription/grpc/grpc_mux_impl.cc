@@ -4,6 +4,7 @@
 #include "envoy/upstream/load_stats_reporter.h"
 
 #include "source/common/config/decoded_resource_impl.h"
+#include "source/common/config/resource_decode_pool.h"
 #include "source/common/config/utility.h"
 #include "source/common/memory/utils.h"
 #include "source/common/protobuf/protobuf.h"
@@ -414,7 +415,7 @@ void GrpcMuxImpl::onDiscoveryResponse(
     std::vector<DecodedResourcePtr> resources;
     OpaqueResourceDecoder& resource_decoder = *api_state.watches_.front()->resource_decoder_;
 
-    for (const auto& resource : message->resources()) {
+    const auto check_type_url = [&](const Protobuf::Any& resource) {
       // TODO(snowp): Check the underlying type when the resource is a Resource.
       if (!resource.Is<envoy::service::discovery::v3::Resource>() &&
           type_url != resource.type_url()) {
@@ -422,13 +423,39 @@ void GrpcMuxImpl::onDiscoveryResponse(
             fmt::format("{} does not match the message-wide type URL {} in DiscoveryResponse {}",
                         resource.type_url(), type_url, message->DebugString()));
       }
+    };
+    const bool reuse_unchanged = Runtime::runtimeFeatureEnabled(
+        "envoy.reloadable_features.xds_sotw_reuse_unchanged_resources");
+    if (!reuse_unchanged) {
+      api_state.decoded_resources_.clear();
+    }
+    if (reuse_unchanged ||
+        ResourceDecodePool::shouldDecodeInParallel(message->resources().size())) {
+      for (const auto& resource : message->resources()) {
+        check_type_url(resource);
+      }
+      std::vector<DecodedResourcePtr> decoded_resources =
+          reuse_unchanged ? api_state.decoded_resources_.decode(
+                                api_state.watches_.front()->resource_decoder_,
+                                message->resources(), message->version_info())
+                          : ResourceDecodePool::get().decode(
+                                resource_decoder, message->resources(), message->version_info());
+      for (auto& decoded_resource : decoded_resources) {
+        if (!isHeartbeatResource(type_url, *decoded_resource)) {
+          resources.emplace_back(std::move(decoded_resource));
+        }
+      }
+    } else {
+      for (const auto& resource : message->resources()) {
+        check_type_url(resource);
 
-      auto decoded_resource = THROW_OR_RETURN_VALUE(
-          DecodedResourceImpl::fromResource(resource_decoder, resource, message->version_info()),
-          DecodedResourceImplPtr);
+        auto decoded_resource = THROW_OR_RETURN_VALUE(
+            DecodedResourceImpl::fromResource(resource_decoder, resource, message->version_info()),
+            DecodedResourceImplPtr);
 
-      if (!isHeartbeatResource(type_url, *decoded_resource)) {
-        resources.emplace_back(std::move(decoded_resource));
+        if (!isHeartbeatResource(type_url, *decoded_resource)) {
+          resources.emplace_back(std::move(decoded_resource));
+        }
       }
     }
 
@@ -21,6 +21,7 @@
 #include "source/common/common/logger.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/api_version.h"
+#include "source/common/config/decoded_resource_cache.h"
 #include "source/common/config/resource_name.h"
 #include "source/common/config/ttl.h"
 #include "source/common/config/utility.h"
@@ -297,6 +298,8 @@ private:
     std::string control_plane_identifier_;
     // If true, xDS resources were previously fetched from an xDS source or an xDS delegate.
     bool previously_fetched_data_{false};
+    // The decoded resources of the last response, reused when they are sent again unchanged.
+    DecodedResourceCache decoded_resources_;
   };
 
   bool isHeartbeatResource(const std::string& type_url, const DecodedResource& resource) {
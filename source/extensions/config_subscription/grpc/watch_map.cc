@@ -5,6 +5,7 @@
 #include "source/common/common/cleanup.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/decoded_resource_impl.h"
+#include "source/common/config/resource_decode_pool.h"
 #include "source/common/config/utility.h"
 #include "source/common/config/xds_resource.h"
 
@@ -205,6 +206,13 @@ void WatchMap::onConfigUpdate(const Protobuf::RepeatedPtrField<Protobuf::Any>& r
     return;
   }
 
+  if (ResourceDecodePool::shouldDecodeInParallel(resources.size())) {
+    onConfigUpdate(ResourceDecodePool::get().decode((*watches_.begin())->resource_decoder_,
+                                                    resources, version_info),
+                   version_info);
+    return;
+  }
+
   std::vector<DecodedResourcePtr> decoded_resources;
   decoded_resources.reserve(resources.size());
   for (const auto& r : resources) {
@@ -233,17 +241,42 @@ void WatchMap::onConfigUpdate(
   // resources the watch map is interested in. Reserve the correct amount of
   // space for the vector for the good case.
   decoded_resources.reserve(added_resources.size());
-  for (const auto* r : added_resources) {
-    const absl::flat_hash_set<Watch*>& interested_in_r = watchesInterestedIn(r->name());
-    // If there are no watches, then we don't need to decode. If there are watches, they should all
-    // be for the same resource type, so we can just use the callbacks of the first watch to decode.
-    if (interested_in_r.empty()) {
-      continue;
+  if (ResourceDecodePool::shouldDecodeInParallel(added_resources.size())) {
+    // All the watches are for the same resource type, so the decoder of any of them will do.
+    std::vector<const envoy::service::discovery::v3::Resource*> interesting_resources;
+    std::vector<absl::flat_hash_set<Watch*>> interested_watches;
+    interesting_resources.reserve(added_resources.size());
+    interested_watches.reserve(added_resources.size());
+    for (const auto* r : added_resources) {
+      absl::flat_hash_set<Watch*> interested_in_r = watchesInterestedIn(r->name());
+      if (!interested_in_r.empty()) {
+        interesting_resources.push_back(r);
+        interested_watches.push_back(std::move(interested_in_r));
+      }
     }
-    decoded_resources.emplace_back(
-        new DecodedResourceImpl((*interested_in_r.begin())->resource_decoder_, *r));
-    for (const auto& interested_watch : interested_in_r) {
-      per_watch_added[interested_watch].emplace_back(*decoded_resources.back());
+    if (!interesting_resources.empty()) {
+      decoded_resources = ResourceDecodePool::get().decode(
+          (*interested_watches.front().begin())->resource_decoder_, interesting_resources);
+    }
+    for (size_t i = 0; i < decoded_resources.size(); ++i) {
+      for (const auto& interested_watch : interested_watches[i]) {
+        per_watch_added[interested_watch].emplace_back(*decoded_resources[i]);
+      }
+    }
+  } else {
+    for (const auto* r : added_resources) {
+      const absl::flat_hash_set<Watch*>& interested_in_r = watchesInterestedIn(r->name());
+      // If there are no watches, then we don't need to decode. If there are watches, they should
+      // all be for the same resource type, so we can just use the callbacks of the first watch to
+      // decode.
+      if (interested_in_r.empty()) {
+        continue;
+      }
+      decoded_resources.emplace_back(
+          new DecodedResourceImpl((*interested_in_r.begin())->resource_decoder_, *r));
+      for (const auto& interested_watch : interested_in_r) {
+        per_watch_added[interested_watch].emplace_back(*decoded_resources.back());
+      }
     }
   }
   absl::flat_hash_map<Watch*, Protobuf::RepeatedPtrField<std::string>> per_watch_removed;
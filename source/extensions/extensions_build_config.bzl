@@ -395,6 +395,7 @@ EXTENSIONS = {
     "envoy.extensions.http.cache.simple":                    "//source/extensions/http/cache/simple_http_cache:config",
     "envoy.extensions.http.cache_v2.file_system_http_cache": "//source/extensions/http/cache_v2/file_system_http_cache:config",
     "envoy.extensions.http.cache_v2.simple":                 "//source/extensions/http/cache_v2/simple_http_cache:config",
+    "envoy.extensions.http.cache_v2.tiered_http_cache":      "//source/extensions/http/cache_v2/tiered_http_cache:config",
 
     #
     # Internal redirect predicates
@@ -665,6 +666,9 @@ EXTENSIONS = {
     "envoy.tls.certificate_mappers.static_name":                    "//source/extensions/transport_sockets/tls/cert_mappers/static_name:config",
     "envoy.tls.upstream_certificate_mappers.filter_state_override": "//source/extensions/transport_sockets/tls/cert_mappers/filter_state_override:config",
 
+    # Private key providers
+    "envoy.tls.key_providers.software":                             "//source/extensions/transport_sockets/tls/private_key_providers/software:config",
+
     # Local address selectors
     "envoy.upstream.local_address_selector.filter_state_override": "//source/extensions/local_address_selectors/filter_state_override:config",
 }
@@ -29,6 +29,8 @@ absl::string_view cacheEntryStatusString(CacheEntryStatus s) {
     return "LookupError";
   case CacheEntryStatus::UpstreamReset:
     return "UpstreamReset";
+  case CacheEntryStatus::CollapseOverflow:
+    return "CollapseOverflow";
   }
   IS_ENVOY_BUG(absl::StrCat("Unexpected CacheEntryStatus: ", s));
   return "UnexpectedCacheEntryStatus";
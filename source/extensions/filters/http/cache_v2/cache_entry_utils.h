@@ -53,6 +53,9 @@ enum class CacheEntryStatus {
   LookupError,
   // The cache attempted to read from upstream for insert, but upstream reset.
   UpstreamReset,
+  // The entry was being looked up, inserted or validated by another request, but too
+  // many requests were already waiting for it, so this request bypassed the cache.
+  CollapseOverflow,
 };
 
 absl::string_view cacheEntryStatusString(CacheEntryStatus s);
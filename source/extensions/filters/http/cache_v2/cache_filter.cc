@@ -1,11 +1,14 @@
 #include "source/extensions/filters/http/cache_v2/cache_filter.h"
 
+#include <limits>
+
 #include "envoy/http/header_map.h"
 
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/enum_to_int.h"
 #include "source/common/http/headers.h"
 #include "source/common/http/utility.h"
+#include "source/common/protobuf/utility.h"
 #include "source/extensions/filters/http/cache_v2/cache_entry_utils.h"
 #include "source/extensions/filters/http/cache_v2/cacheability_utils.h"
 #include "source/extensions/filters/http/cache_v2/upstream_request_impl.h"
@@ -48,6 +51,8 @@ CacheFilterConfig::CacheFilterConfig(
     Server::Configuration::CommonFactoryContext& context)
     : vary_allow_list_(config.allowed_vary_headers(), context), time_source_(context.timeSource()),
       ignore_request_cache_control_header_(config.ignore_request_cache_control_header()),
+      max_collapsed_requests_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config, max_collapsed_requests, std::numeric_limits<uint32_t>::max())),
       cluster_manager_(context.clusterManager()), cache_sessions_(std::move(cache_sessions)),
       override_upstream_cluster_(config.override_upstream_cluster()) {}
 
@@ -151,7 +156,7 @@ Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::RequestHeaderMap& hea
   auto lookup_request = std::make_unique<ActiveLookupRequest>(
       headers, std::move(upstream_request_factory), *original_cluster_name,
       decoder_callbacks_->dispatcher(), config_->timeSource().systemTime(), config_, config_,
-      config_->ignoreRequestCacheControlHeader());
+      config_->ignoreRequestCacheControlHeader(), config_->maxCollapsedRequests());
   is_head_request_ = headers.getMethodValue() == Http::Headers::get().MethodValues.Head;
   ENVOY_STREAM_LOG(debug, "CacheFilter::decodeHeaders starting lookup", *decoder_callbacks_);
   config_->cacheSessions().lookup(
@@ -178,6 +183,7 @@ static absl::string_view responseCodeDetailsFromStatus(CacheEntryStatus status)
     return CacheResponseCodeDetails::ResponseFromCacheFilter;
   case CacheEntryStatus::Uncacheable:
   case CacheEntryStatus::LookupError:
+  case CacheEntryStatus::CollapseOverflow:
     break;
   }
   return StreamInfo::ResponseCodeDetails::get().ViaUpstream;
@@ -195,7 +201,8 @@ void CacheFilter::onLookupResult(ActiveLookupResultPtr lookup_result) {
   }
 
   stats().incForStatus(lookup_result_->status_);
-  if (lookup_result_->status_ != CacheEntryStatus::Uncacheable) {
+  if (lookup_result_->status_ != CacheEntryStatus::Uncacheable &&
+      lookup_result_->status_ != CacheEntryStatus::CollapseOverflow) {
     decoder_callbacks_->streamInfo().setResponseFlag(
         StreamInfo::CoreResponseFlag::ResponseFromCacheFilter);
   }
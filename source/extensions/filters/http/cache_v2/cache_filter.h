@@ -34,6 +34,7 @@ public:
   Upstream::ClusterManager& clusterManager() const { return cluster_manager_; }
   const std::string& overrideUpstreamCluster() const { return override_upstream_cluster_; }
   bool ignoreRequestCacheControlHeader() const { return ignore_request_cache_control_header_; }
+  uint32_t maxCollapsedRequests() const { return max_collapsed_requests_; }
   CacheSessions& cacheSessions() const { return *cache_sessions_; }
   bool hasCache() const { return cache_sessions_ != nullptr; }
   CacheFilterStats& stats() const override { return cache_sessions_->stats(); }
@@ -42,6 +43,7 @@ private:
   const VaryAllowList vary_allow_list_;
   TimeSource& time_source_;
   const bool ignore_request_cache_control_header_;
+  const uint32_t max_collapsed_requests_;
   Upstream::ClusterManager& cluster_manager_;
   Http::AsyncClient::StreamOptions upstream_options_;
   std::shared_ptr<CacheSessions> cache_sessions_;
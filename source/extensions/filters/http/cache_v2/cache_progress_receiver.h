@@ -18,6 +18,9 @@ public:
   virtual void onBodyInserted(AdjustedByteRange range, bool end_stream) PURE;
   virtual void onTrailersInserted(Http::ResponseTrailerMapPtr trailers) PURE;
   virtual void onInsertFailed(absl::Status status) PURE;
+  // Called after the response was completely inserted if the cache chose not to keep it, for
+  // example because of its admission policy. The CacheReader of the insert remains readable.
+  virtual void onInsertDiscarded() {}
   virtual ~CacheProgressReceiver() = default;
 };
 
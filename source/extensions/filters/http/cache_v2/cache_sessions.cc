@@ -17,12 +17,13 @@ ActiveLookupRequest::ActiveLookupRequest(
     Event::Dispatcher& dispatcher, SystemTime timestamp,
     const std::shared_ptr<const CacheableResponseChecker> cacheable_response_checker,
     const std::shared_ptr<const CacheFilterStatsProvider> stats_provider,
-    bool ignore_request_cache_control_header)
+    bool ignore_request_cache_control_header, uint32_t max_collapsed_requests)
     : upstream_request_factory_(std::move(upstream_request_factory)), dispatcher_(dispatcher),
       key_(CacheHeadersUtils::makeKey(request_headers, cluster_name)),
       request_headers_(Http::createHeaderMap<Http::RequestHeaderMapImpl>(request_headers)),
       cacheable_response_checker_(std::move(cacheable_response_checker)),
-      stats_provider_(std::move(stats_provider)), timestamp_(timestamp) {
+      stats_provider_(std::move(stats_provider)), timestamp_(timestamp),
+      max_collapsed_requests_(max_collapsed_requests) {
   if (!ignore_request_cache_control_header) {
     initializeRequestCacheControl(request_headers);
   }
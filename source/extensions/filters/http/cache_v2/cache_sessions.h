@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <memory>
 
 #include "envoy/buffer/buffer.h"
@@ -23,7 +24,8 @@ public:
       Event::Dispatcher& dispatcher, SystemTime timestamp,
       const std::shared_ptr<const CacheableResponseChecker> cacheable_response_checker,
       const std::shared_ptr<const CacheFilterStatsProvider> stats_provider,
-      bool ignore_request_cache_control_header);
+      bool ignore_request_cache_control_header,
+      uint32_t max_collapsed_requests = std::numeric_limits<uint32_t>::max());
 
   // Caches may modify the key according to local needs, though care must be
   // taken to ensure that meaningfully distinct responses have distinct keys.
@@ -49,6 +51,9 @@ public:
                           SystemTime::duration age) const;
   std::optional<std::vector<RawByteRange>> parseRange() const;
   bool isRangeRequest() const;
+  // The most requests that may wait for another request's upstream request for the same
+  // cache entry, including this one.
+  uint32_t maxCollapsedRequests() const { return max_collapsed_requests_; }
 
 private:
   void initializeRequestCacheControl(const Http::RequestHeaderMap& request_headers);
@@ -63,6 +68,7 @@ private:
   // Time when this LookupRequest was created (in response to an HTTP request).
   SystemTime timestamp_;
   RequestCacheControl request_cache_control_;
+  const uint32_t max_collapsed_requests_;
 };
 using ActiveLookupRequestPtr = std::unique_ptr<ActiveLookupRequest>;
 
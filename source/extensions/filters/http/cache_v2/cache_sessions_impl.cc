@@ -562,7 +562,13 @@ void CacheSession::getLookupResult(ActiveLookupRequestPtr lookup, ActiveLookupRe
   }
   case State::Validating:
   case State::Pending:
+    // The first subscriber is the one whose lookup or upstream request is in flight;
+    // the rest are waiting to share its result.
+    if (lookup_subscribers_.size() > sub.context_->lookup().maxCollapsedRequests()) {
+      return postUpstreamPassThrough(std::move(sub), CacheEntryStatus::CollapseOverflow);
+    }
     sub.context_->lookup().stats().incCacheSessionsSubscribers();
+    sub.context_->lookup().stats().incCollapsedRequests();
     lookup_subscribers_.push_back(std::move(sub));
     return;
   case State::Exists:
@@ -585,6 +591,10 @@ void CacheSession::getLookupResult(ActiveLookupRequestPtr lookup, ActiveLookupRe
         return;
       }
     }
+    if (state_ == State::Inserting) {
+      // The body is streamed from another request's upstream response as it is inserted.
+      sub.context_->lookup().stats().incCollapsedRequests();
+    }
     auto result = std::make_unique<ActiveLookupResult>();
     Event::Dispatcher& dispatcher = sub.dispatcher();
     result->http_source_ = std::move(sub.context_);
@@ -13,6 +13,7 @@ namespace CacheV2 {
   STATNAME(cache_sessions_entries)                                                                 \
   STATNAME(cache_sessions_subscribers)                                                             \
   STATNAME(upstream_buffered_bytes)                                                                \
+  STATNAME(collapsed_requests)                                                                     \
   STATNAME(cache)                                                                                  \
   STATNAME(cache_label)                                                                            \
   STATNAME(event)                                                                                  \
@@ -23,6 +24,7 @@ namespace CacheV2 {
   STATNAME(uncacheable)                                                                            \
   STATNAME(upstream_reset)                                                                         \
   STATNAME(lookup_error)                                                                           \
+  STATNAME(collapse_overflow)                                                                      \
   STATNAME(validate)
 
 MAKE_STAT_NAMES_STRUCT(CacheStatNames, CACHE_FILTER_STATS);
@@ -50,6 +52,8 @@ public:
                             {stat_names_.event_type_, stat_names_.lookup_error_}}),
         tags_validate_(
             {{stat_names_.cache_label_, label_}, {stat_names_.event_type_, stat_names_.validate_}}),
+        tags_collapse_overflow_({{stat_names_.cache_label_, label_},
+                                 {stat_names_.event_type_, stat_names_.collapse_overflow_}}),
         gauge_cache_sessions_entries_(
             gaugeFromStatNames(scope, {prefix_, stat_names_.cache_sessions_entries_},
                                Stats::Gauge::ImportMode::NeverImport, tags_just_label_)),
@@ -70,7 +74,11 @@ public:
         counter_lookup_error_(
             counterFromStatNames(scope, {prefix_, stat_names_.event_}, tags_lookup_error_)),
         counter_validate_(
-            counterFromStatNames(scope, {prefix_, stat_names_.event_}, tags_validate_)) {}
+            counterFromStatNames(scope, {prefix_, stat_names_.event_}, tags_validate_)),
+        counter_collapse_overflow_(
+            counterFromStatNames(scope, {prefix_, stat_names_.event_}, tags_collapse_overflow_)),
+        counter_collapsed_requests_(counterFromStatNames(
+            scope, {prefix_, stat_names_.collapsed_requests_}, tags_just_label_)) {}
   void incForStatus(CacheEntryStatus status) override;
   void incCacheSessionsEntries() override { gauge_cache_sessions_entries_.inc(); }
   void decCacheSessionsEntries() override { gauge_cache_sessions_entries_.dec(); }
@@ -84,6 +92,7 @@ public:
   void subUpstreamBufferedBytes(uint64_t bytes) override {
     gauge_upstream_buffered_bytes_.sub(bytes);
   }
+  void incCollapsedRequests() override { counter_collapsed_requests_.inc(); }
 
 private:
   CacheFilterStatsImpl(CacheFilterStatsImpl&) = delete;
@@ -98,6 +107,7 @@ private:
   const Stats::StatNameTagVector tags_upstream_reset_;
   const Stats::StatNameTagVector tags_lookup_error_;
   const Stats::StatNameTagVector tags_validate_;
+  const Stats::StatNameTagVector tags_collapse_overflow_;
   Stats::Gauge& gauge_cache_sessions_entries_;
   Stats::Gauge& gauge_cache_sessions_subscribers_;
   Stats::Gauge& gauge_upstream_buffered_bytes_;
@@ -108,6 +118,8 @@ private:
   Stats::Counter& counter_upstream_reset_;
   Stats::Counter& counter_lookup_error_;
   Stats::Counter& counter_validate_;
+  Stats::Counter& counter_collapse_overflow_;
+  Stats::Counter& counter_collapsed_requests_;
 };
 
 CacheFilterStatsPtr generateStats(Stats::Scope& scope, absl::string_view label) {
@@ -133,6 +145,8 @@ void CacheFilterStatsImpl::incForStatus(CacheEntryStatus status) {
     return counter_uncacheable_.inc();
   case CacheEntryStatus::LookupError:
     return counter_lookup_error_.inc();
+  case CacheEntryStatus::CollapseOverflow:
+    return counter_collapse_overflow_.inc();
   }
 }
 
@@ -18,6 +18,9 @@ public:
   virtual void subCacheSessionsSubscribers(uint64_t count) PURE;
   virtual void addUpstreamBufferedBytes(uint64_t bytes) PURE;
   virtual void subUpstreamBufferedBytes(uint64_t bytes) PURE;
+  // Counts a lookup that was served by another request's upstream request for the same
+  // cache entry, instead of making its own.
+  virtual void incCollapsedRequests() PURE;
   virtual ~CacheFilterStats() = default;
 };
 
@@ -0,0 +1,151 @@
+#include "source/extensions/filters/http/compressor/compression_thread_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "envoy/singleton/manager.h"
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+SINGLETON_MANAGER_REGISTRATION(compressor_thread_pool);
+
+void CompressionJobTracker::waitForJobs() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) { return jobs_ == 0; };
+  absl::MutexLock lock(mu_);
+  mu_.Await(absl::Condition(&condition));
+}
+
+void CompressionJobTracker::onJobStarted() {
+  absl::MutexLock lock(mu_);
+  jobs_++;
+}
+
+void CompressionJobTracker::onJobDone() {
+  absl::MutexLock lock(mu_);
+  jobs_--;
+}
+
+std::shared_ptr<CompressionThreadPool>
+CompressionThreadPool::singleton(Server::Configuration::ServerFactoryContext& context) {
+  return context.singletonManager().getTyped<CompressionThreadPool>(
+      SINGLETON_MANAGER_REGISTERED_NAME(compressor_thread_pool), [&context] {
+        // As many compression threads as workers, so that every worker can have a body being
+        // compressed at once.
+        return std::make_shared<CompressionThreadPool>(
+            std::max(context.options().concurrency(), 1U), context.api().threadFactory(),
+            context.mainThreadDispatcher());
+      });
+}
+
+CompressionThreadPool::CompressionThreadPool(uint32_t thread_count,
+                                             Thread::ThreadFactory& thread_factory,
+                                             Event::Dispatcher& main_thread_dispatcher)
+    : main_thread_dispatcher_(main_thread_dispatcher) {
+  threads_.reserve(thread_count);
+  while (threads_.size() < thread_count) {
+    threads_.push_back(thread_factory.createThread([this]() { worker(); },
+                                                   Thread::Options{"compressor"}));
+  }
+}
+
+CompressionThreadPool::~CompressionThreadPool() {
+  {
+    absl::MutexLock lock(mu_);
+    terminate_ = true;
+  }
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+CompressionThreadPool::CancelFunction
+CompressionThreadPool::compress(Event::Dispatcher& dispatcher, CompressionJobPtr job,
+                                absl::AnyInvocable<void(CompressionJobPtr)> on_complete) {
+  ASSERT(dispatcher.isThreadSafe());
+  auto task = std::make_shared<Task>(dispatcher, std::move(job), std::move(on_complete));
+  {
+    absl::MutexLock lock(mu_);
+    queue_.push(task);
+  }
+  return [task]() {
+    // Unless a pool thread is using it, the job is destroyed here, while the stream, and so the
+    // compressor's factory, is still alive.
+    CompressionJobPtr job;
+    absl::MutexLock lock(task->mu_);
+    task->cancelled_ = true;
+    if (!task->compressing_) {
+      job = std::move(task->job_);
+    }
+  };
+}
+
+void CompressionThreadPool::worker() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return terminate_ || !queue_.empty();
+  };
+  while (true) {
+    std::shared_ptr<Task> task;
+    {
+      absl::MutexLock lock(mu_);
+      mu_.Await(absl::Condition(&condition));
+      if (terminate_) {
+        return;
+      }
+      task = std::move(queue_.front());
+      queue_.pop();
+    }
+    CompressionJobTracker* tracker;
+    {
+      absl::MutexLock lock(task->mu_);
+      if (task->cancelled_) {
+        continue;
+      }
+      task->compressing_ = true;
+      // Counting the job before a cancel can see it being compressed ensures that its factory
+      // is not destroyed while it is.
+      tracker = task->job_->tracker_;
+      if (tracker != nullptr) {
+        tracker->onJobStarted();
+      }
+    }
+    CompressionJob& job = *task->job_;
+    job.compressor_->compress(job.data_, job.state_);
+    CompressionJobPtr cancelled_job;
+    {
+      // Posting under the lock ensures that a cancel, which happens before the dispatcher is
+      // destroyed, either precedes the post or prevents it.
+      absl::MutexLock lock(task->mu_);
+      task->compressing_ = false;
+      if (task->cancelled_) {
+        // The stream is gone, so the job is destroyed here, before the tracker lets its factory
+        // be destroyed.
+        cancelled_job = std::move(task->job_);
+      } else {
+        task->dispatcher_.post([task]() {
+          {
+            absl::MutexLock lock(task->mu_);
+            if (task->cancelled_) {
+              return;
+            }
+          }
+          task->on_complete_(std::move(task->job_));
+        });
+      }
+    }
+    cancelled_job.reset();
+    if (tracker != nullptr) {
+      tracker->onJobDone();
+    }
+  }
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/compression/compressor/compressor.h"
+#include "envoy/compression/compressor/factory.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/dispatcher_thread_deletable.h"
+#include "envoy/server/factory_context.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/buffer/buffer_impl.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * Counts the jobs with compressors of one factory that are being compressed on a
+ * CompressionThreadPool. A job can still be compressing after its stream was destroyed, and its
+ * compressor may use the state of its factory, so the factory is not destroyed until the jobs
+ * are done. @see TrackedCompressorFactory.
+ */
+class CompressionJobTracker {
+public:
+  // Blocks until no job of the factory is being compressed.
+  void waitForJobs() ABSL_LOCKS_EXCLUDED(mu_);
+
+private:
+  friend class CompressionThreadPool;
+
+  void onJobStarted() ABSL_LOCKS_EXCLUDED(mu_);
+  void onJobDone() ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Mutex mu_;
+  uint32_t jobs_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+/**
+ * A compressor factory and the tracker of its jobs. Its owner deletes it in the main thread,
+ * where it waits for the jobs still being compressed before destroying the factory, so that a
+ * worker releasing the last reference to a filter config never waits for the pool.
+ */
+class TrackedCompressorFactory : public Event::DispatcherThreadDeletable {
+public:
+  explicit TrackedCompressorFactory(Envoy::Compression::Compressor::CompressorFactoryPtr factory)
+      : factory_(std::move(factory)) {}
+  ~TrackedCompressorFactory() override { tracker_.waitForJobs(); }
+
+  Envoy::Compression::Compressor::CompressorFactory& factory() const { return *factory_; }
+  CompressionJobTracker& tracker() const { return tracker_; }
+
+private:
+  const Envoy::Compression::Compressor::CompressorFactoryPtr factory_;
+  mutable CompressionJobTracker tracker_;
+};
+
+using TrackedCompressorFactoryPtr = std::unique_ptr<TrackedCompressorFactory>;
+
+// A chunk of a body to be compressed on a CompressionThreadPool, and the compressor of its
+// stream. The compressor is owned by the job while it is on the pool, so that a stream has at
+// most one chunk being compressed at a time, and chunks are compressed in order.
+struct CompressionJob {
+  Envoy::Compression::Compressor::CompressorPtr compressor_;
+  // Replaced with the compressed data when the job is complete.
+  Buffer::OwnedImpl data_;
+  Envoy::Compression::Compressor::State state_;
+  uint64_t uncompressed_length_;
+  // The tracker of the compressor's factory, if the factory has state that the compressor uses.
+  CompressionJobTracker* tracker_{};
+};
+
+using CompressionJobPtr = std::unique_ptr<CompressionJob>;
+
+/**
+ * Threads shared by all workers for compressing large bodies, so that compressing them doesn't
+ * block a worker's event loop.
+ */
+class CompressionThreadPool : public Singleton::Instance {
+public:
+  using CancelFunction = absl::AnyInvocable<void()>;
+
+  static std::shared_ptr<CompressionThreadPool>
+  singleton(Server::Configuration::ServerFactoryContext& context);
+
+  CompressionThreadPool(uint32_t thread_count, Thread::ThreadFactory& thread_factory,
+                        Event::Dispatcher& main_thread_dispatcher);
+  ~CompressionThreadPool() override;
+
+  // The dispatcher in which the factories of offloading configs are deleted.
+  Event::Dispatcher& mainThreadDispatcher() const { return main_thread_dispatcher_; }
+
+  /**
+   * Compresses a job on the pool, then posts on_complete with the job to the dispatcher.
+   * @return a function that prevents on_complete being called. It must be called from the
+   *         dispatcher's thread, before the dispatcher is destroyed, if on_complete has not been
+   *         called. It destroys the job, unless the job is being compressed, in which case the
+   *         pool destroys it once compressed, before its tracker stops counting it.
+   */
+  CancelFunction compress(Event::Dispatcher& dispatcher, CompressionJobPtr job,
+                          absl::AnyInvocable<void(CompressionJobPtr)> on_complete)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+private:
+  struct Task {
+    Task(Event::Dispatcher& dispatcher, CompressionJobPtr job,
+         absl::AnyInvocable<void(CompressionJobPtr)> on_complete)
+        : dispatcher_(dispatcher), job_(std::move(job)), on_complete_(std::move(on_complete)) {}
+    Event::Dispatcher& dispatcher_;
+    CompressionJobPtr job_;
+    absl::AnyInvocable<void(CompressionJobPtr)> on_complete_;
+    absl::Mutex mu_;
+    bool cancelled_ ABSL_GUARDED_BY(mu_) = false;
+    // Set while a pool thread uses the job.
+    bool compressing_ ABSL_GUARDED_BY(mu_) = false;
+  };
+
+  void worker() ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Mutex mu_;
+  std::queue<std::shared_ptr<Task>> queue_ ABSL_GUARDED_BY(mu_);
+  bool terminate_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<Thread::ThreadPtr> threads_;
+  Event::Dispatcher& main_thread_dispatcher_;
+};
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -11,6 +11,7 @@
 #include "source/common/http/header_map_impl.h"
 #include "source/common/http/utility.h"
 #include "source/common/protobuf/protobuf.h"
+#include "source/common/protobuf/utility.h"
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
@@ -45,6 +46,9 @@ bool isWeakEtag(absl::string_view value) {
 // Default minimum length of an upstream response that allows compression.
 const uint64_t DefaultMinimumContentLength = 30;
 
+// Default minimum size of a response body chunk that is compressed on the thread pool.
+const uint32_t DefaultOffloadMinResponseBytes = 64 * 1024;
+
 // Default content types will be used if any is provided by the user.
 const std::vector<std::string>& defaultContentEncoding() {
   CONSTRUCT_ON_FIRST_USE(std::vector<std::string>, {"text/html",
@@ -100,15 +104,27 @@ CompressorFilterConfig::DirectionConfig::DirectionConfig(
 CompressorFilterConfig::CompressorFilterConfig(
     const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
     const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-    Compression::Compressor::CompressorFactoryPtr compressor_factory)
+    Compression::Compressor::CompressorFactoryPtr compressor_factory,
+    std::shared_ptr<CompressionThreadPool> response_thread_pool)
     : common_stats_prefix_(fmt::format("{}compressor.{}.{}", stats_prefix,
                                        proto_config.compressor_library().name(),
                                        compressor_factory->statsPrefix())),
       request_direction_config_(proto_config, common_stats_prefix_, scope, runtime),
       response_direction_config_(proto_config, common_stats_prefix_, scope, runtime),
       content_encoding_(compressor_factory->contentEncoding()),
-      compressor_factory_(std::move(compressor_factory)),
-      choose_first_(proto_config.choose_first()) {}
+      compressor_factory_(
+          std::make_unique<TrackedCompressorFactory>(std::move(compressor_factory))),
+      choose_first_(proto_config.choose_first()),
+      response_thread_pool_(std::move(response_thread_pool)) {}
+
+CompressorFilterConfig::~CompressorFilterConfig() {
+  // A chunk of a destroyed stream may still be compressing on the thread pool, and this may be
+  // a worker releasing the last reference, so the wait for it happens in the main thread.
+  if (response_thread_pool_ != nullptr) {
+    response_thread_pool_->mainThreadDispatcher().deleteInDispatcherThread(
+        std::move(compressor_factory_));
+  }
+}
 
 StringUtil::CaseUnorderedSet CompressorFilterConfig::DirectionConfig::contentTypeSet(
     const Protobuf::RepeatedPtrField<std::string>& types) {
@@ -151,6 +167,9 @@ CompressorFilterConfig::ResponseDirectionConfig::ResponseDirectionConfig(
               ? proto_config.response_direction_config().remove_accept_encoding_header()
               : proto_config.remove_accept_encoding_header()),
       status_header_enabled_(proto_config.response_direction_config().status_header_enabled()),
+      offload_min_response_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          proto_config.response_direction_config().offload(), min_response_bytes,
+          DefaultOffloadMinResponseBytes)),
       uncompressible_response_codes_(uncompressibleResponseCodesSet(
           proto_config.response_direction_config().uncompressible_response_codes())),
       response_stats_{generateResponseStats(stats_prefix, scope)} {}
@@ -183,7 +202,7 @@ CompressorFilterConfig::ResponseDirectionConfig::commonConfig(
 }
 
 Envoy::Compression::Compressor::CompressorPtr CompressorFilterConfig::makeCompressor() {
-  return compressor_factory_->createCompressor();
+  return compressor_factory_->factory().createCompressor();
 }
 
 CompressorFilter::CompressorFilter(const CompressorFilterConfigSharedPtr config)
@@ -199,7 +218,8 @@ void CompressorFilter::initPerRouteConfig() {
 
 CompressorPerRouteFilterConfig::CompressorPerRouteFilterConfig(
     const envoy::extensions::filters::http::compressor::v3::CompressorPerRoute& config,
-    Server::Configuration::GenericFactoryContext& context) {
+    Server::Configuration::GenericFactoryContext& context)
+    : main_thread_dispatcher_(context.serverFactoryContext().mainThreadDispatcher()) {
   switch (config.override_case()) {
   case CompressorPerRoute::kDisabled:
     response_compression_enabled_ = false;
@@ -231,7 +251,8 @@ CompressorPerRouteFilterConfig::CompressorPerRouteFilterConfig(
       ProtobufTypes::MessagePtr message = Config::Utility::translateAnyToFactoryConfig(
           config.overrides().compressor_library().typed_config(),
           context.messageValidationVisitor(), *config_factory);
-      compressor_factory_ = config_factory->createCompressorFactoryFromProto(*message, context);
+      compressor_factory_ = std::make_unique<TrackedCompressorFactory>(
+          config_factory->createCompressorFactoryFromProto(*message, context));
     }
     break;
   case CompressorPerRoute::OVERRIDE_NOT_SET:
@@ -241,6 +262,14 @@ CompressorPerRouteFilterConfig::CompressorPerRouteFilterConfig(
   }
 }
 
+CompressorPerRouteFilterConfig::~CompressorPerRouteFilterConfig() {
+  // As for CompressorFilterConfig. Whether the filter offloads is not known here, so the factory
+  // is always deleted in the main thread.
+  if (compressor_factory_ != nullptr) {
+    main_thread_dispatcher_.deleteInDispatcherThread(std::move(compressor_factory_));
+  }
+}
+
 Http::FilterHeadersStatus CompressorFilter::decodeHeaders(Http::RequestHeaderMap& headers,
                                                           bool end_stream) {
   const Http::HeaderEntry* accept_encoding = headers.getInline(accept_encoding_handle.handle());
@@ -369,6 +398,7 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
     config.stats().compressed_.inc();
     // Finally instantiate the compressor.
     response_compressor_ = getCompressorFactory().createCompressor();
+    response_job_tracker_ = &getResponseJobTracker();
   } else {
     config.stats().not_compressed_.inc();
   }
@@ -459,6 +489,7 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeadersWithStatusHeader(
   config.stats().compressed_.inc();
   // Finally instantiate the compressor.
   response_compressor_ = config_->makeCompressor();
+  response_job_tracker_ = &config_->responseJobTracker();
   insertEnvoyCompressionStatusHeader(headers, getContentEncoding(),
                                      Http::Headers::get().EnvoyCompressionStatusValues.Compressed,
                                      content_length);
@@ -466,6 +497,13 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeadersWithStatusHeader(
 }
 
 Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  response_body_bytes_ += data.length();
+  if (responseCompressionOffloaded() ||
+      (response_compressor_ != nullptr && config_->responseThreadPool() != nullptr &&
+       response_body_bytes_ >= config_->responseDirectionConfig().offloadMinResponseBytes())) {
+    offloadResponseChunk(data, end_stream);
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
   if (response_compressor_ != nullptr) {
     compressAndUpdateStats(response_compressor_, config_->responseDirectionConfig().stats(), data,
                            end_stream);
@@ -474,6 +512,14 @@ Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool
 }
 
 Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTrailerMap&) {
+  if (responseCompressionOffloaded()) {
+    // The end of the compressed data has to follow the chunks on the thread pool, and the
+    // trailers have to follow that.
+    response_trailers_held_ = true;
+    Buffer::OwnedImpl empty_buffer;
+    offloadResponseChunk(empty_buffer, true);
+    return Http::FilterTrailersStatus::StopIteration;
+  }
   if (response_compressor_ != nullptr) {
     Buffer::OwnedImpl empty_buffer;
     // The presence of trailers means the stream is ended, but encodeData()
@@ -486,6 +532,64 @@ Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTraile
   return Http::FilterTrailersStatus::Continue;
 }
 
+void CompressorFilter::onDestroy() { cancel_response_chunk_(); }
+
+void CompressorFilter::offloadResponseChunk(Buffer::Instance& data, bool end_stream) {
+  auto job = std::make_unique<CompressionJob>();
+  job->uncompressed_length_ = data.length();
+  job->data_.move(data);
+  job->state_ = end_stream ? Envoy::Compression::Compressor::State::Finish
+                           : Envoy::Compression::Compressor::State::Flush;
+  config_->responseDirectionConfig().stats().total_uncompressed_bytes_.add(
+      job->uncompressed_length_);
+  offloaded_response_bytes_ += job->uncompressed_length_;
+  queued_response_chunks_.push(std::move(job));
+  // The filter manager doesn't buffer data for a filter that stops iteration without buffering,
+  // so the filter applies its buffer limit to the chunks it holds itself.
+  const uint32_t limit = encoder_callbacks_->encoderBufferLimit();
+  if (limit > 0 && !above_write_buffer_high_watermark_ && offloaded_response_bytes_ > limit) {
+    above_write_buffer_high_watermark_ = true;
+    encoder_callbacks_->onEncoderFilterAboveWriteBufferHighWatermark();
+  }
+  compressNextResponseChunk();
+}
+
+void CompressorFilter::compressNextResponseChunk() {
+  if (response_chunk_in_pool_ || queued_response_chunks_.empty()) {
+    return;
+  }
+  CompressionJobPtr job = std::move(queued_response_chunks_.front());
+  queued_response_chunks_.pop();
+  ASSERT(response_compressor_ != nullptr);
+  job->compressor_ = std::move(response_compressor_);
+  job->tracker_ = response_job_tracker_;
+  response_chunk_in_pool_ = true;
+  cancel_response_chunk_ = config_->responseThreadPool()->compress(
+      encoder_callbacks_->dispatcher(), std::move(job),
+      [this](CompressionJobPtr job) { onResponseChunkCompressed(std::move(job)); });
+}
+
+void CompressorFilter::onResponseChunkCompressed(CompressionJobPtr job) {
+  response_chunk_in_pool_ = false;
+  cancel_response_chunk_ = []() {};
+  response_compressor_ = std::move(job->compressor_);
+  config_->responseDirectionConfig().stats().total_compressed_bytes_.add(job->data_.length());
+  offloaded_response_bytes_ -= job->uncompressed_length_;
+  if (above_write_buffer_high_watermark_ &&
+      offloaded_response_bytes_ <= encoder_callbacks_->encoderBufferLimit() / 2) {
+    above_write_buffer_high_watermark_ = false;
+    encoder_callbacks_->onEncoderFilterBelowWriteBufferLowWatermark();
+  }
+  const bool end_stream = job->state_ == Envoy::Compression::Compressor::State::Finish;
+  if (end_stream && response_trailers_held_) {
+    encoder_callbacks_->injectEncodedDataToFilterChain(job->data_, false);
+    encoder_callbacks_->continueEncoding();
+    return;
+  }
+  encoder_callbacks_->injectEncodedDataToFilterChain(job->data_, end_stream);
+  compressNextResponseChunk();
+}
+
 bool CompressorFilter::hasCacheControlNoTransform(Http::ResponseHeaderMap& headers) const {
   const Http::HeaderEntry* cache_control = headers.getInline(cache_control_handle.handle());
   if (cache_control) {
@@ -879,6 +983,13 @@ Envoy::Compression::Compressor::CompressorFactory& CompressorFilter::getCompress
       config_->compressorFactory());
 }
 
+CompressionJobTracker& CompressorFilter::getResponseJobTracker() const {
+  if (per_route_config_ && per_route_config_->compressorFactory()) {
+    return per_route_config_->responseJobTracker();
+  }
+  return config_->responseJobTracker();
+}
+
 std::string CompressorFilter::getContentEncoding() const {
   if (per_route_config_ && per_route_config_->contentEncoding().has_value()) {
     return per_route_config_->contentEncoding().value();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <queue>
 
 #include "envoy/compression/compressor/factory.h"
 #include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
@@ -11,6 +12,7 @@
 #include "source/common/protobuf/protobuf.h"
 #include "source/common/runtime/runtime_protos.h"
 #include "source/extensions/filters/http/common/pass_through_filter.h"
+#include "source/extensions/filters/http/compressor/compression_thread_pool.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -122,6 +124,7 @@ public:
     bool weakenEtagOnCompress() const { return weaken_etag_on_compress_; }
     bool removeAcceptEncodingHeader() const { return remove_accept_encoding_header_; }
     bool statusHeaderEnabled() const { return status_header_enabled_; }
+    uint32_t offloadMinResponseBytes() const { return offload_min_response_bytes_; }
     bool areAllResponseCodesCompressible() const;
     bool isResponseCodeCompressible(uint32_t response_code) const;
 
@@ -140,6 +143,7 @@ public:
     const bool weaken_etag_on_compress_;
     const bool remove_accept_encoding_header_;
     const bool status_header_enabled_;
+    const uint32_t offload_min_response_bytes_;
     const absl::flat_hash_set<uint32_t> uncompressible_response_codes_;
     const ResponseCompressorStats response_stats_;
   };
@@ -148,17 +152,24 @@ public:
   CompressorFilterConfig(
       const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
       const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory);
+      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory,
+      std::shared_ptr<CompressionThreadPool> response_thread_pool = nullptr);
+  ~CompressorFilterConfig();
 
   Envoy::Compression::Compressor::CompressorPtr makeCompressor();
+  // The thread pool to compress large response body chunks on, or nullptr if response
+  // compression is not offloaded.
+  CompressionThreadPool* responseThreadPool() const { return response_thread_pool_.get(); }
 
   const std::string contentEncoding() const { return content_encoding_; };
   bool chooseFirst() const { return choose_first_; };
   const RequestDirectionConfig& requestDirectionConfig() { return request_direction_config_; }
   const ResponseDirectionConfig& responseDirectionConfig() { return response_direction_config_; }
   const Envoy::Compression::Compressor::CompressorFactory& compressorFactory() const {
-    return *compressor_factory_;
+    return compressor_factory_->factory();
   }
+  // Counts the offloaded response chunks of the compressor factory.
+  CompressionJobTracker& responseJobTracker() const { return compressor_factory_->tracker(); }
 
 private:
   const std::string common_stats_prefix_;
@@ -166,8 +177,10 @@ private:
   const ResponseDirectionConfig response_direction_config_;
 
   const std::string content_encoding_;
-  const Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory_;
+  // Deleted in the main thread if response compression is offloaded.
+  TrackedCompressorFactoryPtr compressor_factory_;
   const bool choose_first_;
+  const std::shared_ptr<CompressionThreadPool> response_thread_pool_;
 };
 using CompressorFilterConfigSharedPtr = std::shared_ptr<CompressorFilterConfig>;
 
@@ -177,6 +190,7 @@ public:
   CompressorPerRouteFilterConfig(
       const envoy::extensions::filters::http::compressor::v3::CompressorPerRoute& config,
       Server::Configuration::GenericFactoryContext& context);
+  ~CompressorPerRouteFilterConfig() override;
 
   // If a value is present, that value overrides
   // ResponseDirectionConfig::compressionEnabled.
@@ -185,19 +199,25 @@ public:
 
   // Returns the per-route compressor factory if configured, nullptr otherwise.
   const Envoy::Compression::Compressor::CompressorFactory* compressorFactory() const {
-    return compressor_factory_.get();
+    return compressor_factory_ != nullptr ? &compressor_factory_->factory() : nullptr;
   }
 
   // Returns the content encoding for the per-route compressor if configured.
   std::optional<std::string> contentEncoding() const {
-    return compressor_factory_ ? std::make_optional(compressor_factory_->contentEncoding())
-                               : std::nullopt;
+    return compressor_factory_
+               ? std::make_optional(compressor_factory_->factory().contentEncoding())
+               : std::nullopt;
   }
 
+  // Counts the offloaded response chunks of the per-route compressor factory, if configured.
+  CompressionJobTracker& responseJobTracker() const { return compressor_factory_->tracker(); }
+
 private:
   std::optional<bool> response_compression_enabled_;
   std::optional<bool> remove_accept_encoding_header_;
-  Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory_;
+  Event::Dispatcher& main_thread_dispatcher_;
+  // Deleted in the main thread.
+  TrackedCompressorFactoryPtr compressor_factory_;
 };
 
 /**
@@ -221,6 +241,9 @@ public:
   Http::FilterDataStatus encodeData(Buffer::Instance& buffer, bool end_stream) override;
   Http::FilterTrailersStatus encodeTrailers(Http::ResponseTrailerMap&) override;
 
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
   // Grant testing peer access.
   friend class CompressorFilterTestingPeer;
 
@@ -280,6 +303,8 @@ private:
   // Returns the appropriate compressor factory for the current route.
   // Checks for per-route config first, then falls back to main config.
   Envoy::Compression::Compressor::CompressorFactory& getCompressorFactory() const;
+  // Returns the tracker of the factory that getCompressorFactory() returns.
+  CompressionJobTracker& getResponseJobTracker() const;
 
   // Returns the appropriate content encoding for the current route.
   std::string getContentEncoding() const;
@@ -287,12 +312,37 @@ private:
   // Returns the request stream info (downstream or upstream depending on the filter type).
   StreamInfo::StreamInfo& streamInfo() const;
 
+  // Queues a response body chunk to be compressed on the thread pool, after any chunks already
+  // queued.
+  void offloadResponseChunk(Buffer::Instance& data, bool end_stream);
+  // Sends the next queued chunk to the thread pool, if none is already there.
+  void compressNextResponseChunk();
+  void onResponseChunkCompressed(CompressionJobPtr job);
+  bool responseCompressionOffloaded() const {
+    return response_chunk_in_pool_ || !queued_response_chunks_.empty();
+  }
+
   Envoy::Compression::Compressor::CompressorPtr response_compressor_;
+  // The tracker of the factory of response_compressor_.
+  CompressionJobTracker* response_job_tracker_{};
   Envoy::Compression::Compressor::CompressorPtr request_compressor_;
   const CompressorFilterConfigSharedPtr config_;
   std::unique_ptr<std::string> accept_encoding_;
   // Cached per-route configuration pointer, initialized once per stream.
   const CompressorPerRouteFilterConfig* per_route_config_{};
+
+  // Response body chunks waiting to be compressed on the thread pool. While a chunk is on the
+  // pool, response_compressor_ is owned by its job.
+  std::queue<CompressionJobPtr> queued_response_chunks_;
+  bool response_chunk_in_pool_{};
+  CompressionThreadPool::CancelFunction cancel_response_chunk_ = []() {};
+  // Uncompressed bytes queued or on the pool, for flow control.
+  uint64_t offloaded_response_bytes_{};
+  // Uncompressed response body bytes so far, which decide when the response is offloaded.
+  uint64_t response_body_bytes_{};
+  bool above_write_buffer_high_watermark_{};
+  // Trailers wait for the last chunk to come back from the pool.
+  bool response_trailers_held_{};
 };
 
 } // namespace Compressor
@@ -32,9 +32,13 @@ absl::StatusOr<Http::FilterFactoryCb> CompressorFilterFactory::createFilterFacto
       *config_factory);
   Compression::Compressor::CompressorFactoryPtr compressor_factory =
       config_factory->createCompressorFactoryFromProto(*message, context);
+  std::shared_ptr<CompressionThreadPool> response_thread_pool;
+  if (proto_config.response_direction_config().has_offload()) {
+    response_thread_pool = CompressionThreadPool::singleton(context.serverFactoryContext());
+  }
   CompressorFilterConfigSharedPtr config = std::make_shared<CompressorFilterConfig>(
       proto_config, stats_prefix, context.scope(), context.serverFactoryContext().runtime(),
-      std::move(compressor_factory));
+      std::move(compressor_factory), std::move(response_thread_pool));
   return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<CompressorFilter>(config));
   };
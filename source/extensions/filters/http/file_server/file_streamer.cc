@@ -1,9 +1,12 @@
 #include "source/extensions/filters/http/file_server/file_streamer.h"
 
+#include <optional>
+
 #include "envoy/http/codes.h"
 
 #include "source/common/common/enum_to_int.h"
 #include "source/common/http/header_map_impl.h"
+#include "source/common/http/headers.h"
 #include "source/extensions/common/async_files/async_file_manager.h"
 #include "source/extensions/filters/http/file_server/absl_status_to_http_status.h"
 
@@ -23,13 +26,21 @@ const Http::LowerCaseString& acceptRangesHeaderKey() {
 } // namespace
 
 void FileStreamer::begin(const FileServerConfig& config, Event::Dispatcher& dispatcher,
-                         uint64_t start, uint64_t end, std::filesystem::path file_path) {
+                         uint64_t start, uint64_t end, std::filesystem::path file_path,
+                         RequestConditions conditions) {
   ASSERT(config.asyncFileManager() != nullptr);
   file_server_config_ = &config;
   dispatcher_ = &dispatcher;
   pos_ = start;
   end_ = end;
   file_path_ = std::move(file_path);
+  conditions_ = std::move(conditions);
+  if (HotFileCache* cache = file_server_config_->hotFileCache()) {
+    if (HotFileSharedPtr file = cache->lookup(file_path_.string())) {
+      serveHotFile(*file);
+      return;
+    }
+  }
   cancel_callback_ = file_server_config_->asyncFileManager()->stat(
       dispatcher_, file_path_.string(),
       Envoy::CancelWrapper::cancelWrapped(
@@ -111,44 +122,90 @@ void FileStreamer::startFile() {
               return;
             }
             const struct stat& s = result.value();
-            if (static_cast<uint64_t>(s.st_size) < end_ ||
-                static_cast<uint64_t>(s.st_size) < pos_ || (end_ != 0 && end_ < pos_)) {
-              client_.errorFromFile(Http::Code::RangeNotSatisfiable,
-                                    "file_server_range_not_satisfiable");
-              return;
-            }
-            auto headers = Http::ResponseHeaderMapImpl::create();
-            headers->setReference(acceptRangesHeaderKey(), "bytes");
-            if (pos_ || end_) {
-              // Range request gets PartialContent, a content-range, and reduced content-length
-              // header.
-              if (!end_) {
-                end_ = s.st_size;
-              }
-              headers->setContentLength(end_ - pos_);
-              // Subtract one from end_ in this header because range headers use [start, end) vs.
-              // end_ is in normal programmer [start, end] style.
-              headers->setReferenceKey(Envoy::Http::Headers::get().ContentRange,
-                                       absl::StrCat("bytes ", pos_, "-", end_ - 1, "/", s.st_size));
-              headers->setStatus(enumToInt(Http::Code::PartialContent));
-            } else {
-              end_ = s.st_size;
-              headers->setContentLength(s.st_size);
-              headers->setStatus(enumToInt(Http::Code::OK));
-            }
+            const uint64_t file_size = s.st_size;
             absl::string_view ct = file_server_config_->contentTypeForPath(file_path_);
-            if (!ct.empty()) {
-              headers->setContentType(ct);
+            HotFileCache* cache = file_server_config_->hotFileCache();
+            std::optional<FileValidators> validators;
+            if (cache != nullptr) {
+              validators = FileValidators::fromStat(s);
             }
-            if (client_.headersFromFile(std::move(headers))) {
-              readBodyChunk();
+            const bool whole_file = pos_ == 0 && (end_ == 0 || end_ == file_size);
+            if (!sendHeaders(file_size, ct, validators ? &*validators : nullptr)) {
+              return;
+            }
+            if (cache != nullptr && whole_file && file_size <= cache->maxFileSize()) {
+              hot_file_ = std::make_unique<HotFile>();
+              hot_file_->validators_ = std::move(*validators);
+              hot_file_->content_type_ = std::string{ct};
+              hot_file_contents_.reserve(file_size);
             }
+            readBodyChunk();
           },
           &cancel_dispatcher_callbacks_));
   ASSERT(queued.ok());
   cancel_callback_ = std::move(queued.value());
 }
 
+bool FileStreamer::sendHeaders(uint64_t file_size, absl::string_view content_type,
+                               const FileValidators* validators) {
+  // Conditions are evaluated before the range, which does not apply to a 304.
+  if (validators != nullptr && conditions_.notModified(*validators)) {
+    auto headers = Http::ResponseHeaderMapImpl::create();
+    headers->setStatus(enumToInt(Http::Code::NotModified));
+    headers->setReferenceKey(Http::CustomHeaders::get().Etag, validators->etag_);
+    headers->setReferenceKey(Http::CustomHeaders::get().LastModified, validators->last_modified_);
+    client_.headersFromFile(std::move(headers));
+    return false;
+  }
+  if (file_size < end_ || file_size < pos_ || (end_ != 0 && end_ < pos_)) {
+    client_.errorFromFile(Http::Code::RangeNotSatisfiable, "file_server_range_not_satisfiable");
+    return false;
+  }
+  auto headers = Http::ResponseHeaderMapImpl::create();
+  headers->setReference(acceptRangesHeaderKey(), "bytes");
+  if (pos_ || end_) {
+    // Range request gets PartialContent, a content-range, and reduced content-length
+    // header.
+    if (!end_) {
+      end_ = file_size;
+    }
+    headers->setContentLength(end_ - pos_);
+    // Subtract one from end_ in this header because range headers use [start, end) vs.
+    // end_ is in normal programmer [start, end] style.
+    headers->setReferenceKey(Envoy::Http::Headers::get().ContentRange,
+                             absl::StrCat("bytes ", pos_, "-", end_ - 1, "/", file_size));
+    headers->setStatus(enumToInt(Http::Code::PartialContent));
+  } else {
+    end_ = file_size;
+    headers->setContentLength(file_size);
+    headers->setStatus(enumToInt(Http::Code::OK));
+  }
+  if (!content_type.empty()) {
+    headers->setContentType(content_type);
+  }
+  if (validators != nullptr) {
+    headers->setReferenceKey(Http::CustomHeaders::get().Etag, validators->etag_);
+    headers->setReferenceKey(Http::CustomHeaders::get().LastModified, validators->last_modified_);
+  }
+  return client_.headersFromFile(std::move(headers));
+}
+
+void FileStreamer::serveHotFile(const HotFile& file) {
+  if (sendHeaders(file.contents_->size(), file.content_type_, &file.validators_)) {
+    client_.bodyChunkFromFile(file.body(pos_, end_), true);
+  }
+}
+
+void FileStreamer::appendToHotFile(const Buffer::Instance& buf) {
+  const size_t offset = hot_file_contents_.size();
+  hot_file_contents_.resize(offset + buf.length());
+  buf.copyOut(0, buf.length(), hot_file_contents_.data() + offset);
+  if (pos_ == end_) {
+    hot_file_->contents_ = std::make_shared<const std::string>(std::move(hot_file_contents_));
+    file_server_config_->hotFileCache()->insert(file_path_.string(), std::move(hot_file_));
+  }
+}
+
 void FileStreamer::pause() { paused_ = true; }
 
 void FileStreamer::unpause() {
@@ -176,6 +233,9 @@ void FileStreamer::readBodyChunk() {
                                         }
                                         Buffer::InstancePtr buf = std::move(result.value());
                                         pos_ += buf->length();
+                                        if (hot_file_ != nullptr) {
+                                          appendToHotFile(*buf);
+                                        }
                                         client_.bodyChunkFromFile(std::move(buf), pos_ == end_);
                                         if (!paused_ && pos_ != end_) {
                                           readBodyChunk();
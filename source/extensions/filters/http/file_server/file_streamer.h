@@ -7,6 +7,7 @@
 #include "source/common/common/cancel_wrapper.h"
 #include "source/extensions/common/async_files/async_file_manager.h"
 #include "source/extensions/filters/http/file_server/filter_config.h"
+#include "source/extensions/filters/http/file_server/hot_file_cache.h"
 
 #include "absl/strings/string_view.h"
 
@@ -34,8 +35,10 @@ public:
   ~FileStreamer();
   // Starts reading and streaming the file.
   // end == 0 means read to end of file.
+  // If the request's conditions show that the client has the file already, the response is a
+  // 304 Not Modified with no body.
   void begin(const FileServerConfig& config, Event::Dispatcher& dispatcher, uint64_t start,
-             uint64_t end, std::filesystem::path file_path);
+             uint64_t end, std::filesystem::path file_path, RequestConditions conditions = {});
   // Call when the downstream buffer is over watermark.
   // Stops at the completion of the current action if not unpaused first.
   void pause();
@@ -51,6 +54,16 @@ private:
   void startDir(int behavior_index);
   void onFileOpened(AsyncFileHandle handle);
   void readBodyChunk();
+  // Accumulates a chunk of a file being read for the hot file cache, and inserts the file into
+  // the cache once the last chunk has been read.
+  void appendToHotFile(const Buffer::Instance& buf);
+  // Responds from memory, with no file operations.
+  void serveHotFile(const HotFile& file);
+  // Sends the response headers for a file of the given size, or an error if the requested range
+  // is not satisfiable, or a 304 if the request's conditions say the file is not modified.
+  // Returns true if the body should follow.
+  bool sendHeaders(uint64_t file_size, absl::string_view content_type,
+                   const FileValidators* validators);
   Event::Dispatcher* dispatcher_;
   FileStreamerClient& client_;
   std::filesystem::path file_path_;
@@ -59,9 +72,14 @@ private:
   // To get the last byte, end_ must be the size of the file, not the inclusive last byte
   // like a range request uses.
   uint64_t end_ = 0;
+  RequestConditions conditions_;
   bool paused_ = false;
   bool action_has_been_postponed_by_pause_ = false;
   AsyncFileHandle async_file_;
+  // Set while reading a whole file that is small enough for the hot file cache. The contents
+  // accumulate in hot_file_contents_ and are inserted when the last chunk is read.
+  std::unique_ptr<HotFile> hot_file_;
+  std::string hot_file_contents_;
   // Cancel handle for the in-flight AsyncFileManager operation. Stops the
   // file-side work if it has not yet completed when abort() runs.
   CancelFunction cancel_callback_ = []() {};
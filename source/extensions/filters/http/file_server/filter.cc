@@ -5,6 +5,7 @@
 
 #include "envoy/buffer/buffer.h"
 
+#include "source/common/common/enum_to_int.h"
 #include "source/common/http/codes.h"
 #include "source/common/http/headers.h"
 #include "source/common/http/utility.h"
@@ -115,12 +116,14 @@ Http::FilterHeadersStatus FileServerFilter::decodeHeaders(RequestHeaderMap& head
   auto [start, end] = parseRangeHeader(headers);
   is_head_ = headers.Method()->value() == Http::Headers::get().MethodValues.Head;
   file_streamer_.begin(*config, decoder_callbacks_->dispatcher(), start, end,
-                       std::move(*file_path));
+                       std::move(*file_path), RequestConditions::fromHeaders(headers));
   return Http::FilterHeadersStatus::StopIteration;
 }
 
 bool FileServerFilter::headersFromFile(Http::ResponseHeaderMapPtr response_headers) {
-  bool end_response = is_head_ || response_headers->getContentLengthValue() == "0";
+  bool end_response = is_head_ || response_headers->getContentLengthValue() == "0" ||
+                      Http::Utility::getResponseStatus(*response_headers) ==
+                          enumToInt(Http::Code::NotModified);
   decoder_callbacks_->encodeHeaders(std::move(response_headers), end_response, "file_server");
   headers_sent_ = true;
   return !end_response;
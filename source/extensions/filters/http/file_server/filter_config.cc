@@ -35,8 +35,14 @@ FileServerConfig::create(const ProtoFileServerConfig& config,
   TRY_ASSERT_MAIN_THREAD {
     // TODO(ravenblack): make getAsyncFileManager use StatusOr instead of throw.
     auto async_file_manager = factory->getAsyncFileManager(config.manager_config());
+    std::shared_ptr<HotFileCache> hot_file_cache;
+    if (config.has_hot_file_cache()) {
+      hot_file_cache =
+          std::make_shared<HotFileCache>(config.hot_file_cache(), context.mainThreadDispatcher());
+    }
     return std::make_shared<const FileServerConfig>(config, std::move(factory),
-                                                    std::move(async_file_manager));
+                                                    std::move(async_file_manager),
+                                                    std::move(hot_file_cache));
   }
   END_TRY
   catch (const EnvoyException& e) {
@@ -46,13 +52,15 @@ FileServerConfig::create(const ProtoFileServerConfig& config,
 
 FileServerConfig::FileServerConfig(const ProtoFileServerConfig& config,
                                    std::shared_ptr<AsyncFileManagerFactory> factory,
-                                   std::shared_ptr<AsyncFileManager> manager)
+                                   std::shared_ptr<AsyncFileManager> manager,
+                                   std::shared_ptr<HotFileCache> hot_file_cache)
     : async_file_manager_factory_(std::move(factory)), async_file_manager_(std::move(manager)),
       path_mappings_(makePathMappings(config)),
       content_types_(config.content_types().begin(), config.content_types().end()),
       default_content_type_(config.default_content_type()),
       directory_behaviors_(config.directory_behaviors().begin(),
-                           config.directory_behaviors().end()) {}
+                           config.directory_behaviors().end()),
+      hot_file_cache_(std::move(hot_file_cache)) {}
 
 std::shared_ptr<const ProtoFileServerConfig::PathMapping>
 FileServerConfig::pathMapping(absl::string_view path) const {
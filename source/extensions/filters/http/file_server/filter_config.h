@@ -11,6 +11,7 @@
 #include "source/common/common/radix_tree.h"
 #include "source/extensions/common/async_files/async_file_manager.h"
 #include "source/extensions/common/async_files/async_file_manager_factory.h"
+#include "source/extensions/filters/http/file_server/hot_file_cache.h"
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
@@ -31,9 +32,12 @@ public:
          Envoy::Server::Configuration::ServerFactoryContext& context);
   FileServerConfig(const ProtoFileServerConfig& config,
                    std::shared_ptr<AsyncFileManagerFactory> factory,
-                   std::shared_ptr<AsyncFileManager> manager);
+                   std::shared_ptr<AsyncFileManager> manager,
+                   std::shared_ptr<HotFileCache> hot_file_cache = nullptr);
 
   const std::shared_ptr<AsyncFileManager>& asyncFileManager() const { return async_file_manager_; }
+  // nullptr if hot_file_cache is not configured.
+  HotFileCache* hotFileCache() const { return hot_file_cache_.get(); }
   // Returns nullptr if there is no corresponding path mapping (filter should be bypassed).
   std::shared_ptr<const ProtoFileServerConfig::PathMapping>
   pathMapping(absl::string_view path) const;
@@ -54,6 +58,7 @@ private:
   const absl::flat_hash_map<std::string, std::string> content_types_;
   const std::string default_content_type_;
   const std::vector<ProtoFileServerConfig::DirectoryBehavior> directory_behaviors_;
+  const std::shared_ptr<HotFileCache> hot_file_cache_;
 };
 
 } // namespace FileServer
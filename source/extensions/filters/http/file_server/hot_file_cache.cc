@@ -0,0 +1,250 @@
+#include "source/extensions/filters/http/file_server/hot_file_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/utility.h"
+#include "source/common/http/header_utility.h"
+#include "source/common/http/headers.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/time.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace FileServer {
+
+namespace {
+
+constexpr uint64_t DefaultMaxFileSize = 64 * 1024;
+constexpr uint64_t DefaultMaxTotalSize = 16 * 1024 * 1024;
+// The watcher is rebuilt once it watches this many paths, or twice as many as are cached if that
+// is more, so rebuilding costs a constant amount per watched path.
+constexpr size_t MinWatchedPathsBeforeRewatch = 1024;
+constexpr absl::string_view HttpDateFormat = "%a, %d %b %Y %H:%M:%S GMT";
+
+const struct timespec& modificationTime(const struct stat& s) {
+#ifdef _DARWIN_FEATURE_64_BIT_INODE
+  return s.st_mtimespec;
+#else
+  return s.st_mtim;
+#endif
+}
+
+} // namespace
+
+FileValidators FileValidators::fromStat(const struct stat& s) {
+  static const DateFormatter formatter(HttpDateFormat);
+  const struct timespec& mtime = modificationTime(s);
+  const SystemTime last_modified_time{std::chrono::seconds{mtime.tv_sec}};
+  return FileValidators{
+      absl::StrCat("\"", absl::Hex(s.st_size), "-", absl::Hex(mtime.tv_sec), ".",
+                   absl::Hex(mtime.tv_nsec), "\""),
+      formatter.fromTime(last_modified_time),
+      last_modified_time,
+  };
+}
+
+RequestConditions RequestConditions::fromHeaders(const Http::RequestHeaderMap& headers) {
+  RequestConditions conditions;
+  const Http::HeaderMap::GetResult if_none_match =
+      headers.get(Http::CustomHeaders::get().IfNoneMatch);
+  if (!if_none_match.empty()) {
+    conditions.if_none_match_ =
+        std::string{Http::HeaderUtility::getAllOfHeaderAsString(if_none_match).result().value()};
+  }
+  const Http::HeaderMap::GetResult if_modified_since =
+      headers.get(Http::CustomHeaders::get().IfModifiedSince);
+  absl::Time time;
+  if (if_modified_since.size() == 1 &&
+      absl::ParseTime(HttpDateFormat, if_modified_since[0]->value().getStringView(), &time,
+                      nullptr)) {
+    conditions.if_modified_since_ = absl::ToChronoTime(time);
+  }
+  return conditions;
+}
+
+bool RequestConditions::notModified(const FileValidators& validators) const {
+  if (if_none_match_.has_value()) {
+    for (absl::string_view tag : absl::StrSplit(*if_none_match_, ',')) {
+      tag = absl::StripAsciiWhitespace(tag);
+      // GET and HEAD use the weak comparison, which ignores the weakness indicator.
+      absl::ConsumePrefix(&tag, "W/");
+      if (tag == "*" || tag == validators.etag_) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return if_modified_since_.has_value() && validators.last_modified_time_ <= *if_modified_since_;
+}
+
+Buffer::InstancePtr HotFile::body(uint64_t start, uint64_t end) const {
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
+  if (start < end) {
+    buffer->addBufferFragment(*new Buffer::BufferFragmentImpl(
+        contents_->data() + start, end - start,
+        [contents = contents_](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+          delete fragment;
+        }));
+  }
+  return buffer;
+}
+
+HotFileCache::HotFileCache(const ProtoHotFileCache& config,
+                           Event::Dispatcher& main_thread_dispatcher)
+    : max_file_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_file_size_bytes,
+                                                     DefaultMaxFileSize)),
+      max_total_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_total_size_bytes,
+                                                      DefaultMaxTotalSize)),
+      main_thread_dispatcher_(main_thread_dispatcher), watches_(std::make_unique<Watches>()) {
+  watches_->watcher_ = main_thread_dispatcher_.createFilesystemWatcher();
+}
+
+HotFileCache::~HotFileCache() {
+  // The last reference to the cache may be released by a worker, or by a watch callback, but the
+  // watcher belongs to the main thread and must outlive its callbacks.
+  main_thread_dispatcher_.deleteInDispatcherThread(std::move(watches_));
+}
+
+HotFileSharedPtr HotFileCache::lookup(absl::string_view path) {
+  absl::MutexLock lock(mu_);
+  auto it = entries_.find(path);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->file_;
+}
+
+void HotFileCache::insert(absl::string_view path, HotFileSharedPtr file) {
+  const uint64_t size = file->contents_->size();
+  if (size > max_file_size_ || size > max_total_size_) {
+    return;
+  }
+  {
+    absl::MutexLock lock(mu_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+      eraseLocked(it->second);
+    }
+    while (total_size_ + size > max_total_size_) {
+      eraseLocked(std::prev(lru_.end()));
+    }
+    lru_.push_front(Entry{std::string{path}, std::move(file)});
+    entries_.emplace(lru_.front().path_, lru_.begin());
+    total_size_ += size;
+  }
+  main_thread_dispatcher_.post([weak_cache = weak_from_this(), path = std::string{path}]() {
+    if (std::shared_ptr<HotFileCache> cache = weak_cache.lock()) {
+      cache->watch(path);
+    }
+  });
+}
+
+void HotFileCache::invalidate(absl::string_view path) {
+  absl::MutexLock lock(mu_);
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    eraseLocked(it->second);
+  }
+}
+
+uint64_t HotFileCache::totalSizeForTest() {
+  absl::MutexLock lock(mu_);
+  return total_size_;
+}
+
+size_t HotFileCache::entryCount() {
+  absl::MutexLock lock(mu_);
+  return entries_.size();
+}
+
+void HotFileCache::watch(const std::string& path) {
+  if (!watches_->paths_.contains(path)) {
+    if (watches_->paths_.size() >= std::max(MinWatchedPathsBeforeRewatch, 2 * entryCount())) {
+      rewatch();
+    }
+    // Each path is watched at most once per watcher, however often it is evicted and reinserted.
+    if (!watches_->paths_.contains(path) && !addWatch(path)) {
+      // A file that can't be watched can't be kept up to date.
+      invalidate(path);
+      return;
+    }
+  }
+  revalidate(path);
+}
+
+bool HotFileCache::addWatch(const std::string& path) {
+  absl::Status status = watches_->watcher_->addWatch(
+      path, Filesystem::Watcher::Events::Modified | Filesystem::Watcher::Events::MovedTo,
+      [weak_cache = weak_from_this(), path](uint32_t) {
+        // The watches may briefly outlive the cache, while waiting to be deleted.
+        if (std::shared_ptr<HotFileCache> cache = weak_cache.lock()) {
+          cache->invalidate(path);
+        }
+        return absl::OkStatus();
+      });
+  if (!status.ok()) {
+    return false;
+  }
+  watches_->paths_.insert(path);
+  return true;
+}
+
+void HotFileCache::revalidate(const std::string& path) {
+  // The file may have changed between being read and being watched.
+  HotFileSharedPtr file = lookup(path);
+  struct stat s;
+  if (file != nullptr &&
+      (Api::OsSysCallsSingleton::get().stat(path.c_str(), &s).return_value_ != 0 ||
+       FileValidators::fromStat(s).etag_ != file->validators_.etag_)) {
+    invalidate(path);
+  }
+}
+
+void HotFileCache::rewatch() {
+  std::vector<std::string> cached_paths;
+  {
+    absl::MutexLock lock(mu_);
+    cached_paths.reserve(lru_.size());
+    for (const Entry& entry : lru_) {
+      cached_paths.push_back(entry.path_);
+    }
+  }
+  // Destroying the old watcher removes its watches, and with them the callbacks for paths that
+  // are no longer cached.
+  watches_->watcher_ = main_thread_dispatcher_.createFilesystemWatcher();
+  watches_->paths_.clear();
+  for (const std::string& path : cached_paths) {
+    if (watches_->paths_.contains(path)) {
+      continue;
+    }
+    if (!addWatch(path)) {
+      invalidate(path);
+      continue;
+    }
+    // A change made while the path was between watchers went unobserved.
+    revalidate(path);
+  }
+}
+
+void HotFileCache::eraseLocked(LruList::iterator it) {
+  total_size_ -= it->file_->contents_->size();
+  entries_.erase(it->path_);
+  lru_.erase(it);
+}
+
+} // namespace FileServer
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
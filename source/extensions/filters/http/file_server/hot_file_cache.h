@@ -0,0 +1,138 @@
+#pragma once
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/dispatcher_thread_deletable.h"
+#include "envoy/extensions/filters/http/file_server/v3/file_server.pb.h"
+#include "envoy/filesystem/watcher.h"
+#include "envoy/http/header_map.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace FileServer {
+
+using ProtoHotFileCache =
+    envoy::extensions::filters::http::file_server::v3::FileServerConfig::HotFileCache;
+
+// The validators that a file_server response carries when the hot file cache is configured.
+struct FileValidators {
+  static FileValidators fromStat(const struct stat& s);
+  std::string etag_;
+  std::string last_modified_;
+  // The modification time, truncated to the whole seconds of last_modified_.
+  SystemTime last_modified_time_;
+};
+
+// The conditions of a conditional GET or HEAD request, which are evaluated against the
+// validators of the file, so they only apply when the hot file cache is configured.
+struct RequestConditions {
+  static RequestConditions fromHeaders(const Http::RequestHeaderMap& headers);
+
+  // Returns true if the request is for a copy of the file that the client already has, so a
+  // 304 Not Modified is the response. As in RFC 9110, If-Modified-Since is ignored if
+  // If-None-Match is present.
+  bool notModified(const FileValidators& validators) const;
+
+  // The entity tags of If-None-Match, all of its values joined by commas.
+  std::optional<std::string> if_none_match_;
+  // Unset if If-Modified-Since is absent or not an IMF-fixdate.
+  std::optional<SystemTime> if_modified_since_;
+};
+
+// The contents of a cached file, and the precomputed parts of a response for it.
+struct HotFile {
+  // Returns a buffer referencing the range [start, end) of the file contents. The buffer keeps
+  // the contents alive, even if the file is evicted from the cache before the buffer is drained.
+  Buffer::InstancePtr body(uint64_t start, uint64_t end) const;
+
+  std::shared_ptr<const std::string> contents_;
+  // Also used to detect changes that happened before the file was being watched, as the etag
+  // changes with the size and modification time.
+  FileValidators validators_;
+  std::string content_type_;
+};
+
+using HotFileSharedPtr = std::shared_ptr<const HotFile>;
+
+// A bounded, least-recently-used cache of file contents keyed by path, shared by all the workers
+// using a FileServerConfig.
+// Entries are invalidated by a Filesystem::Watcher, which can only be used from the main thread,
+// so lookups and inserts may happen on any thread but watches are added by posting to the main
+// thread dispatcher.
+class HotFileCache : public std::enable_shared_from_this<HotFileCache> {
+public:
+  HotFileCache(const ProtoHotFileCache& config, Event::Dispatcher& main_thread_dispatcher);
+  ~HotFileCache();
+
+  uint64_t maxFileSize() const { return max_file_size_; }
+
+  // Returns nullptr if the file is not in the cache.
+  HotFileSharedPtr lookup(absl::string_view path) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Adds a file to the cache, evicting the least recently used files if necessary, and starts
+  // watching it for changes.
+  void insert(absl::string_view path, HotFileSharedPtr file) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Removes a file from the cache, if present.
+  void invalidate(absl::string_view path) ABSL_LOCKS_EXCLUDED(mu_);
+
+  uint64_t totalSizeForTest() ABSL_LOCKS_EXCLUDED(mu_);
+  size_t watchedPathsForTest() const { return watches_->paths_.size(); }
+
+private:
+  // The watcher and the set of paths it watches. Only used in the main thread, and deleted there.
+  struct Watches : public Event::DispatcherThreadDeletable {
+    Filesystem::WatcherPtr watcher_;
+    absl::flat_hash_set<std::string> paths_;
+  };
+  struct Entry {
+    std::string path_;
+    HotFileSharedPtr file_;
+  };
+  using LruList = std::list<Entry>;
+
+  // Called in the main thread after a file is inserted.
+  void watch(const std::string& path);
+  // Watches a path for changes, returning false if it can't be watched. Main thread only.
+  bool addWatch(const std::string& path);
+  // Invalidates a cached file that changed before it was watched. Main thread only.
+  void revalidate(const std::string& path);
+  // Filesystem::Watcher has no way to remove a watch, so once the paths ever watched outnumber
+  // the files still cached by enough, the watcher is replaced by one watching only the files
+  // still cached. Main thread only.
+  void rewatch() ABSL_LOCKS_EXCLUDED(mu_);
+  size_t entryCount() ABSL_LOCKS_EXCLUDED(mu_);
+  void eraseLocked(LruList::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const uint64_t max_file_size_;
+  const uint64_t max_total_size_;
+  Event::Dispatcher& main_thread_dispatcher_;
+  std::unique_ptr<Watches> watches_;
+
+  absl::Mutex mu_;
+  // The front is the most recently used.
+  LruList lru_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<absl::string_view, LruList::iterator> entries_ ABSL_GUARDED_BY(mu_);
+  uint64_t total_size_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+} // namespace FileServer
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
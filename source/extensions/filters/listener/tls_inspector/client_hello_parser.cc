@@ -0,0 +1,150 @@
+#include "source/extensions/filters/listener/tls_inspector/client_hello_parser.h"
+
+#include "openssl/bytestring.h"
+#include "openssl/ssl3.h"
+#include "openssl/tls1.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ListenerFilters {
+namespace TlsInspector {
+namespace {
+
+constexpr uint8_t TlsVersionMajor = 3;
+constexpr size_t MaxSessionIdLength = 32;
+constexpr size_t MaxHostNameLength = 255;
+// Duplicate extensions are detected with a quadratic scan, which is only cheap for the number of
+// extensions real clients send. Larger lists are left to BoringSSL.
+constexpr size_t MaxExtensions = 64;
+
+// Mirrors the extension block validation of BoringSSL's SSL_parse_client_hello().
+bool validExtensions(CBS extensions) {
+  size_t count = 0;
+  while (CBS_len(&extensions) > 0) {
+    uint16_t type;
+    CBS body;
+    if (!CBS_get_u16(&extensions, &type) || !CBS_get_u16_length_prefixed(&extensions, &body) ||
+        ++count > MaxExtensions) {
+      return false;
+    }
+    CBS rest = extensions;
+    while (CBS_len(&rest) > 0) {
+      uint16_t other_type;
+      CBS other_body;
+      if (!CBS_get_u16(&rest, &other_type) || !CBS_get_u16_length_prefixed(&rest, &other_body) ||
+          other_type == type) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Mirrors BoringSSL's SSL_parse_client_hello() for TLS.
+bool parseBody(CBS body, SSL_CLIENT_HELLO& out) {
+  CBS random, session_id, cipher_suites, compression_methods, extensions;
+  if (!CBS_get_u16(&body, &out.version) || !CBS_get_bytes(&body, &random, SSL3_RANDOM_SIZE) ||
+      !CBS_get_u8_length_prefixed(&body, &session_id) ||
+      CBS_len(&session_id) > MaxSessionIdLength ||
+      !CBS_get_u16_length_prefixed(&body, &cipher_suites) || CBS_len(&cipher_suites) < 2 ||
+      CBS_len(&cipher_suites) % 2 != 0 ||
+      !CBS_get_u8_length_prefixed(&body, &compression_methods) ||
+      CBS_len(&compression_methods) < 1) {
+    return false;
+  }
+  out.random = CBS_data(&random);
+  out.random_len = CBS_len(&random);
+  out.session_id = CBS_data(&session_id);
+  out.session_id_len = CBS_len(&session_id);
+  out.cipher_suites = CBS_data(&cipher_suites);
+  out.cipher_suites_len = CBS_len(&cipher_suites);
+  out.compression_methods = CBS_data(&compression_methods);
+  out.compression_methods_len = CBS_len(&compression_methods);
+
+  // A ClientHello without an extension block is valid.
+  if (CBS_len(&body) == 0) {
+    out.extensions = nullptr;
+    out.extensions_len = 0;
+    return true;
+  }
+  if (!CBS_get_u16_length_prefixed(&body, &extensions) || CBS_len(&body) != 0 ||
+      !validExtensions(extensions)) {
+    return false;
+  }
+  out.extensions = CBS_data(&extensions);
+  out.extensions_len = CBS_len(&extensions);
+  return true;
+}
+
+} // namespace
+
+ClientHelloParser::Result ClientHelloParser::parse(absl::Span<const uint8_t> data,
+                                                   SSL_CLIENT_HELLO& client_hello,
+                                                   size_t& bytes_consumed) {
+  // Reject anything that cannot be the start of a TLS handshake record as early as possible, so
+  // that plaintext protocols are handed to BoringSSL without waiting for more data.
+  if ((data.size() >= 1 && data[0] != SSL3_RT_HANDSHAKE) ||
+      (data.size() >= 2 && data[1] != TlsVersionMajor)) {
+    return Result::Unsupported;
+  }
+  if (data.size() < SSL3_RT_HEADER_LENGTH) {
+    return Result::NeedMoreData;
+  }
+  const size_t record_length = (static_cast<size_t>(data[3]) << 8) | data[4];
+  if (record_length < SSL3_HM_HEADER_LENGTH || record_length > SSL3_RT_MAX_PLAIN_LENGTH) {
+    return Result::Unsupported;
+  }
+  if (data.size() < SSL3_RT_HEADER_LENGTH + record_length) {
+    return Result::NeedMoreData;
+  }
+
+  // The whole ClientHello must be in this record; reassembling handshake messages from several
+  // records is left to BoringSSL.
+  CBS record_body;
+  CBS_init(&record_body, data.data() + SSL3_RT_HEADER_LENGTH, record_length);
+  uint8_t message_type;
+  CBS message_body;
+  if (!CBS_get_u8(&record_body, &message_type) || message_type != SSL3_MT_CLIENT_HELLO ||
+      !CBS_get_u24_length_prefixed(&record_body, &message_body)) {
+    return Result::Unsupported;
+  }
+
+  client_hello = {};
+  client_hello.client_hello = CBS_data(&message_body);
+  client_hello.client_hello_len = CBS_len(&message_body);
+  if (!parseBody(message_body, client_hello)) {
+    return Result::Unsupported;
+  }
+  bytes_consumed = SSL3_RT_HEADER_LENGTH + record_length;
+  return Result::Complete;
+}
+
+bool ClientHelloParser::serverName(const SSL_CLIENT_HELLO& client_hello,
+                                   absl::string_view& server_name) {
+  server_name = {};
+  const uint8_t* data;
+  size_t len;
+  if (!SSL_early_callback_ctx_extension_get(&client_hello, TLSEXT_TYPE_server_name, &data, &len)) {
+    return true;
+  }
+  // Mirrors the server_name validation BoringSSL performs before the certificate selection
+  // callback: exactly one non-empty host_name without NUL bytes.
+  CBS extension, name_list, host_name;
+  uint8_t name_type;
+  CBS_init(&extension, data, len);
+  if (!CBS_get_u16_length_prefixed(&extension, &name_list) || CBS_len(&extension) != 0 ||
+      !CBS_get_u8(&name_list, &name_type) || name_type != TLSEXT_NAMETYPE_host_name ||
+      !CBS_get_u16_length_prefixed(&name_list, &host_name) || CBS_len(&name_list) != 0 ||
+      CBS_len(&host_name) == 0 || CBS_len(&host_name) > MaxHostNameLength ||
+      CBS_contains_zero_byte(&host_name)) {
+    return false;
+  }
+  server_name =
+      absl::string_view(reinterpret_cast<const char*>(CBS_data(&host_name)), CBS_len(&host_name));
+  return true;
+}
+
+} // namespace TlsInspector
+} // namespace ListenerFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ListenerFilters {
+namespace TlsInspector {
+
+/**
+ * Extracts a TLS ClientHello directly from the first bytes sent by a client, without creating an
+ * SSL object or driving a handshake. The parser is stateless, bounds checked and does not allocate:
+ * the parsed ClientHello points into the input.
+ *
+ * Only the common case of a ClientHello carried in a single TLS record is handled. Inputs that
+ * BoringSSL might treat differently (fragmented or SSLv2 ClientHellos, anything that is not a
+ * well-formed ClientHello) are reported as unsupported so that the caller can fall back to
+ * BoringSSL and keep its exact error reporting.
+ */
+class ClientHelloParser {
+public:
+  enum class Result {
+    // A complete ClientHello was parsed.
+    Complete,
+    // The input is a prefix of a TLS record that may carry a ClientHello.
+    NeedMoreData,
+    // The input must be handled by BoringSSL.
+    Unsupported,
+  };
+
+  /**
+   * Parses the ClientHello at the start of `data`.
+   * @param data the bytes received from the client so far.
+   * @param client_hello receives the ClientHello on Result::Complete. Its `ssl` member is null and
+   *        every other pointer refers to `data`.
+   * @param bytes_consumed receives the size of the TLS record carrying the ClientHello on
+   *        Result::Complete.
+   * @return the parse result.
+   */
+  static Result parse(absl::Span<const uint8_t> data, SSL_CLIENT_HELLO& client_hello,
+                      size_t& bytes_consumed);
+
+  /**
+   * Extracts the host name from the server_name extension, applying the same validation BoringSSL
+   * applies before invoking the certificate selection callback.
+   * @param client_hello a ClientHello returned by parse().
+   * @param server_name receives the host name, or an empty string if the extension is absent.
+   * @return false if the extension is malformed.
+   */
+  static bool serverName(const SSL_CLIENT_HELLO& client_hello, absl::string_view& server_name);
+};
+
+} // namespace TlsInspector
+} // namespace ListenerFilters
+} // namespace Extensions
+} // namespace Envoy
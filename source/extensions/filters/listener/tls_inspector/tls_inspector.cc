@@ -20,6 +20,7 @@
 #include "source/common/protobuf/utility.h"
 #include "source/common/runtime/runtime_features.h"
 #include "source/common/tls/utility.h"
+#include "source/extensions/filters/listener/tls_inspector/client_hello_parser.h"
 #include "source/extensions/filters/listener/tls_inspector/ja4_fingerprint.h"
 
 #include "absl/strings/str_cat.h"
@@ -82,19 +83,8 @@ Config::Config(
   SSL_CTX_set_select_certificate_cb(
       ssl_ctx_.get(), [](const SSL_CLIENT_HELLO* client_hello) -> ssl_select_cert_result_t {
         Filter* filter = static_cast<Filter*>(SSL_get_app_data(client_hello->ssl));
-        filter->setClientTlsVersion(client_hello->version);
-        filter->createJA3Hash(client_hello);
-        filter->createJA4Hash(client_hello);
-
-        const uint8_t* data;
-        size_t len;
-        if (SSL_early_callback_ctx_extension_get(
-                client_hello, TLSEXT_TYPE_application_layer_protocol_negotiation, &data, &len)) {
-          filter->onALPN(data, len);
-        }
-
         const char* servername = SSL_get_servername(client_hello->ssl, TLSEXT_NAMETYPE_host_name);
-        filter->onServername(absl::NullSafeStringView(servername));
+        filter->onClientHello(client_hello, absl::NullSafeStringView(servername));
         return ssl_select_cert_error;
       });
 }
@@ -102,11 +92,10 @@ Config::Config(
 bssl::UniquePtr<SSL> Config::newSsl() { return bssl::UniquePtr<SSL>{SSL_new(ssl_ctx_.get())}; }
 
 Filter::Filter(const ConfigSharedPtr& config)
-    : config_(config), ssl_(config_->newSsl()),
-      requested_read_bytes_(config->initialReadBufferSize()) {
-  SSL_set_app_data(ssl_.get(), this);
-  SSL_set_accept_state(ssl_.get());
-}
+    : config_(config),
+      use_client_hello_parser_(Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.tls_inspector_client_hello_parser")),
+      requested_read_bytes_(config->initialReadBufferSize()) {}
 
 Network::FilterStatus Filter::onAccept(Network::ListenerFilterCallbacks& cb) {
   ENVOY_LOG(trace, "tls inspector: new connection accepted");
@@ -115,6 +104,20 @@ Network::FilterStatus Filter::onAccept(Network::ListenerFilterCallbacks& cb) {
   return Network::FilterStatus::StopIteration;
 }
 
+void Filter::onClientHello(const SSL_CLIENT_HELLO* client_hello, absl::string_view server_name) {
+  setClientTlsVersion(client_hello->version);
+  createJA3Hash(client_hello);
+  createJA4Hash(client_hello);
+
+  const uint8_t* data;
+  size_t len;
+  if (SSL_early_callback_ctx_extension_get(
+          client_hello, TLSEXT_TYPE_application_layer_protocol_negotiation, &data, &len)) {
+    onALPN(data, len);
+  }
+  onServername(server_name);
+}
+
 void Filter::onALPN(const unsigned char* data, unsigned int len) {
   CBS wire, list;
   CBS_init(&wire, reinterpret_cast<const uint8_t*>(data), static_cast<size_t>(len));
@@ -154,12 +157,22 @@ Network::FilterStatus Filter::onData(Network::ListenerFilterBuffer& buffer) {
   // Because we're doing a MSG_PEEK, data we've seen before gets returned every time, so
   // skip over what we've already processed.
   if (static_cast<uint64_t>(raw_slice.len_) > read_) {
-    const uint8_t* data = static_cast<const uint8_t*>(raw_slice.mem_) + read_;
-    const size_t len = raw_slice.len_ - read_;
-    const uint64_t bytes_already_processed = read_;
+    const uint8_t* data = static_cast<const uint8_t*>(raw_slice.mem_);
+    uint64_t bytes_already_processed = read_;
     read_ = raw_slice.len_;
-    ParseState parse_state = parseClientHello(data, len, bytes_already_processed);
-    switch (parse_state) {
+    std::optional<ParseState> parse_state;
+    if (use_client_hello_parser_) {
+      parse_state = parseClientHelloDirect(data, raw_slice.len_);
+      // BoringSSL has not seen any of the bytes yet if it has to take over.
+      bytes_already_processed = 0;
+    }
+    if (!parse_state.has_value()) {
+      // BoringSSL keeps the bytes it has already been given, so only pass the new ones.
+      parse_state = parseClientHello(data + bytes_already_processed,
+                                     raw_slice.len_ - bytes_already_processed,
+                                     bytes_already_processed);
+    }
+    switch (*parse_state) {
     case ParseState::Error:
       cb_->socket().ioHandle().close();
       return Network::FilterStatus::StopIteration;
@@ -192,21 +205,35 @@ void Filter::setDownstreamTransportFailureReason() {
   cb_->streamInfo().setDownstreamTransportFailureReason(transport_failure);
 }
 
+ParseState Filter::onNeedMoreData() {
+  if (read_ >= maxConfigReadBytes()) {
+    // We've hit the specified size limit. This is an unreasonably large ClientHello;
+    // indicate failure.
+    config_->stats().client_hello_too_large_.inc();
+    setDynamicMetadata(failureReasonClientHelloTooLarge());
+    return ParseState::Error;
+  }
+  if (read_ >= requested_read_bytes_) {
+    // Double requested bytes up to the maximum configured.
+    requested_read_bytes_ = std::min<uint32_t>(2 * read_, maxConfigReadBytes());
+  }
+  return ParseState::Continue;
+}
+
+void Filter::onTlsFound() {
+  config_->stats().tls_found_.inc();
+  if (alpn_found_) {
+    config_->stats().alpn_found_.inc();
+  } else {
+    config_->stats().alpn_not_found_.inc();
+  }
+  cb_->socket().setDetectedTransportProtocol("tls");
+}
+
 ParseState Filter::getParserState(int handshake_status) {
   switch (SSL_get_error(ssl_.get(), handshake_status)) {
   case SSL_ERROR_WANT_READ:
-    if (read_ >= maxConfigReadBytes()) {
-      // We've hit the specified size limit. This is an unreasonably large ClientHello;
-      // indicate failure.
-      config_->stats().client_hello_too_large_.inc();
-      setDynamicMetadata(failureReasonClientHelloTooLarge());
-      return ParseState::Error;
-    }
-    if (read_ >= requested_read_bytes_) {
-      // Double requested bytes up to the maximum configured.
-      requested_read_bytes_ = std::min<uint32_t>(2 * read_, maxConfigReadBytes());
-    }
-    return ParseState::Continue;
+    return onNeedMoreData();
   case SSL_ERROR_SSL:
     // There are 3 possibilities when get here:
     // 1. A valid TLS Client Hello message was parsed (`clienthello_success_` is true)
@@ -226,13 +253,7 @@ ParseState Filter::getParserState(int handshake_status) {
         setDownstreamTransportFailureReason();
         return ParseState::Error;
       }
-      config_->stats().tls_found_.inc();
-      if (alpn_found_) {
-        config_->stats().alpn_found_.inc();
-      } else {
-        config_->stats().alpn_not_found_.inc();
-      }
-      cb_->socket().setDetectedTransportProtocol("tls");
+      onTlsFound();
     } else {
       // Checking max message length should not be done here as it will close all plain text
       // connections that happened to read more than maxConfigReadBytes() in one I/O operation. With
@@ -260,8 +281,44 @@ ParseState Filter::getParserState(int handshake_status) {
   }
 }
 
+std::optional<ParseState> Filter::parseClientHelloDirect(const uint8_t* data, size_t len) {
+  SSL_CLIENT_HELLO client_hello;
+  size_t bytes_consumed = 0;
+  absl::string_view server_name;
+  switch (ClientHelloParser::parse({data, len}, client_hello, bytes_consumed)) {
+  case ClientHelloParser::Result::NeedMoreData: {
+    const ParseState state = onNeedMoreData();
+    if (state != ParseState::Continue) {
+      config_->stats().bytes_processed_.recordValue(len);
+    }
+    return state;
+  }
+  case ClientHelloParser::Result::Complete:
+    // Versions outside of the supported range and malformed server names are rejected by
+    // BoringSSL, which also provides the error details for them.
+    if (client_hello.version >= Config::TLS_MIN_SUPPORTED_VERSION &&
+        client_hello.version <= Config::TLS_MAX_SUPPORTED_VERSION &&
+        ClientHelloParser::serverName(client_hello, server_name)) {
+      onClientHello(&client_hello, server_name);
+      onTlsFound();
+      config_->stats().bytes_processed_.recordValue(bytes_consumed);
+      return ParseState::Done;
+    }
+    break;
+  case ClientHelloParser::Result::Unsupported:
+    break;
+  }
+  use_client_hello_parser_ = false;
+  return std::nullopt;
+}
+
 ParseState Filter::parseClientHello(const void* data, size_t len,
                                     uint64_t bytes_already_processed) {
+  if (ssl_ == nullptr) {
+    ssl_ = config_->newSsl();
+    SSL_set_app_data(ssl_.get(), this);
+    SSL_set_accept_state(ssl_.get());
+  }
   // Ownership remains here though we pass a reference to it in `SSL_set0_rbio()`.
   bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(data, len));
 
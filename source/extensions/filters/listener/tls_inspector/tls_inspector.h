@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <string>
 
 #include "envoy/extensions/filters/listener/tls_inspector/v3/tls_inspector.pb.h"
@@ -107,20 +108,28 @@ public:
 
 private:
   ParseState parseClientHello(const void* data, size_t len, uint64_t bytes_already_processed);
+  // Parses the ClientHello with ClientHelloParser. Returns nullopt if BoringSSL must handle the
+  // connection instead.
+  std::optional<ParseState> parseClientHelloDirect(const uint8_t* data, size_t len);
   ParseState onRead();
+  void onClientHello(const SSL_CLIENT_HELLO* client_hello, absl::string_view server_name);
   void onALPN(const unsigned char* data, unsigned int len);
   void onServername(absl::string_view name);
   void createJA3Hash(const SSL_CLIENT_HELLO* ssl_client_hello);
   void createJA4Hash(const SSL_CLIENT_HELLO* ssl_client_hello);
   uint32_t maxConfigReadBytes() const { return config_->maxClientHelloSize(); }
   ParseState getParserState(int handshake_status);
+  ParseState onNeedMoreData();
+  void onTlsFound();
   void setDynamicMetadata(absl::string_view failure_reason);
   void setDownstreamTransportFailureReason();
 
   ConfigSharedPtr config_;
   Network::ListenerFilterCallbacks* cb_{};
 
+  // Only created if the ClientHello cannot be handled by ClientHelloParser.
   bssl::UniquePtr<SSL> ssl_;
+  bool use_client_hello_parser_;
   uint64_t read_{0};
   bool alpn_found_{false};
   bool clienthello_success_{false};
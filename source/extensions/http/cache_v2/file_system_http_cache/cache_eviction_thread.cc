@@ -1,5 +1,6 @@
 #include "source/extensions/http/cache_v2/file_system_http_cache/cache_eviction_thread.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "envoy/thread/thread.h"
@@ -18,6 +19,14 @@ namespace {
 bool isCacheFile(const Filesystem::DirectoryEntry& entry) {
   return entry.type_ == Filesystem::FileType::Regular && absl::StartsWith(entry.name_, "cache-");
 }
+
+Envoy::SystemTime lastTouch(const struct stat& s) {
+#ifdef _DARWIN_FEATURE_64_BIT_INODE
+  return std::max(timespecToChrono(s.st_atimespec), timespecToChrono(s.st_ctimespec));
+#else
+  return std::max(timespecToChrono(s.st_atim), timespecToChrono(s.st_ctim));
+#endif
+}
 } // namespace
 
 CacheEvictionThread::CacheEvictionThread(Thread::ThreadFactory& thread_factory)
@@ -40,9 +49,24 @@ void CacheEvictionThread::addCache(std::shared_ptr<CacheShared> cache) {
 }
 
 void CacheEvictionThread::removeCache(std::shared_ptr<CacheShared>& cache) {
-  absl::MutexLock lock(cache_mu_);
-  bool removed = caches_.erase(cache);
-  ASSERT(removed);
+  {
+    absl::MutexLock lock(cache_mu_);
+    bool removed = caches_.erase(cache);
+    ASSERT(removed);
+    removed_caches_.push_back(cache);
+  }
+  // Closing the index of the cache writes and syncs the index file, which is done on this
+  // thread rather than on the thread that destroyed the cache.
+  signal();
+}
+
+void CacheEvictionThread::closeIndexes(std::vector<std::shared_ptr<CacheShared>>& caches) {
+  for (const std::shared_ptr<CacheShared>& cache : caches) {
+    cache->closeIndex();
+  }
+  // Releases the lock on the index file, unless an insert still holds the cache, so that a new
+  // cache on the same path can use the index.
+  caches.clear();
 }
 
 void CacheEvictionThread::signal() {
@@ -56,13 +80,13 @@ void CacheEvictionThread::terminate() {
   signalled_ = true;
 }
 
-bool CacheEvictionThread::waitForSignal() {
+bool CacheEvictionThread::waitForSignal(absl::Duration timeout) {
   absl::MutexLock lock(mu_);
   // Worth noting here that if `signalled_` is already true, the lock is not released
   // until idle_ is false again, so waitForIdle will not return until `signalled_`
   // stays false for the duration of an eviction cycle.
   idle_ = true;
-  mu_.Await(absl::Condition(&signalled_));
+  mu_.AwaitWithTimeout(absl::Condition(&signalled_), timeout);
   signalled_ = false;
   idle_ = false;
   return !terminating_;
@@ -75,13 +99,43 @@ void CacheShared::initStats() {
   if (config_.has_max_cache_entry_count()) {
     stats_.size_limit_count_.set(config_.max_cache_entry_count().value());
   }
-  // TODO(ravenblack): Add support for directory tree structure.
-  for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(std::string{cachePath()})) {
-    if (!isCacheFile(entry)) {
-      continue;
+  if (index_ && !index_->lock()) {
+    ENVOY_LOG(warn,
+              "the index of cache {} is in use by another process, so the cache is measured and "
+              "evicted by scanning its directory",
+              cachePath());
+    index_usable_ = false;
+  }
+  CacheIndex* const index = this->index();
+  if (index && index->load()) {
+    ENVOY_LOG(info, "loaded {} entries of cache {} from its index", index->count(), cachePath());
+  } else {
+    auto os_sys_calls = Api::OsSysCallsSingleton::get();
+    // TODO(ravenblack): Add support for directory tree structure.
+    for (const Filesystem::DirectoryEntry& entry :
+         Filesystem::Directory(std::string{cachePath()})) {
+      if (!isCacheFile(entry)) {
+        continue;
+      }
+      size_count_++;
+      size_bytes_ += entry.size_bytes_.value_or(0);
+      std::optional<uint64_t> hash = hashFromCacheFilename(entry.name_);
+      struct stat s;
+      if (index && hash.has_value() &&
+          os_sys_calls.stat(absl::StrCat(cachePath(), entry.name_).c_str(), &s).return_value_ !=
+              -1) {
+        index->addIfUnknown(*hash, entry.size_bytes_.value_or(0), lastTouch(s));
+      }
     }
-    size_count_++;
-    size_bytes_ += entry.size_bytes_.value_or(0);
+    if (index) {
+      index->markComplete();
+    }
+  }
+  if (index) {
+    // Files added or removed while initializing were already counted by the index, whereas
+    // the directory scan may have counted them twice.
+    size_count_ = index->count();
+    size_bytes_ = index->bytes();
   }
   stats_.size_count_.set(size_count_);
   stats_.size_bytes_.set(size_bytes_);
@@ -100,24 +154,31 @@ void CacheShared::evict() {
   };
   std::vector<CacheFile> cache_files;
 
-  // TODO(ravenblack): Add support for directory tree structure.
-  for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(std::string{cachePath()})) {
-    if (!isCacheFile(entry)) {
-      continue;
+  CacheIndex* const index = this->index();
+  if (index) {
+    // The index already knows the size and last touch of every file, so there is no
+    // need to scan the directory.
+    for (const auto& [hash, entry] : index->entries()) {
+      count++;
+      size += entry.size_;
+      cache_files.push_back(
+          CacheFile{absl::StrCat("cache-", hash), entry.size_, entry.last_touch_});
     }
-    count++;
-    size += entry.size_bytes_.value_or(0);
-    struct stat s;
-    if (os_sys_calls.stat(absl::StrCat(cachePath(), entry.name_).c_str(), &s).return_value_ != -1) {
-#ifdef _DARWIN_FEATURE_64_BIT_INODE
-      Envoy::SystemTime last_touch =
-          std::max(timespecToChrono(s.st_atimespec), timespecToChrono(s.st_ctimespec));
-#else
-      Envoy::SystemTime last_touch =
-          std::max(timespecToChrono(s.st_atim), timespecToChrono(s.st_ctim));
-#endif
-
-      cache_files.push_back(CacheFile{entry.name_, entry.size_bytes_.value_or(0), last_touch});
+  } else {
+    // TODO(ravenblack): Add support for directory tree structure.
+    for (const Filesystem::DirectoryEntry& entry :
+         Filesystem::Directory(std::string{cachePath()})) {
+      if (!isCacheFile(entry)) {
+        continue;
+      }
+      count++;
+      size += entry.size_bytes_.value_or(0);
+      struct stat s;
+      if (os_sys_calls.stat(absl::StrCat(cachePath(), entry.name_).c_str(), &s).return_value_ !=
+          -1) {
+        cache_files.push_back(
+            CacheFile{entry.name_, entry.size_bytes_.value_or(0), lastTouch(s)});
+      }
     }
   }
   // Sort the vector by last-touch timestamp, highest (i.e. youngest) first.
@@ -144,7 +205,10 @@ void CacheShared::evict() {
   }
   // Evict the rest.
   while (it != cache_files.end()) {
-    if (os_sys_calls.unlink(absl::StrCat(cachePath(), it->name_).c_str()).return_value_ != -1) {
+    const std::string path = absl::StrCat(cachePath(), it->name_);
+    Api::SysCallIntResult unlinked = os_sys_calls.unlink(path.c_str());
+    // A file that is already gone is removed from the index, as otherwise it would stay there.
+    if (unlinked.return_value_ != -1 || (index && unlinked.errno_ == ENOENT)) {
       // May want to add logging here for cache eviction failure, but it's expected sometimes,
       // e.g. if another instance of Envoy is performing cleanup at the same time, or some external
       // operator deleted the file. If it fails we don't reduce the estimated cache size, so another
@@ -154,6 +218,7 @@ void CacheShared::evict() {
       // and the eviction thread will be churning, trying and failing to remove a file, which would
       // be worth logging a warning, versus if the file is already gone then there's no problem.
       trackFileRemoved(it->size_);
+      indexFileRemoved(path);
     }
     ++it;
   }
@@ -161,15 +226,21 @@ void CacheShared::evict() {
 
 void CacheEvictionThread::work() {
   ENVOY_LOG(info, "Starting cache eviction thread.");
-  while (waitForSignal()) {
+  absl::Duration checkpoint_interval = absl::InfiniteDuration();
+  while (waitForSignal(checkpoint_interval)) {
     absl::flat_hash_set<std::shared_ptr<CacheShared>> caches;
+    std::vector<std::shared_ptr<CacheShared>> removed_caches;
     {
       // Take a local copy of the set of caches, so we don't hold the lock while
       // work is being performed.
       absl::MutexLock lock(cache_mu_);
       caches = caches_;
+      removed_caches.swap(removed_caches_);
     }
+    // A removed cache is closed before a cache that replaced it on the same path is initialized.
+    closeIndexes(removed_caches);
 
+    checkpoint_interval = absl::InfiniteDuration();
     for (const std::shared_ptr<CacheShared>& cache : caches) {
       if (cache->needs_init_) {
         cache->initStats();
@@ -177,8 +248,17 @@ void CacheEvictionThread::work() {
       if (cache->needsEviction()) {
         cache->evict();
       }
+      cache->flushIndex();
+      checkpoint_interval = std::min(checkpoint_interval, cache->indexCheckpointInterval());
     }
   }
+  // Caches removed just before termination are closed too.
+  std::vector<std::shared_ptr<CacheShared>> removed_caches;
+  {
+    absl::MutexLock lock(cache_mu_);
+    removed_caches.swap(removed_caches_);
+  }
+  closeIndexes(removed_caches);
   ENVOY_LOG(info, "Ending cache eviction thread.");
 }
 
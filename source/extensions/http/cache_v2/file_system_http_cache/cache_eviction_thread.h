@@ -50,7 +50,8 @@ public:
   void addCache(std::shared_ptr<CacheShared> cache);
 
   /**
-   * Removes the given cache from the caches that may be evicted from.
+   * Removes the given cache from the caches that may be evicted from, and has the thread
+   * close its index.
    * @param cache an unowned reference to the cache in question.
    */
   void removeCache(std::shared_ptr<CacheShared>& cache);
@@ -72,6 +73,8 @@ private:
    *
    * Otherwise, each cache instance's `needsEviction` function is called, in an
    * arbitrary order, and, if that returns true, the `evict` function is also called.
+   * Caches with an index then write their pending index changes to disk; the
+   * shortest index_checkpoint_interval of the caches is the run-again period.
    *
    * If `signal` is called during the eviction process, the eviction
    * cycle may run a second time after completion, depending on configured
@@ -80,10 +83,11 @@ private:
   void work();
 
   /**
+   * @param timeout the run-again period, after which the thread runs without a signal.
    * @return false if terminating, true if `signalled_` is true or the run-again period
    * has passed.
    */
-  bool waitForSignal();
+  bool waitForSignal(absl::Duration timeout);
 
   /**
    * Notifies the thread to terminate. If it is currently evicting, it will
@@ -93,6 +97,11 @@ private:
    */
   void terminate();
 
+  /**
+   * Closes the indexes of removed caches, and drops them.
+   */
+  void closeIndexes(std::vector<std::shared_ptr<CacheShared>>& caches);
+
   // These two mutexes are never held at the same time.
   absl::Mutex mu_;
   bool signalled_ ABSL_GUARDED_BY(mu_) = false;
@@ -103,6 +112,8 @@ private:
   // during config changes - that destruction is the only signal that a cache
   // instance should be removed.
   absl::flat_hash_set<std::shared_ptr<CacheShared>> caches_ ABSL_GUARDED_BY(cache_mu_);
+  // Caches that were removed, and whose indexes are yet to be closed by the thread.
+  std::vector<std::shared_ptr<CacheShared>> removed_caches_ ABSL_GUARDED_BY(cache_mu_);
 
   // Allow test access to waitForIdle for synchronization.
   friend class FileSystemCacheTestContext;
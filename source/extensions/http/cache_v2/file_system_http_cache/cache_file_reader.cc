@@ -1,6 +1,7 @@
 #include "source/extensions/http/cache_v2/file_system_http_cache/cache_file_reader.h"
 
 #include "source/extensions/http/cache_v2/file_system_http_cache/cache_file_fixed_block.h"
+#include "source/extensions/http/cache_v2/file_system_http_cache/file_system_http_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -10,13 +11,54 @@ namespace FileSystemHttpCache {
 
 using Common::AsyncFiles::AsyncFileHandle;
 
-CacheFileReader::CacheFileReader(AsyncFileHandle handle) : file_handle_(handle) {}
+CacheFileReader::CacheFileReader(AsyncFileHandle handle, std::shared_ptr<CacheShared> cache)
+    : file_handle_(handle), cache_(std::move(cache)) {}
 
 void CacheFileReader::getBody(Event::Dispatcher& dispatcher, AdjustedByteRange range,
                               GetBodyCallback&& cb) {
-  auto queued = file_handle_->read(
+  if (!cache_->config_.has_min_mapped_body_read_bytes() ||
+      range.length() < cache_->config_.min_mapped_body_read_bytes().value()) {
+    absl::Status queued = readBody(file_handle_, cache_, dispatcher, range, std::move(cb));
+    ASSERT(queued.ok(), queued.ToString());
+    return;
+  }
+  // Like readBody, the callback doesn't use the reader, which may be destroyed before it is called.
+  auto queued = file_handle_->readMapped(
       &dispatcher, CacheFileFixedBlock::offsetToBody() + range.begin(), range.length(),
-      [len = range.length(),
+      [file_handle = file_handle_, cache = cache_, &dispatcher, range,
+       cb = std::move(cb)](absl::StatusOr<Buffer::InstancePtr> read_result) mutable -> void {
+        if (!read_result.ok()) {
+          // The file system may not support mapping, in which case the body can still be copied.
+          // The handle may have been closed since, if the reader was destroyed, in which case
+          // the read is not queued and cb must still be called.
+          auto shared_cb = std::make_shared<GetBodyCallback>(std::move(cb));
+          absl::Status queued =
+              readBody(file_handle, cache, dispatcher, range,
+                       [shared_cb](Buffer::InstancePtr buffer, EndStream end_stream) {
+                         (*shared_cb)(std::move(buffer), end_stream);
+                       });
+          if (!queued.ok()) {
+            (*shared_cb)(nullptr, EndStream::Reset);
+          }
+          return;
+        }
+        if (read_result.value()->length() != range.length()) {
+          return cb(nullptr, EndStream::Reset);
+        }
+        cache->stats_.body_bytes_read_.add(range.length());
+        cache->stats_.body_bytes_mapped_.add(range.length());
+        return cb(std::move(read_result.value()), EndStream::More);
+      });
+  ASSERT(queued.ok(), queued.status().ToString());
+}
+
+absl::Status CacheFileReader::readBody(AsyncFileHandle file_handle,
+                                       std::shared_ptr<CacheShared> cache,
+                                       Event::Dispatcher& dispatcher, AdjustedByteRange range,
+                                       GetBodyCallback&& cb) {
+  auto queued = file_handle->read(
+      &dispatcher, CacheFileFixedBlock::offsetToBody() + range.begin(), range.length(),
+      [cache = std::move(cache), len = range.length(),
        cb = std::move(cb)](absl::StatusOr<Buffer::InstancePtr> read_result) mutable -> void {
         if (!read_result.ok()) {
           return cb(nullptr, EndStream::Reset);
@@ -24,9 +66,10 @@ void CacheFileReader::getBody(Event::Dispatcher& dispatcher, AdjustedByteRange r
         if (read_result.value()->length() != len) {
           return cb(nullptr, EndStream::Reset);
         }
+        cache->stats_.body_bytes_read_.add(len);
         return cb(std::move(read_result.value()), EndStream::More);
       });
-  ASSERT(queued.ok(), queued.status().ToString());
+  return queued.status();
 }
 
 CacheFileReader::~CacheFileReader() {
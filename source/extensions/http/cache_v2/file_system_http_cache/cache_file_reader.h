@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "source/extensions/common/async_files/async_file_handle.h"
 #include "source/extensions/filters/http/cache_v2/http_cache.h"
 
@@ -9,15 +11,26 @@ namespace HttpFilters {
 namespace CacheV2 {
 namespace FileSystemHttpCache {
 
+struct CacheShared;
+
 class CacheFileReader : public CacheReader {
 public:
-  CacheFileReader(Common::AsyncFiles::AsyncFileHandle handle);
+  CacheFileReader(Common::AsyncFiles::AsyncFileHandle handle, std::shared_ptr<CacheShared> cache);
   ~CacheFileReader() override;
   // From CacheReader
   void getBody(Event::Dispatcher& dispatcher, AdjustedByteRange range, GetBodyCallback&& cb) final;
 
 private:
+  // Reads the body by copying it out of the file. Used for small reads, and for large reads if
+  // mapping the file fails. Uses none of the reader, so that it can be called after the reader is
+  // destroyed.
+  static absl::Status readBody(Common::AsyncFiles::AsyncFileHandle file_handle,
+                               std::shared_ptr<CacheShared> cache, Event::Dispatcher& dispatcher,
+                               AdjustedByteRange range, GetBodyCallback&& cb);
+
   Common::AsyncFiles::AsyncFileHandle file_handle_;
+  // For the config and stats of the cache, which the reader may outlive.
+  std::shared_ptr<CacheShared> cache_;
 };
 
 } // namespace FileSystemHttpCache
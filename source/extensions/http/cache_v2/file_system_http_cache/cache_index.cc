@@ -0,0 +1,415 @@
+#include "source/extensions/http/cache_v2/file_system_http_cache/cache_index.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+
+#include <chrono>
+
+#include "envoy/common/exception.h"
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/common/utility.h"
+
+#include "absl/base/internal/endian.h"
+#include "absl/cleanup/cleanup.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace FileSystemHttpCache {
+
+namespace {
+
+// The first 8 bytes of an index file - the last 4 are the version of the format, so that an
+// index written by an incompatible version is rebuilt rather than misread. The index file has
+// the in-use header from when it is loaded or written until the cache shuts down cleanly, so an
+// index file left by a crash, which misses the changes since the last flush, is rebuilt.
+constexpr absl::string_view CleanHeader = "INDX0002";
+constexpr absl::string_view InUseHeader = "INDU0002";
+constexpr size_t HeaderSize = CleanHeader.size();
+static_assert(InUseHeader.size() == HeaderSize);
+
+// A record is a type byte, 7 bytes of padding, then the key hash, the size of the cache file and
+// its last touch time in microseconds since the epoch, as big-endian 64-bit values.
+constexpr size_t RecordSize = 32;
+constexpr char UpsertRecord = 'U';
+constexpr char RemoveRecord = 'R';
+
+// Appending is cheaper than compacting until the file holds this many records more than twice
+// the number of entries.
+constexpr uint64_t MinRecordsBeforeCompaction = 4096;
+
+// Compaction writes the snapshot in chunks of this size.
+constexpr size_t CompactionChunkSize = 1024 * 1024;
+
+void appendRecord(std::string& out, char type, uint64_t hash, const CacheIndex::Entry& entry) {
+  char record[RecordSize] = {};
+  record[0] = type;
+  absl::big_endian::Store64(&record[8], hash);
+  absl::big_endian::Store64(&record[16], entry.size_);
+  absl::big_endian::Store64(
+      &record[24], std::chrono::duration_cast<std::chrono::microseconds>(
+                       entry.last_touch_.time_since_epoch())
+                       .count());
+  out.append(record, RecordSize);
+}
+
+absl::Status fileError(absl::string_view action, absl::string_view path, int error) {
+  return absl::UnavailableError(
+      absl::StrCat("failed to ", action, " cache index ", path, ": ", errorDetails(error)));
+}
+
+absl::Status writeAll(int fd, absl::string_view data, off_t offset, absl::string_view path) {
+  auto& posix = Api::OsSysCallsSingleton::get();
+  while (!data.empty()) {
+    Api::SysCallSizeResult written = posix.pwrite(fd, data.data(), data.size(), offset);
+    if (written.return_value_ == -1) {
+      return fileError("write", path, written.errno_);
+    }
+    data.remove_prefix(written.return_value_);
+    offset += written.return_value_;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status sync(int fd, absl::string_view path) {
+  Api::SysCallIntResult synced = Api::OsSysCallsSingleton::get().fsync(fd);
+  if (synced.return_value_ == -1) {
+    return fileError("sync", path, synced.errno_);
+  }
+  return absl::OkStatus();
+}
+
+} // namespace
+
+std::optional<uint64_t> hashFromCacheFilename(absl::string_view filename) {
+  const size_t slash = filename.rfind('/');
+  if (slash != absl::string_view::npos) {
+    filename.remove_prefix(slash + 1);
+  }
+  uint64_t hash;
+  if (!absl::ConsumePrefix(&filename, "cache-") || !absl::SimpleAtoi(filename, &hash)) {
+    return std::nullopt;
+  }
+  return hash;
+}
+
+CacheIndex::CacheIndex(std::string path) : path_(std::move(path)) {}
+
+CacheIndex::~CacheIndex() {
+  absl::MutexLock lock(file_mu_);
+  if (fd_ != -1) {
+    Api::OsSysCallsSingleton::get().close(fd_);
+  }
+  if (lock_fd_ != -1) {
+    Api::OsSysCallsSingleton::get().close(lock_fd_);
+  }
+}
+
+bool CacheIndex::lock() {
+  absl::MutexLock file_lock(file_mu_);
+  if (lock_fd_ != -1) {
+    return true;
+  }
+  auto& posix = Api::OsSysCallsSingleton::get();
+  const std::string lock_path = absl::StrCat(path_, ".lock");
+  Api::SysCallIntResult fd = posix.open(lock_path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+  if (fd.return_value_ == -1) {
+    return false;
+  }
+  // A flock is owned by the open file, so that it also excludes other caches of this process.
+  if (::flock(fd.return_value_, LOCK_EX | LOCK_NB) == -1) {
+    posix.close(fd.return_value_);
+    return false;
+  }
+  lock_fd_ = fd.return_value_;
+  return true;
+}
+
+bool CacheIndex::load() {
+  absl::MutexLock file_lock(file_mu_);
+  auto& posix = Api::OsSysCallsSingleton::get();
+  Api::SysCallIntResult fd = posix.open(path_.c_str(), O_RDWR);
+  if (fd.return_value_ == -1) {
+    return false;
+  }
+  absl::Cleanup close_fd = [&posix, &fd]() { posix.close(fd.return_value_); };
+  struct stat s;
+  if (posix.fstat(fd.return_value_, &s).return_value_ != 0 ||
+      static_cast<size_t>(s.st_size) < HeaderSize) {
+    return false;
+  }
+  Api::SysCallPtrResult mapped =
+      posix.mmap(nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd.return_value_, 0);
+  if (mapped.return_value_ == MAP_FAILED) {
+    return false;
+  }
+  absl::Cleanup unmap = [&mapped, &s]() { ::munmap(mapped.return_value_, s.st_size); };
+  const absl::string_view data{static_cast<const char*>(mapped.return_value_),
+                               static_cast<size_t>(s.st_size)};
+  if (!absl::StartsWith(data, CleanHeader)) {
+    return false;
+  }
+  absl::flat_hash_map<uint64_t, Entry> loaded;
+  uint64_t records = 0;
+  // A partial record at the end is the remains of an interrupted append, and is ignored.
+  for (size_t offset = HeaderSize; offset + RecordSize <= data.size(); offset += RecordSize) {
+    const char* record = &data[offset];
+    const uint64_t hash = absl::big_endian::Load64(&record[8]);
+    switch (record[0]) {
+    case UpsertRecord:
+      loaded[hash] = Entry{absl::big_endian::Load64(&record[16]),
+                           SystemTime{std::chrono::microseconds(
+                               static_cast<int64_t>(absl::big_endian::Load64(&record[24])))}};
+      break;
+    case RemoveRecord:
+      loaded.erase(hash);
+      break;
+    default:
+      return false;
+    }
+    records++;
+  }
+  // Until close marks it clean again, the file is stale as soon as the index changes.
+  if (!writeAll(fd.return_value_, InUseHeader, 0, path_).ok() ||
+      !sync(fd.return_value_, path_).ok()) {
+    return false;
+  }
+  absl::MutexLock lock(mu_);
+  for (const auto& [hash, entry] : loaded) {
+    // A dirty hash was added or removed since startup, which is more recent than the file.
+    if (!dirty_.contains(hash) && entries_.try_emplace(hash, entry).second) {
+      bytes_ += entry.size_;
+    }
+  }
+  records_ = records;
+  needs_compaction_ = false;
+  complete_ = true;
+  return true;
+}
+
+void CacheIndex::markComplete() {
+  absl::MutexLock file_lock(file_mu_);
+  complete_ = true;
+}
+
+absl::Status CacheIndex::flush() {
+  absl::MutexLock file_lock(file_mu_);
+  std::string records;
+  std::vector<std::pair<uint64_t, Entry>> snapshot;
+  bool compact_now;
+  {
+    absl::MutexLock lock(mu_);
+    applyTouches();
+    if (!needs_compaction_ && dirty_.empty()) {
+      return absl::OkStatus();
+    }
+    compact_now = needs_compaction_ ||
+                  records_ + dirty_.size() > 2 * entries_.size() + MinRecordsBeforeCompaction;
+    if (compact_now) {
+      snapshot.assign(entries_.begin(), entries_.end());
+    } else {
+      records.reserve(dirty_.size() * RecordSize);
+      for (uint64_t hash : dirty_) {
+        auto it = entries_.find(hash);
+        if (it == entries_.end()) {
+          appendRecord(records, RemoveRecord, hash, Entry{0, SystemTime{}});
+        } else {
+          appendRecord(records, UpsertRecord, hash, it->second);
+        }
+      }
+    }
+    dirty_.clear();
+  }
+  absl::Status status = compact_now ? compact(std::move(snapshot)) : append(records);
+  if (!status.ok()) {
+    // The changes that failed to be written are no longer dirty, so they are only persisted by
+    // rewriting the whole index.
+    needs_compaction_ = true;
+  }
+  return status;
+}
+
+absl::Status CacheIndex::close() {
+  // Any add or remove from here on may miss the final flush, so it checks closed_.
+  closing_ = true;
+  RETURN_IF_NOT_OK(flush());
+  absl::MutexLock file_lock(file_mu_);
+  if (!complete_) {
+    // The next start rebuilds the index, as the index file has the in-use header.
+    return absl::OkStatus();
+  }
+  RETURN_IF_NOT_OK(open());
+  // The records must be on disk before the header that vouches for them.
+  RETURN_IF_NOT_OK(sync(fd_, path_));
+  RETURN_IF_NOT_OK(writeAll(fd_, CleanHeader, 0, path_));
+  closed_ = true;
+  return sync(fd_, path_);
+}
+
+void CacheIndex::discardClosedIndexFile() {
+  absl::MutexLock file_lock(file_mu_);
+  if (closed_) {
+    // The change is not in the index file that was marked clean, so the next start must rebuild
+    // the index from the cache directory.
+    Api::OsSysCallsSingleton::get().unlink(path_.c_str());
+    closed_ = false;
+  }
+}
+
+absl::Status CacheIndex::compact(std::vector<std::pair<uint64_t, Entry>> entries) {
+  auto& posix = Api::OsSysCallsSingleton::get();
+  const std::string tmp_path = absl::StrCat(path_, ".tmp");
+  Api::SysCallIntResult fd =
+      posix.open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd.return_value_ == -1) {
+    return fileError("create", tmp_path, fd.errno_);
+  }
+  absl::Cleanup discard = [&posix, &fd, &tmp_path]() {
+    posix.close(fd.return_value_);
+    posix.unlink(tmp_path.c_str());
+  };
+  std::string chunk{InUseHeader};
+  off_t offset = 0;
+  for (const auto& [hash, entry] : entries) {
+    appendRecord(chunk, UpsertRecord, hash, entry);
+    if (chunk.size() >= CompactionChunkSize) {
+      RETURN_IF_NOT_OK(writeAll(fd.return_value_, chunk, offset, tmp_path));
+      offset += chunk.size();
+      chunk.clear();
+    }
+  }
+  RETURN_IF_NOT_OK(writeAll(fd.return_value_, chunk, offset, tmp_path));
+  // Without syncing first, a crash soon after the rename could leave an empty index file.
+  RETURN_IF_NOT_OK(sync(fd.return_value_, tmp_path));
+  Api::SysCallIntResult renamed = posix.rename(tmp_path.c_str(), path_.c_str());
+  if (renamed.return_value_ == -1) {
+    return fileError("replace", path_, renamed.errno_);
+  }
+  std::move(discard).Cancel();
+  if (fd_ != -1) {
+    posix.close(fd_);
+  }
+  fd_ = fd.return_value_;
+  records_ = entries.size();
+  needs_compaction_ = false;
+  return absl::OkStatus();
+}
+
+absl::Status CacheIndex::open() {
+  if (fd_ != -1) {
+    return absl::OkStatus();
+  }
+  auto& posix = Api::OsSysCallsSingleton::get();
+  Api::SysCallIntResult fd = posix.open(path_.c_str(), O_WRONLY);
+  if (fd.return_value_ == -1) {
+    return fileError("open", path_, fd.errno_);
+  }
+  fd_ = fd.return_value_;
+  // Drops any partial record left by an interrupted append, which load ignored.
+  Api::SysCallIntResult truncated = posix.ftruncate(fd_, HeaderSize + records_ * RecordSize);
+  if (truncated.return_value_ == -1) {
+    return fileError("truncate", path_, truncated.errno_);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CacheIndex::append(const std::string& records) {
+  RETURN_IF_NOT_OK(open());
+  RETURN_IF_NOT_OK(writeAll(fd_, records, HeaderSize + records_ * RecordSize, path_));
+  records_ += records.size() / RecordSize;
+  return absl::OkStatus();
+}
+
+void CacheIndex::add(uint64_t hash, uint64_t size, SystemTime now) {
+  {
+    absl::MutexLock lock(mu_);
+    auto [it, inserted] = entries_.try_emplace(hash, Entry{size, now});
+    if (!inserted) {
+      bytes_ -= it->second.size_;
+      it->second = Entry{size, now};
+    }
+    bytes_ += size;
+    dirty_.insert(hash);
+  }
+  if (closing_) {
+    discardClosedIndexFile();
+  }
+}
+
+void CacheIndex::addIfUnknown(uint64_t hash, uint64_t size, SystemTime last_touch) {
+  absl::MutexLock lock(mu_);
+  if (dirty_.contains(hash)) {
+    return;
+  }
+  if (entries_.try_emplace(hash, Entry{size, last_touch}).second) {
+    bytes_ += size;
+  }
+}
+
+void CacheIndex::remove(uint64_t hash) {
+  {
+    absl::MutexLock lock(mu_);
+    auto it = entries_.find(hash);
+    if (it != entries_.end()) {
+      bytes_ -= it->second.size_;
+      entries_.erase(it);
+    }
+    dirty_.insert(hash);
+  }
+  if (closing_) {
+    discardClosedIndexFile();
+  }
+}
+
+void CacheIndex::touch(uint64_t hash, SystemTime now) {
+  TouchStripe& stripe = touch_stripes_[hash % TouchStripes];
+  absl::MutexLock lock(stripe.mu_);
+  SystemTime& last_touch = stripe.touches_[hash];
+  last_touch = std::max(last_touch, now);
+}
+
+void CacheIndex::applyTouches() {
+  for (TouchStripe& stripe : touch_stripes_) {
+    absl::flat_hash_map<uint64_t, SystemTime> touches;
+    {
+      absl::MutexLock lock(stripe.mu_);
+      touches.swap(stripe.touches_);
+    }
+    for (const auto& [hash, now] : touches) {
+      auto it = entries_.find(hash);
+      if (it != entries_.end() && it->second.last_touch_ < now) {
+        it->second.last_touch_ = now;
+        dirty_.insert(hash);
+      }
+    }
+  }
+}
+
+uint64_t CacheIndex::count() const {
+  absl::MutexLock lock(mu_);
+  return entries_.size();
+}
+
+uint64_t CacheIndex::bytes() const {
+  absl::MutexLock lock(mu_);
+  return bytes_;
+}
+
+std::vector<std::pair<uint64_t, CacheIndex::Entry>> CacheIndex::entries() {
+  absl::MutexLock lock(mu_);
+  applyTouches();
+  return {entries_.begin(), entries_.end()};
+}
+
+} // namespace FileSystemHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/time.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace FileSystemHttpCache {
+
+/**
+ * @return the key hash that a cache file is named after, or nullopt if the name is not that of a
+ * cache file. The name may include a path.
+ */
+std::optional<uint64_t> hashFromCacheFilename(absl::string_view filename);
+
+/**
+ * An index of the files of a cache, with their size and the time they were last looked up. The
+ * index is persisted in a file in the cache directory, so that a cache can measure itself and
+ * choose what to evict without scanning the directory, which can take minutes for a large cache.
+ *
+ * The index file starts with an 8 byte header, followed by fixed-size records in explicit byte
+ * order, each of which either sets the size and last touch time of a cache file or removes it.
+ * Changes are appended in batches by flush. Once the index file holds many more records than the
+ * index has entries, flush compacts it instead, by writing a snapshot of the entries to a
+ * temporary file that then replaces it.
+ *
+ * The header also records whether the index file is complete. Loading the index file marks it
+ * in use, and only close marks it clean again, so an index file left by a crash, which lacks
+ * the changes made since the last flush, is rebuilt from the cache directory on the next start.
+ * Adding or removing a file after close, e.g. from an insert that was still in flight, deletes
+ * the index file instead, for the same reason.
+ *
+ * Only one process can use an index file, as it only knows the cache files of that process. The
+ * owner holds an exclusive lock on a separate lock file next to it, since compaction replaces the
+ * index file itself.
+ *
+ * The in-memory index is updated by the cache's workers, while the index file is read and written
+ * by the CacheEvictionThread.
+ */
+class CacheIndex {
+public:
+  struct Entry {
+    uint64_t size_;
+    SystemTime last_touch_;
+  };
+
+  explicit CacheIndex(std::string path);
+  ~CacheIndex();
+
+  /**
+   * Takes the lock on the index file, which is held until the index is destroyed. Runs in the
+   * CacheEvictionThread, before load.
+   * @return false if another process, or another cache of this process, holds the lock, in
+   * which case the index must not be used.
+   */
+  bool lock();
+
+  /**
+   * Reads the index file into memory. Changes made to the index before the load take precedence
+   * over the contents of the file. Runs in the CacheEvictionThread.
+   * @return false if the index file is missing, inconsistent or was not closed cleanly, in which
+   * case the caller should rebuild the index from the cache directory.
+   */
+  bool load();
+
+  /**
+   * Records that the index holds every file of the cache, after the caller rebuilt it from the
+   * cache directory because load failed.
+   */
+  void markComplete();
+
+  /**
+   * Writes the changes made since the previous flush to the index file. Runs in the
+   * CacheEvictionThread, and once more when the cache is destroyed.
+   * @return an error if the index file could not be written; the next flush rewrites it.
+   */
+  absl::Status flush();
+
+  /**
+   * Flushes the index, then marks the index file clean so that the next start loads it, if the
+   * index was loaded or rebuilt. Runs once when the cache is destroyed.
+   * @return an error if the index file could not be written; the next start rebuilds it.
+   */
+  absl::Status close();
+
+  // Adds a cache file to the index, or replaces it.
+  void add(uint64_t hash, uint64_t size, SystemTime now);
+  // Adds a cache file found in the cache directory, unless the index already has it or it was
+  // removed since the directory was read.
+  void addIfUnknown(uint64_t hash, uint64_t size, SystemTime last_touch);
+  void remove(uint64_t hash);
+  // Updates the last touch time of a cache file, if it is in the index. Every lookup touches,
+  // so touches only take the lock of one of several stripes, and are applied to the index by
+  // flush and entries.
+  void touch(uint64_t hash, SystemTime now);
+
+  uint64_t count() const;
+  uint64_t bytes() const;
+  std::vector<std::pair<uint64_t, Entry>> entries();
+
+private:
+  static constexpr size_t TouchStripes = 16;
+
+  struct TouchStripe {
+    absl::Mutex mu_;
+    absl::flat_hash_map<uint64_t, SystemTime> touches_ ABSL_GUARDED_BY(mu_);
+  };
+
+  // Moves the buffered touches into the index.
+  void applyTouches() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Deletes the index file if close already marked it clean.
+  void discardClosedIndexFile();
+  absl::Status compact(std::vector<std::pair<uint64_t, Entry>> entries)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  absl::Status append(const std::string& records) ABSL_EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  // Opens fd_ for writing, if it is not open yet.
+  absl::Status open() ABSL_EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+
+  const std::string path_;
+
+  // Held while reading or writing the index file, which is mostly done by the
+  // CacheEvictionThread, but also by the final flush when the cache is destroyed.
+  // Acquired before mu_.
+  absl::Mutex file_mu_;
+  int fd_ ABSL_GUARDED_BY(file_mu_){-1};
+  // The number of complete records in the index file.
+  uint64_t records_ ABSL_GUARDED_BY(file_mu_){0};
+  // Set until the index file is known to hold the index, e.g. after a failed write.
+  bool needs_compaction_ ABSL_GUARDED_BY(file_mu_){true};
+  // Set once the index holds every cache file, by load or markComplete.
+  bool complete_ ABSL_GUARDED_BY(file_mu_){false};
+  // The file the lock is held on, if lock succeeded.
+  int lock_fd_ ABSL_GUARDED_BY(file_mu_){-1};
+  // Set once close marked the index file clean.
+  bool closed_ ABSL_GUARDED_BY(file_mu_){false};
+  // Set when close starts, so that adds and removes don't take file_mu_ before then.
+  std::atomic<bool> closing_{false};
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<uint64_t, Entry> entries_ ABSL_GUARDED_BY(mu_);
+  // The hashes added, touched or removed since the last flush.
+  absl::flat_hash_set<uint64_t> dirty_ ABSL_GUARDED_BY(mu_);
+  uint64_t bytes_ ABSL_GUARDED_BY(mu_){0};
+
+  // Acquired after mu_.
+  std::array<TouchStripe, TouchStripes> touch_stripes_;
+};
+
+} // namespace FileSystemHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
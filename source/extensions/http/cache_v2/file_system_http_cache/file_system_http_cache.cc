@@ -4,6 +4,7 @@
 
 #include "source/common/filesystem/directory.h"
 #include "source/common/http/header_map_impl.h"
+#include "source/common/protobuf/utility.h"
 #include "source/extensions/http/cache_v2/file_system_http_cache/cache_eviction_thread.h"
 #include "source/extensions/http/cache_v2/file_system_http_cache/cache_file_fixed_block.h"
 #include "source/extensions/http/cache_v2/file_system_http_cache/cache_file_header_proto_util.h"
@@ -38,7 +39,12 @@ CacheShared::CacheShared(ConfigProto config, Stats::Scope& stats_scope,
                          CacheEvictionThread& eviction_thread)
     : signal_eviction_([&eviction_thread]() { eviction_thread.signal(); }), config_(config),
       stat_names_(stats_scope.symbolTable()),
-      stats_(generateStats(stat_names_, stats_scope, cachePath())) {}
+      stats_(generateStats(stat_names_, stats_scope, cachePath())) {
+  if (config_.has_index_checkpoint_interval()) {
+    // The name must not look like a cache file, or eviction would treat it as one.
+    index_ = std::make_unique<CacheIndex>(absl::StrCat(cachePath(), "fs_cache_index"));
+  }
+}
 
 void CacheShared::disconnectEviction() {
   absl::MutexLock lock(signal_mu_);
@@ -47,6 +53,8 @@ void CacheShared::disconnectEviction() {
 
 FileSystemHttpCache::~FileSystemHttpCache() {
   shared_->disconnectEviction();
+  // Also has the eviction thread persist the touches and evictions since the last checkpoint,
+  // so the next start of the cache can trust the index.
   cache_eviction_thread_.removeCache(shared_);
 }
 
@@ -60,7 +68,7 @@ void FileSystemHttpCache::lookup(LookupRequest&& lookup, LookupCallback&& callba
   std::string filepath = absl::StrCat(cachePath(), generateFilename(lookup.key()));
   async_file_manager_->openExistingFile(
       &lookup.dispatcher(), filepath, Common::AsyncFiles::AsyncFileManager::Mode::ReadOnly,
-      [&dispatcher = lookup.dispatcher(),
+      [&dispatcher = lookup.dispatcher(), shared = shared_,
        callback = std::move(callback)](absl::StatusOr<AsyncFileHandle> open_result) mutable {
         if (!open_result.ok()) {
           if (open_result.status().code() == absl::StatusCode::kNotFound) {
@@ -69,7 +77,8 @@ void FileSystemHttpCache::lookup(LookupRequest&& lookup, LookupCallback&& callba
           ENVOY_LOG(error, "open file failed: {}", open_result.status());
           return callback(open_result.status());
         }
-        FileLookupContext::begin(dispatcher, std::move(open_result.value()), std::move(callback));
+        FileLookupContext::begin(dispatcher, std::move(open_result.value()), std::move(shared),
+                                 std::move(callback));
       });
 }
 
@@ -226,19 +235,24 @@ void FileSystemHttpCache::evict(Event::Dispatcher& dispatcher, const Key& key) {
                                 return;
                               }
                               off_t sz = stat_result.value().st_size;
-                              file_manager->unlink(&dispatcher, filepath,
-                                                   [sz, stats](absl::Status unlink_result) {
-                                                     if (!unlink_result.ok()) {
-                                                       return;
-                                                     }
-                                                     stats->trackFileRemoved(sz);
-                                                   });
+                              file_manager->unlink(
+                                  &dispatcher, filepath,
+                                  [sz, stats, filepath](absl::Status unlink_result) {
+                                    if (!unlink_result.ok()) {
+                                      return;
+                                    }
+                                    stats->trackFileRemoved(sz);
+                                    stats->indexFileRemoved(filepath);
+                                  });
                             });
 }
 
-void FileSystemHttpCache::touch(const Key&, SystemTime) {
-  // Reading from a file counts as a touch for stat purposes, so no
-  // need to update timestamps directly.
+void FileSystemHttpCache::touch(const Key& key, SystemTime timestamp) {
+  // Reading from a file counts as a touch for stat purposes, so without an index
+  // there is no need to update timestamps directly.
+  if (CacheIndex* index = shared_->index()) {
+    index->touch(stableHashKey(key), timestamp);
+  }
 }
 
 absl::string_view FileSystemHttpCache::cachePath() const { return shared_->cachePath(); }
@@ -293,6 +307,56 @@ void CacheShared::trackFileRemoved(uint64_t file_size) {
   stats_.size_bytes_.set(size_bytes_);
 }
 
+void CacheShared::indexFileAdded(absl::string_view filepath, uint64_t file_size,
+                                 SystemTime now) {
+  CacheIndex* const index = this->index();
+  if (!index) {
+    return;
+  }
+  if (std::optional<uint64_t> hash = hashFromCacheFilename(filepath)) {
+    index->add(*hash, file_size, now);
+  }
+}
+
+void CacheShared::indexFileRemoved(absl::string_view filepath) {
+  CacheIndex* const index = this->index();
+  if (!index) {
+    return;
+  }
+  if (std::optional<uint64_t> hash = hashFromCacheFilename(filepath)) {
+    index->remove(*hash);
+  }
+}
+
+absl::Duration CacheShared::indexCheckpointInterval() const {
+  if (!index()) {
+    return absl::InfiniteDuration();
+  }
+  return absl::Milliseconds(PROTOBUF_GET_MS_REQUIRED(config_, index_checkpoint_interval));
+}
+
+void CacheShared::flushIndex() {
+  CacheIndex* const index = this->index();
+  if (!index) {
+    return;
+  }
+  absl::Status status = index->flush();
+  if (!status.ok()) {
+    ENVOY_LOG(warn, "{}", status);
+  }
+}
+
+void CacheShared::closeIndex() {
+  CacheIndex* const index = this->index();
+  if (!index) {
+    return;
+  }
+  absl::Status status = index->close();
+  if (!status.ok()) {
+    ENVOY_LOG(warn, "{}", status);
+  }
+}
+
 bool CacheShared::needsEviction() const {
   if (config_.has_max_cache_size_bytes() && size_bytes_ > config_.max_cache_size_bytes().value()) {
     return true;
@@ -7,6 +7,7 @@
 #include "source/common/common/logger.h"
 #include "source/extensions/common/async_files/async_file_manager.h"
 #include "source/extensions/filters/http/cache_v2/http_cache.h"
+#include "source/extensions/http/cache_v2/file_system_http_cache/cache_index.h"
 #include "source/extensions/http/cache_v2/file_system_http_cache/stats.h"
 
 #include "absl/base/thread_annotations.h"
@@ -123,7 +124,7 @@ private:
 // This part of the cache implementation is shared between CacheEvictionThread and
 // FileSystemHttpCache. The implementation of CacheShared is also split between the
 // two implementation files, accordingly.
-struct CacheShared {
+struct CacheShared : public Logger::Loggable<Logger::Id::cache_filter> {
   CacheShared(ConfigProto config, Stats::Scope& stats_scope, CacheEvictionThread& eviction_thread);
   absl::Mutex signal_mu_;
   std::function<void()> signal_eviction_ ABSL_GUARDED_BY(signal_mu_);
@@ -140,6 +141,17 @@ struct CacheShared {
   std::atomic<uint64_t> size_count_ = 0;
   std::atomic<uint64_t> size_bytes_ = 0;
   bool needs_init_ = true;
+  // The persistent index of the cache files, or null if index_checkpoint_interval is
+  // not configured.
+  std::unique_ptr<CacheIndex> index_;
+  // Cleared if another process holds the index file, in which case the cache works as if it
+  // had no index.
+  std::atomic<bool> index_usable_ = true;
+
+  /**
+   * @return the index of the cache, or null if it has none or cannot use it.
+   */
+  CacheIndex* index() const { return index_usable_ ? index_.get() : nullptr; }
 
   /**
    * When the cache is deleted, cache state metrics may still be being updated - the
@@ -171,13 +183,46 @@ struct CacheShared {
    */
   void trackFileRemoved(uint64_t file_size);
 
+  /**
+   * Records a file added to the cache in the index, if the cache has one.
+   * @param filepath The path of the file that was added.
+   * @param file_size The size in bytes of the file that was added.
+   * @param now The current time, which counts as the file's last touch.
+   */
+  void indexFileAdded(absl::string_view filepath, uint64_t file_size, SystemTime now);
+
+  /**
+   * Removes a file from the index, if the cache has one.
+   * @param filepath The path of the file that was removed.
+   */
+  void indexFileRemoved(absl::string_view filepath);
+
+  /**
+   * @return how often the index should be written to disk, or absl::InfiniteDuration() if
+   * the cache has no index.
+   */
+  absl::Duration indexCheckpointInterval() const;
+
+  /**
+   * Writes pending index changes to disk, logging any failure. Runs in the
+   * CacheEvictionThread.
+   */
+  void flushIndex();
+
+  /**
+   * Writes pending index changes to disk and marks the index file clean, logging any failure.
+   * Runs in the CacheEvictionThread once the cache is destroyed.
+   */
+  void closeIndex();
+
   /**
    * Performs an eviction pass over this cache. Runs in the CacheEvictionThread.
    */
   void evict();
 
   /**
-   * Initializes the stats for this cache. Runs in the CacheEvictionThread.
+   * Initializes the stats for this cache, from the index file if it is usable, or else by
+   * scanning the cache directory. Runs in the CacheEvictionThread.
    */
   void initStats();
 };
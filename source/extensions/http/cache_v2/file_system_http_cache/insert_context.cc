@@ -79,8 +79,8 @@ void FileInsertContext::dupFile() {
         }
         bool end_stream = source_ == nullptr;
         progress_receiver_->onHeadersInserted(
-            std::make_unique<CacheFileReader>(std::move(dup_result.value())), std::move(headers_),
-            end_stream);
+            std::make_unique<CacheFileReader>(std::move(dup_result.value()), stat_recorder_),
+            std::move(headers_), end_stream);
         writeEmptyHeaderBlock();
       });
   ASSERT(queued.ok(), queued.status().ToString());
@@ -234,6 +234,7 @@ void FileInsertContext::createHardLink() {
         ENVOY_LOG(debug, "created cache file {}", filepath_);
         uint64_t file_size = header_block_.offsetToTrailers() + header_block_.trailerSize();
         stat_recorder_->trackFileAdded(file_size);
+        stat_recorder_->indexFileAdded(filepath_, file_size, dispatcher_.timeSource().systemTime());
         complete();
       });
   ASSERT(queued.ok(), queued.status().ToString());
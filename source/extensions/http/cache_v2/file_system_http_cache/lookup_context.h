@@ -14,17 +14,18 @@ namespace FileSystemHttpCache {
 
 class CacheSession;
 class FileSystemHttpCache;
+struct CacheShared;
 
 using Envoy::Extensions::Common::AsyncFiles::AsyncFileHandle;
 
 class FileLookupContext {
 public:
   static void begin(Event::Dispatcher& dispatcher, AsyncFileHandle handle,
-                    HttpCache::LookupCallback&& callback);
+                    std::shared_ptr<CacheShared> cache, HttpCache::LookupCallback&& callback);
 
 private:
   FileLookupContext(Event::Dispatcher& dispatcher, AsyncFileHandle handle,
-                    HttpCache::LookupCallback&& callback);
+                    std::shared_ptr<CacheShared> cache, HttpCache::LookupCallback&& callback);
   void getHeaderBlock();
   void getHeaders();
   void getTrailers();
@@ -32,6 +33,7 @@ private:
 
   Event::Dispatcher& dispatcher_;
   AsyncFileHandle file_handle_;
+  std::shared_ptr<CacheShared> cache_;
   CacheFileFixedBlock header_block_;
   HttpCache::LookupCallback callback_;
   LookupResult result_;
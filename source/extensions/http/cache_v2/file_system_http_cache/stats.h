@@ -19,11 +19,16 @@ namespace FileSystemHttpCache {
  *
  * Drift will eventually be reconciled at the next pre-cache-purge measurement.
  *
+ * body_bytes_read counts all body bytes read from cache files, and body_bytes_mapped the part of
+ * them that was mapped into memory rather than copied.
+ *
  * There are also cache_hit_ and cache_miss_, defined separately to accommodate extra tags;
  * these two both go into the stat with key `event`, and with tag `event_type=(hit|miss)`
  **/
 
 #define ALL_CACHE_STATS(COUNTER, GAUGE, HISTOGRAM, TEXT_READOUT, STATNAME)                         \
+  COUNTER(body_bytes_mapped)                                                                       \
+  COUNTER(body_bytes_read)                                                                         \
   COUNTER(eviction_runs)                                                                           \
   GAUGE(size_bytes, NeverImport)                                                                   \
   GAUGE(size_count, NeverImport)                                                                   \
@@ -0,0 +1,74 @@
+#include "source/extensions/http/cache_v2/simple_http_cache/frequency_sketch.h"
+
+#include <algorithm>
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace {
+
+constexpr uint32_t Rows = 4;
+constexpr uint32_t CountersPerWord = 16;
+constexpr uint64_t MinWords = 16;
+constexpr uint64_t MaxWords = uint64_t(1) << 24;
+// Odd constants, so that each row spreads the keys differently.
+constexpr uint64_t Seeds[Rows] = {0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+                                  0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+
+} // namespace
+
+FrequencySketch::FrequencySketch(uint64_t expected_entries) {
+  const uint64_t wanted = std::clamp<uint64_t>(expected_entries, MinWords, MaxWords);
+  uint64_t words = MinWords;
+  while (words < wanted) {
+    words *= 2;
+  }
+  table_.resize(words);
+  counter_mask_ = words * CountersPerWord - 1;
+  sample_size_ = 10 * words;
+}
+
+uint64_t FrequencySketch::counterIndex(uint64_t hash, uint32_t row) const {
+  uint64_t h = (hash + Seeds[row]) * Seeds[row];
+  h ^= h >> 32;
+  return h & counter_mask_;
+}
+
+void FrequencySketch::increment(uint64_t hash) {
+  bool incremented = false;
+  for (uint32_t row = 0; row < Rows; ++row) {
+    const uint64_t index = counterIndex(hash, row);
+    uint64_t& word = table_[index / CountersPerWord];
+    const uint32_t shift = (index % CountersPerWord) * 4;
+    if (((word >> shift) & 0xf) < MaxFrequency) {
+      word += uint64_t(1) << shift;
+      incremented = true;
+    }
+  }
+  if (incremented && ++additions_ >= sample_size_) {
+    halve();
+  }
+}
+
+uint32_t FrequencySketch::frequency(uint64_t hash) const {
+  uint32_t frequency = MaxFrequency;
+  for (uint32_t row = 0; row < Rows; ++row) {
+    const uint64_t index = counterIndex(hash, row);
+    const uint32_t shift = (index % CountersPerWord) * 4;
+    frequency = std::min<uint32_t>(frequency, (table_[index / CountersPerWord] >> shift) & 0xf);
+  }
+  return frequency;
+}
+
+void FrequencySketch::halve() {
+  for (uint64_t& word : table_) {
+    word = (word >> 1) & 0x7777777777777777ULL;
+  }
+  additions_ /= 2;
+}
+
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
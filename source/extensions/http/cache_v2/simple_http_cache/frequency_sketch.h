@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+
+/**
+ * An approximate count of how often each key has been seen recently, used by the TinyLFU
+ * admission policy. This is a count-min sketch of 4-bit counters: each key increments four
+ * counters, and its frequency is the smallest of them. Once the number of increments reaches ten
+ * times the number of expected entries every counter is halved, so that keys that were popular a
+ * long time ago lose their advantage.
+ *
+ * Not thread safe.
+ */
+class FrequencySketch {
+public:
+  // The highest frequency a counter can hold.
+  static constexpr uint32_t MaxFrequency = 15;
+
+  /**
+   * @param expected_entries the number of keys expected to be tracked at once. The sketch has
+   *        16 counters per entry, rounded up to a power of two.
+   */
+  explicit FrequencySketch(uint64_t expected_entries);
+
+  void increment(uint64_t hash);
+  uint32_t frequency(uint64_t hash) const;
+
+private:
+  // The index of the counter for the given row, in units of counters.
+  uint64_t counterIndex(uint64_t hash, uint32_t row) const;
+  void halve();
+
+  // Each word holds 16 counters.
+  std::vector<uint64_t> table_;
+  uint64_t counter_mask_;
+  uint64_t sample_size_;
+  uint64_t additions_{0};
+};
+
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,5 +1,8 @@
 #include "source/extensions/http/cache_v2/simple_http_cache/simple_http_cache.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "envoy/extensions/http/cache_v2/simple_http_cache/v3/config.pb.h"
 #include "envoy/registry/registry.h"
 
@@ -17,16 +20,25 @@ constexpr absl::string_view Name = "envoy.extensions.http.cache_v2.simple";
 
 constexpr uint64_t InsertReadChunkSize = 512 * 1024;
 
+// The share of each shard's budget that is given to the window LRU.
+constexpr uint64_t WindowPercent = 1;
+// Used to size the frequency sketch of a shard from its budget.
+constexpr uint64_t ExpectedEntrySize = 8 * 1024;
+
 class InsertContext {
 public:
-  static void start(std::shared_ptr<SimpleHttpCache::Entry> entry,
+  static void start(std::shared_ptr<SimpleHttpCache::Shard> shard, Key key,
+                    std::shared_ptr<SimpleHttpCache::Entry> entry,
                     std::shared_ptr<CacheProgressReceiver> progress_receiver, HttpSourcePtr source);
 
 private:
-  InsertContext(std::shared_ptr<SimpleHttpCache::Entry> entry,
+  InsertContext(std::shared_ptr<SimpleHttpCache::Shard> shard, Key key,
+                std::shared_ptr<SimpleHttpCache::Entry> entry,
                 std::shared_ptr<CacheProgressReceiver> progress_receiver, HttpSourcePtr source);
   void onBody(AdjustedByteRange range, Buffer::InstancePtr buffer, EndStream end_stream);
   void onTrailers(Http::ResponseTrailerMapPtr trailers, EndStream end_stream);
+  std::shared_ptr<SimpleHttpCache::Shard> shard_;
+  const Key key_;
   std::shared_ptr<SimpleHttpCache::Entry> entry_;
   std::shared_ptr<CacheProgressReceiver> progress_receiver_;
   HttpSourcePtr source_;
@@ -47,25 +59,29 @@ void SimpleHttpCacheReader::getBody(Event::Dispatcher&, AdjustedByteRange range,
   cb(entry_->body(std::move(range)), EndStream::More);
 }
 
-void InsertContext::start(std::shared_ptr<SimpleHttpCache::Entry> entry,
+void InsertContext::start(std::shared_ptr<SimpleHttpCache::Shard> shard, Key key,
+                          std::shared_ptr<SimpleHttpCache::Entry> entry,
                           std::shared_ptr<CacheProgressReceiver> progress_receiver,
                           HttpSourcePtr source) {
-  auto ctx = new InsertContext(std::move(entry), std::move(progress_receiver), std::move(source));
+  auto ctx = new InsertContext(std::move(shard), std::move(key), std::move(entry),
+                               std::move(progress_receiver), std::move(source));
   ctx->source_->getBody(AdjustedByteRange(0, InsertReadChunkSize), [ctx](Buffer::InstancePtr buffer,
                                                                          EndStream end_stream) {
     ctx->onBody(AdjustedByteRange(0, InsertReadChunkSize), std::move(buffer), end_stream);
   });
 }
 
-InsertContext::InsertContext(std::shared_ptr<SimpleHttpCache::Entry> entry,
+InsertContext::InsertContext(std::shared_ptr<SimpleHttpCache::Shard> shard, Key key,
+                             std::shared_ptr<SimpleHttpCache::Entry> entry,
                              std::shared_ptr<CacheProgressReceiver> progress_receiver,
                              HttpSourcePtr source)
-    : entry_(std::move(entry)), progress_receiver_(std::move(progress_receiver)),
-      source_(std::move(source)) {}
+    : shard_(std::move(shard)), key_(std::move(key)), entry_(std::move(entry)),
+      progress_receiver_(std::move(progress_receiver)), source_(std::move(source)) {}
 
 void InsertContext::onBody(AdjustedByteRange range, Buffer::InstancePtr buffer,
                            EndStream end_stream) {
   if (end_stream == EndStream::Reset) {
+    shard_->onInsertFailed(key_, entry_);
     progress_receiver_->onInsertFailed(absl::UnavailableError("upstream reset"));
     delete this;
     return;
@@ -85,7 +101,11 @@ void InsertContext::onBody(AdjustedByteRange range, Buffer::InstancePtr buffer,
   } else {
     range = AdjustedByteRange(0, entry_->bodySize());
   }
+  const bool kept = end_stream != EndStream::End || shard_->onInsertComplete(key_, entry_);
   progress_receiver_->onBodyInserted(range, end_stream == EndStream::End);
+  if (!kept) {
+    progress_receiver_->onInsertDiscarded();
+  }
   if (end_stream != EndStream::End) {
     AdjustedByteRange next_range(range.end(), range.end() + InsertReadChunkSize);
     return source_->getBody(next_range,
@@ -98,10 +118,15 @@ void InsertContext::onBody(AdjustedByteRange range, Buffer::InstancePtr buffer,
 
 void InsertContext::onTrailers(Http::ResponseTrailerMapPtr trailers, EndStream end_stream) {
   if (end_stream == EndStream::Reset) {
+    shard_->onInsertFailed(key_, entry_);
     progress_receiver_->onInsertFailed(absl::UnavailableError("upstream reset during trailers"));
   } else {
     entry_->setTrailers(std::move(trailers));
+    const bool kept = shard_->onInsertComplete(key_, entry_);
     progress_receiver_->onTrailersInserted(entry_->copyTrailers());
+    if (!kept) {
+      progress_receiver_->onInsertDiscarded();
+    }
   }
   delete this;
 }
@@ -109,19 +134,64 @@ void InsertContext::onTrailers(Http::ResponseTrailerMapPtr trailers, EndStream e
 } // namespace
 
 Buffer::InstancePtr SimpleHttpCache::Entry::body(AdjustedByteRange range) const {
-  absl::ReaderMutexLock lock(mu_);
-  return std::make_unique<Buffer::OwnedImpl>(
-      absl::string_view{body_}.substr(range.begin(), range.length()));
+  std::vector<BodyChunk> chunks;
+  {
+    absl::ReaderMutexLock lock(mu_);
+    auto it = std::upper_bound(
+        body_.begin(), body_.end(), range.begin(),
+        [](uint64_t offset, const BodyChunk& chunk) { return offset < chunk.begin_; });
+    if (it != body_.begin()) {
+      --it;
+    }
+    for (; it != body_.end() && it->begin_ < range.end(); ++it) {
+      chunks.push_back(*it);
+    }
+  }
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
+  for (const BodyChunk& chunk : chunks) {
+    uint64_t slice_begin = chunk.begin_;
+    for (const Buffer::RawSlice& slice : chunk.data_->getRawSlices()) {
+      const uint64_t begin = std::max(range.begin(), slice_begin) - slice_begin;
+      const uint64_t end = std::min(range.end(), slice_begin + slice.len_) - slice_begin;
+      slice_begin += slice.len_;
+      if (begin >= end) {
+        continue;
+      }
+      // The fragment keeps the chunk alive until the buffer is done with it, even if the entry is
+      // evicted in the meantime. Chunks are never modified, so their slices don't move.
+      auto fragment = new Buffer::BufferFragmentImpl(
+          static_cast<const char*>(slice.mem_) + begin, end - begin,
+          [chunk_data = chunk.data_](const void*, size_t,
+                                     const Buffer::BufferFragmentImpl* fragment) {
+            delete fragment;
+          });
+      buffer->addBufferFragment(*fragment);
+    }
+  }
+  return buffer;
 }
 
 void SimpleHttpCache::Entry::appendBody(Buffer::InstancePtr buf) {
+  if (buf->length() == 0) {
+    return;
+  }
+  // Moving the slices out of the source's buffer doesn't copy them.
+  auto data = std::make_shared<Buffer::OwnedImpl>();
+  data->move(*buf);
+  const uint64_t length = data->length();
   absl::WriterMutexLock lock(mu_);
-  body_ += buf->toString();
+  body_.push_back({body_size_, std::move(data)});
+  body_size_ += length;
 }
 
 uint64_t SimpleHttpCache::Entry::bodySize() const {
   absl::ReaderMutexLock lock(mu_);
-  return body_.size();
+  return body_size_;
+}
+
+uint64_t SimpleHttpCache::Entry::byteSize() const {
+  absl::ReaderMutexLock lock(mu_);
+  return response_headers_->byteSize() + body_size_ + (trailers_ ? trailers_->byteSize() : 0);
 }
 
 Http::ResponseHeaderMapPtr SimpleHttpCache::Entry::copyHeaders() const {
@@ -159,6 +229,192 @@ void SimpleHttpCache::Entry::setEndStreamAfterBody() {
   end_stream_after_body_ = true;
 }
 
+SimpleHttpCache::Shard::Shard(uint64_t max_size_bytes,
+                              std::shared_ptr<SimpleHttpCacheStats> stats)
+    : window_max_size_(max_size_bytes / 100 * WindowPercent),
+      main_max_size_(max_size_bytes - window_max_size_), stats_(std::move(stats)),
+      sketch_(max_size_bytes == std::numeric_limits<uint64_t>::max()
+                  ? 0
+                  : max_size_bytes / ExpectedEntrySize) {}
+
+std::shared_ptr<SimpleHttpCache::Entry> SimpleHttpCache::Shard::lookup(const Key& key,
+                                                                       uint64_t hash) {
+  absl::MutexLock lock(mu_);
+  sketch_.increment(hash);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    stats_->misses_.inc();
+    return nullptr;
+  }
+  stats_->hits_.inc();
+  Node& node = it->second;
+  if (node.region_ == Region::Window) {
+    window_.splice(window_.begin(), window_, node.lru_it_);
+  } else if (node.region_ == Region::Main) {
+    main_.splice(main_.begin(), main_, node.lru_it_);
+  }
+  return node.entry_;
+}
+
+void SimpleHttpCache::Shard::evict(const Key& key) {
+  absl::MutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    erase(it);
+  }
+}
+
+void SimpleHttpCache::Shard::updateHeaders(const Key& key,
+                                           const Http::ResponseHeaderMap& updated_headers,
+                                           const ResponseMetadata& updated_metadata) {
+  absl::MutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return;
+  }
+  Node& node = it->second;
+  node.entry_->updateHeadersAndMetadata(
+      Http::createHeaderMap<Http::ResponseHeaderMapImpl>(updated_headers), updated_metadata);
+  if (node.region_ == Region::Pending) {
+    return;
+  }
+  const uint64_t size = key.ByteSizeLong() + node.entry_->byteSize();
+  if (size > main_max_size_) {
+    // Larger headers can make an entry too large to ever be admitted to main.
+    stats_->evictions_.inc();
+    erase(it);
+    return;
+  }
+  uint64_t& region_size = node.region_ == Region::Window ? window_size_ : main_size_;
+  region_size = region_size - node.size_ + size;
+  stats_->size_bytes_.sub(node.size_);
+  stats_->size_bytes_.add(size);
+  node.size_ = size;
+  rebalance();
+}
+
+void SimpleHttpCache::Shard::insertPending(const Key& key, uint64_t hash,
+                                           std::shared_ptr<Entry> entry) {
+  absl::MutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    erase(it);
+  }
+  entries_.emplace(key, Node{std::move(entry), hash});
+}
+
+bool SimpleHttpCache::Shard::onInsertComplete(const Key& key,
+                                              const std::shared_ptr<Entry>& entry) {
+  absl::MutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.entry_ != entry) {
+    // Evicted or replaced while it was being written.
+    return false;
+  }
+  Node& node = it->second;
+  node.size_ = key.ByteSizeLong() + entry->byteSize();
+  if (node.size_ > main_max_size_) {
+    stats_->size_rejected_.inc();
+    erase(it);
+    return false;
+  }
+  node.region_ = Region::Window;
+  node.lru_it_ = window_.insert(window_.begin(), &it->first);
+  window_size_ += node.size_;
+  stats_->size_bytes_.add(node.size_);
+  stats_->size_count_.inc();
+  rebalance();
+  // The entry may have been moved out of the window straight away, and rejected by the admission
+  // policy.
+  it = entries_.find(key);
+  return it != entries_.end() && it->second.entry_ == entry;
+}
+
+void SimpleHttpCache::Shard::onInsertFailed(const Key& key, const std::shared_ptr<Entry>& entry) {
+  absl::MutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end() && it->second.entry_ == entry) {
+    erase(it);
+  }
+}
+
+void SimpleHttpCache::Shard::erase(Map::iterator it) {
+  Node& node = it->second;
+  if (node.region_ != Region::Pending) {
+    if (node.region_ == Region::Window) {
+      window_.erase(node.lru_it_);
+      window_size_ -= node.size_;
+    } else {
+      main_.erase(node.lru_it_);
+      main_size_ -= node.size_;
+    }
+    stats_->size_bytes_.sub(node.size_);
+    stats_->size_count_.dec();
+  }
+  entries_.erase(it);
+}
+
+void SimpleHttpCache::Shard::rebalance() {
+  while (window_size_ > window_max_size_) {
+    admitFromWindow();
+  }
+  while (main_size_ > main_max_size_) {
+    stats_->evictions_.inc();
+    erase(entries_.find(*main_.back()));
+  }
+}
+
+void SimpleHttpCache::Shard::admitFromWindow() {
+  auto candidate = entries_.find(*window_.back());
+  Node& node = candidate->second;
+  if (node.size_ > main_max_size_) {
+    stats_->size_rejected_.inc();
+    erase(candidate);
+    return;
+  }
+  // The candidate is only admitted if it is used more often than every entry it would evict, in
+  // which case they are all evicted, so nothing is evicted for a rejected candidate.
+  const uint32_t frequency = sketch_.frequency(node.hash_);
+  uint32_t victims = 0;
+  uint64_t freed = 0;
+  for (auto victim = main_.rbegin(); main_size_ - freed + node.size_ > main_max_size_; ++victim) {
+    // The candidate fits in an empty main, so this stops before running out of victims.
+    ASSERT(victim != main_.rend());
+    const Node& victim_node = entries_.find(**victim)->second;
+    if (frequency <= sketch_.frequency(victim_node.hash_)) {
+      stats_->admission_rejected_.inc();
+      erase(candidate);
+      return;
+    }
+    freed += victim_node.size_;
+    ++victims;
+  }
+  for (; victims > 0; --victims) {
+    stats_->evictions_.inc();
+    erase(entries_.find(*main_.back()));
+  }
+  window_.erase(node.lru_it_);
+  window_size_ -= node.size_;
+  node.region_ = Region::Main;
+  node.lru_it_ = main_.insert(main_.begin(), &candidate->first);
+  main_size_ += node.size_;
+}
+
+SimpleHttpCache::SimpleHttpCache(const ConfigProto& config, Stats::Scope& scope)
+    : config_(config),
+      stats_(std::make_shared<SimpleHttpCacheStats>(SimpleHttpCacheStats{
+          ALL_SIMPLE_HTTP_CACHE_STATS(POOL_COUNTER_PREFIX(scope, "cache.simple."),
+                                      POOL_GAUGE_PREFIX(scope, "cache.simple."))})) {
+  const uint32_t shards = std::max<uint32_t>(config.shards(), 1);
+  const uint64_t max_size_bytes = config.has_max_size_bytes()
+                                      ? config.max_size_bytes().value() / shards
+                                      : std::numeric_limits<uint64_t>::max();
+  shards_.reserve(shards);
+  for (uint32_t i = 0; i < shards; ++i) {
+    shards_.push_back(std::make_shared<Shard>(max_size_bytes, stats_));
+  }
+}
+
 CacheInfo SimpleHttpCache::cacheInfo() const {
   CacheInfo cache_info;
   cache_info.name_ = Name;
@@ -166,36 +422,27 @@ CacheInfo SimpleHttpCache::cacheInfo() const {
 }
 
 void SimpleHttpCache::lookup(LookupRequest&& request, LookupCallback&& callback) {
+  const uint64_t hash = MessageUtil::hash(request.key());
+  std::shared_ptr<Entry> entry = shardFor(hash).lookup(request.key(), hash);
   LookupResult result;
-  {
-    absl::ReaderMutexLock lock(mu_);
-    auto it = entries_.find(request.key());
-    if (it != entries_.end()) {
-      result.cache_reader_ = std::make_unique<SimpleHttpCacheReader>(it->second);
-      result.response_headers_ = it->second->copyHeaders();
-      result.response_metadata_ = it->second->metadata();
-      result.response_trailers_ = it->second->copyTrailers();
-      result.body_length_ = it->second->bodySize();
-    }
+  if (entry) {
+    result.response_headers_ = entry->copyHeaders();
+    result.response_metadata_ = entry->metadata();
+    result.response_trailers_ = entry->copyTrailers();
+    result.body_length_ = entry->bodySize();
+    result.cache_reader_ = std::make_unique<SimpleHttpCacheReader>(std::move(entry));
   }
   callback(std::move(result));
 }
 
 void SimpleHttpCache::evict(Event::Dispatcher&, const Key& key) {
-  absl::WriterMutexLock lock(mu_);
-  entries_.erase(key);
+  shardFor(MessageUtil::hash(key)).evict(key);
 }
 
 void SimpleHttpCache::updateHeaders(Event::Dispatcher&, const Key& key,
                                     const Http::ResponseHeaderMap& updated_headers,
                                     const ResponseMetadata& updated_metadata) {
-  absl::WriterMutexLock lock(mu_);
-  auto it = entries_.find(key);
-  if (it == entries_.end()) {
-    return;
-  }
-  it->second->updateHeadersAndMetadata(
-      Http::createHeaderMap<Http::ResponseHeaderMapImpl>(updated_headers), updated_metadata);
+  shardFor(MessageUtil::hash(key)).updateHeaders(key, updated_headers, updated_metadata);
 }
 
 void SimpleHttpCache::insert(Event::Dispatcher&, Key key, Http::ResponseHeaderMapPtr headers,
@@ -203,16 +450,19 @@ void SimpleHttpCache::insert(Event::Dispatcher&, Key key, Http::ResponseHeaderMa
                              std::shared_ptr<CacheProgressReceiver> progress) {
   auto entry = std::make_shared<Entry>(Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*headers),
                                        std::move(metadata));
-  {
-    absl::WriterMutexLock lock(mu_);
-    entries_.emplace(key, entry);
-  }
+  const uint64_t hash = MessageUtil::hash(key);
+  const std::shared_ptr<Shard>& shard = shards_[hash % shards_.size()];
+  shard->insertPending(key, hash, entry);
   if (source) {
     progress->onHeadersInserted(std::make_unique<SimpleHttpCacheReader>(entry), std::move(headers),
                                 false);
-    InsertContext::start(entry, std::move(progress), std::move(source));
+    InsertContext::start(shard, std::move(key), entry, std::move(progress), std::move(source));
   } else {
+    const bool kept = shard->onInsertComplete(key, entry);
     progress->onHeadersInserted(nullptr, std::move(headers), true);
+    if (!kept) {
+      progress->onInsertDiscarded();
+    }
   }
 }
 
@@ -229,12 +479,22 @@ public:
   }
   // From HttpCacheFactory
   absl::StatusOr<std::shared_ptr<CacheSessions>>
-  getCache(const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config&,
+  getCache(const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config& filter_config,
            Server::Configuration::ServerFactoryContext& context) override {
-    return context.singletonManager().getTyped<CacheSessions>(
-        SINGLETON_MANAGER_REGISTERED_NAME(simple_http_cache_v2_singleton), [&context]() {
-          return CacheSessions::create(context, std::make_unique<SimpleHttpCache>());
+    SimpleHttpCache::ConfigProto config;
+    RETURN_IF_NOT_OK(MessageUtil::unpackTo(filter_config.typed_config(), config));
+    std::shared_ptr<CacheSessions> cache = context.singletonManager().getTyped<CacheSessions>(
+        SINGLETON_MANAGER_REGISTERED_NAME(simple_http_cache_v2_singleton), [&context, &config]() {
+          return CacheSessions::create(context,
+                                       std::make_unique<SimpleHttpCache>(config, context.scope()));
         });
+    const SimpleHttpCache& simple_cache = static_cast<const SimpleHttpCache&>(cache->cache());
+    if (!Protobuf::util::MessageDifferencer::Equals(simple_cache.config(), config)) {
+      return absl::InvalidArgumentError(
+          fmt::format("mismatched SimpleHttpCacheV2Config\n{}\nvs.\n{}",
+                      simple_cache.config().DebugString(), config.DebugString()));
+    }
+    return cache;
   }
 
 private:
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <list>
+
+#include "envoy/extensions/http/cache_v2/simple_http_cache/v3/config.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
 #include "source/common/protobuf/utility.h"
 #include "source/extensions/filters/http/cache_v2/http_cache.h"
+#include "source/extensions/http/cache_v2/simple_http_cache/frequency_sketch.h"
 
 #include "absl/base/thread_annotations.h"
-#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/synchronization/mutex.h"
 
 namespace Envoy {
@@ -12,16 +19,44 @@ namespace Extensions {
 namespace HttpFilters {
 namespace CacheV2 {
 
-// Example cache backend that never evicts. Not suitable for production use.
+/**
+ * All simple cache stats. @see stats_macros.h
+ *
+ * size_bytes and size_count only count entries that have been completely written.
+ **/
+#define ALL_SIMPLE_HTTP_CACHE_STATS(COUNTER, GAUGE)                                                \
+  COUNTER(admission_rejected)                                                                      \
+  COUNTER(evictions)                                                                               \
+  COUNTER(hits)                                                                                    \
+  COUNTER(misses)                                                                                  \
+  COUNTER(size_rejected)                                                                           \
+  GAUGE(size_bytes, NeverImport)                                                                   \
+  GAUGE(size_count, NeverImport)
+
+struct SimpleHttpCacheStats {
+  ALL_SIMPLE_HTTP_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+// In-memory cache backend. Entries are spread over lock-striped shards by the hash of their key,
+// and each shard keeps its share of the byte budget with a W-TinyLFU policy: new entries go into
+// a small LRU window, and leave it for the main LRU only if they have been looked up more often
+// than the entry they would evict from it. Entries larger than the main LRU of a shard are never
+// admitted, and are counted as size_rejected.
 class SimpleHttpCache : public HttpCache {
 public:
+  using ConfigProto =
+      envoy::extensions::http::cache_v2::simple_http_cache::v3::SimpleHttpCacheV2Config;
+
   class Entry {
   public:
     Entry(Http::ResponseHeaderMapPtr response_headers, ResponseMetadata metadata)
         : response_headers_(std::move(response_headers)), metadata_(std::move(metadata)) {}
+    // The returned buffer references the stored body rather than copying it.
     Buffer::InstancePtr body(AdjustedByteRange range) const;
     void appendBody(Buffer::InstancePtr buf);
     uint64_t bodySize() const;
+    // The size of the headers, body and trailers.
+    uint64_t byteSize() const;
     Http::ResponseHeaderMapPtr copyHeaders() const;
     Http::ResponseTrailerMapPtr copyTrailers() const;
     ResponseMetadata metadata() const;
@@ -31,15 +66,79 @@ public:
     void setEndStreamAfterBody();
 
   private:
+    struct BodyChunk {
+      // The offset of the chunk in the body.
+      uint64_t begin_;
+      // The slices of the buffer the chunk was inserted with, which are referenced by the
+      // buffers of readers rather than copied.
+      std::shared_ptr<const Buffer::Instance> data_;
+    };
+
     mutable absl::Mutex mu_;
-    // Body can be being written to while being read from, so mutex guarded.
-    std::string body_ ABSL_GUARDED_BY(mu_);
+    // Body can be being written to while being read from, so mutex guarded. Chunks are never
+    // modified once appended, so readers can hold on to them after releasing the mutex.
+    std::vector<BodyChunk> body_ ABSL_GUARDED_BY(mu_);
+    uint64_t body_size_ ABSL_GUARDED_BY(mu_){0};
     Http::ResponseHeaderMapPtr response_headers_ ABSL_GUARDED_BY(mu_);
     ResponseMetadata metadata_ ABSL_GUARDED_BY(mu_);
-    bool end_stream_after_body_{false};
-    Http::ResponseTrailerMapPtr trailers_;
+    bool end_stream_after_body_ ABSL_GUARDED_BY(mu_){false};
+    Http::ResponseTrailerMapPtr trailers_ ABSL_GUARDED_BY(mu_);
+  };
+
+  // A part of the cache with its own lock, byte budget and frequency sketch.
+  class Shard {
+  public:
+    Shard(uint64_t max_size_bytes, std::shared_ptr<SimpleHttpCacheStats> stats);
+
+    std::shared_ptr<Entry> lookup(const Key& key, uint64_t hash);
+    void evict(const Key& key);
+    void updateHeaders(const Key& key, const Http::ResponseHeaderMap& updated_headers,
+                       const ResponseMetadata& updated_metadata);
+    // Adds an entry that is still being written, replacing any entry with the same key. It can
+    // be looked up straight away, but is only accounted for once it is complete.
+    void insertPending(const Key& key, uint64_t hash, std::shared_ptr<Entry> entry);
+    // Admits or rejects a completely written entry. Returns false if the entry is no longer
+    // cached afterwards.
+    bool onInsertComplete(const Key& key, const std::shared_ptr<Entry>& entry);
+    void onInsertFailed(const Key& key, const std::shared_ptr<Entry>& entry);
+
+  private:
+    enum class Region { Pending, Window, Main };
+    using Lru = std::list<const Key*>;
+    struct Node {
+      std::shared_ptr<Entry> entry_;
+      uint64_t hash_;
+      uint64_t size_{0};
+      Region region_{Region::Pending};
+      Lru::iterator lru_it_;
+    };
+    using Map = absl::node_hash_map<Key, Node, MessageUtil, MessageUtil>;
+
+    void erase(Map::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    // Moves entries out of the window and out of the main LRU until both fit their budgets.
+    void rebalance() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    // Moves the least recently used entry of the window into the main LRU if it is looked up
+    // more often than the entries it evicts, or rejects it.
+    void admitFromWindow() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+    const uint64_t window_max_size_;
+    const uint64_t main_max_size_;
+    const std::shared_ptr<SimpleHttpCacheStats> stats_;
+    absl::Mutex mu_;
+    // Keys in the LRUs point into the map, whose nodes do not move.
+    Map entries_ ABSL_GUARDED_BY(mu_);
+    Lru window_ ABSL_GUARDED_BY(mu_);
+    Lru main_ ABSL_GUARDED_BY(mu_);
+    uint64_t window_size_ ABSL_GUARDED_BY(mu_){0};
+    uint64_t main_size_ ABSL_GUARDED_BY(mu_){0};
+    FrequencySketch sketch_ ABSL_GUARDED_BY(mu_);
   };
 
+  SimpleHttpCache(const ConfigProto& config, Stats::Scope& scope);
+
+  const ConfigProto& config() const { return config_; }
+  const SimpleHttpCacheStats& stats() const { return *stats_; }
+
   // HttpCache
   CacheInfo cacheInfo() const override;
   void lookup(LookupRequest&& request, LookupCallback&& callback) override;
@@ -53,9 +152,13 @@ public:
               ResponseMetadata metadata, HttpSourcePtr source,
               std::shared_ptr<CacheProgressReceiver> progress) override;
 
-  absl::Mutex mu_;
-  absl::flat_hash_map<Key, std::shared_ptr<Entry>, MessageUtil, MessageUtil>
-      entries_ ABSL_GUARDED_BY(mu_);
+private:
+  Shard& shardFor(uint64_t hash) { return *shards_[hash % shards_.size()]; }
+
+  const ConfigProto config_;
+  const std::shared_ptr<SimpleHttpCacheStats> stats_;
+  // Shared with the inserts in progress, which may outlive the cache.
+  std::vector<std::shared_ptr<Shard>> shards_;
 };
 
 } // namespace CacheV2
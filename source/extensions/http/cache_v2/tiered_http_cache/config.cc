@@ -0,0 +1,115 @@
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/http/cache_v2/tiered_http_cache/v3/tiered_http_cache.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/cache_v2/cache_sessions.h"
+#include "source/extensions/filters/http/cache_v2/http_cache.h"
+#include "source/extensions/http/cache_v2/tiered_http_cache/tiered_http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace {
+
+/**
+ * Creates one tier of a tiered cache with the factory registered for its type.
+ * @return the cache of the tier, which keeps the CacheSessions it belongs to alive.
+ */
+absl::StatusOr<std::shared_ptr<HttpCache>>
+createTier(const Protobuf::Any& typed_config,
+           Server::Configuration::ServerFactoryContext& context) {
+  const std::string type{TypeUtil::typeUrlToDescriptorFullName(typed_config.type_url())};
+  HttpCacheFactory* const factory =
+      Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(type);
+  if (factory == nullptr) {
+    return absl::InvalidArgumentError(
+        fmt::format("Didn't find a registered implementation for type: '{}'", type));
+  }
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config tier_config;
+  *tier_config.mutable_typed_config() = typed_config;
+  absl::StatusOr<std::shared_ptr<CacheSessions>> sessions =
+      factory->getCache(tier_config, context);
+  RETURN_IF_NOT_OK_REF(sessions.status());
+  HttpCache& cache = (*sessions)->cache();
+  return std::shared_ptr<HttpCache>(*std::move(sessions), &cache);
+}
+
+/**
+ * A singleton that hands out the same tiered cache for equal configs, so that the filters sharing
+ * a config also share the hit counts of its disk tier.
+ */
+class CacheSingleton : public Envoy::Singleton::Instance {
+public:
+  absl::StatusOr<std::shared_ptr<CacheSessions>>
+  get(const TieredHttpCache::ConfigProto& config,
+      Server::Configuration::ServerFactoryContext& context) {
+    const uint64_t key = MessageUtil::hash(config);
+    {
+      absl::MutexLock lock(mu_);
+      auto it = caches_.find(key);
+      if (it != caches_.end()) {
+        if (std::shared_ptr<CacheSessions> cache = it->second.lock()) {
+          return cache;
+        }
+      }
+    }
+    // The tiers are created without holding the lock, as a tier may itself be a tiered cache.
+    absl::StatusOr<std::shared_ptr<HttpCache>> memory_tier =
+        createTier(config.memory_tier(), context);
+    RETURN_IF_NOT_OK_REF(memory_tier.status());
+    absl::StatusOr<std::shared_ptr<HttpCache>> disk_tier = createTier(config.disk_tier(), context);
+    RETURN_IF_NOT_OK_REF(disk_tier.status());
+    std::shared_ptr<CacheSessions> cache = CacheSessions::create(
+        context, std::make_unique<TieredHttpCache>(
+                     *std::move(memory_tier), *std::move(disk_tier),
+                     PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, promote_after_hits, 2),
+                     context.scope()));
+    absl::MutexLock lock(mu_);
+    caches_[key] = cache;
+    return cache;
+  }
+
+private:
+  absl::Mutex mu_;
+  // We keep weak_ptr here so the caches can be destroyed once no filter config uses them.
+  absl::flat_hash_map<uint64_t, std::weak_ptr<CacheSessions>> caches_ ABSL_GUARDED_BY(mu_);
+};
+
+SINGLETON_MANAGER_REGISTRATION(tiered_http_cache_v2_singleton);
+
+class TieredHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return "envoy.extensions.http.cache_v2.tiered_http_cache"; }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<TieredHttpCache::ConfigProto>();
+  }
+  // From HttpCacheFactory
+  absl::StatusOr<std::shared_ptr<CacheSessions>>
+  getCache(const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config& filter_config,
+           Server::Configuration::ServerFactoryContext& context) override {
+    TieredHttpCache::ConfigProto config;
+    RETURN_IF_NOT_OK(MessageUtil::unpackTo(filter_config.typed_config(), config));
+    if (!config.has_memory_tier() || !config.has_disk_tier()) {
+      return absl::InvalidArgumentError(
+          "TieredHttpCacheV2Config requires both memory_tier and disk_tier");
+    }
+    std::shared_ptr<CacheSingleton> caches = context.singletonManager().getTyped<CacheSingleton>(
+        SINGLETON_MANAGER_REGISTERED_NAME(tiered_http_cache_v2_singleton),
+        [] { return std::make_shared<CacheSingleton>(); }, true);
+    return caches->get(config, context);
+  }
+};
+
+static Registry::RegisterFactory<TieredHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,236 @@
+#include "source/extensions/http/cache_v2/tiered_http_cache/tiered_http_cache.h"
+
+#include <algorithm>
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/cache_v2/cache_progress_receiver.h"
+#include "source/extensions/filters/http/cache_v2/http_source.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace {
+
+constexpr absl::string_view Name = "envoy.extensions.http.cache_v2.tiered_http_cache";
+
+// Feeds a response read back from the disk tier into an insert into the memory tier.
+class CacheReaderHttpSource : public HttpSource {
+public:
+  CacheReaderHttpSource(Event::Dispatcher& dispatcher, CacheReaderPtr reader, uint64_t body_length,
+                        Http::ResponseTrailerMapPtr trailers)
+      : dispatcher_(dispatcher), reader_(std::move(reader)), body_length_(body_length),
+        trailers_(std::move(trailers)) {}
+
+  // The headers are passed to the insert directly.
+  void getHeaders(GetHeadersCallback&& cb) override { cb(nullptr, EndStream::Reset); }
+
+  void getBody(AdjustedByteRange range, GetBodyCallback&& cb) override {
+    if (range.begin() >= body_length_) {
+      cb(nullptr, trailers_ ? EndStream::More : EndStream::End);
+      return;
+    }
+    const uint64_t begin = range.begin();
+    reader_->getBody(dispatcher_, AdjustedByteRange(begin, std::min(range.end(), body_length_)),
+                     [this, begin, cb = std::move(cb)](Buffer::InstancePtr buffer,
+                                                       EndStream end_stream) mutable {
+                       if (buffer == nullptr || end_stream == EndStream::Reset) {
+                         cb(nullptr, EndStream::Reset);
+                         return;
+                       }
+                       const bool last = begin + buffer->length() >= body_length_ && !trailers_;
+                       cb(std::move(buffer), last ? EndStream::End : EndStream::More);
+                     });
+  }
+
+  void getTrailers(GetTrailersCallback&& cb) override {
+    cb(std::move(trailers_), EndStream::End);
+  }
+
+private:
+  Event::Dispatcher& dispatcher_;
+  CacheReaderPtr reader_;
+  const uint64_t body_length_;
+  Http::ResponseTrailerMapPtr trailers_;
+};
+
+// Ends the promotion once the memory tier is done with the insert, whether it succeeded or not.
+class PromotionProgressReceiver : public CacheProgressReceiver {
+public:
+  PromotionProgressReceiver(std::shared_ptr<TieredHttpCache::Tiers> tiers,
+                            Event::Dispatcher& dispatcher, Key key, uint64_t hash)
+      : tiers_(std::move(tiers)), dispatcher_(dispatcher), key_(std::move(key)), hash_(hash) {}
+  ~PromotionProgressReceiver() override {
+    if (tiers_->tracker_.onPromotionDone(hash_)) {
+      // The response was replaced or evicted while it was being promoted.
+      tiers_->memory_->evict(dispatcher_, key_);
+    }
+  }
+
+  // CacheProgressReceiver
+  void onHeadersInserted(CacheReaderPtr, Http::ResponseHeaderMapPtr, bool) override {}
+  void onBodyInserted(AdjustedByteRange, bool) override {}
+  void onTrailersInserted(Http::ResponseTrailerMapPtr) override {}
+  void onInsertFailed(absl::Status) override { tiers_->stats_.promotion_failures_.inc(); }
+  // The memory tier didn't admit the response, e.g. because its admission policy prefers the
+  // responses it would have to evict for it.
+  void onInsertDiscarded() override { tiers_->stats_.promotion_failures_.inc(); }
+
+private:
+  const std::shared_ptr<TieredHttpCache::Tiers> tiers_;
+  Event::Dispatcher& dispatcher_;
+  const Key key_;
+  const uint64_t hash_;
+};
+
+// Reads the response back from the disk tier and inserts it into the memory tier.
+void promote(std::shared_ptr<TieredHttpCache::Tiers> tiers, Event::Dispatcher& dispatcher, Key key,
+             uint64_t hash) {
+  tiers->stats_.promotions_.inc();
+  auto progress = std::make_shared<PromotionProgressReceiver>(tiers, dispatcher, key, hash);
+  std::shared_ptr<HttpCache> disk = tiers->disk_;
+  LookupRequest request(Key(key), dispatcher);
+  disk->lookup(
+      std::move(request),
+      [tiers = std::move(tiers), &dispatcher, key = std::move(key),
+       progress = std::move(progress)](absl::StatusOr<LookupResult>&& result) mutable {
+        if (!result.ok() || !result->populated()) {
+          // Evicted from the disk tier in the meantime.
+          progress->onInsertFailed(result.ok() ? absl::NotFoundError("evicted") : result.status());
+          return;
+        }
+        const uint64_t body_length = result->body_length_.value();
+        HttpSourcePtr source;
+        if (body_length > 0 || result->response_trailers_ != nullptr) {
+          source = std::make_unique<CacheReaderHttpSource>(dispatcher,
+                                                           std::move(result->cache_reader_),
+                                                           body_length,
+                                                           std::move(result->response_trailers_));
+        }
+        tiers->memory_->insert(dispatcher, std::move(key), std::move(result->response_headers_),
+                               result->response_metadata_, std::move(source),
+                               std::move(progress));
+      });
+}
+
+} // namespace
+
+bool TieredHttpCache::PromotionTracker::onDiskHit(uint64_t hash) {
+  absl::MutexLock lock(mu_);
+  if (promoting_.contains(hash)) {
+    return false;
+  }
+  if (disk_hits_.size() >= MaxTrackedKeys && !disk_hits_.contains(hash)) {
+    disk_hits_.clear();
+  }
+  uint32_t& hits = disk_hits_[hash];
+  if (++hits < promote_after_hits_) {
+    return false;
+  }
+  disk_hits_.erase(hash);
+  promoting_.insert(hash);
+  return true;
+}
+
+bool TieredHttpCache::PromotionTracker::onPromotionDone(uint64_t hash) {
+  absl::MutexLock lock(mu_);
+  promoting_.erase(hash);
+  return invalidated_.erase(hash) > 0;
+}
+
+void TieredHttpCache::PromotionTracker::forget(uint64_t hash) {
+  absl::MutexLock lock(mu_);
+  disk_hits_.erase(hash);
+  if (promoting_.contains(hash)) {
+    invalidated_.insert(hash);
+  }
+}
+
+TieredHttpCache::Tiers::Tiers(std::shared_ptr<HttpCache> memory, std::shared_ptr<HttpCache> disk,
+                              uint32_t promote_after_hits, Stats::Scope& scope)
+    : memory_(std::move(memory)), disk_(std::move(disk)),
+      tracker_(std::max<uint32_t>(promote_after_hits, 1)),
+      stats_{ALL_TIERED_HTTP_CACHE_STATS(POOL_COUNTER_PREFIX(scope, "cache.tiered."))} {}
+
+TieredHttpCache::TieredHttpCache(std::shared_ptr<HttpCache> memory_tier,
+                                 std::shared_ptr<HttpCache> disk_tier, uint32_t promote_after_hits,
+                                 Stats::Scope& scope)
+    : tiers_(std::make_shared<Tiers>(std::move(memory_tier), std::move(disk_tier),
+                                     promote_after_hits, scope)) {}
+
+CacheInfo TieredHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = Name;
+  return cache_info;
+}
+
+void TieredHttpCache::lookup(LookupRequest&& request, LookupCallback&& callback) {
+  Event::Dispatcher& dispatcher = request.dispatcher();
+  Key key = request.key();
+  tiers_->memory_->lookup(
+      std::move(request),
+      [tiers = tiers_, &dispatcher, key = std::move(key),
+       callback = std::move(callback)](absl::StatusOr<LookupResult>&& result) mutable {
+        if (result.ok() && result->populated()) {
+          tiers->stats_.memory_hits_.inc();
+          callback(std::move(result));
+          return;
+        }
+        // A failure of the memory tier is treated as a miss, as the disk tier has every response.
+        std::shared_ptr<HttpCache> disk = tiers->disk_;
+        LookupRequest disk_request(Key(key), dispatcher);
+        disk->lookup(std::move(disk_request),
+                     [tiers = std::move(tiers), &dispatcher, key = std::move(key),
+                      callback = std::move(callback)](
+                         absl::StatusOr<LookupResult>&& result) mutable {
+                       if (!result.ok() || !result->populated()) {
+                         tiers->stats_.misses_.inc();
+                         callback(std::move(result));
+                         return;
+                       }
+                       tiers->stats_.disk_hits_.inc();
+                       callback(std::move(result));
+                       const uint64_t hash = MessageUtil::hash(key);
+                       if (tiers->tracker_.onDiskHit(hash)) {
+                         promote(std::move(tiers), dispatcher, std::move(key), hash);
+                       }
+                     });
+      });
+}
+
+void TieredHttpCache::evict(Event::Dispatcher& dispatcher, const Key& key) {
+  tiers_->tracker_.forget(MessageUtil::hash(key));
+  tiers_->memory_->evict(dispatcher, key);
+  tiers_->disk_->evict(dispatcher, key);
+}
+
+void TieredHttpCache::touch(const Key& key, SystemTime timestamp) {
+  tiers_->memory_->touch(key, timestamp);
+  tiers_->disk_->touch(key, timestamp);
+}
+
+void TieredHttpCache::updateHeaders(Event::Dispatcher& dispatcher, const Key& key,
+                                    const Http::ResponseHeaderMap& updated_headers,
+                                    const ResponseMetadata& updated_metadata) {
+  // A promotion in progress may already have read the old headers from the disk tier, and would
+  // insert them into the memory tier after this update.
+  tiers_->tracker_.forget(MessageUtil::hash(key));
+  tiers_->memory_->updateHeaders(dispatcher, key, updated_headers, updated_metadata);
+  tiers_->disk_->updateHeaders(dispatcher, key, updated_headers, updated_metadata);
+}
+
+void TieredHttpCache::insert(Event::Dispatcher& dispatcher, Key key,
+                             Http::ResponseHeaderMapPtr headers, ResponseMetadata metadata,
+                             HttpSourcePtr source,
+                             std::shared_ptr<CacheProgressReceiver> progress) {
+  // The new response is promoted again once it has been hit often enough on disk.
+  tiers_->tracker_.forget(MessageUtil::hash(key));
+  tiers_->memory_->evict(dispatcher, key);
+  tiers_->disk_->insert(dispatcher, std::move(key), std::move(headers), std::move(metadata),
+                        std::move(source), std::move(progress));
+}
+
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
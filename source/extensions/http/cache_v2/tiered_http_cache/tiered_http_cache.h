@@ -0,0 +1,104 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/extensions/http/cache_v2/tiered_http_cache/v3/tiered_http_cache.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/extensions/filters/http/cache_v2/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+
+/**
+ * All tiered cache stats. @see stats_macros.h
+ **/
+#define ALL_TIERED_HTTP_CACHE_STATS(COUNTER)                                                       \
+  COUNTER(disk_hits)                                                                               \
+  COUNTER(memory_hits)                                                                             \
+  COUNTER(misses)                                                                                  \
+  COUNTER(promotion_failures)                                                                      \
+  COUNTER(promotions)
+
+struct TieredHttpCacheStats {
+  ALL_TIERED_HTTP_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+// A cache backend made of a fast memory tier in front of a slow disk tier. Responses are written
+// to the disk tier, and copied into the memory tier once they have been hit there often enough.
+// Evicting a response from the memory tier drops it from memory only, as it is still on disk.
+class TieredHttpCache : public HttpCache {
+public:
+  using ConfigProto =
+      envoy::extensions::http::cache_v2::tiered_http_cache::v3::TieredHttpCacheV2Config;
+
+  // Counts the disk tier hits of each key, and the promotions in progress.
+  class PromotionTracker {
+  public:
+    explicit PromotionTracker(uint32_t promote_after_hits)
+        : promote_after_hits_(promote_after_hits) {}
+
+    // Records a disk tier hit, and returns true if the caller should promote the key.
+    bool onDiskHit(uint64_t hash);
+    // Returns true if the key was forgotten while it was being promoted, in which case the
+    // promoted response is stale.
+    bool onPromotionDone(uint64_t hash);
+    // Forgets the hits of a key whose response was replaced or evicted.
+    void forget(uint64_t hash);
+
+  private:
+    // Past this many keys the hit counts are cleared, so that the table stays bounded and old hits
+    // age out.
+    static constexpr size_t MaxTrackedKeys = 100000;
+
+    const uint32_t promote_after_hits_;
+    absl::Mutex mu_;
+    absl::flat_hash_map<uint64_t, uint32_t> disk_hits_ ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_set<uint64_t> promoting_ ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_set<uint64_t> invalidated_ ABSL_GUARDED_BY(mu_);
+  };
+
+  // Everything the lookups and promotions in flight use, as they may outlive the cache.
+  struct Tiers {
+    Tiers(std::shared_ptr<HttpCache> memory, std::shared_ptr<HttpCache> disk,
+          uint32_t promote_after_hits, Stats::Scope& scope);
+
+    const std::shared_ptr<HttpCache> memory_;
+    const std::shared_ptr<HttpCache> disk_;
+    PromotionTracker tracker_;
+    TieredHttpCacheStats stats_;
+  };
+
+  TieredHttpCache(std::shared_ptr<HttpCache> memory_tier, std::shared_ptr<HttpCache> disk_tier,
+                  uint32_t promote_after_hits, Stats::Scope& scope);
+
+  const TieredHttpCacheStats& stats() const { return tiers_->stats_; }
+
+  // HttpCache
+  CacheInfo cacheInfo() const override;
+  void lookup(LookupRequest&& request, LookupCallback&& callback) override;
+  void evict(Event::Dispatcher& dispatcher, const Key& key) override;
+  void touch(const Key& key, SystemTime timestamp) override;
+  void updateHeaders(Event::Dispatcher& dispatcher, const Key& key,
+                     const Http::ResponseHeaderMap& updated_headers,
+                     const ResponseMetadata& updated_metadata) override;
+  void insert(Event::Dispatcher& dispatcher, Key key, Http::ResponseHeaderMapPtr headers,
+              ResponseMetadata metadata, HttpSourcePtr source,
+              std::shared_ptr<CacheProgressReceiver> progress) override;
+
+private:
+  const std::shared_ptr<Tiers> tiers_;
+};
+
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,40 @@
+#include "source/extensions/transport_sockets/tls/private_key_providers/software/config.h"
+
+#include <memory>
+
+#include "envoy/extensions/transport_sockets/tls/private_key_providers/software/v3/software.pb.h"
+#include "envoy/extensions/transport_sockets/tls/private_key_providers/software/v3/software.pb.validate.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/transport_socket_config.h"
+
+#include "source/common/config/utility.h"
+#include "source/common/protobuf/message_validator_impl.h"
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/transport_sockets/tls/private_key_providers/software/software_private_key_provider.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace Software {
+
+using ConfigProto = envoy::extensions::transport_sockets::tls::private_key_providers::software::v3::
+    SoftwarePrivateKeyMethodConfig;
+
+Ssl::PrivateKeyMethodProviderSharedPtr
+SoftwarePrivateKeyMethodFactory::createPrivateKeyMethodProviderInstance(
+    const envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider& proto_config,
+    Server::Configuration::TransportSocketFactoryContext& private_key_provider_context) {
+  ConfigProto message;
+  THROW_IF_NOT_OK(Config::Utility::translateOpaqueConfig(
+      proto_config.typed_config(), ProtobufMessage::getNullValidationVisitor(), message));
+  const ConfigProto& conf = MessageUtil::downcastAndValidate<const ConfigProto&>(
+      message, private_key_provider_context.messageValidationVisitor());
+  return std::make_shared<SoftwarePrivateKeyMethodProvider>(conf, private_key_provider_context);
+}
+
+REGISTER_FACTORY(SoftwarePrivateKeyMethodFactory, Ssl::PrivateKeyMethodProviderInstanceFactory);
+
+} // namespace Software
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,445 @@
+#include "source/extensions/transport_sockets/tls/private_key_providers/software/software_private_key_provider.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/singleton/manager.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/config/datasource.h"
+#include "source/common/protobuf/utility.h"
+
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace Software {
+
+SINGLETON_MANAGER_REGISTRATION(software_private_key_queues);
+
+SoftwarePrivateKeyStats generateSoftwarePrivateKeyStats(Stats::Scope& scope) {
+  const std::string prefix = "software_private_key.";
+  return SoftwarePrivateKeyStats{
+      ALL_SOFTWARE_PRIVATE_KEY_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                     POOL_HISTOGRAM_PREFIX(scope, prefix))};
+}
+
+void ResultPoster::post(Event::PostCb callback) {
+  absl::MutexLock lock(mutex_);
+  if (dispatcher_ != nullptr) {
+    dispatcher_->post(std::move(callback));
+  }
+}
+
+void ResultPoster::close() {
+  absl::MutexLock lock(mutex_);
+  dispatcher_ = nullptr;
+}
+
+KeyOperation::KeyOperation(Type type, bssl::UniquePtr<EVP_PKEY> pkey,
+                           uint16_t signature_algorithm, const uint8_t* in, size_t in_len,
+                           ResultPosterSharedPtr poster, Ssl::PrivateKeyConnectionCallbacks* cb,
+                           MonotonicTime enqueue_time)
+    : type_(type), pkey_(std::move(pkey)), signature_algorithm_(signature_algorithm),
+      input_(in, in + in_len), poster_(std::move(poster)), cb_(cb), enqueue_time_(enqueue_time) {}
+
+void KeyOperation::execute(TimeSource& time_source, uint32_t batch_size) {
+  batch_size_ = batch_size;
+  start_time_ = time_source.monotonicTime();
+  succeeded_ = type_ == Type::Sign ? sign() : decrypt();
+  end_time_ = time_source.monotonicTime();
+}
+
+bool KeyOperation::sign() {
+  if (EVP_PKEY_id(pkey_.get()) != SSL_get_signature_algorithm_key_type(signature_algorithm_)) {
+    return false;
+  }
+
+  // Ed25519 signs the message directly, so a null digest is valid here.
+  const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm_);
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pctx;
+  if (!EVP_DigestSignInit(ctx.get(), &pctx, md, nullptr, pkey_.get())) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm_) &&
+      (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+       !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+    return false;
+  }
+
+  size_t out_len = EVP_PKEY_size(pkey_.get());
+  output_.resize(out_len);
+  if (!EVP_DigestSign(ctx.get(), output_.data(), &out_len, input_.data(), input_.size())) {
+    return false;
+  }
+  output_.resize(out_len);
+  return true;
+}
+
+bool KeyOperation::decrypt() {
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+  if (rsa == nullptr) {
+    return false;
+  }
+
+  size_t out_len = RSA_size(rsa);
+  output_.resize(out_len);
+  if (!RSA_decrypt(rsa, &out_len, output_.data(), output_.size(), input_.data(), input_.size(),
+                   RSA_NO_PADDING)) {
+    return false;
+  }
+  output_.resize(out_len);
+  return true;
+}
+
+bool KeyOperation::markDone() {
+  State expected = State::Queued;
+  return state_.compare_exchange_strong(expected, State::Done);
+}
+
+void KeyOperation::deliver() {
+  if (state() == State::Cancelled) {
+    // The connection has gone away while the operation was in flight.
+    return;
+  }
+  ASSERT(state() == State::Done);
+  completed_ = true;
+  cb_->onPrivateKeyMethodComplete();
+}
+
+std::chrono::microseconds KeyOperation::queueTime() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(start_time_ - enqueue_time_);
+}
+
+std::chrono::microseconds KeyOperation::operationTime() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end_time_ - start_time_);
+}
+
+KeyOperationQueue::KeyOperationQueue(uint32_t thread_count, uint32_t max_batch_size,
+                                     uint32_t max_pending_operations,
+                                     ThreadLocal::SlotAllocator& tls,
+                                     Thread::ThreadFactory& thread_factory,
+                                     TimeSource& time_source)
+    : max_batch_size_(max_batch_size), max_pending_operations_(max_pending_operations),
+      time_source_(time_source),
+      poster_slot_(ThreadLocal::TypedSlot<ThreadLocalResultPoster>::makeUnique(tls)) {
+  ASSERT(thread_count > 0);
+  ASSERT(max_batch_size > 0);
+  poster_slot_->set([](Event::Dispatcher& dispatcher) {
+    return std::make_shared<ThreadLocalResultPoster>(dispatcher);
+  });
+  threads_.reserve(thread_count);
+  while (threads_.size() < thread_count) {
+    threads_.push_back(
+        thread_factory.createThread([this]() { worker(); }, Thread::Options{"PrivateKeyOps"}));
+  }
+}
+
+KeyOperationQueue::~KeyOperationQueue() {
+  {
+    absl::MutexLock lock(mutex_);
+    terminate_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+uint64_t KeyOperationQueue::enqueue(KeyOperationSharedPtr operation) {
+  absl::MutexLock lock(mutex_);
+  if (max_pending_operations_ > 0 && queue_.size() >= max_pending_operations_) {
+    return 0;
+  }
+  queue_.push_back(std::move(operation));
+  return queue_.size();
+}
+
+void KeyOperationQueue::waitForIdle() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return queue_.empty() && active_batches_ == 0;
+  };
+  absl::MutexLock lock(mutex_);
+  mutex_.Await(absl::Condition(&condition));
+}
+
+void KeyOperationQueue::worker() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !queue_.empty() || terminate_;
+  };
+  std::vector<KeyOperationSharedPtr> batch;
+  batch.reserve(max_batch_size_);
+  while (true) {
+    {
+      absl::MutexLock lock(mutex_);
+      if (!batch.empty()) {
+        active_batches_--;
+        batch.clear();
+      }
+      mutex_.Await(absl::Condition(&condition));
+      if (terminate_) {
+        // Any operations left in the queue belong to connections that no longer exist,
+        // because the queue lives until the server shuts down.
+        return;
+      }
+      while (!queue_.empty() && batch.size() < max_batch_size_) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      active_batches_++;
+    }
+    processBatch(batch);
+  }
+}
+
+void KeyOperationQueue::processBatch(std::vector<KeyOperationSharedPtr>& batch) {
+  ENVOY_LOG(trace, "software private key provider processing {} operations", batch.size());
+
+  // Results are grouped by the thread of the connection that submitted them, so that
+  // each worker is woken up once per batch instead of once per operation.
+  absl::flat_hash_map<ResultPoster*, std::vector<KeyOperationSharedPtr>> results;
+  for (KeyOperationSharedPtr& operation : batch) {
+    if (operation->state() == KeyOperation::State::Cancelled) {
+      continue;
+    }
+    operation->execute(time_source_, batch.size());
+    if (!operation->markDone()) {
+      continue;
+    }
+    results[&operation->poster()].push_back(operation);
+  }
+
+  // The operations keep their posters alive, and a poster whose thread has shut down drops
+  // its results.
+  for (auto& [poster, operations] : results) {
+    poster->post([operations = std::move(operations)]() {
+      for (const KeyOperationSharedPtr& operation : operations) {
+        operation->deliver();
+      }
+    });
+  }
+}
+
+KeyOperationQueues::KeyOperationQueues(ThreadLocal::SlotAllocator& tls,
+                                       Thread::ThreadFactory& thread_factory,
+                                       TimeSource& time_source)
+    : tls_(tls), thread_factory_(thread_factory), time_source_(time_source) {}
+
+std::shared_ptr<KeyOperationQueues>
+KeyOperationQueues::singleton(Server::Configuration::ServerFactoryContext& context) {
+  // Pinned, so that the queues and their crypto threads are only destroyed on the main thread
+  // at shutdown, rather than wherever the last provider happens to be released.
+  return context.singletonManager().getTyped<KeyOperationQueues>(
+      SINGLETON_MANAGER_REGISTERED_NAME(software_private_key_queues),
+      [&context] {
+        return std::make_shared<KeyOperationQueues>(
+            context.threadLocal(), context.api().threadFactory(), context.timeSource());
+      },
+      true);
+}
+
+KeyOperationQueue& KeyOperationQueues::get(uint32_t thread_count, uint32_t max_batch_size,
+                                           uint32_t max_pending_operations) {
+  std::unique_ptr<KeyOperationQueue>& queue =
+      queues_[std::make_tuple(thread_count, max_batch_size, max_pending_operations)];
+  if (queue == nullptr) {
+    queue = std::make_unique<KeyOperationQueue>(thread_count, max_batch_size,
+                                                max_pending_operations, tls_, thread_factory_,
+                                                time_source_);
+  }
+  return *queue;
+}
+
+SoftwarePrivateKeyConnection::SoftwarePrivateKeyConnection(Ssl::PrivateKeyConnectionCallbacks& cb,
+                                                           bssl::UniquePtr<EVP_PKEY> pkey,
+                                                           KeyOperationQueue& queue,
+                                                           TimeSource& time_source,
+                                                           SoftwarePrivateKeyStats& stats)
+    : cb_(cb), pkey_(std::move(pkey)), queue_(queue), poster_(queue.poster()),
+      time_source_(time_source), stats_(stats) {}
+
+SoftwarePrivateKeyConnection::~SoftwarePrivateKeyConnection() {
+  if (operation_ != nullptr) {
+    operation_->cancel();
+  }
+}
+
+ssl_private_key_result_t SoftwarePrivateKeyConnection::submit(KeyOperation::Type type,
+                                                              uint16_t signature_algorithm,
+                                                              const uint8_t* in, size_t in_len) {
+  if (operation_ != nullptr) {
+    operation_->cancel();
+  }
+  operation_ =
+      std::make_shared<KeyOperation>(type, bssl::UpRef(pkey_), signature_algorithm, in, in_len,
+                                     poster_, &cb_, time_source_.monotonicTime());
+  const uint64_t depth = queue_.enqueue(operation_);
+  if (depth == 0) {
+    ENVOY_LOG(debug, "software private key provider queue is full");
+    stats_.queue_overflow_.inc();
+    operation_ = nullptr;
+    return ssl_private_key_failure;
+  }
+  stats_.queue_depth_.recordValue(depth);
+  if (type == KeyOperation::Type::Sign) {
+    stats_.sign_.inc();
+  } else {
+    stats_.decrypt_.inc();
+  }
+  return ssl_private_key_retry;
+}
+
+ssl_private_key_result_t SoftwarePrivateKeyConnection::complete(uint8_t* out, size_t* out_len,
+                                                                size_t max_out) {
+  if (operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+
+  // The result is only used after it has been delivered on this thread. This can
+  // happen if someone calls the top-level SSL function too early.
+  if (!operation_->completed()) {
+    return ssl_private_key_retry;
+  }
+
+  KeyOperationSharedPtr operation = std::move(operation_);
+  stats_.batch_size_.recordValue(operation->batchSize());
+  stats_.queue_time_us_.recordValue(operation->queueTime().count());
+  stats_.operation_time_us_.recordValue(operation->operationTime().count());
+
+  const std::vector<uint8_t>& output = operation->output();
+  if (!operation->succeeded() || output.size() > max_out) {
+    ENVOY_LOG(debug, "software private key operation failed");
+    stats_.failed_.inc();
+    return ssl_private_key_failure;
+  }
+
+  std::copy(output.begin(), output.end(), out);
+  *out_len = output.size();
+  return ssl_private_key_success;
+}
+
+namespace {
+
+SoftwarePrivateKeyConnection* getConnection(SSL* ssl) {
+  return ssl == nullptr ? nullptr
+                        : static_cast<SoftwarePrivateKeyConnection*>(SSL_get_ex_data(
+                              ssl, SoftwarePrivateKeyMethodProvider::connectionIndex()));
+}
+
+ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t*, size_t*, size_t,
+                                        uint16_t signature_algorithm, const uint8_t* in,
+                                        size_t in_len) {
+  SoftwarePrivateKeyConnection* ops = getConnection(ssl);
+  return ops == nullptr ? ssl_private_key_failure
+                        : ops->submit(KeyOperation::Type::Sign, signature_algorithm, in, in_len);
+}
+
+ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t*, size_t*, size_t, const uint8_t* in,
+                                           size_t in_len) {
+  SoftwarePrivateKeyConnection* ops = getConnection(ssl);
+  return ops == nullptr ? ssl_private_key_failure
+                        : ops->submit(KeyOperation::Type::Decrypt, 0, in, in_len);
+}
+
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                            size_t max_out) {
+  SoftwarePrivateKeyConnection* ops = getConnection(ssl);
+  return ops == nullptr ? ssl_private_key_failure : ops->complete(out, out_len, max_out);
+}
+
+int createIndex() {
+  int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+  return index;
+}
+
+} // namespace
+
+SoftwarePrivateKeyMethodProvider::SoftwarePrivateKeyMethodProvider(
+    const envoy::extensions::transport_sockets::tls::private_key_providers::software::v3::
+        SoftwarePrivateKeyMethodConfig& conf,
+    Server::Configuration::TransportSocketFactoryContext& factory_context)
+    : time_source_(factory_context.serverFactoryContext().timeSource()),
+      stats_(generateSoftwarePrivateKeyStats(factory_context.statsScope())) {
+  Api::Api& api = factory_context.serverFactoryContext().api();
+  const std::string private_key =
+      THROW_OR_RETURN_VALUE(Config::DataSource::read(conf.private_key(), false, api), std::string);
+
+  bssl::UniquePtr<BIO> bio(
+      BIO_new_mem_buf(const_cast<char*>(private_key.data()), private_key.size()));
+  bssl::UniquePtr<EVP_PKEY> pkey(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey == nullptr) {
+    throw EnvoyException("Failed to read private key.");
+  }
+
+  switch (EVP_PKEY_id(pkey.get())) {
+  case EVP_PKEY_RSA:
+  case EVP_PKEY_EC:
+  case EVP_PKEY_ED25519:
+    break;
+  default:
+    throw EnvoyException("Not supported key type, only RSA, EC and Ed25519 are supported.");
+  }
+  pkey_ = std::move(pkey);
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  method_->sign = privateKeySign;
+  method_->decrypt = privateKeyDecrypt;
+  method_->complete = privateKeyComplete;
+
+  queues_ = KeyOperationQueues::singleton(factory_context.serverFactoryContext());
+  queue_ = &queues_->get(PROTOBUF_GET_WRAPPED_OR_DEFAULT(conf, thread_count, 1),
+                         PROTOBUF_GET_WRAPPED_OR_DEFAULT(conf, max_batch_size, 32),
+                         conf.max_pending_operations());
+}
+
+void SoftwarePrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  // Results are posted to the dispatcher of the registering thread.
+  ASSERT(dispatcher.isThreadSafe());
+  if (SSL_get_ex_data(ssl, SoftwarePrivateKeyMethodProvider::connectionIndex()) != nullptr) {
+    throw EnvoyException("Not registering the software provider twice for same context");
+  }
+
+  SoftwarePrivateKeyConnection* ops =
+      new SoftwarePrivateKeyConnection(cb, bssl::UpRef(pkey_), *queue_, time_source_, stats_);
+  SSL_set_ex_data(ssl, SoftwarePrivateKeyMethodProvider::connectionIndex(), ops);
+}
+
+void SoftwarePrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  SoftwarePrivateKeyConnection* ops = static_cast<SoftwarePrivateKeyConnection*>(
+      SSL_get_ex_data(ssl, SoftwarePrivateKeyMethodProvider::connectionIndex()));
+  SSL_set_ex_data(ssl, SoftwarePrivateKeyMethodProvider::connectionIndex(), nullptr);
+  delete ops;
+}
+
+bool SoftwarePrivateKeyMethodProvider::checkFips() {
+  switch (EVP_PKEY_id(pkey_.get())) {
+  case EVP_PKEY_RSA: {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa != nullptr && RSA_check_fips(rsa);
+  }
+  case EVP_PKEY_EC: {
+    const EC_KEY* ec_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+    return ec_key != nullptr && EC_KEY_check_fips(ec_key);
+  }
+  default:
+    return false;
+  }
+}
+
+Ssl::BoringSslPrivateKeyMethodSharedPtr
+SoftwarePrivateKeyMethodProvider::getBoringSslPrivateKeyMethod() {
+  return method_;
+}
+
+int SoftwarePrivateKeyMethodProvider::connectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+} // namespace Software
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
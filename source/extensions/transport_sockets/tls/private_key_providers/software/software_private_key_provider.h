@@ -0,0 +1,264 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/transport_sockets/tls/private_key_providers/software/v3/software.pb.h"
+#include "envoy/server/factory_context.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/private_key/private_key_config.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+#include "envoy/thread_local/thread_local.h"
+#include "envoy/thread_local/thread_local_object.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace Software {
+
+#define ALL_SOFTWARE_PRIVATE_KEY_STATS(COUNTER, HISTOGRAM)                                         \
+  COUNTER(sign)                                                                                    \
+  COUNTER(decrypt)                                                                                 \
+  COUNTER(failed)                                                                                  \
+  COUNTER(queue_overflow)                                                                          \
+  HISTOGRAM(queue_depth, Unspecified)                                                              \
+  HISTOGRAM(batch_size, Unspecified)                                                               \
+  HISTOGRAM(queue_time_us, Microseconds)                                                           \
+  HISTOGRAM(operation_time_us, Microseconds)
+
+/**
+ * Software private key provider stats. @see stats_macros.h
+ */
+struct SoftwarePrivateKeyStats {
+  ALL_SOFTWARE_PRIVATE_KEY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
+SoftwarePrivateKeyStats generateSoftwarePrivateKeyStats(Stats::Scope& scope);
+
+// Posts the results of the operations submitted on one thread to that thread's dispatcher, for
+// as long as the dispatcher exists. The operations hold it, so it can outlive the dispatcher.
+class ResultPoster {
+public:
+  explicit ResultPoster(Event::Dispatcher& dispatcher) : dispatcher_(&dispatcher) {}
+
+  // Posts the callback, unless the poster has been closed. Called on a crypto thread.
+  void post(Event::PostCb callback) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Stops posting. Called on the dispatcher's thread, before the dispatcher is destroyed.
+  void close() ABSL_LOCKS_EXCLUDED(mutex_);
+
+private:
+  absl::Mutex mutex_;
+  Event::Dispatcher* dispatcher_ ABSL_GUARDED_BY(mutex_);
+};
+
+using ResultPosterSharedPtr = std::shared_ptr<ResultPoster>;
+
+// The poster of one thread. Thread local objects are destroyed on their thread before its
+// dispatcher, so the poster is closed in time.
+class ThreadLocalResultPoster : public ThreadLocal::ThreadLocalObject {
+public:
+  explicit ThreadLocalResultPoster(Event::Dispatcher& dispatcher)
+      : poster_(std::make_shared<ResultPoster>(dispatcher)) {}
+  ~ThreadLocalResultPoster() override { poster_->close(); }
+
+  const ResultPosterSharedPtr poster_;
+};
+
+// A single sign or decrypt operation. The input is copied when the operation is
+// created on the worker thread, the output is produced on a crypto thread, and the
+// result is consumed on the worker thread again.
+class KeyOperation {
+public:
+  enum class Type { Sign, Decrypt };
+  enum class State { Queued, Done, Cancelled };
+
+  KeyOperation(Type type, bssl::UniquePtr<EVP_PKEY> pkey, uint16_t signature_algorithm,
+               const uint8_t* in, size_t in_len, ResultPosterSharedPtr poster,
+               Ssl::PrivateKeyConnectionCallbacks* cb, MonotonicTime enqueue_time);
+
+  // Runs the private key operation as part of a batch of the given size. Called on a
+  // crypto thread.
+  void execute(TimeSource& time_source, uint32_t batch_size);
+
+  // Marks the operation as no longer wanted by the connection. Called on the worker thread.
+  void cancel() { state_.store(State::Cancelled); }
+
+  // Notifies the connection that the result is ready. Called on the worker thread.
+  void deliver();
+
+  // Marks the operation as executed. Returns false if it was cancelled in the meantime.
+  bool markDone();
+
+  Type type() const { return type_; }
+  State state() const { return state_.load(); }
+  bool completed() const { return completed_; }
+  bool succeeded() const { return succeeded_; }
+  const std::vector<uint8_t>& output() const { return output_; }
+  ResultPoster& poster() const { return *poster_; }
+  std::chrono::microseconds queueTime() const;
+  std::chrono::microseconds operationTime() const;
+  uint32_t batchSize() const { return batch_size_; }
+
+private:
+  bool sign();
+  bool decrypt();
+
+  const Type type_;
+  const bssl::UniquePtr<EVP_PKEY> pkey_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> input_;
+  const ResultPosterSharedPtr poster_;
+  Ssl::PrivateKeyConnectionCallbacks* const cb_;
+  const MonotonicTime enqueue_time_;
+
+  std::vector<uint8_t> output_;
+  MonotonicTime start_time_;
+  MonotonicTime end_time_;
+  uint32_t batch_size_{};
+  bool succeeded_{};
+  bool completed_{};
+  std::atomic<State> state_{State::Queued};
+};
+
+using KeyOperationSharedPtr = std::shared_ptr<KeyOperation>;
+
+// KeyOperationQueue holds the operations submitted by all worker threads and
+// processes them on a fixed set of crypto threads. Each crypto thread takes up to
+// max_batch_size operations at once, executes them and posts the results back with
+// one callback per destination dispatcher. Must be created and destroyed on the main thread.
+class KeyOperationQueue : public Logger::Loggable<Logger::Id::connection> {
+public:
+  KeyOperationQueue(uint32_t thread_count, uint32_t max_batch_size,
+                    uint32_t max_pending_operations, ThreadLocal::SlotAllocator& tls,
+                    Thread::ThreadFactory& thread_factory, TimeSource& time_source);
+  ~KeyOperationQueue() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the poster for the operations submitted on the calling thread.
+  ResultPosterSharedPtr poster() { return (*poster_slot_)->poster_; }
+
+  // Adds an operation to the queue. Returns the queue depth including the new
+  // operation, or zero if the queue is full and the operation was rejected.
+  uint64_t enqueue(KeyOperationSharedPtr operation) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Blocks until the queue is empty and no batch is being processed. For tests and
+  // benchmarks only.
+  void waitForIdle() ABSL_LOCKS_EXCLUDED(mutex_);
+
+private:
+  void worker() ABSL_LOCKS_EXCLUDED(mutex_);
+  void processBatch(std::vector<KeyOperationSharedPtr>& batch);
+
+  const uint32_t max_batch_size_;
+  const uint32_t max_pending_operations_;
+  TimeSource& time_source_;
+
+  absl::Mutex mutex_;
+  std::deque<KeyOperationSharedPtr> queue_ ABSL_GUARDED_BY(mutex_);
+  uint32_t active_batches_ ABSL_GUARDED_BY(mutex_){};
+  bool terminate_ ABSL_GUARDED_BY(mutex_){};
+
+  ThreadLocal::TypedSlotPtr<ThreadLocalResultPoster> poster_slot_;
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+// The queues of all the software providers of a server, so that a provider that replaces
+// another, e.g. on an SDS update, uses the crypto threads of its predecessor rather than
+// starting its own. There is one queue for each combination of queue settings in use, and it
+// lives until the server shuts down.
+class KeyOperationQueues : public Singleton::Instance {
+public:
+  static std::shared_ptr<KeyOperationQueues>
+  singleton(Server::Configuration::ServerFactoryContext& context);
+
+  KeyOperationQueues(ThreadLocal::SlotAllocator& tls, Thread::ThreadFactory& thread_factory,
+                     TimeSource& time_source);
+
+  // Returns the queue with the given settings, creating it if needed. Called on the main thread.
+  KeyOperationQueue& get(uint32_t thread_count, uint32_t max_batch_size,
+                         uint32_t max_pending_operations);
+
+private:
+  ThreadLocal::SlotAllocator& tls_;
+  Thread::ThreadFactory& thread_factory_;
+  TimeSource& time_source_;
+  absl::flat_hash_map<std::tuple<uint32_t, uint32_t, uint32_t>,
+                      std::unique_ptr<KeyOperationQueue>>
+      queues_;
+};
+
+// SoftwarePrivateKeyConnection maintains the data needed by a given SSL
+// connection.
+class SoftwarePrivateKeyConnection : public Logger::Loggable<Logger::Id::connection> {
+public:
+  SoftwarePrivateKeyConnection(Ssl::PrivateKeyConnectionCallbacks& cb,
+                               bssl::UniquePtr<EVP_PKEY> pkey, KeyOperationQueue& queue,
+                               TimeSource& time_source, SoftwarePrivateKeyStats& stats);
+  ~SoftwarePrivateKeyConnection();
+
+  ssl_private_key_result_t submit(KeyOperation::Type type, uint16_t signature_algorithm,
+                                  const uint8_t* in, size_t in_len);
+  ssl_private_key_result_t complete(uint8_t* out, size_t* out_len, size_t max_out);
+
+private:
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  KeyOperationQueue& queue_;
+  // The poster of the connection's thread.
+  const ResultPosterSharedPtr poster_;
+  TimeSource& time_source_;
+  SoftwarePrivateKeyStats& stats_;
+  KeyOperationSharedPtr operation_;
+};
+
+// SoftwarePrivateKeyMethodProvider handles the private key method operations for
+// an SSL socket.
+class SoftwarePrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider,
+                                         public Logger::Loggable<Logger::Id::connection> {
+public:
+  SoftwarePrivateKeyMethodProvider(
+      const envoy::extensions::transport_sockets::tls::private_key_providers::software::v3::
+          SoftwarePrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& private_key_provider_context);
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  bool isAvailable() override { return true; }
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override;
+
+  static int connectionIndex();
+
+private:
+  TimeSource& time_source_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  SoftwarePrivateKeyStats stats_;
+  // Keeps the queue alive if the provider outlives the server's singletons, e.g. in tests.
+  std::shared_ptr<KeyOperationQueues> queues_;
+  KeyOperationQueue* queue_;
+};
+
+} // namespace Software
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -13,6 +13,8 @@ namespace Server {
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_transport_socket_connect_timeout)                                          \
   COUNTER(downstream_cx_overload_reject)                                                           \
+  COUNTER(downstream_cx_incoming_cpu_local)                                                        \
+  COUNTER(downstream_cx_incoming_cpu_remote)                                                       \
   COUNTER(downstream_global_cx_overflow)                                                           \
   COUNTER(downstream_pre_cx_timeout)                                                               \
   COUNTER(downstream_listener_filter_remote_close)                                                 \
@@ -11,6 +11,7 @@
 #include "source/common/config/utility.h"
 #include "source/common/event/scaled_range_timer_manager_impl.h"
 #include "source/common/protobuf/utility.h"
+#include "source/common/runtime/runtime_features.h"
 #include "source/common/stats/symbol_table.h"
 #include "source/server/resource_monitor_config_impl.h"
 
@@ -667,7 +668,9 @@ LoadShedPoint* OverloadManagerImpl::getLoadShedPoint(absl::string_view point_nam
 Event::ScaledRangeTimerManagerPtr OverloadManagerImpl::createScaledRangeTimerManager(
     Event::Dispatcher& dispatcher,
     const Event::ScaledTimerTypeMapConstSharedPtr& timer_minimums) const {
-  return std::make_unique<Event::ScaledRangeTimerManagerImpl>(dispatcher, timer_minimums);
+  return std::make_unique<Event::ScaledRangeTimerManagerImpl>(
+      dispatcher, timer_minimums,
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.scaled_timers_use_timer_wheel"));
 }
 
 void OverloadManagerImpl::updateResourcePressure(const std::string& resource, double pressure,
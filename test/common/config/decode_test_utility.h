@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+
+#include "source/common/protobuf/protobuf.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Config {
+
+// Appends count ClusterLoadAssignments, named cluster_0 to cluster_<count - 1>, to resources.
+inline void addClusterLoadAssignments(Protobuf::RepeatedPtrField<Protobuf::Any>& resources,
+                                      size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment cla;
+    cla.set_cluster_name(absl::StrCat("cluster_", i));
+    std::ignore = resources.Add()->PackFrom(cla);
+  }
+}
+
+} // namespace Config
+} // namespace Envoy
@@ -0,0 +1,150 @@
+#include <memory>
+#include <vector>
+
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/config/endpoint/v3/endpoint.pb.validate.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "source/common/config/decoded_resource_cache.h"
+#include "source/common/config/opaque_resource_decoder_impl.h"
+#include "source/common/protobuf/message_validator_impl.h"
+
+#include "test/common/config/decode_test_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+using envoy::config::endpoint::v3::ClusterLoadAssignment;
+
+// Counts the field checks, and fails them for the resource named failing_name_.
+class CheckCountingDecoder : public OpaqueResourceDecoderImpl<ClusterLoadAssignment> {
+public:
+  using OpaqueResourceDecoderImpl::OpaqueResourceDecoderImpl;
+
+  void checkUnexpectedFields(const Protobuf::Message& resource) override {
+    ++checks_;
+    if (resourceName(resource) == failing_name_) {
+      throwEnvoyExceptionOrPanic("field check failed");
+    }
+    OpaqueResourceDecoderImpl::checkUnexpectedFields(resource);
+  }
+
+  uint32_t checks_{0};
+  std::string failing_name_;
+};
+
+class DecodedResourceCacheTest : public testing::Test {
+public:
+  ProtobufMessage::StrictValidationVisitorImpl validation_visitor_;
+  OpaqueResourceDecoderSharedPtr resource_decoder_{
+      std::make_shared<OpaqueResourceDecoderImpl<ClusterLoadAssignment>>(validation_visitor_,
+                                                                         "cluster_name")};
+  DecodedResourceCache cache_;
+  Protobuf::RepeatedPtrField<Protobuf::Any> resources_;
+};
+
+// Unchanged resources are handed back as the same message, with the version of the new response.
+TEST_F(DecodedResourceCacheTest, ReusesUnchangedResources) {
+  addClusterLoadAssignments(resources_, 3);
+  const auto first = cache_.decode(resource_decoder_, resources_, "v1");
+  ASSERT_EQ(3, first.size());
+  EXPECT_EQ(3, cache_.size());
+
+  ClusterLoadAssignment changed;
+  changed.set_cluster_name("cluster_1");
+  changed.mutable_policy()->mutable_overprovisioning_factor()->set_value(200);
+  std::ignore = resources_[1].PackFrom(changed);
+  const auto second = cache_.decode(resource_decoder_, resources_, "v2");
+  ASSERT_EQ(3, second.size());
+  for (size_t i = 0; i < second.size(); ++i) {
+    EXPECT_EQ(absl::StrCat("cluster_", i), second[i]->name());
+    EXPECT_EQ("v2", second[i]->version());
+    EXPECT_TRUE(second[i]->hasResource());
+  }
+  EXPECT_EQ(&first[0]->resource(), &second[0]->resource());
+  EXPECT_NE(&first[1]->resource(), &second[1]->resource());
+  EXPECT_TRUE(TestUtility::protoEqual(changed, second[1]->resource()));
+  EXPECT_EQ(&first[2]->resource(), &second[2]->resource());
+  EXPECT_EQ("v1", first[0]->version());
+
+  // Resources that are no longer sent are dropped.
+  resources_.RemoveLast();
+  cache_.decode(resource_decoder_, resources_, "v3");
+  EXPECT_EQ(2, cache_.size());
+}
+
+// An invalid resource leaves the cache as it was.
+TEST_F(DecodedResourceCacheTest, InvalidResource) {
+  addClusterLoadAssignments(resources_, 2);
+  const auto first = cache_.decode(resource_decoder_, resources_, "v1");
+
+  std::ignore = resources_.Add()->PackFrom(ClusterLoadAssignment());
+  EXPECT_THROW_WITH_REGEX(cache_.decode(resource_decoder_, resources_, "v2"), EnvoyException,
+                          "ClusterName");
+  EXPECT_EQ(2, cache_.size());
+
+  resources_.RemoveLast();
+  const auto second = cache_.decode(resource_decoder_, resources_, "v3");
+  EXPECT_EQ(&first[0]->resource(), &second[0]->resource());
+}
+
+// The field checks of reused resources are run again, since the runtime they depend on may have
+// changed.
+TEST_F(DecodedResourceCacheTest, ReusedResourcesAreChecked) {
+  auto resource_decoder =
+      std::make_shared<CheckCountingDecoder>(validation_visitor_, "cluster_name");
+  addClusterLoadAssignments(resources_, 3);
+  const auto first = cache_.decode(resource_decoder, resources_, "v1");
+  const uint32_t checks = resource_decoder->checks_;
+
+  const auto second = cache_.decode(resource_decoder, resources_, "v2");
+  EXPECT_EQ(&first[1]->resource(), &second[1]->resource());
+  EXPECT_EQ(checks + 3, resource_decoder->checks_);
+
+  resource_decoder->failing_name_ = "cluster_1";
+  EXPECT_THROW_WITH_MESSAGE(cache_.decode(resource_decoder, resources_, "v3"), EnvoyException,
+                            "field check failed");
+  EXPECT_EQ(3, cache_.size());
+}
+
+// Resources decoded by another decoder are not reused.
+TEST_F(DecodedResourceCacheTest, DecoderChanged) {
+  addClusterLoadAssignments(resources_, 2);
+  const auto first = cache_.decode(resource_decoder_, resources_, "v1");
+
+  resource_decoder_ = std::make_shared<OpaqueResourceDecoderImpl<ClusterLoadAssignment>>(
+      validation_visitor_, "cluster_name");
+  const auto second = cache_.decode(resource_decoder_, resources_, "v1");
+  EXPECT_NE(&first[0]->resource(), &second[0]->resource());
+  EXPECT_EQ(2, cache_.size());
+}
+
+// Resources wrapped in a discovery Resource are always decoded, and keep their TTL.
+TEST_F(DecodedResourceCacheTest, WrappedResourcesAreNotCached) {
+  addClusterLoadAssignments(resources_, 1);
+  envoy::service::discovery::v3::Resource wrapped;
+  wrapped.set_name("cluster_1");
+  wrapped.mutable_ttl()->set_seconds(5);
+  ClusterLoadAssignment cla;
+  cla.set_cluster_name("cluster_1");
+  wrapped.mutable_resource()->PackFrom(cla);
+  std::ignore = resources_.Add()->PackFrom(wrapped);
+
+  const auto first = cache_.decode(resource_decoder_, resources_, "v1");
+  EXPECT_EQ(1, cache_.size());
+  const auto second = cache_.decode(resource_decoder_, resources_, "v2");
+  ASSERT_EQ(2, second.size());
+  EXPECT_EQ(&first[0]->resource(), &second[0]->resource());
+  EXPECT_NE(&first[1]->resource(), &second[1]->resource());
+  EXPECT_EQ("cluster_1", second[1]->name());
+  EXPECT_EQ(std::chrono::milliseconds(5000), second[1]->ttl());
+  EXPECT_EQ("v2", second[1]->version());
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
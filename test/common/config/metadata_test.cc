@@ -353,6 +353,46 @@ TEST_F(TypedMetadataTest, InvalidAnyMetadataTest) {
                             "Cannot create a Foo when Any metadata is empty.");
 }
 
+// Tests that identical metadata is parsed once and shared until its last holder releases it.
+TEST_F(TypedMetadataTest, InternedPacksAreShared) {
+  using Interner = MetadataPackInterner<TypedMetadataFactory>;
+  const size_t initial_size = Interner::size();
+  envoy::config::core::v3::Metadata metadata;
+  (*metadata.mutable_filter_metadata())[foo_factory_.name()] =
+      MessageUtil::keyValueStruct("name", "garply");
+
+  auto pack = Interner::get(metadata);
+  auto same_pack = Interner::get(metadata);
+  EXPECT_EQ(pack.get(), same_pack.get());
+  EXPECT_EQ("garply", pack->typed_metadata_.get<Foo>(foo_factory_.name())->name_);
+  EXPECT_EQ(initial_size + 1, Interner::size());
+
+  (*metadata.mutable_filter_metadata())[foo_factory_.name()] =
+      MessageUtil::keyValueStruct("name", "plugh");
+  auto other_pack = Interner::get(metadata);
+  EXPECT_NE(pack.get(), other_pack.get());
+  EXPECT_EQ("plugh", other_pack->typed_metadata_.get<Foo>(foo_factory_.name())->name_);
+  EXPECT_EQ(initial_size + 2, Interner::size());
+
+  pack.reset();
+  EXPECT_EQ(initial_size + 2, Interner::size());
+  same_pack.reset();
+  EXPECT_EQ(initial_size + 1, Interner::size());
+  other_pack.reset();
+  EXPECT_EQ(initial_size, Interner::size());
+}
+
+// Tests that metadata that fails to parse is not interned.
+TEST_F(TypedMetadataTest, InternInvalidMetadata) {
+  using Interner = MetadataPackInterner<TypedMetadataFactory>;
+  const size_t initial_size = Interner::size();
+  envoy::config::core::v3::Metadata metadata;
+  (*metadata.mutable_filter_metadata())[foo_factory_.name()] = Protobuf::Struct();
+  EXPECT_THROW_WITH_MESSAGE(Interner::get(metadata), Envoy::EnvoyException,
+                            "Cannot create a Foo when Struct metadata is empty.");
+  EXPECT_EQ(initial_size, Interner::size());
+}
+
 } // namespace
 } // namespace Config
 } // namespace Envoy
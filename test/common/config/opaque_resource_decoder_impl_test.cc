@@ -68,6 +68,26 @@ TEST_F(OpaqueResourceDecoderImplTest, ValidateIgnored) {
   EXPECT_EQ("fare", resource_decoder_.resourceName(*decoded_resource));
 }
 
+// The field checks are left out of decodeResourceWithoutFieldChecks(), and run by
+// checkUnexpectedFields().
+TEST_F(OpaqueResourceDecoderImplTest, DeferredFieldChecks) {
+  envoy::config::endpoint::v3::ClusterLoadAssignment strange_resource;
+  strange_resource.set_cluster_name("fare");
+  strange_resource.GetReflection()->MutableUnknownFields(&strange_resource)->AddFixed32(1000, 1);
+  Protobuf::Any opaque_resource;
+  std::ignore = opaque_resource.PackFrom(strange_resource);
+  const auto decoded_resource = resource_decoder_.decodeResourceWithoutFieldChecks(opaque_resource);
+  EXPECT_EQ("fare", resource_decoder_.resourceName(*decoded_resource));
+  EXPECT_THROW_WITH_REGEX(resource_decoder_.checkUnexpectedFields(*decoded_resource),
+                          EnvoyException, "unknown fields");
+
+  // The protoc-gen-validate constraints are still checked.
+  envoy::config::endpoint::v3::ClusterLoadAssignment invalid_resource;
+  std::ignore = opaque_resource.PackFrom(invalid_resource);
+  EXPECT_THROW(resource_decoder_.decodeResourceWithoutFieldChecks(opaque_resource),
+               ProtoValidationException);
+}
+
 // Happy path.
 TEST_F(OpaqueResourceDecoderImplTest, Success) {
   envoy::config::endpoint::v3::ClusterLoadAssignment cluster_resource;
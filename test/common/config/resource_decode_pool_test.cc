@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/config/endpoint/v3/endpoint.pb.validate.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "source/common/config/opaque_resource_decoder_impl.h"
+#include "source/common/config/resource_decode_pool.h"
+#include "source/common/protobuf/message_validator_impl.h"
+
+#include "test/common/config/decode_test_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class ResourceDecodePoolTest : public testing::Test {
+public:
+  ProtobufMessage::StrictValidationVisitorImpl validation_visitor_;
+  OpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment> resource_decoder_{
+      validation_visitor_, "cluster_name"};
+  ResourceDecodePool pool_{3};
+  Protobuf::RepeatedPtrField<Protobuf::Any> resources_;
+};
+
+TEST_F(ResourceDecodePoolTest, ParallelForCallsEachIndexOnce) {
+  for (size_t count : {0, 5, 1000}) {
+    std::vector<std::atomic<uint32_t>> calls(count);
+    pool_.parallelFor(count, [&calls](size_t i) { ++calls[i]; });
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(1, calls[i].load()) << i;
+    }
+  }
+}
+
+TEST_F(ResourceDecodePoolTest, NoThreads) {
+  ResourceDecodePool pool(0);
+  std::vector<size_t> order;
+  pool.parallelFor(100, [&order](size_t i) { order.push_back(i); });
+  EXPECT_EQ(100, order.size());
+  EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+}
+
+// The resources are handed back in the order of the response.
+TEST_F(ResourceDecodePoolTest, DecodeInOrder) {
+  addClusterLoadAssignments(resources_, 500);
+  const auto decoded = pool_.decode(resource_decoder_, resources_, "v1");
+  ASSERT_EQ(500, decoded.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    EXPECT_EQ(absl::StrCat("cluster_", i), decoded[i]->name());
+    EXPECT_EQ("v1", decoded[i]->version());
+    EXPECT_TRUE(decoded[i]->hasResource());
+  }
+}
+
+// The error of the first invalid resource is reported, whether it fails on the pool or in the
+// field checks run by the calling thread.
+TEST_F(ResourceDecodePoolTest, DecodeFirstError) {
+  addClusterLoadAssignments(resources_, 200);
+  envoy::config::endpoint::v3::ClusterLoadAssignment unknown_fields;
+  unknown_fields.set_cluster_name("unknown");
+  unknown_fields.GetReflection()->MutableUnknownFields(&unknown_fields)->AddFixed32(1000, 1);
+  std::ignore = resources_[150].PackFrom(unknown_fields);
+  EXPECT_THROW_WITH_REGEX(pool_.decode(resource_decoder_, resources_, "v1"), EnvoyException,
+                          "unknown fields");
+
+  std::ignore = resources_[50].PackFrom(envoy::config::endpoint::v3::ClusterLoadAssignment());
+  EXPECT_THROW_WITH_REGEX(pool_.decode(resource_decoder_, resources_, "v1"), EnvoyException,
+                          "ClusterName");
+}
+
+TEST_F(ResourceDecodePoolTest, DecodeDeltaResources) {
+  addClusterLoadAssignments(resources_, 100);
+  std::vector<envoy::service::discovery::v3::Resource> resources(resources_.size());
+  std::vector<const envoy::service::discovery::v3::Resource*> resource_ptrs;
+  for (int i = 0; i < resources_.size(); ++i) {
+    resources[i].set_name(absl::StrCat("cluster_", i));
+    resources[i].set_version(absl::StrCat(i));
+    *resources[i].mutable_resource() = resources_[i];
+    resource_ptrs.push_back(&resources[i]);
+  }
+  const auto decoded = pool_.decode(resource_decoder_, resource_ptrs);
+  ASSERT_EQ(100, decoded.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    EXPECT_EQ(absl::StrCat("cluster_", i), decoded[i]->name());
+    EXPECT_EQ(absl::StrCat(i), decoded[i]->version());
+  }
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
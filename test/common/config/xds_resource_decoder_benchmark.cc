@@ -13,9 +13,12 @@
 
 #include "source/common/common/assert.h"
 #include "source/common/config/opaque_resource_decoder_impl.h"
+#include "source/common/config/resource_decode_pool.h"
 #include "source/common/protobuf/message_validator_impl.h"
 #include "source/common/protobuf/utility.h"
 
+#include "test/benchmark/main.h"
+
 #include "benchmark/benchmark.h"
 
 namespace Envoy {
@@ -196,6 +199,38 @@ static void BM_Listener_Decode_Complex(benchmark::State& state) {
 }
 BENCHMARK(BM_Listener_Decode_Complex);
 
+// --- Response Benchmarks ---
+
+// Decodes a response with many small CLAs, as pushed by EDS. The first argument is the number of
+// resources, the second one the number of ResourceDecodePool threads (0 decodes them serially).
+static void BM_CLA_Decode_Response(benchmark::State& state) {
+  const int num_resources = state.range(0);
+  const uint32_t threads = state.range(1);
+  if (benchmark::skipExpensiveBenchmarks() && num_resources > 1000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+  setupBenchmarkState();
+  Protobuf::RepeatedPtrField<Protobuf::Any> resources;
+  for (int i = 0; i < num_resources; ++i) {
+    auto cla = makeComplexCLA(1, 10);
+    cla.set_cluster_name(absl::StrCat("cluster_", i));
+    bool ok = resources.Add()->PackFrom(cla);
+    RELEASE_ASSERT(ok, "Failed to pack CLA");
+  }
+  ResourceDecodePool pool(threads);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    auto decoded = pool.decode(g_benchmark_state->cla_decoder_, resources, "1");
+    benchmark::DoNotOptimize(decoded);
+  }
+  state.SetItemsProcessed(state.iterations() * num_resources);
+}
+BENCHMARK(BM_CLA_Decode_Response)
+    ->ArgsProduct({{1000, 50000}, {0, 1, 2, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
 } // namespace
 } // namespace Config
 } // namespace Envoy
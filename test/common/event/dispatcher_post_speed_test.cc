@@ -0,0 +1,72 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the throughput of Dispatcher::post() from several producer threads into a single
+// dispatcher thread, which is the pattern used by stats flushes, thread local slot updates and
+// cluster updates.
+
+#include <vector>
+
+#include "source/common/api/api_impl.h"
+#include "source/common/event/dispatcher_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/notification.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+
+constexpr int PostsPerProducer = 10000;
+
+// The argument is the number of producer threads.
+static void bmDispatcherPost(benchmark::State& state) {
+  const int num_producers = state.range(0);
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher = api->allocateDispatcher("consumer");
+  Thread::ThreadPtr consumer = api->threadFactory().createThread(
+      [&dispatcher]() { dispatcher->run(Dispatcher::RunType::RunUntilExit); });
+
+  uint64_t executed = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    absl::Notification start;
+    std::vector<Thread::ThreadPtr> producers;
+    producers.reserve(num_producers);
+    for (int i = 0; i < num_producers; ++i) {
+      producers.push_back(api->threadFactory().createThread([&dispatcher, &start, &executed]() {
+        start.WaitForNotification();
+        for (int post = 0; post < PostsPerProducer; ++post) {
+          // Small enough to be stored inline in the callback.
+          dispatcher->post([&executed]() { ++executed; });
+        }
+      }));
+    }
+    start.Notify();
+    for (auto& producer : producers) {
+      producer->join();
+    }
+    // Callbacks from one thread run in order, so this runs after every callback posted above.
+    absl::Notification done;
+    dispatcher->post([&done]() { done.Notify(); });
+    done.WaitForNotification();
+  }
+  RELEASE_ASSERT(executed == state.iterations() * num_producers * PostsPerProducer, "");
+  state.SetItemsProcessed(executed);
+
+  dispatcher->exit();
+  consumer->join();
+}
+BENCHMARK(bmDispatcherPost)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->Arg(32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,46 @@
+#include <chrono>
+
+#include "source/common/event/event_loop_utilization.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Runs one loop iteration that waits in poll for `idle` and then runs events for `busy`.
+MonotonicTime iterate(EventLoopUtilizationTracker& tracker, MonotonicTime now,
+                      std::chrono::milliseconds idle, std::chrono::milliseconds busy) {
+  tracker.onPrepare(now, std::nullopt);
+  now += idle;
+  tracker.onCheck(now);
+  return now + busy;
+}
+
+TEST(EventLoopUtilizationTrackerTest, IdleLoop) {
+  EventLoopUtilizationTracker tracker(std::chrono::milliseconds(10));
+  MonotonicTime now;
+  for (int i = 0; i < 20; ++i) {
+    now = iterate(tracker, now, std::chrono::milliseconds(5), std::chrono::milliseconds(0));
+  }
+  EXPECT_EQ(0, tracker.utilization());
+}
+
+TEST(EventLoopUtilizationTrackerTest, ConvergesToBusyFraction) {
+  EventLoopUtilizationTracker tracker(std::chrono::milliseconds(10));
+  MonotonicTime now;
+  for (int i = 0; i < 200; ++i) {
+    now = iterate(tracker, now, std::chrono::milliseconds(1), std::chrono::milliseconds(3));
+  }
+  EXPECT_NEAR(750000, tracker.utilization(), 10000);
+
+  // A single busy iteration moves the average, but does not saturate it.
+  now = iterate(tracker, now, std::chrono::milliseconds(0), std::chrono::milliseconds(100));
+  iterate(tracker, now, std::chrono::milliseconds(0), std::chrono::milliseconds(0));
+  EXPECT_GT(tracker.utilization(), 750000);
+  EXPECT_LT(tracker.utilization(), EventLoopUtilizationTracker::FullUtilization);
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,131 @@
+#include <memory>
+#include <vector>
+
+#include "source/common/event/post_callback_queue.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Pops every callback that is available and runs it.
+size_t drain(PostCallbackQueue& queue) {
+  size_t count = 0;
+  queue.beginPass();
+  PostCb callback;
+  while (queue.pop(callback)) {
+    callback();
+    ++count;
+  }
+  return count;
+}
+
+TEST(PostCallbackQueueTest, Fifo) {
+  PostCallbackQueue queue(4);
+  std::vector<int> order;
+  for (int i = 0; i < 3; ++i) {
+    queue.push([&order, i]() { order.push_back(i); });
+  }
+  EXPECT_EQ(3, queue.size());
+  EXPECT_EQ(3, drain(queue));
+  EXPECT_EQ((std::vector<int>{0, 1, 2}), order);
+  EXPECT_EQ(0, queue.size());
+}
+
+// Only the first push after a pass starts asks for a wakeup.
+TEST(PostCallbackQueueTest, BatchedWakeups) {
+  PostCallbackQueue queue(4);
+  EXPECT_TRUE(queue.push([]() {}));
+  EXPECT_FALSE(queue.push([]() {}));
+  EXPECT_EQ(2, queue.beginPass());
+  EXPECT_TRUE(queue.push([]() {}));
+  EXPECT_FALSE(queue.push([]() {}));
+}
+
+// Callbacks spilling over a full ring keep their order, including callbacks pushed after the
+// ring has room again.
+TEST(PostCallbackQueueTest, OverflowKeepsOrder) {
+  PostCallbackQueue queue(4);
+  std::vector<int> order;
+  for (int i = 0; i < 10; ++i) {
+    queue.push([&order, i]() { order.push_back(i); });
+  }
+  EXPECT_EQ(10, queue.size());
+
+  queue.beginPass();
+  PostCb callback;
+  ASSERT_TRUE(queue.pop(callback));
+  callback();
+  for (int i = 10; i < 12; ++i) {
+    queue.push([&order, i]() { order.push_back(i); });
+  }
+  drain(queue);
+  for (int i = 12; i < 14; ++i) {
+    queue.push([&order, i]() { order.push_back(i); });
+  }
+  drain(queue);
+
+  std::vector<int> expected(14);
+  for (int i = 0; i < 14; ++i) {
+    expected[i] = i;
+  }
+  EXPECT_EQ(expected, order);
+}
+
+TEST(PostCallbackQueueTest, DestroysPendingCallbacks) {
+  auto tracker = std::make_shared<int>(0);
+  {
+    PostCallbackQueue queue(2);
+    for (int i = 0; i < 4; ++i) {
+      queue.push([tracker]() {});
+    }
+    EXPECT_EQ(5, tracker.use_count());
+  }
+  EXPECT_EQ(1, tracker.use_count());
+}
+
+// Several producers race with the consumer, each producer's callbacks run in order and none are
+// lost.
+TEST(PostCallbackQueueTest, ConcurrentProducers) {
+  constexpr int NumProducers = 8;
+  constexpr int PostsPerProducer = 10000;
+  PostCallbackQueue queue(64);
+  std::vector<int> next(NumProducers, 0);
+  bool in_order = true;
+  absl::Notification start;
+
+  std::vector<Thread::ThreadPtr> threads;
+  for (int producer = 0; producer < NumProducers; ++producer) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([&, producer]() {
+      start.WaitForNotification();
+      for (int i = 0; i < PostsPerProducer; ++i) {
+        queue.push([&, producer, i]() {
+          in_order &= next[producer] == i;
+          next[producer] = i + 1;
+        });
+      }
+    }));
+  }
+  start.Notify();
+
+  size_t total = 0;
+  while (total < NumProducers * PostsPerProducer) {
+    total += drain(queue);
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(0, drain(queue));
+  EXPECT_TRUE(in_order);
+  for (int producer = 0; producer < NumProducers; ++producer) {
+    EXPECT_EQ(PostsPerProducer, next[producer]);
+  }
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
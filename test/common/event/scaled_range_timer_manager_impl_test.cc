@@ -440,6 +440,31 @@ TEST_F(ScaledRangeTimerManagerTest, MultipleTimersNoScaling) {
   EXPECT_THAT(*timers[2].trigger_times, ElementsAre(start + std::chrono::seconds(9)));
 }
 
+// The min durations tracked by the timer wheel expire at the same times as with libevent timers.
+TEST_F(ScaledRangeTimerManagerTest, MultipleTimersWithTimerWheel) {
+  ScaledRangeTimerManagerImpl manager(dispatcher_, nullptr, true);
+  std::vector<TrackedRangeTimer> timers;
+  timers.reserve(3);
+
+  const MonotonicTime start = simTime().monotonicTime();
+  timers.emplace_back(AbsoluteMinimum(std::chrono::seconds(1)), manager, simTime());
+  timers.emplace_back(AbsoluteMinimum(std::chrono::seconds(2)), manager, simTime());
+  timers.emplace_back(ScaledMinimum(UnitFloat(0.5)), manager, simTime());
+
+  timers[0].timer->enableTimer(std::chrono::seconds(3));
+  timers[1].timer->enableTimer(std::chrono::seconds(6));
+  timers[2].timer->enableTimer(std::chrono::seconds(8));
+  manager.setScaleFactor(UnitFloat(0.5));
+
+  for (int i = 0; i < 10; ++i) {
+    simTime().advanceTimeAndRun(std::chrono::seconds(1), dispatcher_, Dispatcher::RunType::Block);
+  }
+
+  EXPECT_THAT(*timers[0].trigger_times, ElementsAre(start + std::chrono::seconds(2)));
+  EXPECT_THAT(*timers[1].trigger_times, ElementsAre(start + std::chrono::seconds(4)));
+  EXPECT_THAT(*timers[2].trigger_times, ElementsAre(start + std::chrono::seconds(6)));
+}
+
 TEST_F(ScaledRangeTimerManagerTest, MultipleTimersWithScaling) {
   ScaledRangeTimerManagerImpl manager(dispatcher_);
   std::vector<TrackedRangeTimer> timers;
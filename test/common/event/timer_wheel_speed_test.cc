@@ -0,0 +1,60 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the cost of re-arming many coarse timers that rarely fire, the pattern of idle and
+// request timeouts on busy connections, with libevent timers and with a TimerWheel.
+
+#include <vector>
+
+#include "source/common/api/api_impl.h"
+#include "source/common/event/dispatcher_impl.h"
+#include "source/common/event/timer_wheel.h"
+
+#include "test/benchmark/main.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+
+// The first argument selects libevent timers (0) or the timer wheel (1), the second one is the
+// number of timers.
+static void bmTimerChurn(benchmark::State& state) {
+  const bool use_wheel = state.range(0) != 0;
+  const int num_timers = state.range(1);
+  if (benchmark::skipExpensiveBenchmarks() && num_timers > 1000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  TimerWheel wheel(*dispatcher);
+
+  uint64_t fired = 0;
+  std::vector<TimerPtr> timers;
+  timers.reserve(num_timers);
+  for (int i = 0; i < num_timers; ++i) {
+    TimerCb cb = [&fired]() { ++fired; };
+    timers.push_back(use_wheel ? wheel.createTimer(cb, *dispatcher) : dispatcher->createTimer(cb));
+  }
+
+  uint64_t rearms = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    // Spread the timeouts over a few seconds so that they land in many different slots.
+    for (int i = 0; i < num_timers; ++i) {
+      timers[i]->enableTimer(std::chrono::milliseconds(1000 + (i * 7 + rearms) % 4000));
+      ++rearms;
+    }
+    dispatcher->run(Dispatcher::RunType::NonBlock);
+  }
+  state.SetItemsProcessed(rearms);
+  state.counters["fired"] = fired;
+}
+BENCHMARK(bmTimerChurn)
+    ->ArgsProduct({{0, 1}, {1000, 100000}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace Event
+} // namespace Envoy
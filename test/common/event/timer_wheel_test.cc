@@ -0,0 +1,182 @@
+#include <chrono>
+#include <vector>
+
+#include "source/common/event/dispatcher_impl.h"
+#include "source/common/event/timer_wheel.h"
+
+#include "test/mocks/common.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+using testing::MockFunction;
+
+class TimerWheelTest : public testing::Test, public TestUsingSimulatedTime {
+public:
+  TimerWheelTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        wheel_(*dispatcher_) {}
+
+  void advance(std::chrono::microseconds duration) {
+    simTime().advanceTimeAndRun(duration, *dispatcher_, Dispatcher::RunType::NonBlock);
+  }
+
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+  TimerWheel wheel_;
+};
+
+TEST_F(TimerWheelTest, FiresAtDeadline) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction(), *dispatcher_);
+  EXPECT_FALSE(timer->enabled());
+
+  timer->enableTimer(std::chrono::milliseconds(5));
+  EXPECT_TRUE(timer->enabled());
+  EXPECT_EQ(1, wheel_.armedTimers());
+
+  EXPECT_CALL(callback, Call()).Times(0);
+  advance(std::chrono::milliseconds(4));
+  testing::Mock::VerifyAndClearExpectations(&callback);
+
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(1));
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(0, wheel_.armedTimers());
+}
+
+// Timers never fire early, durations that are not a whole number of ticks are rounded up.
+TEST_F(TimerWheelTest, RoundsUpToTick) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction(), *dispatcher_);
+  timer->enableHRTimer(std::chrono::microseconds(1500));
+
+  EXPECT_CALL(callback, Call()).Times(0);
+  advance(std::chrono::microseconds(1500));
+  testing::Mock::VerifyAndClearExpectations(&callback);
+
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::microseconds(500));
+}
+
+TEST_F(TimerWheelTest, DisableAndReEnable) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction(), *dispatcher_);
+
+  timer->enableTimer(std::chrono::milliseconds(10));
+  timer->disableTimer();
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(0, wheel_.armedTimers());
+  EXPECT_CALL(callback, Call()).Times(0);
+  advance(std::chrono::milliseconds(20));
+  testing::Mock::VerifyAndClearExpectations(&callback);
+
+  // Re-enabling pushes the deadline back, like the idle timeout of an active connection.
+  for (int i = 0; i < 10; ++i) {
+    timer->enableTimer(std::chrono::milliseconds(10));
+    advance(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(1, wheel_.armedTimers());
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(5));
+}
+
+// Timers on the higher levels of the wheel move down as time passes and still fire on time.
+TEST_F(TimerWheelTest, LongDurations) {
+  const std::vector<std::chrono::milliseconds> durations = {
+      std::chrono::milliseconds(300), std::chrono::seconds(70), std::chrono::hours(5),
+      std::chrono::hours(24 * 60)};
+  std::vector<MockFunction<TimerCb>> callbacks(durations.size());
+  std::vector<TimerPtr> timers;
+  for (size_t i = 0; i < durations.size(); ++i) {
+    timers.push_back(wheel_.createTimer(callbacks[i].AsStdFunction(), *dispatcher_));
+    timers.back()->enableTimer(durations[i]);
+  }
+
+  std::chrono::milliseconds elapsed(0);
+  for (size_t i = 0; i < durations.size(); ++i) {
+    EXPECT_CALL(callbacks[i], Call()).Times(0);
+    advance(durations[i] - std::chrono::milliseconds(1) - elapsed);
+    testing::Mock::VerifyAndClearExpectations(&callbacks[i]);
+
+    EXPECT_CALL(callbacks[i], Call());
+    advance(std::chrono::milliseconds(1));
+    testing::Mock::VerifyAndClearExpectations(&callbacks[i]);
+    elapsed = durations[i];
+  }
+  EXPECT_EQ(0, wheel_.armedTimers());
+}
+
+TEST_F(TimerWheelTest, FireOrder) {
+  std::vector<int> fired;
+  std::vector<TimerPtr> timers;
+  for (int i = 0; i < 4; ++i) {
+    timers.push_back(wheel_.createTimer([&fired, i]() { fired.push_back(i); }, *dispatcher_));
+  }
+  timers[0]->enableTimer(std::chrono::milliseconds(400));
+  timers[1]->enableTimer(std::chrono::milliseconds(3));
+  timers[2]->enableTimer(std::chrono::milliseconds(257));
+  timers[3]->enableTimer(std::chrono::milliseconds(3));
+
+  for (int i = 0; i < 400; ++i) {
+    advance(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ((std::vector<int>{1, 3, 2, 0}), fired);
+}
+
+// Callbacks may re-enable their own timer and disable or destroy timers that are due in the same
+// tick.
+TEST_F(TimerWheelTest, ChangesFromCallbacks) {
+  int first_fired = 0;
+  TimerPtr second;
+  TimerPtr third;
+  TimerPtr first = wheel_.createTimer(
+      [&]() {
+        if (++first_fired == 1) {
+          first->enableTimer(std::chrono::milliseconds(2));
+        }
+        second.reset();
+        third->disableTimer();
+      },
+      *dispatcher_);
+  MockFunction<TimerCb> callback;
+  second = wheel_.createTimer(callback.AsStdFunction(), *dispatcher_);
+  third = wheel_.createTimer(callback.AsStdFunction(), *dispatcher_);
+
+  first->enableTimer(std::chrono::milliseconds(1));
+  second->enableTimer(std::chrono::milliseconds(1));
+  third->enableTimer(std::chrono::milliseconds(1));
+  EXPECT_CALL(callback, Call()).Times(0);
+  advance(std::chrono::milliseconds(1));
+  EXPECT_EQ(1, first_fired);
+  EXPECT_TRUE(first->enabled());
+  EXPECT_FALSE(third->enabled());
+
+  advance(std::chrono::milliseconds(2));
+  EXPECT_EQ(2, first_fired);
+  EXPECT_EQ(0, wheel_.armedTimers());
+}
+
+TEST_F(TimerWheelTest, ScopeTracking) {
+  MockScopeTrackedObject scope;
+  bool fired = false;
+  TimerPtr timer = wheel_.createTimer(
+      [&]() {
+        fired = true;
+        EXPECT_FALSE(dispatcher_->trackedObjectStackIsEmpty());
+      },
+      *dispatcher_);
+  timer->enableTimer(std::chrono::milliseconds(1), &scope);
+  advance(std::chrono::milliseconds(1));
+  EXPECT_TRUE(fired);
+  EXPECT_TRUE(dispatcher_->trackedObjectStackIsEmpty());
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
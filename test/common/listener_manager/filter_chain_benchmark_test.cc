@@ -211,6 +211,20 @@ public:
     filter_chains_ = listener_config_.filter_chains();
   }
 
+  // One filter chain per tenant server name, all on the same destination port, as is common for
+  // multi-tenant TLS listeners.
+  void initializeServerNames(::benchmark::State& state) {
+    const int64_t input_size = state.range(0);
+    for (int64_t i = 0; i < input_size; i++) {
+      auto* filter_chain = listener_config_.add_filter_chains();
+      filter_chain->set_name(absl::StrCat("tenant", i));
+      auto* filter_chain_match = filter_chain->mutable_filter_chain_match();
+      filter_chain_match->add_server_names(absl::StrCat("tenant", i, ".example.com"));
+      filter_chain_match->set_transport_protocol("tls");
+    }
+    filter_chains_ = listener_config_.filter_chains();
+  }
+
   Envoy::Thread::MutexBasicLockable lock_;
   Logger::Context logging_state_{spdlog::level::warn, Logger::Logger::DEFAULT_LOG_FORMAT, lock_,
                                  false};
@@ -277,6 +291,59 @@ BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindTest)
     }
   }
 }
+// NOLINTNEXTLINE(readability-redundant-member-init)
+BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainManagerBuildServerNamesTest)
+(::benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  initializeServerNames(state);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  std::vector<Network::Address::InstanceConstSharedPtr> addresses;
+  addresses.emplace_back(std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234));
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    FilterChainManagerImpl filter_chain_manager{addresses, factory_context, init_manager_};
+    THROW_IF_NOT_OK(filter_chain_manager.addFilterChains(
+        nullptr, filter_chains_, nullptr, dummy_builder_, filter_chain_manager, nullptr,
+        empty_config_source_, dummy_fcds_callbacks_));
+  }
+}
+
+BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindServerNamesTest)
+(::benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  initializeServerNames(state);
+  std::vector<MockConnectionSocket> sockets;
+  sockets.reserve(state.range(0));
+  for (int i = 0; i < state.range(0); i++) {
+    sockets.push_back(std::move(*MockConnectionSocket::createMockConnectionSocket(
+        1234, "127.0.0.1", absl::StrCat("tenant", i, ".example.com"), "", "tls", {}, "8.8.8.8",
+        111)));
+  }
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  std::vector<Network::Address::InstanceConstSharedPtr> addresses;
+  addresses.emplace_back(std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234));
+  FilterChainManagerImpl filter_chain_manager{addresses, factory_context, init_manager_};
+
+  THROW_IF_NOT_OK(filter_chain_manager.addFilterChains(
+      nullptr, filter_chains_, nullptr, dummy_builder_, filter_chain_manager, nullptr,
+      empty_config_source_, dummy_fcds_callbacks_));
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    for (int i = 0; i < state.range(0); i++) {
+      filter_chain_manager.findFilterChain(sockets[i], stream_info);
+    }
+  }
+}
+
 BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerBuildTest)
     ->Ranges({
         // scale of the chains
@@ -289,6 +356,18 @@ BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindTest)
         {1, 4096},
     })
     ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerBuildServerNamesTest)
+    ->Ranges({
+        // scale of the chains
+        {1, 20000},
+    })
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindServerNamesTest)
+    ->Ranges({
+        // scale of the chains
+        {1, 20000},
+    })
+    ->Unit(::benchmark::kMillisecond);
 
 /*
 clang-format off
@@ -258,6 +258,8 @@ TEST_P(FilterChainManagerImplTest, DuplicateContextsAreNotBuilt) {
       std::vector<const envoy::config::listener::v3::FilterChain*>{&filter_chain_messages[0]},
       nullptr, filter_chain_factory_builder_, *filter_chain_manager_, nullptr, empty_config_source_,
       dummy_fcds_callbacks_));
+  EXPECT_EQ(1, filter_chain_manager_->builtFilterChains());
+  EXPECT_EQ(0, filter_chain_manager_->reusedFilterChains());
   FilterChainManagerImpl new_filter_chain_manager{addresses_, parent_context_, init_manager_,
                                                   *filter_chain_manager_};
   // The new filter chain manager maintains 3 filter chains, but only 2 filter chain context is
@@ -269,6 +271,8 @@ TEST_P(FilterChainManagerImplTest, DuplicateContextsAreNotBuilt) {
           &filter_chain_messages[0], &filter_chain_messages[1], &filter_chain_messages[2]},
       nullptr, filter_chain_factory_builder_, new_filter_chain_manager, nullptr,
       empty_config_source_, dummy_fcds_callbacks_));
+  EXPECT_EQ(2, new_filter_chain_manager.builtFilterChains());
+  EXPECT_EQ(1, new_filter_chain_manager.reusedFilterChains());
 }
 
 TEST_P(FilterChainManagerImplTest, UpdateFilterChainsBetweenVersions) {
@@ -382,6 +386,53 @@ TEST_P(FilterChainManagerImplTest, DuplicateFilterChainMatchFails) {
   );
 }
 
+// IP levels that only hold the catch-all entry match without a trie, next to levels that need one.
+TEST_P(FilterChainManagerImplTest, CatchAllAndSpecificSourceIPs) {
+  if (GetParam()) {
+    // The matcher API does not use the filter chain match index.
+    return;
+  }
+  envoy::config::listener::v3::FilterChain any_source_chain = filter_chain_template_;
+  any_source_chain.set_name("any_source");
+  any_source_chain.mutable_filter_chain_match()->add_server_names("a.example.com");
+  envoy::config::listener::v3::FilterChain internal_source_chain = any_source_chain;
+  internal_source_chain.set_name("internal_source");
+  auto* source_range =
+      internal_source_chain.mutable_filter_chain_match()->add_source_prefix_ranges();
+  source_range->set_address_prefix("10.0.0.0");
+  source_range->mutable_prefix_len()->set_value(8);
+  envoy::config::listener::v3::FilterChain other_server_chain = filter_chain_template_;
+  other_server_chain.set_name("other_server");
+  other_server_chain.mutable_filter_chain_match()->add_server_names("*.other.com");
+
+  auto any_source_filter_chain = std::make_shared<Network::MockFilterChain>();
+  auto internal_source_filter_chain = std::make_shared<Network::MockFilterChain>();
+  auto other_server_filter_chain = std::make_shared<Network::MockFilterChain>();
+  EXPECT_CALL(filter_chain_factory_builder_, buildFilterChain(_, _, _))
+      .WillOnce(Return(any_source_filter_chain))
+      .WillOnce(Return(internal_source_filter_chain))
+      .WillOnce(Return(other_server_filter_chain));
+  EXPECT_OK(filter_chain_manager_->addFilterChains(
+      nullptr,
+      std::vector<const envoy::config::listener::v3::FilterChain*>{
+          &any_source_chain, &internal_source_chain, &other_server_chain},
+      nullptr, filter_chain_factory_builder_, *filter_chain_manager_, nullptr, empty_config_source_,
+      dummy_fcds_callbacks_));
+
+  EXPECT_EQ(any_source_filter_chain.get(),
+            findFilterChainHelper(10000, "127.0.0.1", "a.example.com", "tls", {}, "8.8.8.8", 111));
+  EXPECT_EQ(
+      internal_source_filter_chain.get(),
+      findFilterChainHelper(10000, "127.0.0.1", "a.example.com", "tls", {}, "10.1.2.3", 111));
+  EXPECT_EQ(other_server_filter_chain.get(),
+            findFilterChainHelper(10000, "127.0.0.1", "www.other.com", "tls", {}, "8.8.8.8", 111));
+  // Unix domain sockets only match the catch-all ranges.
+  EXPECT_EQ(other_server_filter_chain.get(),
+            findFilterChainHelper(10000, "127.0.0.1", "www.other.com", "tls", {}, "/tmp/test", 0));
+  EXPECT_EQ(nullptr,
+            findFilterChainHelper(10000, "127.0.0.1", "b.example.com", "tls", {}, "8.8.8.8", 111));
+}
+
 class MockFcdsClientCallbacks : public FcdsClientCallbacks {
 public:
   MOCK_METHOD(void, drainFilterChain, (Network::DrainableFilterChainSharedPtr draining),
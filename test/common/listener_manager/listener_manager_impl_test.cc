@@ -8905,6 +8905,25 @@ TEST_P(ListenerManagerImplWithRealFiltersTest, CpuLocalityBalanceUsesNopBalancer
 #endif
 }
 
+TEST_P(ListenerManagerImplWithRealFiltersTest, WorkerLoadBalanceUsesWorkerLoadBalancer) {
+// Envoy always use ExactBalance at WIN32, so ignore it.
+#ifndef WIN32
+  auto listener = createIPv4Listener("TCPListener");
+  listener.mutable_connection_balance_config()->mutable_worker_load_balance();
+
+  auto listener_impl = *ListenerImpl::create(listener, "version", *manager_, "foo", true, false,
+                                             /*hash=*/static_cast<uint64_t>(0));
+  auto socket_factory = std::make_unique<Network::MockListenSocketFactory>();
+  Network::Address::InstanceConstSharedPtr address(
+      new Network::Address::Ipv4Instance("192.168.0.1", 80, nullptr));
+  EXPECT_CALL(*socket_factory, localAddress()).WillRepeatedly(ReturnRef(address));
+  EXPECT_OK(listener_impl->addSocketFactory(std::move(socket_factory)));
+  Network::ConnectionBalancer& balancer = listener_impl->connectionBalancer(*address);
+  EXPECT_NE(dynamic_cast<Network::WorkerLoadConnectionBalancerImpl*>(&balancer), nullptr);
+  EXPECT_TRUE(balancer.usesEventLoopUtilization());
+#endif
+}
+
 TEST_P(ListenerManagerImplWithRealFiltersTest,
        CpuLocalityBalanceUsesNopBalancerWhenKernelUnsupported) {
 // CPU locality steering requires Linux reuse port BPF support and worker CPU affinity.
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "source/common/common/assert.h"
+#include "source/common/common/random_generator.h"
 #include "source/common/network/connection_balancer_impl.h"
 
 #include "benchmark/benchmark.h"
@@ -13,15 +14,18 @@ namespace Envoy {
 namespace Network {
 namespace {
 
-// A minimal balanced connection handler that only tracks a connection count, which is all the
-// connection balancers touch on the accept path.
+// A minimal balanced connection handler that only tracks a connection count and a fixed event loop
+// utilization, which is all the connection balancers touch on the accept path.
 class BenchmarkConnectionHandler : public BalancedConnectionHandler {
 public:
+  explicit BenchmarkConnectionHandler(uint32_t utilization) : utilization_(utilization) {}
+
   uint64_t numConnections() const override {
     return num_connections_.load(std::memory_order_relaxed);
   }
   void preIncNumConnections() override { num_connections_.fetch_add(1, std::memory_order_relaxed); }
   void postIncNumConnections() override {}
+  uint32_t eventLoopUtilization() const override { return utilization_; }
   void post(ConnectionSocketPtr&&) override { PANIC("not implemented"); }
   void onAcceptWorker(ConnectionSocketPtr&&, bool, bool,
                       const std::optional<std::string>&) override {
@@ -29,23 +33,35 @@ public:
   }
 
 private:
+  const uint32_t utilization_;
   std::atomic<uint64_t> num_connections_{0};
 };
 
+template <typename BalancerType> std::unique_ptr<ConnectionBalancer> createBalancer() {
+  return std::make_unique<BalancerType>();
+}
+
+template <> std::unique_ptr<ConnectionBalancer> createBalancer<WorkerLoadConnectionBalancerImpl>() {
+  static Random::RandomGeneratorImpl random;
+  return std::make_unique<WorkerLoadConnectionBalancerImpl>(random);
+}
+
 // Measures only the per-accept balancing cost, the exact balancer's mutex and handler scan versus
-// the lock-free increment used when the kernel steers connections. It does not measure CPU cache or
-// `NUMA` locality, which depend on the kernel and `NIC` and are out of scope for a micro-benchmark.
+// the reader locked pick of the worker load balancer and the lock-free increment used when the
+// kernel steers connections. It does not measure CPU cache or `NUMA` locality, which depend on the
+// kernel and `NIC` and are out of scope for a micro-benchmark.
 template <typename BalancerType> void benchmarkPickTargetHandler(::benchmark::State& state) {
   // Shared by every benchmark thread. Thread zero builds it before the start barrier that opens the
   // timed loop, so the other threads observe it safely once inside the loop.
   static std::unique_ptr<ConnectionBalancer> balancer;
   static std::vector<std::unique_ptr<BenchmarkConnectionHandler>> handlers;
   if (state.thread_index() == 0) {
-    balancer = std::make_unique<BalancerType>();
+    balancer = createBalancer<BalancerType>();
     handlers.clear();
     handlers.reserve(state.threads());
     for (int i = 0; i < state.threads(); i++) {
-      handlers.push_back(std::make_unique<BenchmarkConnectionHandler>());
+      // Spread the utilization so the worker load balancer has to compare the handlers.
+      handlers.push_back(std::make_unique<BenchmarkConnectionHandler>((i * 97 % 10) * 100000));
       balancer->registerHandler(*handlers.back());
     }
   }
@@ -68,6 +84,9 @@ template <typename BalancerType> void benchmarkPickTargetHandler(::benchmark::St
 BENCHMARK_TEMPLATE(benchmarkPickTargetHandler, ExactConnectionBalancerImpl)
     ->ThreadRange(1, 32)
     ->UseRealTime();
+BENCHMARK_TEMPLATE(benchmarkPickTargetHandler, WorkerLoadConnectionBalancerImpl)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
 BENCHMARK_TEMPLATE(benchmarkPickTargetHandler, NopConnectionBalancerImpl)
     ->ThreadRange(1, 32)
     ->UseRealTime();
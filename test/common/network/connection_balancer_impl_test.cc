@@ -0,0 +1,159 @@
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "source/common/common/assert.h"
+#include "source/common/network/connection_balancer_impl.h"
+
+#include "test/mocks/common.h"
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+using testing::Return;
+
+class TestConnectionHandler : public BalancedConnectionHandler {
+public:
+  uint64_t numConnections() const override { return num_connections_; }
+  void preIncNumConnections() override { ++num_connections_; }
+  void postIncNumConnections() override {}
+  uint32_t eventLoopUtilization() const override {
+    if (on_utilization_) {
+      on_utilization_();
+    }
+    return utilization_;
+  }
+  void post(ConnectionSocketPtr&&) override { PANIC("not implemented"); }
+  void onAcceptWorker(ConnectionSocketPtr&&, bool, bool,
+                      const std::optional<std::string>&) override {
+    PANIC("not implemented");
+  }
+
+  std::atomic<uint64_t> num_connections_{0};
+  uint32_t utilization_{0};
+  std::function<void()> on_utilization_;
+};
+
+class WorkerLoadConnectionBalancerTest : public testing::Test {
+public:
+  WorkerLoadConnectionBalancerTest() : balancer_(random_) {}
+
+  void addHandlers(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      handlers_.push_back(std::make_unique<TestConnectionHandler>());
+      balancer_.registerHandler(*handlers_.back());
+    }
+  }
+
+  Random::MockRandomGenerator random_;
+  WorkerLoadConnectionBalancerImpl balancer_;
+  std::vector<std::unique_ptr<TestConnectionHandler>> handlers_;
+};
+
+TEST_F(WorkerLoadConnectionBalancerTest, SingleHandler) {
+  addHandlers(1);
+  EXPECT_CALL(random_, random()).Times(0);
+  EXPECT_EQ(handlers_[0].get(), &balancer_.pickTargetHandler(*handlers_[0]));
+  EXPECT_EQ(1, handlers_[0]->numConnections());
+}
+
+TEST_F(WorkerLoadConnectionBalancerTest, MovesToLessUtilizedWorker) {
+  addHandlers(2);
+  handlers_[0]->utilization_ = 800000;
+  handlers_[1]->utilization_ = 100000;
+  // The other worker is busier in connections, but much less utilized.
+  handlers_[1]->num_connections_ = 10;
+
+  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  EXPECT_EQ(handlers_[1].get(), &balancer_.pickTargetHandler(*handlers_[0]));
+  EXPECT_EQ(11, handlers_[1]->numConnections());
+
+  // The current worker is never moved to a busier one.
+  EXPECT_CALL(random_, random()).WillOnce(Return(0));
+  EXPECT_EQ(handlers_[1].get(), &balancer_.pickTargetHandler(*handlers_[1]));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0));
+  EXPECT_EQ(handlers_[1].get(), &balancer_.pickTargetHandler(*handlers_[1]));
+  EXPECT_EQ(13, handlers_[1]->numConnections());
+  EXPECT_EQ(0, handlers_[0]->numConnections());
+}
+
+TEST_F(WorkerLoadConnectionBalancerTest, ConnectionsBreakUtilizationTies) {
+  addHandlers(2);
+  handlers_[0]->utilization_ = 500000;
+  handlers_[1]->utilization_ = 500000 + WorkerLoadConnectionBalancerImpl::UtilizationSlack;
+  handlers_[0]->num_connections_ = 3;
+
+  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  EXPECT_EQ(handlers_[1].get(), &balancer_.pickTargetHandler(*handlers_[0]));
+
+  // Equally loaded workers keep the connection where it was accepted.
+  handlers_[1]->num_connections_ = 3;
+  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  EXPECT_EQ(handlers_[0].get(), &balancer_.pickTargetHandler(*handlers_[0]));
+}
+
+TEST_F(WorkerLoadConnectionBalancerTest, UnregisteredHandlerIsNotPicked) {
+  addHandlers(3);
+  handlers_[0]->utilization_ = 900000;
+  balancer_.unregisterHandler(*handlers_[1]);
+
+  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  EXPECT_EQ(handlers_[0].get(), &balancer_.pickTargetHandler(*handlers_[0]));
+  EXPECT_EQ(0, handlers_[1]->numConnections());
+
+  // The free slot is reused by the next registration.
+  auto handler = std::make_unique<TestConnectionHandler>();
+  balancer_.registerHandler(*handler);
+  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  EXPECT_EQ(handler.get(), &balancer_.pickTargetHandler(*handlers_[0]));
+  balancer_.unregisterHandler(*handler);
+}
+
+TEST_F(WorkerLoadConnectionBalancerTest, ManyHandlers) {
+  addHandlers(100);
+  handlers_[0]->utilization_ = 900000;
+  for (uint64_t i = 1; i < handlers_.size(); ++i) {
+    EXPECT_CALL(random_, random()).WillOnce(Return(i));
+    EXPECT_EQ(handlers_[i].get(), &balancer_.pickTargetHandler(*handlers_[0]));
+  }
+}
+
+TEST_F(WorkerLoadConnectionBalancerTest, UnregisterWaitsForPicksInFlight) {
+  addHandlers(2);
+  absl::Notification picking;
+  absl::Notification release;
+  handlers_[1]->on_utilization_ = [&]() {
+    picking.Notify();
+    release.WaitForNotification();
+  };
+  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  Thread::ThreadPtr pick = Thread::threadFactoryForTest().createThread(
+      [&]() { balancer_.pickTargetHandler(*handlers_[0]); });
+  picking.WaitForNotification();
+
+  std::atomic<bool> unregistered{false};
+  Thread::ThreadPtr unregister = Thread::threadFactoryForTest().createThread([&]() {
+    balancer_.unregisterHandler(*handlers_[1]);
+    unregistered = true;
+  });
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_FALSE(unregistered);
+  release.Notify();
+  pick->join();
+  unregister->join();
+  EXPECT_TRUE(unregistered);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
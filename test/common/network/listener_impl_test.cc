@@ -4,11 +4,13 @@
 #include "envoy/network/exception.h"
 
 #include "source/common/network/address_impl.h"
+#include "source/common/network/reuse_port_bpf_cpu_steering_option_impl.h"
 #include "source/common/network/tcp_listener_impl.h"
 #include "source/common/network/utility.h"
 #include "source/common/stream_info/stream_info_impl.h"
 
 #include "test/common/network/listener_impl_test_base.h"
+#include "test/mocks/api/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/overload_manager.h"
@@ -16,6 +18,7 @@
 #include "test/test_common/logging.h"
 #include "test/test_common/network_utility.h"
 #include "test/test_common/test_runtime.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -790,6 +793,78 @@ TEST_P(TcpListenerImplTest, ShouldOnlyAcceptTheMaxNumberOfConnectionsConfiguredP
   client_connection2->close(ConnectionCloseType::NoFlush);
 }
 
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+// When the listen socket steers connections by CPU, each accepted connection reports whether the
+// kernel received it on the CPU the worker runs on.
+TEST_P(TcpListenerImplTest, RecordsIncomingCpuLocalityWhenSteeringByCpu) {
+  auto socket = std::make_shared<Network::Test::TcpListenSocketImmediateListen>(
+      Network::Test::getCanonicalLoopbackAddress(version_));
+  socket->addOption(
+      std::make_shared<ReusePortBpfCpuSteeringOptionImpl>(std::vector<uint32_t>{0}));
+  MockTcpListenerCallbacks listener_callbacks;
+  Random::MockRandomGenerator random_generator;
+  NiceMock<Runtime::MockLoader> runtime;
+  Server::ThreadLocalOverloadStateOptRef overload_state;
+  TestTcpListenerImpl listener(dispatcherImpl(), random_generator, runtime, socket,
+                               listener_callbacks, true, false, false, overload_state);
+
+  // No CPU can match, so the connection is counted as handed off from another CPU.
+  Api::MockLinuxOsSysCalls linux_os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::LinuxOsSysCallsImpl> linux_os_calls(&linux_os_sys_calls);
+  EXPECT_CALL(linux_os_sys_calls, sched_getcpu())
+      .WillRepeatedly(Return(Api::SysCallIntResult{CPU_SETSIZE, 0}));
+
+  ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket->connectionInfoProvider().localAddress(), Address::InstanceConstSharedPtr(),
+      Network::Test::createRawBufferSocket(), nullptr, nullptr);
+  client_connection->connect();
+
+  Network::ConnectionSocketPtr server_socket;
+  EXPECT_CALL(listener_callbacks, recordIncomingCpuLocality(false));
+  EXPECT_CALL(listener_callbacks, recordConnectionsAcceptedOnSocketEvent(1));
+  EXPECT_CALL(listener_callbacks, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& accepted_socket) -> void {
+        server_socket = std::move(accepted_socket);
+        dispatcher_->exit();
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  client_connection->close(ConnectionCloseType::NoFlush);
+}
+
+TEST_P(TcpListenerImplTest, DoesNotRecordIncomingCpuLocalityWithoutSteering) {
+  auto socket = std::make_shared<Network::Test::TcpListenSocketImmediateListen>(
+      Network::Test::getCanonicalLoopbackAddress(version_));
+  MockTcpListenerCallbacks listener_callbacks;
+  Random::MockRandomGenerator random_generator;
+  NiceMock<Runtime::MockLoader> runtime;
+  Server::ThreadLocalOverloadStateOptRef overload_state;
+  TestTcpListenerImpl listener(dispatcherImpl(), random_generator, runtime, socket,
+                               listener_callbacks, true, false, false, overload_state);
+
+  Api::MockLinuxOsSysCalls linux_os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::LinuxOsSysCallsImpl> linux_os_calls(&linux_os_sys_calls);
+  EXPECT_CALL(linux_os_sys_calls, sched_getcpu()).Times(0);
+
+  ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket->connectionInfoProvider().localAddress(), Address::InstanceConstSharedPtr(),
+      Network::Test::createRawBufferSocket(), nullptr, nullptr);
+  client_connection->connect();
+
+  Network::ConnectionSocketPtr server_socket;
+  EXPECT_CALL(listener_callbacks, recordIncomingCpuLocality(_)).Times(0);
+  EXPECT_CALL(listener_callbacks, recordConnectionsAcceptedOnSocketEvent(1));
+  EXPECT_CALL(listener_callbacks, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& accepted_socket) -> void {
+        server_socket = std::move(accepted_socket);
+        dispatcher_->exit();
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  client_connection->close(ConnectionCloseType::NoFlush);
+}
+#endif
+
 } // namespace
 } // namespace Network
 } // namespace Envoy
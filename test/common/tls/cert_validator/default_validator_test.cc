@@ -8,6 +8,7 @@
 #include "test/common/tls/ssl_test_utility.h"
 #include "test/mocks/server/server_factory_context.h"
 #include "test/test_common/environment.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/status_utility.h"
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
@@ -717,6 +718,12 @@ public:
   std::optional<uint32_t> maxVerifyDepth() const override { return std::nullopt; }
   bool autoSniSanMatch() const override { return false; }
   bool suppressClientCaList() const override { return false; }
+  const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                          CertificateValidationContext::VerificationCache>&
+  verificationCache() const override {
+    CONSTRUCT_ON_FIRST_USE(std::optional<envoy::extensions::transport_sockets::tls::v3::
+                                             CertificateValidationContext::VerificationCache>);
+  }
 
 private:
   std::string s_;
@@ -794,6 +801,12 @@ public:
   std::optional<uint32_t> maxVerifyDepth() const override { return std::nullopt; }
   bool autoSniSanMatch() const override { return false; }
   bool suppressClientCaList() const override { return false; }
+  const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                          CertificateValidationContext::VerificationCache>&
+  verificationCache() const override {
+    CONSTRUCT_ON_FIRST_USE(std::optional<envoy::extensions::transport_sockets::tls::v3::
+                                             CertificateValidationContext::VerificationCache>);
+  }
 
 private:
   std::string ca_name_;
@@ -1163,6 +1176,156 @@ TEST(DefaultCertValidatorTest, SharesCrlAcrossContexts) {
   EXPECT_EQ(getCrlCache(context.singletonManager())->size(), 2);
 }
 
+// Certificate validation context config that trusts ca_cert.pem and caches
+// verification results.
+class CachingValidationContextConfig : public TestCertificateValidationContextConfig {
+public:
+  explicit CachingValidationContextConfig(uint32_t max_entries)
+      : ca_pem_(TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+            "{{ test_rundir }}/test/common/tls/test_data/ca_cert.pem"))) {
+    cache_config_.emplace();
+    cache_config_->mutable_max_entries()->set_value(max_entries);
+  }
+  const std::string& caCert() const override { return ca_pem_; }
+  const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                          CertificateValidationContext::VerificationCache>&
+  verificationCache() const override {
+    return cache_config_;
+  }
+
+private:
+  const std::string ca_pem_;
+  std::optional<envoy::extensions::transport_sockets::tls::v3::
+                    CertificateValidationContext::VerificationCache>
+      cache_config_;
+};
+
+bssl::UniquePtr<STACK_OF(X509)> chainFromFile(const std::string& file) {
+  bssl::UniquePtr<STACK_OF(X509)> chain(sk_X509_new_null());
+  bssl::UniquePtr<X509> cert = readCertFromFile(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/" + file));
+  EXPECT_TRUE(bssl::PushToStack(chain.get(), std::move(cert)));
+  return chain;
+}
+
+// A chain that passed verification is served from the cache on the next
+// handshake, and the cached result carries the same verified chain.
+TEST(DefaultCertValidatorTest, VerificationCacheHit) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  Stats::TestUtil::TestStore store;
+  SslStats stats = generateSslStats(*store.rootScope());
+  CachingValidationContextConfig config(16);
+  DefaultCertValidator validator(&config, stats, context);
+  bssl::UniquePtr<SSL_CTX> ssl_ctx(SSL_CTX_new(TLS_method()));
+  ASSERT_OK(validator.initializeSslContexts({ssl_ctx.get()}, false, *store.rootScope()));
+
+  bssl::UniquePtr<STACK_OF(X509)> chain = chainFromFile("san_dns_cert.pem");
+  ValidationResults first = validator.doVerifyCertChain(*chain, nullptr, nullptr, *ssl_ctx, {},
+                                                        false, "");
+  EXPECT_EQ(ValidationResults::ValidationStatus::Successful, first.status);
+  EXPECT_EQ(1, stats.verification_cache_miss_.value());
+  EXPECT_EQ(0, stats.verification_cache_hit_.value());
+
+  ValidationResults second = validator.doVerifyCertChain(*chain, nullptr, nullptr, *ssl_ctx, {},
+                                                         false, "");
+  EXPECT_EQ(ValidationResults::ValidationStatus::Successful, second.status);
+  EXPECT_EQ(Envoy::Ssl::ClientValidationStatus::Validated, second.detailed_status);
+  EXPECT_EQ(1, stats.verification_cache_hit_.value());
+  ASSERT_EQ(first.validated_chain.size(), second.validated_chain.size());
+  for (size_t i = 0; i < first.validated_chain.size(); i++) {
+    EXPECT_EQ(0, X509_cmp(first.validated_chain[i].get(), second.validated_chain[i].get()));
+  }
+
+  // The verification purpose is part of the key.
+  validator.doVerifyCertChain(*chain, nullptr, nullptr, *ssl_ctx, {}, true, "");
+  EXPECT_EQ(2, stats.verification_cache_miss_.value());
+}
+
+// Chains that fail verification are not cached, so they are rejected every time.
+TEST(DefaultCertValidatorTest, VerificationCacheSkipsFailures) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  Stats::TestUtil::TestStore store;
+  SslStats stats = generateSslStats(*store.rootScope());
+  CachingValidationContextConfig config(16);
+  DefaultCertValidator validator(&config, stats, context);
+  bssl::UniquePtr<SSL_CTX> ssl_ctx(SSL_CTX_new(TLS_method()));
+  ASSERT_OK(validator.initializeSslContexts({ssl_ctx.get()}, false, *store.rootScope()));
+
+  bssl::UniquePtr<STACK_OF(X509)> chain = chainFromFile("selfsigned_cert.pem");
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(ValidationResults::ValidationStatus::Failed,
+              validator.doVerifyCertChain(*chain, nullptr, nullptr, *ssl_ctx, {}, false, "")
+                  .status);
+  }
+  EXPECT_EQ(2, stats.fail_verify_error_.value());
+  EXPECT_EQ(2, stats.verification_cache_miss_.value());
+  EXPECT_EQ(0, stats.verification_cache_hit_.value());
+}
+
+TEST(VerificationCacheTest, ExpiresAfterTtl) {
+  Event::SimulatedTimeSystem time_system;
+  Stats::TestUtil::TestStore store;
+  SslStats stats = generateSslStats(*store.rootScope());
+  VerificationCache cache(16, std::chrono::seconds(60), false, time_system, stats);
+
+  bssl::UniquePtr<STACK_OF(X509)> chain = chainFromFile("san_dns_cert.pem");
+  const VerificationCache::Key key = VerificationCache::key(*chain, false);
+  cache.insert(key, chain.get());
+  EXPECT_TRUE(cache.lookup(key).has_value());
+
+  time_system.advanceTimeWait(std::chrono::seconds(60));
+  EXPECT_FALSE(cache.lookup(key).has_value());
+  EXPECT_EQ(0, cache.size());
+}
+
+// An entry never outlives the certificates it was computed for.
+TEST(VerificationCacheTest, BoundedByCertificateExpiration) {
+  Event::SimulatedTimeSystem time_system;
+  Stats::TestUtil::TestStore store;
+  SslStats stats = generateSslStats(*store.rootScope());
+  VerificationCache cache(16, std::chrono::hours(24), false, time_system, stats);
+
+  bssl::UniquePtr<STACK_OF(X509)> chain = chainFromFile("san_dns_cert.pem");
+  const SystemTime not_after = Utility::getExpirationTime(*sk_X509_value(chain.get(), 0));
+  time_system.setSystemTime(not_after - std::chrono::seconds(10));
+  const VerificationCache::Key key = VerificationCache::key(*chain, false);
+  cache.insert(key, chain.get());
+  EXPECT_TRUE(cache.lookup(key).has_value());
+
+  time_system.advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_FALSE(cache.lookup(key).has_value());
+
+  // Already expired chains are not cached at all.
+  cache.insert(key, chain.get());
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(VerificationCacheTest, EvictsLeastRecentlyUsed) {
+  Event::SimulatedTimeSystem time_system;
+  Stats::TestUtil::TestStore store;
+  SslStats stats = generateSslStats(*store.rootScope());
+  VerificationCache cache(2, std::chrono::seconds(60), false, time_system, stats);
+
+  bssl::UniquePtr<STACK_OF(X509)> chain1 = chainFromFile("san_dns_cert.pem");
+  bssl::UniquePtr<STACK_OF(X509)> chain2 = chainFromFile("san_dns2_cert.pem");
+  bssl::UniquePtr<STACK_OF(X509)> chain3 = chainFromFile("san_dns3_cert.pem");
+  const VerificationCache::Key key1 = VerificationCache::key(*chain1, false);
+  const VerificationCache::Key key2 = VerificationCache::key(*chain2, false);
+  const VerificationCache::Key key3 = VerificationCache::key(*chain3, false);
+
+  cache.insert(key1, chain1.get());
+  cache.insert(key2, chain2.get());
+  // Touch the first chain so that the second one becomes the eviction candidate.
+  EXPECT_TRUE(cache.lookup(key1).has_value());
+  cache.insert(key3, chain3.get());
+
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(1, stats.verification_cache_evicted_.value());
+  EXPECT_TRUE(cache.lookup(key1).has_value());
+  EXPECT_FALSE(cache.lookup(key2).has_value());
+  EXPECT_TRUE(cache.lookup(key3).has_value());
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
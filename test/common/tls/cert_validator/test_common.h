@@ -120,6 +120,12 @@ public:
 
   bool suppressClientCaList() const override { return suppress_client_ca_list_; }
 
+  const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                          CertificateValidationContext::VerificationCache>&
+  verificationCache() const override {
+    return verification_cache_;
+  }
+
 private:
   bool allow_expired_certificate_{false};
   Api::ApiPtr api_;
@@ -132,6 +138,9 @@ private:
   const std::optional<uint32_t> max_verify_depth_{std::nullopt};
   const bool auto_sni_san_match_{false};
   const bool suppress_client_ca_list_{false};
+  const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                          CertificateValidationContext::VerificationCache>
+      verification_cache_;
 };
 
 } // namespace Tls
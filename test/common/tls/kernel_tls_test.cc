@@ -0,0 +1,189 @@
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "source/common/tls/kernel_tls.h"
+
+#include "test/test_common/environment.h"
+
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+// Sets up a TLS connection between two BoringSSL endpoints over loopback TCP, which is required
+// for the kernel TLS ULP.
+class KernelTlsTest : public testing::TestWithParam<std::string> {
+protected:
+  void SetUp() override {
+    int listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listen_fd, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    ASSERT_EQ(0, ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), addr_len));
+    ASSERT_EQ(0, ::listen(listen_fd, 1));
+    ASSERT_EQ(0, ::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len));
+    client_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(0, ::connect(client_fd_, reinterpret_cast<sockaddr*>(&addr), addr_len));
+    server_fd_ = ::accept(listen_fd, nullptr, nullptr);
+    ::close(listen_fd);
+    ASSERT_GE(server_fd_, 0);
+    ::fcntl(client_fd_, F_SETFL, O_NONBLOCK);
+    ::fcntl(server_fd_, F_SETFL, O_NONBLOCK);
+  }
+
+  void TearDown() override {
+    ::close(client_fd_);
+    ::close(server_fd_);
+  }
+
+  void handshake(uint16_t version, const std::string& cipher) {
+    server_ctx_.reset(SSL_CTX_new(TLS_method()));
+    client_ctx_.reset(SSL_CTX_new(TLS_method()));
+    const std::string cert_path =
+        TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/san_dns_cert.pem");
+    const std::string key_path =
+        TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/san_dns_key.pem");
+    ASSERT_EQ(1, SSL_CTX_use_certificate_file(server_ctx_.get(), cert_path.c_str(),
+                                              SSL_FILETYPE_PEM));
+    ASSERT_EQ(1,
+              SSL_CTX_use_PrivateKey_file(server_ctx_.get(), key_path.c_str(), SSL_FILETYPE_PEM));
+    for (SSL_CTX* ctx : {server_ctx_.get(), client_ctx_.get()}) {
+      SSL_CTX_set_min_proto_version(ctx, version);
+      SSL_CTX_set_max_proto_version(ctx, version);
+      if (!cipher.empty()) {
+        ASSERT_EQ(1, SSL_CTX_set_strict_cipher_list(ctx, cipher.c_str()));
+      }
+    }
+
+    server_ssl_.reset(SSL_new(server_ctx_.get()));
+    SSL_set_fd(server_ssl_.get(), server_fd_);
+    SSL_set_accept_state(server_ssl_.get());
+    client_ssl_.reset(SSL_new(client_ctx_.get()));
+    SSL_set_fd(client_ssl_.get(), client_fd_);
+    SSL_set_connect_state(client_ssl_.get());
+
+    for (int i = 0; i < 100; i++) {
+      const int client_rc = SSL_do_handshake(client_ssl_.get());
+      const int server_rc = SSL_do_handshake(server_ssl_.get());
+      if (client_rc == 1 && server_rc == 1) {
+        return;
+      }
+    }
+    FAIL() << "handshake did not complete";
+  }
+
+  // Reads exactly `len` bytes, either through BoringSSL or directly from the socket.
+  std::string readAll(SSL* ssl, int fd, bool kernel, size_t len) {
+    std::string out(len, '\0');
+    size_t offset = 0;
+    for (int i = 0; i < 1000 && offset < len; i++) {
+      const int rc = kernel ? ::read(fd, &out[offset], len - offset)
+                            : SSL_read(ssl, &out[offset], len - offset);
+      if (rc > 0) {
+        offset += rc;
+      }
+    }
+    out.resize(offset);
+    return out;
+  }
+
+  int client_fd_{-1};
+  int server_fd_{-1};
+  bssl::UniquePtr<SSL_CTX> server_ctx_;
+  bssl::UniquePtr<SSL_CTX> client_ctx_;
+  bssl::UniquePtr<SSL> server_ssl_;
+  bssl::UniquePtr<SSL> client_ssl_;
+};
+
+INSTANTIATE_TEST_SUITE_P(Ciphers, KernelTlsTest,
+                         testing::Values("ECDHE-RSA-AES128-GCM-SHA256",
+                                         "ECDHE-RSA-AES256-GCM-SHA384",
+                                         "ECDHE-RSA-CHACHA20-POLY1305"));
+
+// Records produced and consumed by the kernel are interchangeable with BoringSSL's, which checks
+// the key, nonce and sequence number export.
+TEST_P(KernelTlsTest, InteroperatesWithBoringSsl) {
+  handshake(TLS1_2_VERSION, GetParam());
+  auto offload_or_error = KernelTls::enable(client_ssl_.get(), client_fd_);
+  if (!offload_or_error.ok()) {
+    GTEST_SKIP() << "kernel TLS unavailable: " << offload_or_error.status();
+  }
+  ASSERT_TRUE(offload_or_error->rx_);
+  if (!offload_or_error->tx_) {
+    GTEST_SKIP() << "kernel TLS transmit offload unavailable";
+  }
+
+  const std::string request = "hello from the kernel";
+  ASSERT_EQ(static_cast<ssize_t>(request.size()),
+            ::write(client_fd_, request.data(), request.size()));
+  EXPECT_EQ(request, readAll(server_ssl_.get(), server_fd_, false, request.size()));
+
+  const std::string response = "hello from BoringSSL";
+  ASSERT_EQ(static_cast<int>(response.size()),
+            SSL_write(server_ssl_.get(), response.data(), response.size()));
+  EXPECT_EQ(response,
+            readAll(client_ssl_.get(), client_fd_, true, response.size()));
+}
+
+TEST_P(KernelTlsTest, CloseNotify) {
+  handshake(TLS1_2_VERSION, GetParam());
+  auto offload_or_error = KernelTls::enable(client_ssl_.get(), client_fd_);
+  if (!offload_or_error.ok() || !offload_or_error->tx_) {
+    GTEST_SKIP() << "kernel TLS unavailable";
+  }
+
+  // close_notify sent by the kernel is seen by BoringSSL as a graceful shutdown.
+  ASSERT_EQ(2, KernelTls::sendCloseNotify(client_fd_).return_value_);
+  char byte;
+  int rc = 0;
+  for (int i = 0; i < 1000 && rc <= 0; i++) {
+    rc = SSL_read(server_ssl_.get(), &byte, 1);
+    if (SSL_get_error(server_ssl_.get(), rc) == SSL_ERROR_ZERO_RETURN) {
+      break;
+    }
+  }
+  EXPECT_EQ(SSL_ERROR_ZERO_RETURN, SSL_get_error(server_ssl_.get(), rc));
+
+  // close_notify sent by BoringSSL makes plain reads fail until the alert is consumed.
+  SSL_shutdown(server_ssl_.get());
+  EXPECT_EQ(-1, ::read(client_fd_, &byte, 1));
+  EXPECT_EQ(EIO, errno);
+  EXPECT_TRUE(KernelTls::consumeCloseNotify(client_fd_));
+}
+
+// Records that BoringSSL already buffered cannot be handed to the kernel, so neither direction is
+// offloaded.
+TEST_P(KernelTlsTest, RefusedWithPendingData) {
+  handshake(TLS1_2_VERSION, GetParam());
+  const std::string data = "early";
+  ASSERT_EQ(static_cast<int>(data.size()),
+            SSL_write(server_ssl_.get(), data.data(), data.size()));
+  EXPECT_EQ("e", readAll(client_ssl_.get(), client_fd_, false, 1));
+  ASSERT_TRUE(SSL_has_pending(client_ssl_.get()));
+
+  auto offload_or_error = KernelTls::enable(client_ssl_.get(), client_fd_);
+  EXPECT_EQ(absl::StatusCode::kUnavailable, offload_or_error.status().code());
+  EXPECT_EQ("arly", readAll(client_ssl_.get(), client_fd_, false, 4));
+}
+
+TEST_F(KernelTlsTest, Tls13NotSupported) {
+  handshake(TLS1_3_VERSION, "");
+  auto offload_or_error = KernelTls::enable(client_ssl_.get(), client_fd_);
+  EXPECT_EQ(absl::StatusCode::kUnimplemented, offload_or_error.status().code());
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -2188,6 +2188,42 @@ TEST_P(SslSocketTest, MultiCertPreferEcdsaWithoutSni) {
   testUtil(test_options);
 }
 
+// When several ECDSA certificates are compatible with the client, the first configured one is
+// selected by the full scan.
+TEST_P(SslSocketTest, MultiCertPreferFirstEcdsaWithoutSni) {
+  const std::string client_ctx_yaml = absl::StrCat(R"EOF(
+    common_tls_context:
+      tls_params:
+        tls_minimum_protocol_version: TLSv1_2
+        tls_maximum_protocol_version: TLSv1_2
+        cipher_suites:
+        - ECDHE-ECDSA-AES128-GCM-SHA256
+        - ECDHE-RSA-AES128-GCM-SHA256
+      validation_context:
+        verify_certificate_hash: )EOF",
+                                                   TEST_SAN_DNS_ECDSA_1_CERT_256_HASH);
+
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/no_san_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/no_san_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/san_dns_ecdsa_1_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/san_dns_ecdsa_1_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/selfsigned_ecdsa_p256_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/selfsigned_ecdsa_p256_key.pem"
+)EOF";
+
+  TestUtilOptions test_options(client_ctx_yaml, server_ctx_yaml, true, version_);
+  testUtil(test_options);
+}
+
 // When client supports SNI, exact match is preferred over wildcard match.
 TEST_P(SslSocketTest, MultiCertPreferExactSniMatch) {
   const std::string client_ctx_yaml = absl::StrCat(R"EOF(
@@ -7877,6 +7913,214 @@ TEST_P(SslReadBufferLimitTest, SmallReadsIntoSameSlice) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// Drives SslSocket over loopback connections with kernel TLS offload. The tests are skipped when
+// the kernel does not provide the TLS ULP.
+class SslKernelTlsTest : public SslSocketTest {
+protected:
+  // Connects a client with kernel TLS enabled to a server, and runs until both are connected.
+  void connect(bool server_kernel_tls) {
+    envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext server_tls_context;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml_), server_tls_context);
+    server_tls_context.mutable_common_tls_context()->set_enable_kernel_tls(server_kernel_tls);
+    auto server_cfg =
+        *ServerContextConfigImpl::create(server_tls_context, factory_context_, {}, false);
+    manager_ = std::make_unique<ContextManagerImpl>(factory_context_.serverFactoryContext());
+    server_ssl_socket_factory_ = *ServerSslSocketFactory::create(std::move(server_cfg), *manager_,
+                                                                 *server_stats_store_.rootScope());
+
+    socket_ = std::make_shared<Network::Test::TcpListenSocketImmediateListen>(
+        Network::Test::getCanonicalLoopbackAddress(version_));
+    NiceMock<Network::MockListenerConfig> listener_config;
+    Server::ThreadLocalOverloadStateOptRef overload_state;
+    listener_ = createListener(socket_, listener_callbacks_, runtime_, listener_config,
+                               overload_state, *dispatcher_);
+
+    envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext client_tls_context;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml_), client_tls_context);
+    auto client_cfg = *ClientContextConfigImpl::create(client_tls_context, factory_context_);
+    client_ssl_socket_factory_ = *ClientSslSocketFactory::create(std::move(client_cfg), *manager_,
+                                                                 *client_stats_store_.rootScope());
+    client_connection_ = dispatcher_->createClientConnection(
+        socket_->connectionInfoProvider().localAddress(), nullptr,
+        client_ssl_socket_factory_->createTransportSocket(nullptr, nullptr), nullptr, nullptr);
+    client_connection_->enableHalfClose(true);
+    client_connection_->addConnectionCallbacks(client_callbacks_);
+    client_connection_->addReadFilter(readFilter(client_received_, client_end_stream_));
+    client_connection_->connect();
+
+    EXPECT_CALL(listener_callbacks_, onAccept_(_))
+        .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+          server_connection_ = dispatcher_->createServerConnection(
+              std::move(socket), server_ssl_socket_factory_->createDownstreamTransportSocket(),
+              stream_info_);
+          server_connection_->enableHalfClose(true);
+          server_connection_->addConnectionCallbacks(server_callbacks_);
+          server_connection_->addReadFilter(readFilter(server_received_, server_end_stream_));
+        }));
+    EXPECT_CALL(listener_callbacks_, recordConnectionsAcceptedOnSocketEvent(_));
+
+    uint32_t connected = 0;
+    auto on_connected = [&](Network::ConnectionEvent) -> void {
+      if (++connected == 2) {
+        dispatcher_->exit();
+      }
+    };
+    EXPECT_CALL(client_callbacks_, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke(on_connected));
+    EXPECT_CALL(server_callbacks_, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke(on_connected));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  // Appends everything read to `received`, and stops the dispatcher so that tests can check
+  // their condition.
+  Network::ReadFilterSharedPtr readFilter(std::string& received, bool& end_stream) {
+    auto filter = std::make_shared<NiceMock<Network::MockReadFilter>>();
+    ON_CALL(*filter, onData(_, _))
+        .WillByDefault(Invoke([&](Buffer::Instance& data, bool end) -> Network::FilterStatus {
+          received.append(data.toString());
+          data.drain(data.length());
+          end_stream |= end;
+          dispatcher_->exit();
+          return Network::FilterStatus::StopIteration;
+        }));
+    return filter;
+  }
+
+  bool offloaded(Stats::TestUtil::TestStore& stats_store) {
+    return stats_store.counter("ssl.kernel_tls_rx").value() == 1;
+  }
+
+  void disconnect() {
+    client_connection_->close(Network::ConnectionCloseType::NoFlush);
+    server_connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+
+  Stats::TestUtil::TestStore server_stats_store_;
+  Stats::TestUtil::TestStore client_stats_store_;
+  std::shared_ptr<Network::Test::TcpListenSocketImmediateListen> socket_;
+  Network::MockTcpListenerCallbacks listener_callbacks_;
+  // Kernel TLS is only supported for TLS 1.2.
+  const std::string server_ctx_yaml_ = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/unittest_key.pem"
+)EOF";
+  const std::string client_ctx_yaml_ = R"EOF(
+  common_tls_context:
+    enable_kernel_tls: true
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+)EOF";
+
+  std::unique_ptr<ContextManagerImpl> manager_;
+  Network::DownstreamTransportSocketFactoryPtr server_ssl_socket_factory_;
+  Network::UpstreamTransportSocketFactoryPtr client_ssl_socket_factory_;
+  Network::ListenerPtr listener_;
+  Network::ClientConnectionPtr client_connection_;
+  Network::ConnectionPtr server_connection_;
+  NiceMock<Network::MockConnectionCallbacks> client_callbacks_;
+  NiceMock<Network::MockConnectionCallbacks> server_callbacks_;
+  std::string client_received_;
+  std::string server_received_;
+  bool client_end_stream_{false};
+  bool server_end_stream_{false};
+};
+
+INSTANTIATE_TEST_SUITE_P(IpVersions, SslKernelTlsTest,
+                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                         TestUtility::ipTestParamsToString);
+
+// Data flows in both directions, including a response too large for the socket buffers, which
+// has to be written in several partial writes.
+TEST_P(SslKernelTlsTest, ReadAndWrite) {
+  connect(true);
+  if (!offloaded(client_stats_store_) || !offloaded(server_stats_store_)) {
+    disconnect();
+    GTEST_SKIP() << "kernel TLS unavailable";
+  }
+
+  Buffer::OwnedImpl request("hello");
+  client_connection_->write(request, false);
+  while (server_received_.size() < 5) {
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+  EXPECT_EQ("hello", server_received_);
+
+  std::string response(8 * 1024 * 1024, '\0');
+  for (size_t i = 0; i < response.size(); i++) {
+    response[i] = 'a' + i % 26;
+  }
+  Buffer::OwnedImpl response_buffer(response);
+  server_connection_->write(response_buffer, false);
+  while (client_received_.size() < response.size()) {
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+  EXPECT_EQ(response, client_received_);
+
+  disconnect();
+  EXPECT_EQ(0UL, server_stats_store_.counter("ssl.connection_error").value());
+  EXPECT_EQ(0UL, client_stats_store_.counter("ssl.connection_error").value());
+}
+
+// The close_notify alert is sent through and consumed from the kernel in both directions.
+TEST_P(SslKernelTlsTest, CloseNotify) {
+  connect(true);
+  if (!offloaded(client_stats_store_) || !offloaded(server_stats_store_)) {
+    disconnect();
+    GTEST_SKIP() << "kernel TLS unavailable";
+  }
+  ASSERT_EQ(1UL, server_stats_store_.counter("ssl.kernel_tls_tx").value());
+  ASSERT_EQ(1UL, client_stats_store_.counter("ssl.kernel_tls_tx").value());
+
+  Buffer::OwnedImpl response("bye");
+  server_connection_->write(response, true);
+  while (!client_end_stream_) {
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+  EXPECT_EQ("bye", client_received_);
+
+  EXPECT_CALL(server_callbacks_, onEvent(Network::ConnectionEvent::RemoteClose));
+  Buffer::OwnedImpl request("ack");
+  client_connection_->write(request, true);
+  while (!server_end_stream_) {
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+  EXPECT_EQ("ack", server_received_);
+
+  disconnect();
+  EXPECT_EQ(0UL, server_stats_store_.counter("ssl.connection_error").value());
+  EXPECT_EQ(0UL, client_stats_store_.counter("ssl.connection_error").value());
+}
+
+// A record that the kernel cannot decrypt closes the connection.
+TEST_P(SslKernelTlsTest, CorruptRecordClosesConnection) {
+  connect(false);
+  if (!offloaded(client_stats_store_)) {
+    disconnect();
+    GTEST_SKIP() << "kernel TLS unavailable";
+  }
+
+  // The server keeps its record protection in BoringSSL, so bytes written on its socket reach
+  // the client unencrypted.
+  Buffer::OwnedImpl record(absl::string_view("\x17\x03\x03\x00\x20", 5));
+  record.add(std::string(32, 'x'));
+  ASSERT_EQ(37, server_connection_->getSocket()->ioHandle().write(record).return_value_);
+
+  EXPECT_CALL(client_callbacks_, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ("", client_received_);
+  EXPECT_FALSE(client_end_stream_);
+
+  disconnect();
+}
+
 // Test asynchronous signing (ECDHE) using a private key provider.
 BORINGSSL_TEST_P(SslSocketTest, RsaPrivateKeyProviderAsyncSignSuccess) {
   const std::string server_ctx_yaml = R"EOF(
@@ -1,3 +1,4 @@
+#include "source/common/config/metadata.h"
 #include "source/common/protobuf/utility.h"
 
 #include "test/benchmark/main.h"
@@ -186,6 +187,62 @@ BENCHMARK(bmUpdateHostListCachedHash)
     ->Args({5000, 20})
     ->Unit(::benchmark::kMillisecond);
 
+// Simulate updateDynamicHostList with interned metadata. Each incoming host interns its metadata,
+// which finds the pack held by the existing host, and caches the hash that
+// updateDynamicHostList() compares through metadataHash(), like HostDescriptionImpl does.
+void bmUpdateHostListInterned(::benchmark::State& state) {
+  using Interner = Config::MetadataPackInterner<Config::TypedMetadataFactory>;
+  const int num_hosts = state.range(0);
+  const int num_fields = state.range(1);
+  if (benchmark::skipExpensiveBenchmarks() && num_hosts > 1000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+  std::vector<Config::MetadataPackConstSharedPtr<Config::TypedMetadataFactory>> existing;
+  std::vector<std::size_t> existing_hashes;
+  std::vector<envoy::config::core::v3::Metadata> incoming;
+  existing.reserve(num_hosts);
+  existing_hashes.reserve(num_hosts);
+  incoming.reserve(num_hosts);
+  for (int i = 0; i < num_hosts; i++) {
+    existing.push_back(Interner::get(buildMetadata(1, num_fields)));
+    existing_hashes.push_back(MessageUtil::hash(existing.back()->proto_metadata_));
+    incoming.push_back(buildMetadata(1, num_fields));
+  }
+
+  for (auto _ : state) { // NOLINT
+    int changed = 0;
+    for (int i = 0; i < num_hosts; i++) {
+      const auto pack = Interner::get(incoming[i]);
+      const std::size_t metadata_hash = MessageUtil::hash(pack->proto_metadata_);
+      if (metadata_hash != existing_hashes[i]) {
+        changed++;
+      }
+    }
+    ::benchmark::DoNotOptimize(changed);
+  }
+}
+BENCHMARK(bmUpdateHostListInterned)
+    ->Args({100, 5})
+    ->Args({1000, 5})
+    ->Args({5000, 5})
+    ->Args({5000, 20})
+    ->Unit(::benchmark::kMillisecond);
+
+// Benchmark interning metadata that is already in the table, which is what building a host or a
+// route with common metadata costs.
+void bmInternExisting(::benchmark::State& state) {
+  using Interner = Config::MetadataPackInterner<Config::TypedMetadataFactory>;
+  const auto metadata = buildMetadata(state.range(0), state.range(1));
+  const auto pack = Interner::get(metadata);
+
+  for (auto _ : state) { // NOLINT
+    auto result = Interner::get(metadata);
+    ::benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(bmInternExisting)->Args({1, 5})->Args({3, 10})->Args({5, 20})->Args({10, 50});
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -12,6 +12,7 @@
 
 #include "source/common/config/protobuf_link_hacks.h"
 #include "source/common/config/utility.h"
+#include "source/common/memory/stats.h"
 #include "source/common/singleton/manager_impl.h"
 #include "source/extensions/clusters/eds/eds.h"
 #include "source/extensions/config_subscription/grpc/grpc_mux_impl.h"
@@ -165,6 +166,53 @@ public:
            num_hosts);
   }
 
+  // Creates num_clusters EDS clusters that are all assigned the same num_hosts endpoints, and
+  // reports the memory taken by their hosts.
+  void sharedEndpointsMemoryHelper(size_t num_clusters, size_t num_hosts) {
+    state_.PauseTiming();
+    envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
+    cluster_load_assignment.set_cluster_name("fare");
+    auto* endpoints = cluster_load_assignment.add_endpoints();
+    auto* locality = endpoints->mutable_locality();
+    locality->set_region("region");
+    locality->set_zone("zone");
+    for (size_t i = 0; i < num_hosts; ++i) {
+      auto* lb_endpoint = endpoints->add_lb_endpoints();
+      lb_endpoint->set_health_status(envoy::config::core::v3::HEALTHY);
+      auto* socket_address =
+          lb_endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address();
+      socket_address->set_address("10.0.1." + std::to_string(i / 60000));
+      socket_address->set_port_value((1000 + i) % 60000);
+    }
+    const auto decoded_resources =
+        TestUtility::decodeResources({cluster_load_assignment}, "cluster_name");
+
+    EXPECT_CALL(*server_context_.cluster_manager_.subscription_factory_.subscription_, start(_))
+        .Times(num_clusters);
+    std::vector<std::pair<EdsClusterImplSharedPtr, Config::SubscriptionCallbacks*>> clusters;
+    for (size_t i = 0; i < num_clusters; ++i) {
+      envoy::config::cluster::v3::Cluster config = eds_cluster_;
+      config.set_name(fmt::format("cluster_{}", i));
+      Envoy::Upstream::ClusterFactoryContextImpl factory_context(server_context_, nullptr, nullptr,
+                                                                 false);
+      EdsClusterImplSharedPtr cluster = *EdsClusterImpl::create(config, factory_context);
+      cluster->initialize([] { return absl::OkStatus(); });
+      clusters.emplace_back(cluster,
+                            server_context_.cluster_manager_.subscription_factory_.callbacks_);
+    }
+
+    const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
+    state_.ResumeTiming();
+    for (const auto& cluster : clusters) {
+      THROW_IF_NOT_OK(cluster.second->onConfigUpdate(decoded_resources.refvec_, ""));
+    }
+    state_.PauseTiming();
+    const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
+    state_.counters["memory"] = end_mem - start_mem;
+    state_.counters["memory_per_host"] = (end_mem - start_mem) / (num_clusters * num_hosts);
+    state_.ResumeTiming();
+  }
+
   NiceMock<Server::Configuration::MockServerFactoryContext> server_context_;
   Stats::TestUtil::TestStore& stats_ = server_context_.store_;
 
@@ -242,3 +290,22 @@ static void healthOnlyUpdate(State& state) {
 }
 
 BENCHMARK(healthOnlyUpdate)->Ranges({{1, 100000}, {false, true}})->Unit(benchmark::kMillisecond);
+
+static void sharedEndpointsMemory(State& state) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(spdlog::level::warn,
+                                       Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock, false);
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    Envoy::Upstream::EdsSpeedTest speed_test(state, false);
+    const uint32_t clusters = skipExpensiveBenchmarks() ? 1 : state.range(0);
+    const uint32_t endpoints = skipExpensiveBenchmarks() ? 1 : state.range(1);
+
+    speed_test.sharedEndpointsMemoryHelper(clusters, endpoints);
+  }
+}
+
+BENCHMARK(sharedEndpointsMemory)
+    ->Args({1, 1000})
+    ->Args({100, 1000})
+    ->Args({1000, 100})
+    ->Unit(benchmark::kMillisecond);
@@ -623,6 +623,54 @@ TEST_F(EdsTest, EndpointMetadata) {
             "v3");
 }
 
+// Hosts of different clusters with the same endpoint share its address.
+TEST_F(EdsTest, EndpointAddressSharedAcrossClusters) {
+  envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
+  cluster_load_assignment.set_cluster_name("fare");
+  auto* socket_address = cluster_load_assignment.add_endpoints()
+                             ->add_lb_endpoints()
+                             ->mutable_endpoint()
+                             ->mutable_address()
+                             ->mutable_socket_address();
+  socket_address->set_address("1.2.3.4");
+  socket_address->set_port_value(80);
+
+  initialize();
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  const auto first_address =
+      cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->address();
+
+  resetCluster(R"EOF(
+      name: other
+      connect_timeout: 0.25s
+      type: EDS
+      lb_policy: ROUND_ROBIN
+      eds_cluster_config:
+        service_name: fare
+        eds_config:
+          api_config_source:
+            api_type: REST
+            cluster_names:
+            - eds
+            refresh_delay: 1s
+    )EOF",
+               Cluster::InitializePhase::Secondary);
+  initialize();
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  const auto& hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
+  ASSERT_EQ(1, hosts.size());
+  EXPECT_EQ(first_address.get(), hosts[0]->address().get());
+  EXPECT_EQ("1.2.3.4:80", hosts[0]->address()->asString());
+
+  // Another endpoint gets an address of its own.
+  socket_address->set_port_value(81);
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  const auto& new_hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
+  ASSERT_EQ(1, new_hosts.size());
+  EXPECT_EQ("1.2.3.4:81", new_hosts[0]->address()->asString());
+  EXPECT_NE(first_address.get(), new_hosts[0]->address().get());
+}
+
 // Test verifies that updating metadata updates
 // data members dependent on metadata values.
 // Specifically, it transport socket matcher has changed,
@@ -0,0 +1,310 @@
+#include <fcntl.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "envoy/extensions/common/async_files/v3/async_file_manager.pb.h"
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/io/io_uring_impl.h"
+#include "source/common/singleton/manager_impl.h"
+#include "source/extensions/common/async_files/async_file_handle.h"
+#include "source/extensions/common/async_files/async_file_manager.h"
+#include "source/extensions/common/async_files/async_file_manager_factory.h"
+
+#include "test/test_common/status_utility.h"
+#include "test/test_common/utility.h"
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+using StatusHelpers::IsOkAndHolds;
+using StatusHelpers::StatusIs;
+using ::testing::Pointee;
+
+class AsyncFileHandleIoUringTest : public testing::Test {
+public:
+  void SetUp() override {
+    if (!Io::isIoUringSupported()) {
+      GTEST_SKIP() << "io_uring is not supported by this kernel";
+    }
+    envoy::extensions::common::async_files::v3::AsyncFileManagerConfig config;
+    config.mutable_io_uring()->set_io_uring_size(4);
+    manager_ = factory_->getAsyncFileManager(config);
+  }
+
+  void resolveFileActions() {
+    manager_->waitForIdle();
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+  void close(AsyncFileHandle& handle) {
+    absl::Status close_result;
+    EXPECT_OK(
+        handle->close(dispatcher_.get(), [&](absl::Status status) { close_result = status; }));
+    resolveFileActions();
+    EXPECT_OK(close_result);
+  }
+  AsyncFileHandle createAnonymousFile() {
+    AsyncFileHandle create_result;
+    manager_->createAnonymousFile(
+        dispatcher_.get(), tmpdir_,
+        [&](absl::StatusOr<AsyncFileHandle> result) { create_result = result.value(); });
+    resolveFileActions();
+    return create_result;
+  }
+  absl::StatusOr<size_t> write(AsyncFileHandle& handle, absl::string_view data, off_t offset) {
+    absl::StatusOr<size_t> write_status;
+    Buffer::OwnedImpl buf(data);
+    EXPECT_OK(handle->write(dispatcher_.get(), buf, offset, [&](absl::StatusOr<size_t> status) {
+      write_status = std::move(status);
+    }));
+    resolveFileActions();
+    return write_status;
+  }
+  absl::StatusOr<Buffer::InstancePtr> read(AsyncFileHandle& handle, off_t offset, size_t length) {
+    absl::StatusOr<Buffer::InstancePtr> read_status;
+    EXPECT_OK(handle->read(dispatcher_.get(), offset, length,
+                           [&](absl::StatusOr<Buffer::InstancePtr> status) {
+                             read_status = std::move(status);
+                           }));
+    resolveFileActions();
+    return read_status;
+  }
+
+  const char* test_tmpdir = std::getenv("TEST_TMPDIR");
+  std::string tmpdir_ = test_tmpdir ? test_tmpdir : "/tmp";
+
+  std::unique_ptr<Singleton::ManagerImpl> singleton_manager_ =
+      std::make_unique<Singleton::ManagerImpl>();
+  std::shared_ptr<AsyncFileManagerFactory> factory_ =
+      AsyncFileManagerFactory::singleton(singleton_manager_.get());
+  std::shared_ptr<AsyncFileManager> manager_;
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("test_thread");
+};
+
+TEST_F(AsyncFileHandleIoUringTest, DescribesIoUringSize) {
+  EXPECT_EQ(manager_->describe(), "io_uring_size = 4");
+}
+
+TEST_F(AsyncFileHandleIoUringTest, WriteReadClose) {
+  auto handle = createAnonymousFile();
+  EXPECT_THAT(write(handle, "hello", 0), IsOkAndHolds(5U));
+  EXPECT_THAT(write(handle, "p!", 3), IsOkAndHolds(2U));
+  EXPECT_THAT(read(handle, 0, 5), IsOkAndHolds(Pointee(BufferString("help!"))));
+  // A read past the end of the file is short.
+  EXPECT_THAT(read(handle, 2, 10), IsOkAndHolds(Pointee(BufferString("lp!"))));
+  close(handle);
+}
+
+TEST_F(AsyncFileHandleIoUringTest, WritesBufferOfManySlices) {
+  auto handle = createAnonymousFile();
+  Buffer::OwnedImpl buf;
+  std::string expected;
+  for (int i = 0; i < 100; i++) {
+    std::string slice = absl::StrCat("slice", i, ";");
+    buf.appendSliceForTest(slice);
+    expected += slice;
+  }
+  absl::StatusOr<size_t> write_status;
+  EXPECT_OK(handle->write(dispatcher_.get(), buf, 0, [&](absl::StatusOr<size_t> status) {
+    write_status = std::move(status);
+  }));
+  resolveFileActions();
+  EXPECT_THAT(write_status, IsOkAndHolds(expected.size()));
+  EXPECT_THAT(read(handle, 0, expected.size()), IsOkAndHolds(Pointee(BufferString(expected))));
+  close(handle);
+}
+
+// With a submission queue of 4 entries, and a completion queue of 8, most of these operations
+// wait in the backlog.
+TEST_F(AsyncFileHandleIoUringTest, MoreOperationsThanTheCompletionQueueHoldsAllComplete) {
+  const std::string contents = "0123456789abcdefghij";
+  auto handle = createAnonymousFile();
+  ASSERT_THAT(write(handle, contents, 0), IsOkAndHolds(contents.size()));
+  std::string result(contents.size(), '?');
+  size_t completed = 0;
+  for (size_t i = 0; i < contents.size(); i++) {
+    EXPECT_OK(handle->read(dispatcher_.get(), i, 1,
+                           [&result, &completed, i](absl::StatusOr<Buffer::InstancePtr> status) {
+                             result[i] = status.value()->toString()[0];
+                             completed++;
+                           }));
+  }
+  resolveFileActions();
+  EXPECT_EQ(completed, contents.size());
+  EXPECT_EQ(result, contents);
+  close(handle);
+}
+
+// Threads that find another thread submitting leave their operations for it to submit, and
+// none of them may be left behind.
+TEST_F(AsyncFileHandleIoUringTest, OperationsEnqueuedFromManyThreadsAllComplete) {
+  constexpr int threads = 4;
+  constexpr int stats_per_thread = 50;
+  int completed = 0;
+  std::vector<std::thread> enqueuers;
+  for (int i = 0; i < threads; i++) {
+    enqueuers.emplace_back([&]() {
+      for (int j = 0; j < stats_per_thread; j++) {
+        manager_->stat(dispatcher_.get(), tmpdir_, [&](absl::StatusOr<struct stat> status) {
+          EXPECT_OK(status);
+          completed++;
+        });
+      }
+    });
+  }
+  for (std::thread& enqueuer : enqueuers) {
+    enqueuer.join();
+  }
+  resolveFileActions();
+  EXPECT_EQ(completed, threads * stats_per_thread);
+}
+
+TEST_F(AsyncFileHandleIoUringTest, StatTruncateAndDuplicate) {
+  auto handle = createAnonymousFile();
+  ASSERT_THAT(write(handle, "hello world", 0), IsOkAndHolds(11U));
+  absl::Status truncate_status = absl::UnknownError("");
+  EXPECT_OK(handle->truncate(dispatcher_.get(), 5,
+                             [&](absl::Status result) { truncate_status = std::move(result); }));
+  resolveFileActions();
+  EXPECT_OK(truncate_status);
+  absl::StatusOr<struct stat> stat_status;
+  EXPECT_OK(handle->stat(dispatcher_.get(), [&](absl::StatusOr<struct stat> status) {
+    stat_status = std::move(status);
+  }));
+  resolveFileActions();
+  EXPECT_THAT(stat_status, IsOkAndHolds(testing::Field(&stat::st_size, 5)));
+  absl::StatusOr<AsyncFileHandle> duplicate_status;
+  EXPECT_OK(handle->duplicate(dispatcher_.get(), [&](absl::StatusOr<AsyncFileHandle> status) {
+    duplicate_status = std::move(status);
+  }));
+  resolveFileActions();
+  ASSERT_OK(duplicate_status);
+  AsyncFileHandle dup_file = std::move(duplicate_status.value());
+  close(handle);
+  EXPECT_THAT(read(dup_file, 0, 11), IsOkAndHolds(Pointee(BufferString("hello"))));
+  close(dup_file);
+}
+
+TEST_F(AsyncFileHandleIoUringTest, ReadMappedReturnsRangeOfFile) {
+  auto handle = createAnonymousFile();
+  ASSERT_THAT(write(handle, "hello world", 0), IsOkAndHolds(11U));
+  absl::StatusOr<Buffer::InstancePtr> read_result;
+  EXPECT_OK(handle->readMapped(dispatcher_.get(), 6, 100,
+                               [&](absl::StatusOr<Buffer::InstancePtr> result) {
+                                 read_result = std::move(result);
+                               }));
+  resolveFileActions();
+  EXPECT_THAT(read_result, IsOkAndHolds(Pointee(BufferString("world"))));
+  close(handle);
+}
+
+// Mapped reads are performed synchronously, alongside the reads in the ring.
+TEST_F(AsyncFileHandleIoUringTest, SynchronousAndRingOperationsInterleave) {
+  const std::string contents = "0123456789";
+  auto handle = createAnonymousFile();
+  ASSERT_THAT(write(handle, contents, 0), IsOkAndHolds(contents.size()));
+  std::string mapped(contents.size(), '?');
+  std::string read_result(contents.size(), '?');
+  for (size_t i = 0; i < contents.size(); i++) {
+    EXPECT_OK(handle->readMapped(dispatcher_.get(), i, 1,
+                                 [&mapped, i](absl::StatusOr<Buffer::InstancePtr> status) {
+                                   mapped[i] = status.value()->toString()[0];
+                                 }));
+    EXPECT_OK(handle->read(dispatcher_.get(), i, 1,
+                           [&read_result, i](absl::StatusOr<Buffer::InstancePtr> status) {
+                             read_result[i] = status.value()->toString()[0];
+                           }));
+  }
+  resolveFileActions();
+  EXPECT_EQ(mapped, contents);
+  EXPECT_EQ(read_result, contents);
+  close(handle);
+}
+
+TEST_F(AsyncFileHandleIoUringTest, LinkStatOpenAndUnlinkNamedFile) {
+  auto handle = createAnonymousFile();
+  ASSERT_THAT(write(handle, "hello", 0), IsOkAndHolds(5U));
+  const std::string filename = absl::StrCat(tmpdir_, "/async_io_uring_link_test");
+  Api::OsSysCallsSingleton::get().unlink(filename.c_str());
+  absl::Status link_status = absl::InternalError("not set");
+  EXPECT_OK(handle->createHardLink(dispatcher_.get(), filename,
+                                   [&](absl::Status status) { link_status = std::move(status); }));
+  resolveFileActions();
+  ASSERT_OK(link_status);
+  close(handle);
+
+  absl::StatusOr<struct stat> stat_status;
+  manager_->stat(dispatcher_.get(), filename,
+                 [&](absl::StatusOr<struct stat> status) { stat_status = std::move(status); });
+  resolveFileActions();
+  EXPECT_THAT(stat_status, IsOkAndHolds(testing::Field(&stat::st_size, 5)));
+
+  absl::StatusOr<AsyncFileHandle> open_status;
+  manager_->openExistingFile(
+      dispatcher_.get(), filename, AsyncFileManager::Mode::ReadOnly,
+      [&](absl::StatusOr<AsyncFileHandle> status) { open_status = std::move(status); });
+  resolveFileActions();
+  ASSERT_OK(open_status);
+  AsyncFileHandle opened = std::move(open_status.value());
+  EXPECT_THAT(read(opened, 0, 5), IsOkAndHolds(Pointee(BufferString("hello"))));
+  // The file was opened read-only.
+  EXPECT_THAT(write(opened, "x", 0), StatusIs(absl::StatusCode::kFailedPrecondition));
+  close(opened);
+
+  absl::Status unlink_status = absl::InternalError("not set");
+  manager_->unlink(dispatcher_.get(), filename,
+                   [&](absl::Status status) { unlink_status = std::move(status); });
+  resolveFileActions();
+  EXPECT_OK(unlink_status);
+  manager_->stat(dispatcher_.get(), filename,
+                 [&](absl::StatusOr<struct stat> status) { stat_status = std::move(status); });
+  resolveFileActions();
+  EXPECT_THAT(stat_status, StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(AsyncFileHandleIoUringTest, OpenMissingFileReportsNotFound) {
+  absl::StatusOr<AsyncFileHandle> open_status;
+  manager_->openExistingFile(
+      dispatcher_.get(), "/some/path/that/does/not/exist", AsyncFileManager::Mode::ReadOnly,
+      [&](absl::StatusOr<AsyncFileHandle> status) { open_status = std::move(status); });
+  resolveFileActions();
+  EXPECT_THAT(open_status, StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(AsyncFileHandleIoUringTest, CancelledOpenIsClosedAndNotCalledBack) {
+  auto cancel = manager_->createAnonymousFile(
+      dispatcher_.get(), tmpdir_, [](absl::StatusOr<AsyncFileHandle>) {
+        FAIL() << "cancelled callback should not be called";
+      });
+  cancel();
+  // The file is opened and then closed by the cleanup, which must complete before the manager
+  // is idle.
+  resolveFileActions();
+  manager_->waitForIdle();
+}
+
+TEST_F(AsyncFileHandleIoUringTest, EnqueuingActionAfterCloseReturnsError) {
+  auto handle = createAnonymousFile();
+  EXPECT_OK(handle->close(dispatcher_.get(), [](absl::Status) {}));
+  EXPECT_THAT(handle->close(dispatcher_.get(), [](absl::Status) {}),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  resolveFileActions();
+}
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
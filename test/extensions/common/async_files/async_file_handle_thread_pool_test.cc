@@ -1,3 +1,5 @@
+#include <sys/mman.h>
+
 #include <future>
 #include <memory>
 #include <string>
@@ -20,6 +22,7 @@
 #include "test/test_common/utility.h"
 
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -325,6 +328,43 @@ TEST_F(AsyncFileHandleTest, TruncateReducesFileSize) {
   close(handle);
 }
 
+TEST_F(AsyncFileHandleTest, ReadMappedReturnsRangeOfFile) {
+  AsyncFileHandle handle = createAnonymousFile();
+  // Longer than a page, so that reads at an offset map from a page boundary before it.
+  std::string contents;
+  for (int i = 0; i < 2000; i++) {
+    absl::StrAppend(&contents, absl::Dec(i, absl::kZeroPad5));
+  }
+  absl::StatusOr<size_t> write_status;
+  Buffer::OwnedImpl buf(contents);
+  EXPECT_OK(handle->write(dispatcher_.get(), buf, 0, [&](absl::StatusOr<size_t> result) {
+    write_status = std::move(result);
+  }));
+  resolveFileActions();
+  EXPECT_THAT(write_status, IsOkAndHolds(contents.size()));
+  absl::StatusOr<Buffer::InstancePtr> read_result;
+  EXPECT_OK(handle->readMapped(dispatcher_.get(), 5001, 100,
+                               [&](absl::StatusOr<Buffer::InstancePtr> result) {
+                                 read_result = std::move(result);
+                               }));
+  resolveFileActions();
+  EXPECT_THAT(read_result, IsOkAndHolds(Pointee(BufferString(contents.substr(5001, 100)))));
+  // A range extending past the end of the file is clamped to the file.
+  EXPECT_OK(handle->readMapped(dispatcher_.get(), contents.size() - 5, 100,
+                               [&](absl::StatusOr<Buffer::InstancePtr> result) {
+                                 read_result = std::move(result);
+                               }));
+  resolveFileActions();
+  EXPECT_THAT(read_result, IsOkAndHolds(Pointee(BufferString("01999"))));
+  EXPECT_OK(handle->readMapped(dispatcher_.get(), contents.size(), 100,
+                               [&](absl::StatusOr<Buffer::InstancePtr> result) {
+                                 read_result = std::move(result);
+                               }));
+  resolveFileActions();
+  EXPECT_THAT(read_result, IsOkAndHolds(Pointee(BufferString(""))));
+  close(handle);
+}
+
 TEST_F(AsyncFileHandleTest, DuplicateCreatesIndependentHandle) {
   auto handle = createAnonymousFile();
   absl::StatusOr<AsyncFileHandle> duplicate_status;
@@ -496,6 +536,24 @@ TEST_F(AsyncFileHandleWithMockPosixTest, StatFailureReportsError) {
   close(handle);
 }
 
+TEST_F(AsyncFileHandleWithMockPosixTest, ReadMappedFailureReportsError) {
+  auto handle = createAnonymousFile();
+  EXPECT_CALL(mock_posix_file_operations_, fstat(_, _)).WillOnce([](int, struct stat* buffer) {
+    buffer->st_size = 9876;
+    return Api::SysCallIntResult{0, 0};
+  });
+  EXPECT_CALL(mock_posix_file_operations_, mmap(_, 100, PROT_READ, MAP_SHARED, _, 0))
+      .WillOnce(Return(Api::SysCallPtrResult{MAP_FAILED, ENODEV}));
+  absl::StatusOr<Buffer::InstancePtr> read_status;
+  EXPECT_OK(handle->readMapped(dispatcher_.get(), 0, 100,
+                               [&](absl::StatusOr<Buffer::InstancePtr> status) {
+                                 read_status = std::move(status);
+                               }));
+  resolveFileActions();
+  EXPECT_FALSE(read_status.ok());
+  close(handle);
+}
+
 TEST_F(AsyncFileHandleWithMockPosixTest, CloseFailureReportsError) {
   auto handle = createAnonymousFile();
   EXPECT_CALL(mock_posix_file_operations_, close(1))
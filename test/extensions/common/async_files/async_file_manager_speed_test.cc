@@ -0,0 +1,170 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Compares the AsyncFileManager implementations by the rate of reads they complete, and the
+// latency of a read from being enqueued to its callback. The file is in the page cache after it
+// is written, so this measures the overhead of each manager rather than the storage device.
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/common/async_files/v3/async_file_manager.pb.h"
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/singleton/manager_impl.h"
+#include "source/extensions/common/async_files/async_file_handle.h"
+#include "source/extensions/common/async_files/async_file_manager.h"
+#include "source/extensions/common/async_files/async_file_manager_factory.h"
+
+#include "test/benchmark/main.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+namespace {
+
+constexpr size_t ReadSize = 4096;
+
+enum class ManagerType { ThreadPool, IoUring };
+
+envoy::extensions::common::async_files::v3::AsyncFileManagerConfig configFor(ManagerType type) {
+  envoy::extensions::common::async_files::v3::AsyncFileManagerConfig config;
+  switch (type) {
+  case ManagerType::ThreadPool:
+    config.mutable_thread_pool();
+    break;
+  case ManagerType::IoUring:
+    config.mutable_io_uring();
+    break;
+  }
+  return config;
+}
+
+// Writes a file of the given size, returning its name.
+std::string writeTestFile(size_t size) {
+  const char* test_tmpdir = std::getenv("TEST_TMPDIR");
+  const std::string filename =
+      absl::StrCat(test_tmpdir ? test_tmpdir : "/tmp", "/async_file_manager_speed_test");
+  Api::OsSysCalls& posix = Api::OsSysCallsSingleton::get();
+  const int fd =
+      posix.open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR).return_value_;
+  RELEASE_ASSERT(fd != -1, "failed to create test file");
+  const std::string block(1024 * 1024, 'x');
+  for (size_t offset = 0; offset < size; offset += block.size()) {
+    RELEASE_ASSERT(posix.pwrite(fd, block.data(), block.size(), offset).return_value_ ==
+                       static_cast<ssize_t>(block.size()),
+                   "failed to write test file");
+  }
+  posix.close(fd);
+  return filename;
+}
+
+// Keeps state.range(0) reads of 4KiB at random offsets in flight, and reports the reads per
+// second, and the mean and 99th percentile latency of a read in microseconds.
+void bmRandomReads(::benchmark::State& state, ManagerType type) {
+  const size_t file_size = (benchmark::skipExpensiveBenchmarks() ? 8 : 256) * 1024 * 1024;
+  const uint64_t depth = state.range(0);
+  Singleton::ManagerImpl singleton_manager;
+  auto factory = AsyncFileManagerFactory::singleton(&singleton_manager);
+  std::shared_ptr<AsyncFileManager> manager;
+  try {
+    manager = factory->getAsyncFileManager(configFor(type));
+  } catch (const EnvoyException& e) {
+    // e.g. io_uring is not supported by the build or the kernel.
+    state.SkipWithError(e.what());
+    return;
+  }
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("speed_test");
+  const std::string filename = writeTestFile(file_size);
+  AsyncFileHandle handle;
+  manager->openExistingFile(dispatcher.get(), filename, AsyncFileManager::Mode::ReadOnly,
+                            [&handle](absl::StatusOr<AsyncFileHandle> result) {
+                              handle = std::move(result.value());
+                            });
+  while (handle == nullptr) {
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<uint64_t> block(0, file_size / ReadSize - 1);
+  std::vector<double> latencies_us;
+  uint64_t in_flight = 0;
+  const auto startRead = [&]() {
+    const MonotonicTime start = std::chrono::steady_clock::now();
+    in_flight++;
+    auto enqueued = handle->read(
+        dispatcher.get(), block(rng) * ReadSize, ReadSize,
+        [&, start](absl::StatusOr<Buffer::InstancePtr> result) {
+          RELEASE_ASSERT(result.ok() && result.value()->length() == ReadSize, "read failed");
+          latencies_us.push_back(std::chrono::duration<double, std::micro>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count());
+          in_flight--;
+        });
+    RELEASE_ASSERT(enqueued.ok(), "failed to enqueue read");
+  };
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    // Each iteration waits for one read to complete, and replaces it.
+    while (in_flight < depth) {
+      startRead();
+    }
+    const size_t completed = latencies_us.size();
+    while (latencies_us.size() == completed) {
+      dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+  while (in_flight > 0) {
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  state.SetItemsProcessed(latencies_us.size());
+  state.counters["iops"] = ::benchmark::Counter(latencies_us.size(), ::benchmark::Counter::kIsRate);
+  if (!latencies_us.empty()) {
+    double total = 0;
+    for (double latency : latencies_us) {
+      total += latency;
+    }
+    const size_t p99 = latencies_us.size() * 99 / 100;
+    std::nth_element(latencies_us.begin(), latencies_us.begin() + p99, latencies_us.end());
+    state.counters["mean_latency_us"] = total / latencies_us.size();
+    state.counters["p99_latency_us"] = latencies_us[p99];
+  }
+
+  absl::Status close_status = absl::UnknownError("not closed");
+  RELEASE_ASSERT(handle
+                     ->close(dispatcher.get(),
+                             [&close_status](absl::Status status) { close_status = status; })
+                     .ok(),
+                 "failed to enqueue close");
+  while (absl::IsUnknown(close_status)) {
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  Api::OsSysCallsSingleton::get().unlink(filename.c_str());
+}
+BENCHMARK_CAPTURE(bmRandomReads, thread_pool, ManagerType::ThreadPool)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(128)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(bmRandomReads, io_uring, ManagerType::IoUring)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(128)
+    ->UseRealTime();
+
+} // namespace
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
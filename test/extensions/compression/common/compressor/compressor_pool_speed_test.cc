@@ -0,0 +1,88 @@
+#include <sys/resource.h>
+
+#include <vector>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/compression/gzip/compressor/config.h"
+#include "source/extensions/compression/zstd/compressor/config.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Common {
+namespace Compressor {
+
+static constexpr uint64_t BodySize = 1024;
+
+// SPELLCHECKER(off)
+/*
+Each iteration opens 10k streams that are all live at once, compresses a 1KiB body in each, then
+ends them all. The first argument selects the library (0: gzip with a 32KiB window and memory
+level 8, 1: zstd at level 3) and the second whether the compressors of ended streams are reused.
+The "peak_rss_mb" counter is the process high water mark, so select a single configuration per run
+with --benchmark_filter to compare them, e.g.
+
+  bazel run -c opt //test/extensions/compression/common/compressor:compressor_pool_speed_test -- \
+    --benchmark_filter='concurrentStreams/0/0$'
+*/
+// SPELLCHECKER(on)
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void concurrentStreams(benchmark::State& state) {
+  // Each stream's compressor takes from hundreds of KiB to MiBs once used.
+  const uint32_t concurrent_streams = benchmark::skipExpensiveBenchmarks() ? 100 : 10000;
+  const bool zstd = state.range(0) == 1;
+  const uint32_t max_idle = state.range(1) == 1 ? concurrent_streams : 0;
+  Api::ApiPtr api = Api::createApiForTest();
+  testing::NiceMock<ThreadLocal::MockInstance> tls;
+  Stats::IsolatedStoreImpl stats_store;
+  Envoy::Compression::Compressor::CompressorFactoryPtr factory;
+  if (zstd) {
+    envoy::extensions::compression::zstd::compressor::v3::Zstd config;
+    config.set_max_idle_compressors_per_worker(max_idle);
+    factory = std::make_unique<Zstd::Compressor::ZstdCompressorFactory>(
+        config, tls.dispatcher_, *api, tls, *stats_store.rootScope(), nullptr);
+  } else {
+    envoy::extensions::compression::gzip::compressor::v3::Gzip config;
+    config.mutable_window_bits()->set_value(15);
+    config.mutable_memory_level()->set_value(8);
+    config.set_max_idle_compressors_per_worker(max_idle);
+    factory = std::make_unique<Gzip::Compressor::GzipCompressorFactory>(config, *api, tls);
+  }
+  Buffer::OwnedImpl body;
+  TestUtility::feedBufferWithRandomCharacters(body, BodySize);
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    std::vector<Envoy::Compression::Compressor::CompressorPtr> streams;
+    streams.reserve(concurrent_streams);
+    for (uint32_t i = 0; i < concurrent_streams; ++i) {
+      streams.push_back(factory->createCompressor());
+      Buffer::OwnedImpl data;
+      data.add(body);
+      streams.back()->compress(data, Envoy::Compression::Compressor::State::Finish);
+    }
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // ru_maxrss is in KiB on Linux.
+  state.counters["peak_rss_mb"] = usage.ru_maxrss / 1024.0;
+  state.SetItemsProcessed(state.iterations() * concurrent_streams);
+}
+BENCHMARK(concurrentStreams)
+    ->ArgsProduct({{0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace Compressor
+} // namespace Common
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,107 @@
+#include <memory>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/extensions/compression/common/compressor/compressor_pool.h"
+
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Common {
+namespace Compressor {
+namespace {
+
+// Appends its id to the data it compresses, and counts its resets.
+class TestCompressor : public Envoy::Compression::Compressor::Compressor {
+public:
+  explicit TestCompressor(uint32_t id) : id_(id) {}
+
+  void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State) override {
+    buffer.add(std::to_string(id_));
+  }
+  void reset() { ++resets_; }
+
+  const uint32_t id_;
+  uint32_t resets_{};
+};
+
+class CompressorPoolTest : public testing::Test {
+public:
+  CompressorPoolTest()
+      : pool_(tls_, Thread::threadFactoryForTest(), 2, [this]() {
+          auto compressor = std::make_unique<TestCompressor>(++created_);
+          last_created_ = compressor.get();
+          return compressor;
+        }) {}
+
+  // Returns the id of the compressor behind a pooled one.
+  static std::string id(Envoy::Compression::Compressor::Compressor& compressor) {
+    Buffer::OwnedImpl buffer;
+    compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    return buffer.toString();
+  }
+
+  testing::NiceMock<ThreadLocal::MockInstance> tls_;
+  uint32_t created_{};
+  TestCompressor* last_created_{};
+  CompressorPool<TestCompressor> pool_;
+};
+
+TEST_F(CompressorPoolTest, ReusesResetCompressors) {
+  Envoy::Compression::Compressor::CompressorPtr compressor = pool_.acquire();
+  TestCompressor* first = last_created_;
+  EXPECT_EQ(id(*compressor), "1");
+  compressor.reset();
+  EXPECT_EQ(first->resets_, 1U);
+
+  compressor = pool_.acquire();
+  EXPECT_EQ(id(*compressor), "1");
+  EXPECT_EQ(created_, 1U);
+}
+
+TEST_F(CompressorPoolTest, KeepsAtMostMaxIdleCompressors) {
+  std::vector<Envoy::Compression::Compressor::CompressorPtr> compressors;
+  for (int i = 0; i < 3; ++i) {
+    compressors.push_back(pool_.acquire());
+  }
+  compressors.clear();
+  for (int i = 0; i < 3; ++i) {
+    compressors.push_back(pool_.acquire());
+  }
+  // Two of the first three compressors were kept, so only one more was created.
+  EXPECT_EQ(created_, 4U);
+}
+
+TEST_F(CompressorPoolTest, CompressorsAreNotPooledOnUnregisteredThreads) {
+  tls_.registered_ = false;
+  pool_.acquire().reset();
+  pool_.acquire().reset();
+  EXPECT_EQ(created_, 2U);
+}
+
+TEST_F(CompressorPoolTest, CompressorDestroyedOnAnotherThreadIsNotPooled) {
+  Envoy::Compression::Compressor::CompressorPtr compressor = pool_.acquire();
+  Thread::ThreadPtr thread =
+      Thread::threadFactoryForTest().createThread([&compressor]() { compressor.reset(); });
+  thread->join();
+  pool_.acquire().reset();
+  EXPECT_EQ(created_, 2U);
+}
+
+TEST_F(CompressorPoolTest, CompressorCanOutliveThreadLocalPool) {
+  Envoy::Compression::Compressor::CompressorPtr compressor = pool_.acquire();
+  tls_.shutdownThread_();
+  compressor.reset();
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Common
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
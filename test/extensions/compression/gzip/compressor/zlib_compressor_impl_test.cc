@@ -3,6 +3,7 @@
 #include "source/extensions/compression/gzip/compressor/config.h"
 #include "source/extensions/compression/gzip/compressor/zlib_compressor_impl.h"
 
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "absl/container/fixed_array.h"
@@ -15,6 +16,8 @@ namespace Gzip {
 namespace Compressor {
 namespace {
 
+using testing::NiceMock;
+
 // Test helpers
 
 void expectValidFlushedBuffer(const Buffer::OwnedImpl& output_buffer) {
@@ -150,8 +153,10 @@ TEST_P(ZlibCompressorImplFactoryTest, CreateCompressorTest) {
                        strategy, compression_level);
   }
   TestUtility::loadFromJson(json, gzip);
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<ThreadLocal::MockInstance> tls;
   Envoy::Compression::Compressor::CompressorPtr compressor =
-      GzipCompressorFactory(gzip).createCompressor();
+      GzipCompressorFactory(gzip, *api, tls).createCompressor();
   // Check the created compressor produces valid output.
   TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
   compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
@@ -261,6 +266,55 @@ TEST_F(ZlibCompressorImplTest, CompressWithNotCommonParams) {
   expectValidFinishedBuffer(accumulation_buffer, input_size);
 }
 
+// A reset compressor produces the same stream as a new one, even if its previous stream was not
+// finished.
+TEST_F(ZlibCompressorImplTest, ResetCompressorStartsNewStream) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl expected;
+
+  ZlibCompressorImplTester compressor(8);
+  compressor.init(ZlibCompressorImpl::CompressionLevel::Standard,
+                  ZlibCompressorImpl::CompressionStrategy::Standard, gzip_window_bits,
+                  memory_level);
+  TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size, 1);
+  compressor.compressThenFlush(buffer);
+  drainBuffer(buffer);
+  compressor.reset();
+
+  ZlibCompressorImplTester new_compressor(8);
+  new_compressor.init(ZlibCompressorImpl::CompressionLevel::Standard,
+                      ZlibCompressorImpl::CompressionStrategy::Standard, gzip_window_bits,
+                      memory_level);
+  TestUtility::feedBufferWithRandomCharacters(expected, default_input_size, 3);
+  new_compressor.finish(expected);
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size, 3);
+  compressor.finish(buffer);
+  expectValidFinishedBuffer(buffer, default_input_size);
+  EXPECT_EQ(expected.toString(), buffer.toString());
+}
+
+TEST(GzipCompressorFactoryTest, ReusedCompressorsProduceValidStreams) {
+  envoy::extensions::compression::gzip::compressor::v3::Gzip gzip;
+  gzip.set_max_idle_compressors_per_worker(1);
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<ThreadLocal::MockInstance> tls;
+  GzipCompressorFactory factory(gzip, *api, tls);
+  for (int i = 0; i < 3; ++i) {
+    Buffer::OwnedImpl buffer;
+    Envoy::Compression::Compressor::CompressorPtr compressor = factory.createCompressor();
+    TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
+    // Leave every other stream unfinished.
+    compressor->compress(buffer, i % 2 == 0 ? Envoy::Compression::Compressor::State::Finish
+                                            : Envoy::Compression::Compressor::State::Flush);
+    if (i % 2 == 0) {
+      expectValidFinishedBuffer(buffer, 4096);
+    } else {
+      expectValidFlushedBuffer(buffer);
+    }
+  }
+}
+
 } // namespace
 } // namespace Compressor
 } // namespace Gzip
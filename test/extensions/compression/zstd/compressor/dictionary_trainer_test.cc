@@ -0,0 +1,229 @@
+#include <memory>
+#include <string>
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/compression/zstd/compressor/dictionary_trainer.h"
+#include "source/extensions/compression/zstd/decompressor/zstd_decompressor_impl.h"
+
+#include "test/mocks/api/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/file_system_for_test.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zdict.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+namespace {
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+class DictionaryTrainerTest : public testing::Test {
+protected:
+  void createTrainer() {
+    trainer_ = std::make_shared<DictionaryTrainer>(
+        config_, *stats_store_.rootScope(), *dispatcher_, *api_, training_thread_,
+        [this](const std::string& dictionary) {
+          dictionary_ = dictionary;
+          return ZDICT_getDictID(dictionary.data(), dictionary.size());
+        });
+  }
+
+  void addSamples(int count) {
+    for (int i = 0; i < count; ++i) {
+      trainer_->sampleSink()->addSample(absl::StrFormat(
+          R"({"id": %d, "name": "user%d", "email": "user%d@example.com", "active": %s})", i,
+          i * 7, i * 13, i % 2 == 0 ? "false" : "true"));
+    }
+  }
+
+  void waitForDictionary() {
+    while (dictionary_.empty()) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  envoy::extensions::compression::zstd::compressor::v3::Zstd::DictionaryTraining config_;
+  Stats::IsolatedStoreImpl stats_store_;
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("main_thread");
+  DictionaryTrainingThreadSharedPtr training_thread_ =
+      std::make_shared<DictionaryTrainingThread>(api_->threadFactory());
+  std::shared_ptr<DictionaryTrainer> trainer_;
+  std::string dictionary_;
+};
+
+TEST_F(DictionaryTrainerTest, TrainsDictionaryFromSamples) {
+  config_.mutable_dictionary_size()->set_value(1024);
+  createTrainer();
+  addSamples(100);
+  trainer_->trainForTest();
+  waitForDictionary();
+  EXPECT_LE(dictionary_.size(), 1024U);
+  EXPECT_EQ(trainer_->stats().samples_.value(), 100U);
+  EXPECT_EQ(trainer_->stats().dictionaries_trained_.value(), 1U);
+  EXPECT_EQ(trainer_->stats().dictionary_id_.value(),
+            ZDICT_getDictID(dictionary_.data(), dictionary_.size()));
+}
+
+TEST_F(DictionaryTrainerTest, PublishesDictionaryToFile) {
+  const std::string path = TestEnvironment::temporaryPath("zstd_trained_dictionary");
+  config_.mutable_dictionary_size()->set_value(1024);
+  config_.set_dictionary_path(path);
+  createTrainer();
+  addSamples(100);
+  trainer_->trainForTest();
+  waitForDictionary();
+  EXPECT_EQ(TestEnvironment::readFileToStringForTest(path), dictionary_);
+}
+
+TEST_F(DictionaryTrainerTest, DecompressorWatchingDictionaryPathLoadsPublishedDictionary) {
+  // A decompressor needs a dictionary in the file to start with.
+  const std::string initial_dictionary =
+      TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+          "{{ test_rundir }}/test/extensions/compression/zstd/test_data/dictionary_one"));
+  const std::string path =
+      TestEnvironment::writeStringToFileForTest("zstd_watched_dictionary", initial_dictionary);
+  Protobuf::RepeatedPtrField<envoy::config::core::v3::DataSource> dictionaries;
+  dictionaries.Add()->set_filename(path);
+  NiceMock<ThreadLocal::MockInstance> tls;
+  Decompressor::ZstdDDictManager ddict_manager(
+      dictionaries, *dispatcher_, *api_, tls, false,
+      [](const void* dict_buffer, size_t dict_size) {
+        return ZSTD_createDDict(dict_buffer, dict_size);
+      });
+
+  config_.mutable_dictionary_size()->set_value(1024);
+  config_.set_dictionary_path(path);
+  createTrainer();
+  addSamples(100);
+  trainer_->trainForTest();
+  waitForDictionary();
+  const unsigned id = ZDICT_getDictID(dictionary_.data(), dictionary_.size());
+  while (ddict_manager.getDictionaryById(id) == nullptr) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  // The initial dictionary is kept for the bodies compressed with it.
+  EXPECT_NE(ddict_manager.getDictionaryById(
+                ZDICT_getDictID(initial_dictionary.data(), initial_dictionary.size())),
+            nullptr);
+}
+
+TEST_F(DictionaryTrainerTest, DictionaryThatCannotBeRenamedIsRemoved) {
+  const std::string path = TestEnvironment::temporaryPath("zstd_unrenamed_dictionary");
+  config_.mutable_dictionary_size()->set_value(1024);
+  config_.set_dictionary_path(path);
+  createTrainer();
+  addSamples(100);
+  {
+    Api::OsSysCallsImpl real_os_sys_calls;
+    NiceMock<Api::MockOsSysCalls> os_sys_calls;
+    TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> injector(&os_sys_calls);
+    ON_CALL(os_sys_calls, unlink(_)).WillByDefault([&real_os_sys_calls](const char* pathname) {
+      return real_os_sys_calls.unlink(pathname);
+    });
+    EXPECT_CALL(os_sys_calls, rename(_, _)).WillOnce(Return(Api::SysCallIntResult{-1, EACCES}));
+    trainer_->trainForTest();
+    waitForDictionary();
+  }
+  // The dictionary is still used by the compressors.
+  EXPECT_EQ(trainer_->stats().dictionaries_trained_.value(), 1U);
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(path, ".tmp")));
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(path));
+}
+
+TEST_F(DictionaryTrainerTest, StopsCollectingAtMaxSamples) {
+  config_.mutable_max_samples()->set_value(10);
+  createTrainer();
+  EXPECT_TRUE(trainer_->sampleSink()->collectingSamples());
+  addSamples(20);
+  EXPECT_FALSE(trainer_->sampleSink()->collectingSamples());
+  // Training starts collecting the samples for the next dictionary.
+  trainer_->trainForTest();
+  EXPECT_TRUE(trainer_->sampleSink()->collectingSamples());
+  EXPECT_EQ(trainer_->stats().samples_.value(), 10U);
+}
+
+TEST_F(DictionaryTrainerTest, KeepsTooFewSamplesForNextDictionary) {
+  config_.mutable_max_samples()->set_value(100);
+  config_.mutable_dictionary_size()->set_value(1024);
+  createTrainer();
+  addSamples(3);
+  trainer_->trainForTest();
+  addSamples(97);
+  EXPECT_FALSE(trainer_->sampleSink()->collectingSamples());
+  trainer_->trainForTest();
+  waitForDictionary();
+  EXPECT_EQ(trainer_->stats().dictionaries_trained_.value(), 1U);
+}
+
+TEST_F(DictionaryTrainerTest, CountsFailedTraining) {
+  // Too small for zstd to train a dictionary.
+  config_.mutable_dictionary_size()->set_value(8);
+  createTrainer();
+  addSamples(100);
+  trainer_->trainForTest();
+  while (trainer_->stats().training_failed_.value() == 0) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_EQ(trainer_->stats().dictionaries_trained_.value(), 0U);
+  // A dictionary is trained from the next samples once training has failed.
+  addSamples(100);
+  trainer_->trainForTest();
+  while (trainer_->stats().training_failed_.value() == 1) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_EQ(trainer_->stats().training_failed_.value(), 2U);
+}
+
+TEST_F(DictionaryTrainerTest, SampleSinkOutlivesTrainer) {
+  config_.mutable_max_samples()->set_value(10);
+  createTrainer();
+  DictionarySampleSinkSharedPtr sample_sink = trainer_->sampleSink();
+  trainer_.reset();
+  // As compressors releasing the sink last on a worker thread do.
+  sample_sink->addSample("hello");
+  EXPECT_EQ(sample_sink->takeAddedSampleCount(), 1U);
+  EXPECT_TRUE(sample_sink->takeSamples(10).empty());
+  sample_sink.reset();
+}
+
+TEST_F(DictionaryTrainerTest, DestroyingTrainerDoesNotWaitForTraining) {
+  absl::Notification release_training_thread;
+  training_thread_->post([&release_training_thread]() {
+    release_training_thread.WaitForNotification();
+  });
+  config_.mutable_dictionary_size()->set_value(1024);
+  createTrainer();
+  addSamples(100);
+  trainer_->trainForTest();
+  // The dictionary is still to be trained, so this would deadlock if the trainer waited for it.
+  trainer_.reset();
+  release_training_thread.Notify();
+
+  // The dictionary is trained once the trainer is gone, and dropped.
+  absl::Notification trained;
+  training_thread_->post([&trained]() { trained.Notify(); });
+  trained.WaitForNotification();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(dictionary_.empty());
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
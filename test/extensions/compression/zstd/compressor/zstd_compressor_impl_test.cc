@@ -3,10 +3,15 @@
 #include "source/extensions/compression/zstd/compressor/config.h"
 #include "source/extensions/compression/zstd/decompressor/zstd_decompressor_impl.h"
 
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/server/factory_context.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_format.h"
 #include "gtest/gtest.h"
+#include "zdict.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -105,6 +110,114 @@ TEST_F(ZstdCompressorImplTest, CompressWitHugeBuffer) {
   verifyWithDecompressor(std::move(compressor));
 }
 
+TEST_F(ZstdCompressorImplTest, ResetCompressorStartsNewStream) {
+  auto compressor =
+      std::make_unique<ZstdCompressorImpl>(default_compression_level_, default_enable_checksum_,
+                                           default_strategy_, default_cdict_manager_, 8);
+  Buffer::OwnedImpl buffer;
+  TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+  compressor->reset();
+
+  verifyWithDecompressor(std::move(compressor));
+}
+
+TEST_F(ZstdCompressorImplTest, ReusedCompressorsProduceValidStreams) {
+  envoy::extensions::compression::zstd::compressor::v3::Zstd zstd;
+  zstd.set_max_idle_compressors_per_worker(1);
+  NiceMock<Server::Configuration::MockFactoryContext> mock_context;
+  ON_CALL(mock_context.server_factory_context_.api_, threadFactory())
+      .WillByDefault(testing::ReturnRef(Thread::threadFactoryForTest()));
+  Zstd::Compressor::ZstdCompressorLibraryFactory lib_factory;
+  Envoy::Compression::Compressor::CompressorFactoryPtr factory =
+      lib_factory.createCompressorFactoryFromProto(zstd, mock_context);
+  for (int i = 0; i < 3; ++i) {
+    verifyWithDecompressor(factory->createCompressor());
+  }
+}
+
+TEST_F(ZstdCompressorImplTest, CompressorsSampleSmallBodies) {
+  auto sample_sink = std::make_shared<DictionarySampleSink>(2, 100);
+  ZstdCompressorImpl compressor(default_compression_level_, default_enable_checksum_,
+                                default_strategy_, default_cdict_manager_, 4096, sample_sink);
+
+  Buffer::OwnedImpl buffer("hello ");
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Flush);
+  drainBuffer(buffer);
+  buffer.add("world");
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  drainBuffer(buffer);
+  EXPECT_EQ(sample_sink->takeAddedSampleCount(), 1U);
+
+  // Larger bodies are not sampled.
+  compressor.reset();
+  TestUtility::feedBufferWithRandomCharacters(buffer, 101);
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_EQ(sample_sink->takeAddedSampleCount(), 0U);
+  drainBuffer(buffer);
+
+  // Streams aren't sampled once the sink has all the samples it collects.
+  compressor.reset();
+  buffer.add("hello");
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  drainBuffer(buffer);
+  EXPECT_EQ(sample_sink->takeAddedSampleCount(), 1U);
+  EXPECT_FALSE(sample_sink->collectingSamples());
+  compressor.reset();
+  buffer.add("world");
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  drainBuffer(buffer);
+  EXPECT_EQ(sample_sink->takeSamples(1), (std::vector<std::string>{"hello world", "hello"}));
+}
+
+TEST_F(ZstdCompressorImplTest, ResetCompressorUsesReplacedDictionary) {
+  std::string samples;
+  std::vector<size_t> sample_sizes;
+  for (int i = 0; i < 100; ++i) {
+    const std::string sample = absl::StrFormat(R"({"id": %d, "name": "user%d"})", i, i * 7);
+    samples.append(sample);
+    sample_sizes.push_back(sample.size());
+  }
+  std::string dictionary(1024, '\0');
+  dictionary.resize(ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(),
+                                          sample_sizes.data(),
+                                          static_cast<unsigned>(sample_sizes.size())));
+
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  Api::ApiPtr api = Api::createApiForTest();
+  auto cdict_manager = std::make_unique<ZstdCDictManager>(
+      Protobuf::RepeatedPtrField<envoy::config::core::v3::DataSource>(), dispatcher, *api, tls,
+      true, [](const void* dict_buffer, size_t dict_size) {
+        return ZSTD_createCDict(dict_buffer, dict_size, default_compression_level_);
+      });
+  auto compressor =
+      std::make_unique<ZstdCompressorImpl>(default_compression_level_, default_enable_checksum_,
+                                           default_strategy_, cdict_manager, 4096);
+  const unsigned id = cdict_manager->setDictionary(dictionary);
+  EXPECT_EQ(id, ZDICT_getDictID(dictionary.data(), dictionary.size()));
+  EXPECT_EQ(cdict_manager->setDictionary("not a dictionary"), 0U);
+
+  Buffer::OwnedImpl buffer("hello");
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_EQ(ZSTD_getDictID_fromFrame(buffer.linearize(buffer.length()), buffer.length()), 0U);
+  compressor->reset();
+  buffer.drain(buffer.length());
+  buffer.add("hello");
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_EQ(ZSTD_getDictID_fromFrame(buffer.linearize(buffer.length()), buffer.length()), id);
+
+  Protobuf::RepeatedPtrField<envoy::config::core::v3::DataSource> dictionaries;
+  dictionaries.Add()->set_inline_bytes(dictionary);
+  default_ddict_manager_ = std::make_unique<Zstd::Decompressor::ZstdDDictManager>(
+      dictionaries, dispatcher, *api, tls, false,
+      [](const void* dict_buffer, size_t dict_size) {
+        return ZSTD_createDDict(dict_buffer, dict_size);
+      });
+  compressor->reset();
+  verifyWithDecompressor(std::move(compressor));
+}
+
 TEST_F(ZstdCompressorImplTest, IllegalConfig) {
   envoy::extensions::compression::zstd::compressor::v3::Zstd zstd;
   Zstd::Compressor::ZstdCompressorLibraryFactory lib_factory;
@@ -10,6 +10,7 @@
 #include "source/common/config/api_version.h"
 #include "source/common/config/null_grpc_mux_impl.h"
 #include "source/common/config/protobuf_link_hacks.h"
+#include "source/common/config/resource_decode_pool.h"
 #include "source/common/config/utility.h"
 #include "source/common/protobuf/protobuf.h"
 #include "source/common/stats/isolated_store_impl.h"
@@ -683,6 +684,154 @@ TEST_P(GrpcMuxImplTest, WildcardWatch) {
   }
 }
 
+// With parallel decoding, the resources of a large response reach the watch in response order.
+TEST_P(GrpcMuxImplTest, ParallelDecoding) {
+  scoped_runtime_.mergeValues(
+      {{"envoy.reloadable_features.xds_parallel_resource_decoding", "true"}});
+  setup();
+
+  InSequence s;
+  const std::string& type_url = Config::TestTypeUrl::get().ClusterLoadAssignment;
+  OpaqueResourceDecoderSharedPtr resource_decoder(
+      std::make_shared<TestUtility::TestOpaqueResourceDecoderImpl<
+          envoy::config::endpoint::v3::ClusterLoadAssignment>>("cluster_name"));
+  auto foo_sub = grpc_mux_->addWatch(type_url, {}, callbacks_, resource_decoder, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {}, "", true);
+  grpc_mux_->start();
+
+  const size_t count = 4 * ResourceDecodePool::MinParallelResources;
+  auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+  response->set_type_url(type_url);
+  response->set_version_info("1");
+  for (size_t i = 0; i < count; ++i) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+    load_assignment.set_cluster_name(absl::StrCat("cluster_", i));
+    std::ignore = response->add_resources()->PackFrom(load_assignment);
+  }
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"))
+      .WillOnce(Invoke([count](const std::vector<DecodedResourceRef>& resources,
+                               const std::string&) {
+        EXPECT_EQ(count, resources.size());
+        for (size_t i = 0; i < resources.size(); ++i) {
+          EXPECT_EQ(absl::StrCat("cluster_", i), resources[i].get().name());
+          EXPECT_EQ("1", resources[i].get().version());
+        }
+        return absl::OkStatus();
+      }));
+  expectSendMessage(type_url, {}, "1");
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
+}
+
+// With parallel decoding, a response with invalid resources is rejected with the error of the
+// first one, whether it fails on the pool or in the field checks of the main thread.
+TEST_P(GrpcMuxImplTest, ParallelDecodingRejectsFirstInvalidResource) {
+  scoped_runtime_.mergeValues(
+      {{"envoy.reloadable_features.xds_parallel_resource_decoding", "true"}});
+  setup();
+
+  InSequence s;
+  const std::string& type_url = Config::TestTypeUrl::get().ClusterLoadAssignment;
+  OpaqueResourceDecoderSharedPtr resource_decoder(
+      std::make_shared<TestUtility::TestOpaqueResourceDecoderImpl<
+          envoy::config::endpoint::v3::ClusterLoadAssignment>>("cluster_name"));
+  auto foo_sub = grpc_mux_->addWatch(type_url, {}, callbacks_, resource_decoder, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {}, "", true);
+  grpc_mux_->start();
+
+  const size_t count = 4 * ResourceDecodePool::MinParallelResources;
+  auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+  response->set_type_url(type_url);
+  response->set_version_info("1");
+  for (size_t i = 0; i < count; ++i) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+    load_assignment.set_cluster_name(absl::StrCat("cluster_", i));
+    std::ignore = response->add_resources()->PackFrom(load_assignment);
+  }
+  // Unknown fields are only detected by the field checks, after the pool decoded everything.
+  envoy::config::endpoint::v3::ClusterLoadAssignment unknown_fields;
+  unknown_fields.set_cluster_name("unknown");
+  unknown_fields.GetReflection()->MutableUnknownFields(&unknown_fields)->AddFixed32(1000, 1);
+  std::ignore = response->mutable_resources(count / 4)->PackFrom(unknown_fields);
+  // The empty cluster name fails PGV validation on the pool.
+  std::ignore = response->mutable_resources(count / 2)
+                    ->PackFrom(envoy::config::endpoint::v3::ClusterLoadAssignment());
+
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _)).Times(0);
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(ConfigUpdateFailureReason::UpdateRejected, _))
+      .WillOnce(Invoke([&](ConfigUpdateFailureReason, const EnvoyException* e) {
+        EXPECT_THAT(e->what(), testing::HasSubstr("unknown fields"));
+        expectSendMessage(type_url, {}, "", false, "", Grpc::Status::WellKnownGrpcStatus::Internal,
+                          e->what());
+      }));
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
+}
+
+// With reuse of unchanged resources, a resource whose bytes did not change is handed to the watch
+// as the message decoded for the previous response, and a changed one is decoded again.
+TEST_P(GrpcMuxImplTest, ReusesUnchangedResources) {
+  scoped_runtime_.mergeValues(
+      {{"envoy.reloadable_features.xds_sotw_reuse_unchanged_resources", "true"}});
+  setup();
+
+  InSequence s;
+  const std::string& type_url = Config::TestTypeUrl::get().ClusterLoadAssignment;
+  OpaqueResourceDecoderSharedPtr resource_decoder(
+      std::make_shared<TestUtility::TestOpaqueResourceDecoderImpl<
+          envoy::config::endpoint::v3::ClusterLoadAssignment>>("cluster_name"));
+  auto foo_sub = grpc_mux_->addWatch(type_url, {}, callbacks_, resource_decoder, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {}, "", true);
+  grpc_mux_->start();
+
+  const auto make_response = [&type_url](const std::string& version, uint32_t y_factor) {
+    auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(type_url);
+    response->set_version_info(version);
+    envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+    load_assignment.set_cluster_name("x");
+    std::ignore = response->add_resources()->PackFrom(load_assignment);
+    load_assignment.set_cluster_name("y");
+    load_assignment.mutable_policy()->mutable_overprovisioning_factor()->set_value(y_factor);
+    std::ignore = response->add_resources()->PackFrom(load_assignment);
+    return response;
+  };
+
+  std::vector<const Protobuf::Message*> first;
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"))
+      .WillOnce(
+          Invoke([&first](const std::vector<DecodedResourceRef>& resources, const std::string&) {
+            for (const auto& resource : resources) {
+              first.push_back(&resource.get().resource());
+            }
+            return absl::OkStatus();
+          }));
+  expectSendMessage(type_url, {}, "1");
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(make_response("1", 100));
+  ASSERT_EQ(2, first.size());
+
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "2"))
+      .WillOnce(
+          Invoke([&first](const std::vector<DecodedResourceRef>& resources, const std::string&) {
+            EXPECT_EQ(2, resources.size());
+            if (resources.size() == 2) {
+              EXPECT_EQ(first[0], &resources[0].get().resource());
+              EXPECT_EQ("2", resources[0].get().version());
+              EXPECT_NE(first[1], &resources[1].get().resource());
+              EXPECT_EQ(200, Envoy::Protobuf::DynamicCastMessage<
+                                 envoy::config::endpoint::v3::ClusterLoadAssignment>(
+                                 resources[1].get().resource())
+                                 .policy()
+                                 .overprovisioning_factor()
+                                 .value());
+            }
+            return absl::OkStatus();
+          }));
+  expectSendMessage(type_url, {}, "2");
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(make_response("2", 200));
+}
+
 // Validate behavior when watches specify resources (potentially overlapping).
 TEST_P(GrpcMuxImplTest, WatchDemux) {
   setup();
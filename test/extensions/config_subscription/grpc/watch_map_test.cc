@@ -6,11 +6,13 @@
 #include "envoy/service/discovery/v3/discovery.pb.h"
 #include "envoy/stats/scope.h"
 
+#include "source/common/config/resource_decode_pool.h"
 #include "source/extensions/config_subscription/grpc/watch_map.h"
 
 #include "test/mocks/config/custom_config_validators.h"
 #include "test/mocks/config/eds_resources_cache.h"
 #include "test/mocks/config/mocks.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -607,6 +609,74 @@ TEST(WatchMapTest, DeltaOnConfigUpdate) {
   doDeltaAndSotwUpdate(watch_map, update, {"removed"}, "version1");
 }
 
+// With parallel decoding, large SotW and delta updates reach each watch in response order, along
+// with the removals it is interested in.
+TEST(WatchMapTest, ParallelDecoding) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.xds_parallel_resource_decoding", "true"}});
+  MockSubscriptionCallbacks callbacks1;
+  MockSubscriptionCallbacks callbacks2;
+  TestUtility::TestOpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment>
+      resource_decoder("cluster_name");
+  NiceMock<MockCustomConfigValidators> config_validators;
+  WatchMap watch_map(false, "ClusterLoadAssignmentType", &config_validators, {});
+  Watch* watch1 = watch_map.addWatch(callbacks1, resource_decoder);
+  Watch* watch2 = watch_map.addWatch(callbacks2, resource_decoder);
+
+  Protobuf::RepeatedPtrField<Protobuf::Any> updated_resources;
+  std::vector<envoy::config::endpoint::v3::ClusterLoadAssignment> expected_resources1;
+  std::vector<envoy::config::endpoint::v3::ClusterLoadAssignment> expected_resources2;
+  absl::flat_hash_set<std::string> names1({"removed"});
+  absl::flat_hash_set<std::string> names2({"removed"});
+  for (size_t i = 0; i < 4 * ResourceDecodePool::MinParallelResources; ++i) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment cla;
+    cla.set_cluster_name(absl::StrCat("cluster_", i));
+    std::ignore = updated_resources.Add()->PackFrom(cla);
+    expected_resources1.push_back(cla);
+    names1.insert(cla.cluster_name());
+    if (i % 2 == 0) {
+      expected_resources2.push_back(cla);
+      names2.insert(cla.cluster_name());
+    }
+  }
+  watch_map.updateWatchInterest(watch1, names1);
+  watch_map.updateWatchInterest(watch2, names2);
+
+  expectDeltaAndSotwUpdate(callbacks1, expected_resources1, {"removed"}, "version1");
+  expectDeltaAndSotwUpdate(callbacks2, expected_resources2, {"removed"}, "version1");
+  doDeltaAndSotwUpdate(watch_map, updated_resources, {"removed"}, "version1");
+}
+
+// With parallel decoding, an invalid resource rejects the whole update before any watch sees it.
+TEST(WatchMapTest, ParallelDecodingInvalidResource) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.xds_parallel_resource_decoding", "true"}});
+  MockSubscriptionCallbacks callbacks;
+  TestUtility::TestOpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment>
+      resource_decoder("cluster_name");
+  NiceMock<MockCustomConfigValidators> config_validators;
+  WatchMap watch_map(false, "ClusterLoadAssignmentType", &config_validators, {});
+  watch_map.addWatch(callbacks, resource_decoder);
+
+  Protobuf::RepeatedPtrField<Protobuf::Any> updated_resources;
+  for (size_t i = 0; i < 4 * ResourceDecodePool::MinParallelResources; ++i) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment cla;
+    cla.set_cluster_name(absl::StrCat("cluster_", i));
+    std::ignore = updated_resources.Add()->PackFrom(cla);
+  }
+  // The empty cluster name fails PGV validation.
+  std::ignore = updated_resources[ResourceDecodePool::MinParallelResources].PackFrom(
+      envoy::config::endpoint::v3::ClusterLoadAssignment());
+
+  expectNoUpdate(callbacks, "version1");
+  EXPECT_THROW_WITH_REGEX(watch_map.onConfigUpdate(updated_resources, "version1"), EnvoyException,
+                          "ClusterName");
+  EXPECT_THROW_WITH_REGEX(doDeltaUpdate(watch_map, updated_resources, {}, "version1"),
+                          EnvoyException, "ClusterName");
+}
+
 TEST(WatchMapTest, OnConfigUpdateFailed) {
   NiceMock<MockCustomConfigValidators> config_validators;
   WatchMap watch_map(false, "ClusterLoadAssignmentType", &config_validators, {});
@@ -23,6 +23,7 @@ TEST(Coverage, CacheEntryStatusString) {
   EXPECT_EQ(cacheEntryStatusString(CacheEntryStatus::FoundNotModified), "FoundNotModified");
   EXPECT_EQ(cacheEntryStatusString(CacheEntryStatus::LookupError), "LookupError");
   EXPECT_EQ(cacheEntryStatusString(CacheEntryStatus::UpstreamReset), "UpstreamReset");
+  EXPECT_EQ(cacheEntryStatusString(CacheEntryStatus::CollapseOverflow), "CollapseOverflow");
   EXPECT_ENVOY_BUG(cacheEntryStatusString(uncheckedEnumCastForTest<CacheEntryStatus>(99)),
                    "Unexpected CacheEntryStatus");
 }
@@ -141,6 +141,21 @@ protected:
     return testLookupRequest(headers);
   }
 
+  ActiveLookupRequestPtr testLookupRequestWithCollapseLimit(absl::string_view path,
+                                                            uint32_t max_collapsed_requests) {
+    auto headers = requestHeaders(path);
+    return std::make_unique<ActiveLookupRequest>(
+        headers, mockUpstreamFactory(), "test_cluster", *dispatcher_,
+        api_->timeSource().systemTime(), mock_cacheable_response_checker_, cache_sessions_, false,
+        max_collapsed_requests);
+  }
+
+  uint64_t collapsedRequests() {
+    return TestUtility::findCounter(mock_factory_context_.server_factory_context_.store_,
+                                    "cache.collapsed_requests.cache_label.mock_cache")
+        ->value();
+  }
+
   ActiveLookupRequestPtr testLookupRangeRequest(absl::string_view path, int start, int end) {
     auto headers = requestHeaders(path);
     headers.addCopy("range", absl::StrCat("bytes=", start, "-", end));
@@ -258,6 +273,27 @@ TEST_F(CacheSessionsTest, MultipleRequestsForSameKeyIssuesOnlyOneLookupRequest)
   EXPECT_THAT(captured_lookup_callbacks_.size(), Eq(1));
 }
 
+TEST_F(CacheSessionsTest, RequestsBeyondCollapseLimitBypassTheCache) {
+  EXPECT_CALL(*mock_http_cache_, lookup(LookupHasPath("/a"), _));
+  EXPECT_CALL(*mock_http_cache_, touch(KeyHasPath("/a"), _)).Times(3);
+  ActiveLookupResultPtr result3;
+  auto ignore_result = [](ActiveLookupResultPtr) {};
+  cache_sessions_->lookup(testLookupRequestWithCollapseLimit("/a", 1), ignore_result);
+  cache_sessions_->lookup(testLookupRequestWithCollapseLimit("/a", 1), ignore_result);
+  cache_sessions_->lookup(testLookupRequestWithCollapseLimit("/a", 1),
+                          [&result3](ActiveLookupResultPtr r) { result3 = std::move(r); });
+  pumpDispatcher();
+  // The first request looked up the cache, and the second is waiting for its result.
+  EXPECT_THAT(captured_lookup_callbacks_.size(), Eq(1));
+  EXPECT_THAT(collapsedRequests(), Eq(1));
+  // The third request exceeded the limit, so went upstream by itself.
+  ASSERT_THAT(result3, NotNull());
+  EXPECT_THAT(result3->status_, Eq(CacheEntryStatus::CollapseOverflow));
+  ASSERT_THAT(fake_upstreams_.size(), Eq(1));
+  EXPECT_THAT(fake_upstream_sent_headers_[0],
+              Pointee(IsSupersetOfHeaders(Http::TestRequestHeaderMapImpl{{":path", "/a"}})));
+}
+
 TEST_F(CacheSessionsTest, CacheSessionsEntriesExpireOnAdjacentLookup) {
   EXPECT_CALL(*mock_http_cache_, lookup(LookupHasPath("/a"), _)).Times(2);
   EXPECT_CALL(*mock_http_cache_, lookup(LookupHasPath("/b"), _));
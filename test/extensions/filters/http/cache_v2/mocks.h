@@ -26,6 +26,7 @@ public:
   MOCK_METHOD(void, subCacheSessionsSubscribers, (uint64_t count));
   MOCK_METHOD(void, addUpstreamBufferedBytes, (uint64_t bytes));
   MOCK_METHOD(void, subUpstreamBufferedBytes, (uint64_t bytes));
+  MOCK_METHOD(void, incCollapsedRequests, ());
 };
 
 class MockCacheSessions : public CacheSessions {
@@ -87,6 +87,17 @@ TEST_F(CacheStatsTest, StatsAreConstructedCorrectly) {
       "cache.event.cache_label.fake_cache.event_type.lookup_error");
   EXPECT_THAT(lookup_errors, OptCounterIs("cache.event", 1));
 
+  stats_->incForStatus(CacheEntryStatus::CollapseOverflow);
+  Stats::CounterOptConstRef collapse_overflows = context_.store_.findCounterByString(
+      "cache.event.cache_label.fake_cache.event_type.collapse_overflow");
+  EXPECT_THAT(collapse_overflows, OptCounterIs("cache.event", 1));
+
+  stats_->incCollapsedRequests();
+  stats_->incCollapsedRequests();
+  Stats::CounterOptConstRef collapsed_requests =
+      context_.store_.findCounterByString("cache.collapsed_requests.cache_label.fake_cache");
+  EXPECT_THAT(collapsed_requests, OptCounterIs("cache.collapsed_requests", 2));
+
   stats_->incCacheSessionsEntries();
   stats_->incCacheSessionsEntries();
   stats_->incCacheSessionsEntries();
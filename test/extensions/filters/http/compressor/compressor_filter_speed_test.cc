@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <chrono>
+
 #include "envoy/compression/compressor/factory.h"
 #include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
 
@@ -702,6 +705,179 @@ BENCHMARK(compressChunks1024WithBrotli)
     ->UseManualTime()
     ->Unit(benchmark::kMillisecond);
 
+// Measures how long a worker is busy with a large gzip response at the best compression level:
+// compressing it inline (0), or handing its chunks to a thread pool (1). The manual time is the
+// time spent in encodeData(), which is what delays the worker's other streams; the
+// "end_to_end_ms" counter also includes waiting for the compressed data to come back.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void compressLargeResponseOffloadedWithGzip(benchmark::State& state) {
+  const bool offload = state.range(0) == 1;
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("worker");
+  auto thread_pool = std::make_shared<CompressionThreadPool>(1, api->threadFactory(), *dispatcher);
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks;
+  ON_CALL(encoder_callbacks, dispatcher()).WillByDefault(testing::ReturnRef(*dispatcher));
+  bool end_stream_injected = false;
+  ON_CALL(encoder_callbacks, injectEncodedDataToFilterChain(testing::_, testing::_))
+      .WillByDefault(testing::Invoke([&](Buffer::Instance& data, bool end_stream) {
+        data.drain(data.length());
+        end_stream_injected = end_stream;
+      }));
+  double end_to_end_seconds = 0;
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    Stats::IsolatedStoreImpl stats;
+    testing::NiceMock<Runtime::MockLoader> runtime;
+    ON_CALL(runtime.snapshot_, featureEnabled("test.filter_enabled", 100))
+        .WillByDefault(Return(true));
+    envoy::extensions::filters::http::compressor::v3::Compressor proto_config;
+    proto_config.mutable_response_direction_config()
+        ->mutable_offload()
+        ->mutable_min_response_bytes()
+        ->set_value(TestDataSize / 2);
+    auto config = std::make_shared<CompressorFilterConfig>(
+        proto_config, "test.", *stats.rootScope(), runtime,
+        std::make_unique<MockGzipCompressorFactory>(
+            Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel::Best,
+            Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard, 15,
+            9),
+        offload ? thread_pool : nullptr);
+    auto filter = std::make_unique<CompressorFilter>(config);
+    filter->setDecoderFilterCallbacks(decoder_callbacks);
+    filter->setEncoderFilterCallbacks(encoder_callbacks);
+    Http::TestRequestHeaderMapImpl headers = {{":method", "get"}, {"accept-encoding", "gzip"}};
+    filter->decodeHeaders(headers, false);
+    Http::TestResponseHeaderMapImpl response_headers = {
+        {":status", "200"}, {"content-type", "application/json;charset=utf-8"}};
+    filter->encodeHeaders(response_headers, false);
+    std::vector<Buffer::OwnedImpl> chunks = generateChunks(2, TestDataSize / 2);
+    end_stream_injected = false;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      filter->encodeData(chunks[i], i == chunks.size() - 1);
+    }
+    const auto handed_off = std::chrono::high_resolution_clock::now();
+    while (offload && !end_stream_injected) {
+      dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    filter->onDestroy();
+
+    state.SetIterationTime(
+        std::chrono::duration_cast<std::chrono::duration<double>>(handed_off - start).count());
+    end_to_end_seconds +=
+        std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+  }
+  state.counters["end_to_end_ms"] =
+      benchmark::Counter(end_to_end_seconds * 1000, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(compressLargeResponseOffloadedWithGzip)
+    ->DenseRange(0, 1, 1)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Measures the latency of small responses on a worker that is also sending a large gzip response
+// at the best compression level, compressed inline (0) or on a thread pool (1). Each chunk of the
+// large response arrives in the worker's event loop together with a small response, which is
+// compressed inline in either case. The manual time is the mean time from the arrival of a small
+// response until it is compressed; the "max_latency_ms" counter is the worst of those.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void smallResponseLatencyBehindLargeResponseWithGzip(benchmark::State& state) {
+  constexpr size_t LargeChunks = 8;
+  constexpr uint64_t SmallResponseSize = 1024;
+  const bool offload = state.range(0) == 1;
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("worker");
+  auto thread_pool = std::make_shared<CompressionThreadPool>(1, api->threadFactory(), *dispatcher);
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks;
+  ON_CALL(encoder_callbacks, dispatcher()).WillByDefault(testing::ReturnRef(*dispatcher));
+  bool end_stream_injected = false;
+  ON_CALL(encoder_callbacks, injectEncodedDataToFilterChain(testing::_, testing::_))
+      .WillByDefault(testing::Invoke([&](Buffer::Instance& data, bool end_stream) {
+        data.drain(data.length());
+        end_stream_injected = end_stream;
+      }));
+  double max_latency_seconds = 0;
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    Stats::IsolatedStoreImpl stats;
+    testing::NiceMock<Runtime::MockLoader> runtime;
+    ON_CALL(runtime.snapshot_, featureEnabled("test.filter_enabled", 100))
+        .WillByDefault(Return(true));
+    envoy::extensions::filters::http::compressor::v3::Compressor proto_config;
+    proto_config.mutable_response_direction_config()
+        ->mutable_offload()
+        ->mutable_min_response_bytes()
+        ->set_value(TestDataSize / 2);
+    auto config = std::make_shared<CompressorFilterConfig>(
+        proto_config, "test.", *stats.rootScope(), runtime,
+        std::make_unique<MockGzipCompressorFactory>(
+            Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel::Best,
+            Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard, 15,
+            9),
+        offload ? thread_pool : nullptr);
+    const auto start_response = [&]() {
+      auto filter = std::make_unique<CompressorFilter>(config);
+      filter->setDecoderFilterCallbacks(decoder_callbacks);
+      filter->setEncoderFilterCallbacks(encoder_callbacks);
+      Http::TestRequestHeaderMapImpl headers = {{":method", "get"}, {"accept-encoding", "gzip"}};
+      filter->decodeHeaders(headers, false);
+      Http::TestResponseHeaderMapImpl response_headers = {
+          {":status", "200"}, {"content-type", "application/json;charset=utf-8"}};
+      filter->encodeHeaders(response_headers, false);
+      return filter;
+    };
+    std::unique_ptr<CompressorFilter> large_response = start_response();
+    std::vector<Buffer::OwnedImpl> large_chunks;
+    std::vector<std::unique_ptr<CompressorFilter>> small_responses;
+    std::vector<Buffer::OwnedImpl> small_bodies = generateChunks(LargeChunks, SmallResponseSize);
+    for (size_t i = 0; i < LargeChunks; ++i) {
+      // The test data only has room for two chunks of this size, so every chunk is the same.
+      large_chunks.push_back(std::move(generateChunks(1, TestDataSize / 2)[0]));
+      small_responses.push_back(start_response());
+    }
+    std::vector<std::chrono::high_resolution_clock::time_point> compressed(LargeChunks);
+    end_stream_injected = false;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < LargeChunks; ++i) {
+      dispatcher->post(
+          [&, i]() { large_response->encodeData(large_chunks[i], i + 1 == LargeChunks); });
+      dispatcher->post([&, i]() {
+        small_responses[i]->encodeData(small_bodies[i], true);
+        compressed[i] = std::chrono::high_resolution_clock::now();
+      });
+    }
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    while (offload && !end_stream_injected) {
+      dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    }
+    large_response->onDestroy();
+    for (auto& small_response : small_responses) {
+      small_response->onDestroy();
+    }
+
+    double total_latency_seconds = 0;
+    for (const auto& time : compressed) {
+      const double latency_seconds =
+          std::chrono::duration_cast<std::chrono::duration<double>>(time - start).count();
+      total_latency_seconds += latency_seconds;
+      max_latency_seconds = std::max(max_latency_seconds, latency_seconds);
+    }
+    state.SetIterationTime(total_latency_seconds / LargeChunks);
+  }
+  state.counters["max_latency_ms"] = max_latency_seconds * 1000;
+}
+BENCHMARK(smallResponseLatencyBehindLargeResponseWithGzip)
+    ->DenseRange(0, 1, 1)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
 } // namespace Compressor
 } // namespace HttpFilters
 } // namespace Extensions
@@ -1,5 +1,8 @@
 #include <sys/types.h>
 
+#include <atomic>
+#include <functional>
+
 #include "source/common/http/header_utility.h"
 #include "source/extensions/filters/http/compressor/compressor_filter.h"
 
@@ -13,6 +16,8 @@
 #include "test/test_common/utility.h"
 
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -32,16 +37,25 @@ public:
 
   Envoy::Compression::Compressor::CompressorPtr createCompressor() override {
     auto compressor = std::make_unique<Compression::Compressor::MockCompressor>();
-    EXPECT_CALL(*compressor, compress(_, _)).Times(expected_compress_calls_);
+    EXPECT_CALL(*compressor, compress(_, _))
+        .Times(expected_compress_calls_)
+        .WillRepeatedly([this](Buffer::Instance&, Compression::Compressor::State) {
+          if (on_compress_) {
+            on_compress_();
+          }
+        });
     return compressor;
   }
   const std::string& statsPrefix() const override { CONSTRUCT_ON_FIRST_USE(std::string, "test."); }
   const std::string& contentEncoding() const override { return content_encoding_; }
 
   void setExpectedCompressCalls(uint32_t calls) { expected_compress_calls_ = calls; }
+  // Called by every compress call, on the thread that compresses.
+  void setOnCompress(std::function<void()> on_compress) { on_compress_ = std::move(on_compress); }
 
 private:
   uint32_t expected_compress_calls_{1};
+  std::function<void()> on_compress_;
   const std::string content_encoding_;
 };
 
@@ -2566,6 +2580,176 @@ TEST_F(CompressorPerRouteLibraryTest, GetCompressorFactoryUsesPerRoute) {
   EXPECT_EQ(per_route_factory.contentEncoding(), "test");
 }
 
+class CompressorFilterOffloadTest : public CompressorFilterTest {
+public:
+  void SetUp() override { setUpOffloadFilter(1); }
+  void TearDown() override {
+    // The config's factory is deleted in the dispatcher, which is destroyed before the base
+    // fixture's members.
+    filter_.reset();
+    config_.reset();
+    thread_pool_.reset();
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  void setUpOffloadFilter(uint32_t thread_count) {
+    envoy::extensions::filters::http::compressor::v3::Compressor compressor;
+    TestUtility::loadFromJson(R"EOF(
+{
+  "response_direction_config": {
+    "offload": {
+      "min_response_bytes": 4
+    }
+  },
+  "compressor_library": {
+     "name": "test",
+     "typed_config": {
+       "@type": "type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip"
+     }
+  }
+}
+)EOF",
+                              compressor);
+    auto compressor_factory = std::make_unique<TestCompressorFactory>("test");
+    compressor_factory_ = compressor_factory.get();
+    // Held by the fixture as well, as the server holds the singleton, so that it outlives the
+    // config.
+    thread_pool_ =
+        std::make_shared<CompressionThreadPool>(thread_count, api_->threadFactory(), *dispatcher_);
+    config_ = std::make_shared<CompressorFilterConfig>(compressor, "test.", *stats_.rootScope(),
+                                                       runtime_, std::move(compressor_factory),
+                                                       thread_pool_);
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+    ON_CALL(encoder_callbacks_, dispatcher()).WillByDefault(ReturnRef(*dispatcher_));
+    ON_CALL(encoder_callbacks_, injectEncodedDataToFilterChain(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool end_stream) {
+          injected_.push_back(data.toString());
+          injected_end_stream_ = end_stream;
+          data.drain(data.length());
+        }));
+  }
+
+  void startResponse(uint32_t compress_calls) {
+    compressor_factory_->setExpectedCompressCalls(compress_calls);
+    doRequestNoCompression({{":method", "get"}, {"accept-encoding", "test"}});
+    Http::TestResponseHeaderMapImpl headers{{":status", "200"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    EXPECT_EQ("test", headers.get_("content-encoding"));
+  }
+
+  Http::FilterDataStatus encodeData(absl::string_view data, bool end_stream) {
+    Buffer::OwnedImpl buffer(data);
+    return filter_->encodeData(buffer, end_stream);
+  }
+
+  // Runs the dispatcher until the compressed end of the response has been injected.
+  void runUntilEndStream() {
+    while (!injected_end_stream_) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("worker");
+  std::shared_ptr<CompressionThreadPool> thread_pool_;
+  std::vector<std::string> injected_;
+  bool injected_end_stream_{};
+};
+
+TEST_F(CompressorFilterOffloadTest, SmallChunksAreCompressedInline) {
+  startResponse(2);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, encodeData("abc", false));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, encodeData("", true));
+  EXPECT_CALL(encoder_callbacks_, injectEncodedDataToFilterChain(_, _)).Times(0);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(CompressorFilterOffloadTest, ResponseIsOffloadedOnceItReachesTheMinimum) {
+  startResponse(3);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, encodeData("ab", false));
+  // Small chunks are offloaded once the response as a whole is large.
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("cd", false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("e", true));
+  runUntilEndStream();
+  EXPECT_THAT(injected_, testing::ElementsAre("cd", "e"));
+}
+
+TEST_F(CompressorFilterOffloadTest, ChunksAreInjectedInOrder) {
+  startResponse(3);
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("aaaa", false));
+  // Chunks smaller than the minimum wait behind the chunk on the pool.
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("b", false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("cccc", true));
+  runUntilEndStream();
+  EXPECT_THAT(injected_, testing::ElementsAre("aaaa", "b", "cccc"));
+  response_stats_prefix_ = "response.";
+  expected_str_ = "aaaabcccc";
+  data_.drain(data_.length());
+  data_.add(absl::StrJoin(injected_, ""));
+  verifyCompressedData();
+}
+
+TEST_F(CompressorFilterOffloadTest, TrailersWaitForTheLastChunk) {
+  startResponse(2);
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("aaaa", false));
+  Http::TestResponseTrailerMapImpl trailers;
+  EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, filter_->encodeTrailers(trailers));
+  bool continued = false;
+  EXPECT_CALL(encoder_callbacks_, continueEncoding()).WillOnce(Invoke([&]() { continued = true; }));
+  while (!continued) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_THAT(injected_, testing::ElementsAre("aaaa", ""));
+  EXPECT_FALSE(injected_end_stream_);
+}
+
+TEST_F(CompressorFilterOffloadTest, HeldChunksAreSubjectToTheBufferLimit) {
+  ON_CALL(encoder_callbacks_, encoderBufferLimit()).WillByDefault(Return(6));
+  startResponse(2);
+  EXPECT_CALL(encoder_callbacks_, onEncoderFilterAboveWriteBufferHighWatermark());
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("aaaa", false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("bbbb", true));
+  EXPECT_CALL(encoder_callbacks_, onEncoderFilterBelowWriteBufferLowWatermark());
+  runUntilEndStream();
+  EXPECT_THAT(injected_, testing::ElementsAre("aaaa", "bbbb"));
+}
+
+TEST_F(CompressorFilterOffloadTest, DestroyingTheFilterCancelsTheChunkOnThePool) {
+  // Without threads, the chunk stays on the pool until the filter is destroyed.
+  setUpOffloadFilter(0);
+  startResponse(0);
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("aaaa", true));
+  filter_->onDestroy();
+  EXPECT_CALL(encoder_callbacks_, injectEncodedDataToFilterChain(_, _)).Times(0);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(CompressorFilterOffloadTest, DestroyingTheConfigDefersTheWaitToTheMainThread) {
+  absl::Notification compressing;
+  absl::Notification finish_compressing;
+  std::atomic<bool> compressed{false};
+  compressor_factory_->setOnCompress([&]() {
+    compressing.Notify();
+    finish_compressing.WaitForNotification();
+    compressed = true;
+  });
+  startResponse(1);
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeData("aaaa", true));
+  compressing.WaitForNotification();
+  filter_->onDestroy();
+  filter_.reset();
+  // Releasing the last reference doesn't wait for the chunk on the pool, which would deadlock
+  // here.
+  config_.reset();
+  EXPECT_FALSE(compressed);
+  finish_compressing.Notify();
+  // Deleting the factory in the main thread waits for the chunk.
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(compressed);
+}
+
 } // namespace
 } // namespace Compressor
 } // namespace HttpFilters
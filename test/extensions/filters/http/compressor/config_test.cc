@@ -10,6 +10,7 @@
 #include "test/mocks/server/factory_context.h"
 #include "test/test_common/registry.h"
 #include "test/test_common/status_utility.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -100,6 +101,35 @@ TEST(CompressorFilterFactoryTests, RegisteredCompressorLibraryConfig) {
   EXPECT_OK(cb_or.status());
 }
 
+TEST(CompressorFilterFactoryTests, OffloadSharesThreadPoolBetweenFilters) {
+  const std::string yaml_string = R"EOF(
+  response_direction_config:
+    offload:
+      min_response_bytes: 1024
+  compressor_library:
+    name: test.mock.noop
+    typed_config:
+      "@type": type.googleapis.com/test.mock_compressor_library.Registered
+  )EOF";
+
+  envoy::extensions::filters::http::compressor::v3::Compressor proto_config;
+  TestUtility::loadFromYaml(yaml_string, proto_config);
+  CompressorFilterFactory factory;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  ON_CALL(context.server_factory_context_.api_, threadFactory())
+      .WillByDefault(testing::ReturnRef(Thread::threadFactoryForTest()));
+
+  TestNoopCompressorLibraryFactory factory_impl;
+  Envoy::Registry::InjectFactory<
+      Envoy::Compression::Compressor::NamedCompressorLibraryConfigFactory>
+      reg(factory_impl);
+  EXPECT_OK(factory.createFilterFactoryFromProto(proto_config, "stats", context).status());
+  std::shared_ptr<CompressionThreadPool> thread_pool =
+      CompressionThreadPool::singleton(context.server_factory_context_);
+  EXPECT_OK(factory.createFilterFactoryFromProto(proto_config, "stats", context).status());
+  EXPECT_EQ(thread_pool, CompressionThreadPool::singleton(context.server_factory_context_));
+}
+
 // Factory that accesses GenericFactoryContext methods.
 class TestCheckingCompressorLibraryFactory
     : public Envoy::Compression::Compressor::NamedCompressorLibraryConfigFactory {
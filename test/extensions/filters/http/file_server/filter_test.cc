@@ -37,7 +37,8 @@ public:
     std::string s(yaml);
     ProtoFileServerConfig proto_config;
     TestUtility::loadFromYaml(s, proto_config);
-    return std::make_shared<FileServerConfig>(proto_config, nullptr, mock_async_file_manager_);
+    return std::make_shared<FileServerConfig>(proto_config, nullptr, mock_async_file_manager_,
+                                              hot_file_cache_);
   }
   void initFilter(FileServerFilter& filter) {
     filter.setDecoderFilterCallbacks(decoder_callbacks_);
@@ -83,6 +84,9 @@ directory_behaviors:
   NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
   Api::ApiPtr api_ = Api::createApiForTest();
   Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("test_thread");
+  // Never run, so the hot file cache never gets to watch the (nonexistent) files it holds.
+  Event::DispatcherPtr main_thread_dispatcher_ = api_->allocateDispatcher("main_thread");
+  std::shared_ptr<HotFileCache> hot_file_cache_;
 };
 
 TEST_F(FileServerFilterTest, PassThroughIfNoPath) {
@@ -528,6 +532,167 @@ TEST_F(FileServerFilterTest, BufferLimitsDontPauseIfClearedBeforeActionCompletes
   EXPECT_EQ(responseCodeDetails(), "file_server");
 }
 
+TEST_F(FileServerFilterTest, HotFileCacheServesRepeatedRequestsFromMemory) {
+  hot_file_cache_ = std::make_shared<HotFileCache>(ProtoHotFileCache{}, *main_thread_dispatcher_);
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":path", "/path1/foo/index.html"},
+      {":method", "GET"},
+      {":host", "test.host"},
+      {":scheme", "https"},
+  };
+  Http::TestResponseHeaderMapImpl expected_headers{
+      {":status", "200"},
+      {"accept-ranges", "bytes"},
+      {"content-length", "11"},
+      {"content-type", "text/html"},
+      {"etag", "\"b-0.0\""},
+      {"last-modified", "Thu, 01 Jan 1970 00:00:00 GMT"},
+  };
+  {
+    auto filter = testFilter();
+    makeMockFile();
+    InSequence seq;
+    EXPECT_CALL(*mock_async_file_manager_, stat);
+    EXPECT_CALL(*mock_async_file_manager_, openExistingFile(_, "fs1/foo/index.html", _, _));
+    EXPECT_CALL(*mock_file_handle_, stat);
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderMapEqualRef(&expected_headers), false));
+    EXPECT_CALL(*mock_file_handle_, read(_, 0, 11, _));
+    EXPECT_CALL(decoder_callbacks_, encodeData(BufferString("hello world"), true));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter->decodeHeaders(request_headers, true));
+    struct stat stat_result = {};
+    stat_result.st_size = 11;
+    mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{stat_result});
+    pumpDispatcher();
+    mock_async_file_manager_->nextActionCompletes(
+        absl::StatusOr<AsyncFileHandle>{mock_file_handle_});
+    pumpDispatcher();
+    mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{stat_result});
+    pumpDispatcher();
+    mock_async_file_manager_->nextActionCompletes(
+        absl::StatusOr<Buffer::InstancePtr>{std::make_unique<Buffer::OwnedImpl>("hello world")});
+    pumpDispatcher();
+  }
+  EXPECT_EQ(hot_file_cache_->totalSizeForTest(), 11U);
+  {
+    auto filter = testFilter();
+    InSequence seq;
+    EXPECT_CALL(*mock_async_file_manager_, stat).Times(0);
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderMapEqualRef(&expected_headers), false));
+    EXPECT_CALL(decoder_callbacks_, encodeData(BufferString("hello world"), true));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter->decodeHeaders(request_headers, true));
+  }
+  {
+    auto filter = testFilter();
+    request_headers.addCopy(Http::LowerCaseString("range"), "bytes=6-9");
+    Http::TestResponseHeaderMapImpl expected_range_headers{
+        {":status", "206"},
+        {"accept-ranges", "bytes"},
+        {"content-length", "4"},
+        {"content-range", "bytes 6-9/11"},
+        {"content-type", "text/html"},
+        {"etag", "\"b-0.0\""},
+        {"last-modified", "Thu, 01 Jan 1970 00:00:00 GMT"},
+    };
+    InSequence seq;
+    EXPECT_CALL(*mock_async_file_manager_, stat).Times(0);
+    EXPECT_CALL(decoder_callbacks_,
+                encodeHeaders_(HeaderMapEqualRef(&expected_range_headers), false));
+    EXPECT_CALL(decoder_callbacks_, encodeData(BufferString("worl"), true));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter->decodeHeaders(request_headers, true));
+  }
+}
+
+TEST_F(FileServerFilterTest, HotFileCacheAnswersMatchingIfNoneMatchWithNotModified) {
+  hot_file_cache_ = std::make_shared<HotFileCache>(ProtoHotFileCache{}, *main_thread_dispatcher_);
+  auto file = std::make_shared<HotFile>();
+  file->contents_ = std::make_shared<const std::string>("hello world");
+  struct stat stat_result = {};
+  file->validators_ = FileValidators::fromStat(stat_result);
+  file->content_type_ = "text/html";
+  hot_file_cache_->insert("fs1/foo/index.html", std::move(file));
+  auto filter = testFilter();
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":path", "/path1/foo/index.html"},
+      {":method", "GET"},
+      {":host", "test.host"},
+      {":scheme", "https"},
+      {"if-none-match", "\"0-0.0\""},
+      // Conditions are evaluated before the range.
+      {"range", "bytes=6-9"},
+  };
+  Http::TestResponseHeaderMapImpl expected_headers{
+      {":status", "304"},
+      {"etag", "\"0-0.0\""},
+      {"last-modified", "Thu, 01 Jan 1970 00:00:00 GMT"},
+  };
+  EXPECT_CALL(*mock_async_file_manager_, stat).Times(0);
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderMapEqualRef(&expected_headers), true));
+  EXPECT_CALL(decoder_callbacks_, encodeData).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter->decodeHeaders(request_headers, true));
+}
+
+TEST_F(FileServerFilterTest, UnmodifiedFileIsNotReadForIfModifiedSince) {
+  hot_file_cache_ = std::make_shared<HotFileCache>(ProtoHotFileCache{}, *main_thread_dispatcher_);
+  auto filter = testFilter();
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":path", "/path1/foo/index.html"},
+      {":method", "GET"},
+      {":host", "test.host"},
+      {":scheme", "https"},
+      {"if-modified-since", "Thu, 01 Jan 1970 00:00:00 GMT"},
+  };
+  Http::TestResponseHeaderMapImpl expected_headers{
+      {":status", "304"},
+      {"etag", "\"b-0.0\""},
+      {"last-modified", "Thu, 01 Jan 1970 00:00:00 GMT"},
+  };
+  makeMockFile();
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderMapEqualRef(&expected_headers), true));
+  EXPECT_CALL(*mock_file_handle_, read).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter->decodeHeaders(request_headers, true));
+  struct stat stat_result = {};
+  stat_result.st_size = 11;
+  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{stat_result});
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<AsyncFileHandle>{mock_file_handle_});
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{stat_result});
+  pumpDispatcher();
+  EXPECT_EQ(hot_file_cache_->totalSizeForTest(), 0U);
+}
+
+TEST_F(FileServerFilterTest, HotFileCacheDoesNotCacheRangeRequests) {
+  hot_file_cache_ = std::make_shared<HotFileCache>(ProtoHotFileCache{}, *main_thread_dispatcher_);
+  auto filter = testFilter();
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":path", "/path1/foo/index.html"},
+      {":method", "GET"},
+      {":host", "test.host"},
+      {":scheme", "https"},
+      {"range", "bytes=6-"},
+  };
+  makeMockFile();
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(*mock_file_handle_, read(_, 6, 5, _));
+  EXPECT_CALL(decoder_callbacks_, encodeData(BufferString("world"), true));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter->decodeHeaders(request_headers, true));
+  struct stat stat_result = {};
+  stat_result.st_size = 11;
+  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{stat_result});
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<AsyncFileHandle>{mock_file_handle_});
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{stat_result});
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>{std::make_unique<Buffer::OwnedImpl>("world")});
+  pumpDispatcher();
+  EXPECT_EQ(hot_file_cache_->totalSizeForTest(), 0U);
+}
+
 } // namespace FileServer
 } // namespace HttpFilters
 } // namespace Extensions
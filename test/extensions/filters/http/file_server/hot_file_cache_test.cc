@@ -0,0 +1,212 @@
+#include <fcntl.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/extensions/filters/http/file_server/hot_file_cache.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace FileServer {
+
+class HotFileCacheTest : public testing::Test {
+public:
+  void SetUp() override {
+    ProtoHotFileCache config;
+    config.mutable_max_file_size_bytes()->set_value(10);
+    config.mutable_max_total_size_bytes()->set_value(20);
+    cache_ = std::make_shared<HotFileCache>(config, *dispatcher_);
+  }
+
+  // Writes a file, and returns a HotFile as if it had been read from it.
+  HotFileSharedPtr writeFile(const std::string& path, absl::string_view contents) {
+    TestEnvironment::writeStringToFileForTest(path, std::string{contents}, true);
+    return hotFileFromDisk(path, contents);
+  }
+
+  HotFileSharedPtr hotFileFromDisk(const std::string& path, absl::string_view contents) {
+    struct stat s;
+    EXPECT_EQ(0, Api::OsSysCallsSingleton::get().stat(path.c_str(), &s).return_value_);
+    return hotFile(contents, FileValidators::fromStat(s));
+  }
+
+  HotFileSharedPtr hotFile(absl::string_view contents, FileValidators validators = {}) {
+    auto file = std::make_shared<HotFile>();
+    file->contents_ = std::make_shared<const std::string>(contents);
+    file->validators_ = std::move(validators);
+    return file;
+  }
+
+  void runMainThread() { dispatcher_->run(Event::Dispatcher::RunType::NonBlock); }
+
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("main_thread");
+  std::shared_ptr<HotFileCache> cache_;
+};
+
+TEST_F(HotFileCacheTest, ValidatorsDependOnSizeAndModificationTime) {
+  struct stat s = {};
+  s.st_size = 300;
+#ifdef _DARWIN_FEATURE_64_BIT_INODE
+  s.st_mtimespec = {1700000000, 5};
+#else
+  s.st_mtim = {1700000000, 5};
+#endif
+  FileValidators validators = FileValidators::fromStat(s);
+  EXPECT_EQ(validators.etag_, "\"12c-6553f100.5\"");
+  EXPECT_EQ(validators.last_modified_, "Tue, 14 Nov 2023 22:13:20 GMT");
+  EXPECT_EQ(validators.last_modified_time_, SystemTime{std::chrono::seconds{1700000000}});
+}
+
+TEST_F(HotFileCacheTest, IfNoneMatchComparesEntityTagsWeakly) {
+  FileValidators validators{"\"5-1.0\"", "", SystemTime{}};
+  auto conditions = [](absl::string_view if_none_match) {
+    return RequestConditions::fromHeaders(
+        Http::TestRequestHeaderMapImpl{{"if-none-match", std::string{if_none_match}}});
+  };
+  EXPECT_TRUE(conditions("\"5-1.0\"").notModified(validators));
+  EXPECT_TRUE(conditions("W/\"5-1.0\"").notModified(validators));
+  EXPECT_TRUE(conditions("\"other\", \"5-1.0\"").notModified(validators));
+  EXPECT_TRUE(conditions("*").notModified(validators));
+  EXPECT_FALSE(conditions("\"5-1.1\"").notModified(validators));
+}
+
+TEST_F(HotFileCacheTest, IfModifiedSinceComparesWholeSeconds) {
+  FileValidators validators{"\"5-6553f100.5\"", "Tue, 14 Nov 2023 22:13:20 GMT",
+                            SystemTime{std::chrono::seconds{1700000000}}};
+  auto conditions = [](absl::string_view if_modified_since) {
+    return RequestConditions::fromHeaders(
+        Http::TestRequestHeaderMapImpl{{"if-modified-since", std::string{if_modified_since}}});
+  };
+  EXPECT_TRUE(conditions("Tue, 14 Nov 2023 22:13:20 GMT").notModified(validators));
+  EXPECT_TRUE(conditions("Wed, 15 Nov 2023 00:00:00 GMT").notModified(validators));
+  EXPECT_FALSE(conditions("Tue, 14 Nov 2023 22:13:19 GMT").notModified(validators));
+  EXPECT_FALSE(conditions("not a date").notModified(validators));
+  // If-Modified-Since is ignored when If-None-Match is present.
+  EXPECT_FALSE(RequestConditions::fromHeaders(
+                   Http::TestRequestHeaderMapImpl{
+                       {"if-modified-since", "Wed, 15 Nov 2023 00:00:00 GMT"},
+                       {"if-none-match", "\"other\""},
+                   })
+                   .notModified(validators));
+}
+
+TEST_F(HotFileCacheTest, BodyIsRangeOfContentsAndOutlivesEviction) {
+  cache_->insert("a", hotFile("0123456789"));
+  Buffer::InstancePtr body = cache_->lookup("a")->body(2, 5);
+  cache_->invalidate("a");
+  EXPECT_EQ(cache_->lookup("a"), nullptr);
+  EXPECT_EQ(body->toString(), "234");
+}
+
+TEST_F(HotFileCacheTest, FilesLargerThanMaxFileSizeAreNotCached) {
+  cache_->insert("a", hotFile("0123456789a"));
+  EXPECT_EQ(cache_->lookup("a"), nullptr);
+  EXPECT_EQ(cache_->totalSizeForTest(), 0U);
+}
+
+TEST_F(HotFileCacheTest, EvictsLeastRecentlyUsedFilesBeyondMaxTotalSize) {
+  cache_->insert("a", hotFile("aaaaaaaa"));
+  cache_->insert("b", hotFile("bbbbbbbb"));
+  // Using "a" makes "b" the least recently used.
+  EXPECT_NE(cache_->lookup("a"), nullptr);
+  cache_->insert("c", hotFile("cccccccc"));
+  EXPECT_NE(cache_->lookup("a"), nullptr);
+  EXPECT_EQ(cache_->lookup("b"), nullptr);
+  EXPECT_NE(cache_->lookup("c"), nullptr);
+  EXPECT_EQ(cache_->totalSizeForTest(), 16U);
+}
+
+TEST_F(HotFileCacheTest, ReplacingAFileUpdatesTotalSize) {
+  cache_->insert("a", hotFile("aaaaaaaa"));
+  cache_->insert("a", hotFile("aa"));
+  EXPECT_EQ(cache_->lookup("a")->contents_->size(), 2U);
+  EXPECT_EQ(cache_->totalSizeForTest(), 2U);
+}
+
+TEST_F(HotFileCacheTest, UnwatchableFileIsInvalidated) {
+  cache_->insert("/some/path/that/does/not/exist", hotFile("a"));
+  runMainThread();
+  EXPECT_EQ(cache_->lookup("/some/path/that/does/not/exist"), nullptr);
+}
+
+TEST_F(HotFileCacheTest, FileChangedBeforeBeingWatchedIsInvalidated) {
+  const std::string path = TestEnvironment::temporaryPath("hot_file_changed_before_watch");
+  HotFileSharedPtr file = writeFile(path, "hello");
+  TestEnvironment::writeStringToFileForTest(path, "goodbye", true);
+  cache_->insert(path, std::move(file));
+  runMainThread();
+  EXPECT_EQ(cache_->lookup(path), nullptr);
+}
+
+TEST_F(HotFileCacheTest, ModifyingWatchedFileInvalidatesIt) {
+  const std::string path = TestEnvironment::temporaryPath("hot_file_modified");
+  cache_->insert(path, writeFile(path, "hello"));
+  runMainThread();
+  ASSERT_NE(cache_->lookup(path), nullptr);
+  Api::OsSysCalls& posix = Api::OsSysCallsSingleton::get();
+  const int fd = posix.open(path.c_str(), O_WRONLY | O_APPEND).return_value_;
+  ASSERT_NE(fd, -1);
+  EXPECT_EQ(posix.write(fd, "!", 1).return_value_, 1);
+  posix.close(fd);
+  while (cache_->lookup(path) != nullptr) {
+    runMainThread();
+  }
+}
+
+TEST_F(HotFileCacheTest, ReplacingWatchedFileInvalidatesIt) {
+  const std::string path = TestEnvironment::temporaryPath("hot_file_replaced");
+  cache_->insert(path, writeFile(path, "hello"));
+  runMainThread();
+  ASSERT_NE(cache_->lookup(path), nullptr);
+  const std::string replacement = TestEnvironment::temporaryPath("hot_file_replacement");
+  TestEnvironment::writeStringToFileForTest(replacement, "goodbye", true);
+  TestEnvironment::renameFile(replacement, path);
+  while (cache_->lookup(path) != nullptr) {
+    runMainThread();
+  }
+  // The file is watched once, and invalidated again if it is reinserted and changed.
+  cache_->insert(path, hotFileFromDisk(path, "goodbye"));
+  runMainThread();
+  ASSERT_NE(cache_->lookup(path), nullptr);
+  TestEnvironment::writeStringToFileForTest(replacement, "hello", true);
+  TestEnvironment::renameFile(replacement, path);
+  while (cache_->lookup(path) != nullptr) {
+    runMainThread();
+  }
+}
+
+// Watches can't be removed, so the watcher is replaced once it watches many more paths than are
+// cached, and the replacement keeps watching the files still cached.
+TEST_F(HotFileCacheTest, WatchedPathsAreBoundedAndCachedFilesStayWatched) {
+  const std::string path = TestEnvironment::temporaryPath("hot_file_rewatched");
+  cache_->insert(path, writeFile(path, "hello"));
+  runMainThread();
+  ASSERT_NE(cache_->lookup(path), nullptr);
+  // Files that don't exist are watched, and then invalidated because they can't be stat'ed.
+  for (int i = 0; i < 3000; i++) {
+    cache_->insert(TestEnvironment::temporaryPath(absl::StrCat("hot_file_missing_", i)),
+                   hotFile("a"));
+    runMainThread();
+    EXPECT_LE(cache_->watchedPathsForTest(), 1024U);
+  }
+  ASSERT_NE(cache_->lookup(path), nullptr);
+  TestEnvironment::writeStringToFileForTest(path, "goodbye", true);
+  while (cache_->lookup(path) != nullptr) {
+    runMainThread();
+  }
+}
+
+} // namespace FileServer
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
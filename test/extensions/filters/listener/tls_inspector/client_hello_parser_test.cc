@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "source/extensions/filters/listener/tls_inspector/client_hello_parser.h"
+
+#include "test/extensions/filters/listener/tls_inspector/tls_utility.h"
+
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ListenerFilters {
+namespace TlsInspector {
+namespace {
+
+constexpr size_t RecordHeaderSize = 5;
+constexpr size_t HandshakeHeaderSize = 4;
+
+absl::Span<const uint8_t> span(const std::vector<uint8_t>& data) {
+  return {data.data(), data.size()};
+}
+
+// The parsed ClientHello is identical to the one BoringSSL hands to the certificate selection
+// callback, which is what the filter used before.
+TEST(ClientHelloParserTest, MatchesBoringSsl) {
+  const std::vector<uint8_t> hello = Tls::Test::generateClientHello(
+      TLS1_VERSION, TLS1_3_VERSION, "example.com", "\x02h2\x08http/1.1");
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  ASSERT_EQ(ClientHelloParser::Result::Complete,
+            ClientHelloParser::parse(span(hello), parsed, bytes_consumed));
+  EXPECT_EQ(hello.size(), bytes_consumed);
+  EXPECT_EQ(nullptr, parsed.ssl);
+
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL> ssl(SSL_new(ctx.get()));
+  SSL_CLIENT_HELLO expected;
+  const uint8_t* body = hello.data() + RecordHeaderSize + HandshakeHeaderSize;
+  ASSERT_EQ(1, SSL_parse_client_hello(ssl.get(), &expected, body,
+                                      hello.size() - RecordHeaderSize - HandshakeHeaderSize));
+
+  EXPECT_EQ(expected.version, parsed.version);
+  EXPECT_EQ(absl::MakeSpan(expected.client_hello, expected.client_hello_len),
+            absl::MakeSpan(parsed.client_hello, parsed.client_hello_len));
+  EXPECT_EQ(absl::MakeSpan(expected.random, expected.random_len),
+            absl::MakeSpan(parsed.random, parsed.random_len));
+  EXPECT_EQ(absl::MakeSpan(expected.session_id, expected.session_id_len),
+            absl::MakeSpan(parsed.session_id, parsed.session_id_len));
+  EXPECT_EQ(absl::MakeSpan(expected.cipher_suites, expected.cipher_suites_len),
+            absl::MakeSpan(parsed.cipher_suites, parsed.cipher_suites_len));
+  EXPECT_EQ(absl::MakeSpan(expected.compression_methods, expected.compression_methods_len),
+            absl::MakeSpan(parsed.compression_methods, parsed.compression_methods_len));
+  EXPECT_EQ(absl::MakeSpan(expected.extensions, expected.extensions_len),
+            absl::MakeSpan(parsed.extensions, parsed.extensions_len));
+
+  absl::string_view server_name;
+  EXPECT_TRUE(ClientHelloParser::serverName(parsed, server_name));
+  EXPECT_EQ("example.com", server_name);
+}
+
+TEST(ClientHelloParserTest, NoServerName) {
+  const std::vector<uint8_t> hello =
+      Tls::Test::generateClientHello(TLS1_2_VERSION, TLS1_2_VERSION, "", "");
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  ASSERT_EQ(ClientHelloParser::Result::Complete,
+            ClientHelloParser::parse(span(hello), parsed, bytes_consumed));
+  absl::string_view server_name = "unset";
+  EXPECT_TRUE(ClientHelloParser::serverName(parsed, server_name));
+  EXPECT_TRUE(server_name.empty());
+}
+
+TEST(ClientHelloParserTest, NoExtensions) {
+  const std::vector<uint8_t> hello =
+      Tls::Test::generateClientHelloWithoutExtensions(TLS1_2_VERSION);
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  ASSERT_EQ(ClientHelloParser::Result::Complete,
+            ClientHelloParser::parse(span(hello), parsed, bytes_consumed));
+  EXPECT_EQ(nullptr, parsed.extensions);
+  EXPECT_EQ(0U, parsed.extensions_len);
+}
+
+// Every strict prefix of a ClientHello asks for more data.
+TEST(ClientHelloParserTest, Prefixes) {
+  const std::vector<uint8_t> hello =
+      Tls::Test::generateClientHello(TLS1_2_VERSION, TLS1_3_VERSION, "example.com", "\x02h2");
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  for (size_t len = 0; len < hello.size(); len++) {
+    EXPECT_EQ(ClientHelloParser::Result::NeedMoreData,
+              ClientHelloParser::parse({hello.data(), len}, parsed, bytes_consumed))
+        << len;
+  }
+}
+
+TEST(ClientHelloParserTest, PlainText) {
+  const std::string request = "GET / HTTP/1.1\r\n";
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  EXPECT_EQ(ClientHelloParser::Result::Unsupported,
+            ClientHelloParser::parse({reinterpret_cast<const uint8_t*>(request.data()), 1}, parsed,
+                                     bytes_consumed));
+  const std::vector<uint8_t> wrong_version = {0x16, 0x02};
+  EXPECT_EQ(ClientHelloParser::Result::Unsupported,
+            ClientHelloParser::parse(span(wrong_version), parsed, bytes_consumed));
+}
+
+// A ClientHello split over two records is left to BoringSSL.
+TEST(ClientHelloParserTest, FragmentedClientHello) {
+  const std::vector<uint8_t> hello =
+      Tls::Test::generateClientHello(TLS1_2_VERSION, TLS1_3_VERSION, "example.com", "");
+  const size_t first_fragment = 10;
+  const size_t second_fragment = hello.size() - RecordHeaderSize - first_fragment;
+  std::vector<uint8_t> fragmented(hello.begin(), hello.begin() + RecordHeaderSize);
+  fragmented[3] = 0;
+  fragmented[4] = first_fragment;
+  fragmented.insert(fragmented.end(), hello.begin() + RecordHeaderSize,
+                    hello.begin() + RecordHeaderSize + first_fragment);
+  fragmented.insert(fragmented.end(), hello.begin(), hello.begin() + 3);
+  fragmented.push_back(second_fragment >> 8);
+  fragmented.push_back(second_fragment & 0xff);
+  fragmented.insert(fragmented.end(), hello.begin() + RecordHeaderSize + first_fragment,
+                    hello.end());
+
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  EXPECT_EQ(ClientHelloParser::Result::Unsupported,
+            ClientHelloParser::parse(span(fragmented), parsed, bytes_consumed));
+}
+
+TEST(ClientHelloParserTest, RecordTooLarge) {
+  const std::vector<uint8_t> header = {0x16, 0x03, 0x01, 0x40, 0x01};
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  EXPECT_EQ(ClientHelloParser::Result::Unsupported,
+            ClientHelloParser::parse(span(header), parsed, bytes_consumed));
+}
+
+TEST(ClientHelloParserTest, DuplicateExtensions) {
+  std::vector<uint8_t> hello =
+      Tls::Test::generateClientHelloFromJA3Fingerprint("771,49199,0-65281,29,0");
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  ASSERT_EQ(ClientHelloParser::Result::Complete,
+            ClientHelloParser::parse(span(hello), parsed, bytes_consumed));
+
+  // Rewrite the renegotiation_info extension type to server_name.
+  const size_t offset = parsed.extensions - hello.data();
+  bool rewritten = false;
+  for (size_t i = offset; i + 1 < hello.size(); i++) {
+    if (hello[i] == 0xff && hello[i + 1] == 0x01) {
+      hello[i] = 0;
+      hello[i + 1] = 0;
+      rewritten = true;
+      break;
+    }
+  }
+  ASSERT_TRUE(rewritten);
+  EXPECT_EQ(ClientHelloParser::Result::Unsupported,
+            ClientHelloParser::parse(span(hello), parsed, bytes_consumed));
+}
+
+TEST(ClientHelloParserTest, InvalidServerName) {
+  const std::vector<uint8_t> hello =
+      Tls::Test::generateClientHello(TLS1_2_VERSION, TLS1_3_VERSION, "example.com", "");
+  SSL_CLIENT_HELLO parsed;
+  size_t bytes_consumed = 0;
+  ASSERT_EQ(ClientHelloParser::Result::Complete,
+            ClientHelloParser::parse(span(hello), parsed, bytes_consumed));
+
+  // A NUL byte in the host name is rejected, as BoringSSL would.
+  std::vector<uint8_t> extensions(parsed.extensions, parsed.extensions + parsed.extensions_len);
+  const std::string name = "example.com";
+  auto it = std::search(extensions.begin(), extensions.end(), name.begin(), name.end());
+  ASSERT_NE(extensions.end(), it);
+  *it = 0;
+  parsed.extensions = extensions.data();
+  absl::string_view server_name;
+  EXPECT_FALSE(ClientHelloParser::serverName(parsed, server_name));
+}
+
+} // namespace
+} // namespace TlsInspector
+} // namespace ListenerFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -5,6 +5,7 @@
 #include "source/common/network/io_socket_handle_impl.h"
 #include "source/common/network/listen_socket_impl.h"
 #include "source/common/network/listener_filter_buffer_impl.h"
+#include "source/common/runtime/runtime_features.h"
 #include "source/extensions/filters/listener/tls_inspector/tls_inspector.h"
 
 #include "test/extensions/filters/listener/tls_inspector/tls_utility.h"
@@ -66,7 +67,10 @@ public:
   const std::vector<uint8_t> client_hello_;
 };
 
+// The argument selects between the standalone ClientHello parser (1) and BoringSSL (0).
 static void bmTlsInspector(benchmark::State& state) {
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.tls_inspector_client_hello_parser",
+                                state.range(0) != 0);
   NiceMock<FastMockOsSysCalls> os_sys_calls(Tls::Test::generateClientHello(
       Config::TLS_MIN_SUPPORTED_VERSION, Config::TLS_MAX_SUPPORTED_VERSION, "example.com",
       "\x02h2\x08http/1.1"));
@@ -101,7 +105,7 @@ static void bmTlsInspector(benchmark::State& state) {
   }
 }
 
-BENCHMARK(bmTlsInspector)->Unit(benchmark::kMicrosecond);
+BENCHMARK(bmTlsInspector)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
 
 } // namespace TlsInspector
 } // namespace ListenerFilters
@@ -1292,6 +1292,62 @@ TEST_P(TlsInspectorTest, TlsVersionTooHighAllowedByRuntime) {
   EXPECT_EQ(0, cfg_->stats().tls_not_found_.value());
 }
 
+// Test that a ClientHello split over two TLS records, which the standalone parser does not
+// reassemble, is still inspected by BoringSSL.
+TEST_P(TlsInspectorTest, FragmentedClientHello) {
+  init();
+  const std::string servername("example.com");
+  const std::vector<uint8_t> hello = Tls::Test::generateClientHello(
+      std::get<0>(GetParam()), std::get<1>(GetParam()), servername, "");
+  constexpr size_t header_size = 5;
+  constexpr size_t first_fragment = 16;
+  std::vector<uint8_t> client_hello(hello.begin(), hello.begin() + 3);
+  append_u16(client_hello, first_fragment);
+  client_hello.insert(client_hello.end(), hello.begin() + header_size,
+                      hello.begin() + header_size + first_fragment);
+  client_hello.insert(client_hello.end(), hello.begin(), hello.begin() + 3);
+  append_u16(client_hello, hello.size() - header_size - first_fragment);
+  client_hello.insert(client_hello.end(), hello.begin() + header_size + first_fragment,
+                      hello.end());
+  mockSysCallForPeek(client_hello);
+  EXPECT_CALL(socket_, setRequestedServerName(Eq(servername)));
+  EXPECT_CALL(socket_, setDetectedTransportProtocol(absl::string_view("tls")));
+  EXPECT_CALL(socket_, detectedTransportProtocol()).Times(::testing::AnyNumber());
+  EXPECT_OK(file_event_callback_(Event::FileReadyType::Read));
+  auto state = filter_->onData(*buffer_);
+  EXPECT_EQ(Network::FilterStatus::Continue, state);
+  EXPECT_EQ(1, cfg_->stats().tls_found_.value());
+  EXPECT_EQ(1, cfg_->stats().sni_found_.value());
+}
+
+// Test that the ClientHello is inspected by BoringSSL alone when the standalone parser is
+// disabled.
+TEST_P(TlsInspectorTest, ClientHelloParserDisabledByRuntime) {
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.tls_inspector_client_hello_parser",
+                                false);
+  init();
+  const auto alpn_protos = std::vector<absl::string_view>{Http::Utility::AlpnNames::get().Http2};
+  const std::string servername("example.com");
+  std::vector<uint8_t> client_hello = Tls::Test::generateClientHello(
+      std::get<0>(GetParam()), std::get<1>(GetParam()), servername, "\x02h2");
+  mockSysCallForPeek(client_hello);
+  EXPECT_CALL(socket_, setRequestedServerName(Eq(servername)));
+  EXPECT_CALL(socket_, setRequestedApplicationProtocols(alpn_protos));
+  EXPECT_CALL(socket_, setDetectedTransportProtocol(absl::string_view("tls")));
+  EXPECT_CALL(socket_, detectedTransportProtocol()).Times(::testing::AnyNumber());
+  EXPECT_OK(file_event_callback_(Event::FileReadyType::Read));
+  auto state = filter_->onData(*buffer_);
+  EXPECT_EQ(Network::FilterStatus::Continue, state);
+  EXPECT_EQ(1, cfg_->stats().tls_found_.value());
+  EXPECT_EQ(1, cfg_->stats().alpn_found_.value());
+  const std::vector<uint64_t> bytes_processed =
+      store_.histogramValues("tls_inspector.bytes_processed", false);
+  ASSERT_EQ(1, bytes_processed.size());
+  EXPECT_EQ(client_hello.size(), bytes_processed[0]);
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.tls_inspector_client_hello_parser",
+                                true);
+}
+
 } // namespace
 } // namespace TlsInspector
 } // namespace ListenerFilters
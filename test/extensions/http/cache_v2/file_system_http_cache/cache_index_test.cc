@@ -0,0 +1,330 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "source/extensions/http/cache_v2/file_system_http_cache/cache_index.h"
+
+#include "test/mocks/api/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/file_system_for_test.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace FileSystemHttpCache {
+
+namespace {
+
+using ::testing::_;
+using ::testing::HasSubstr;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+// The header and the size of one record of the index file format.
+constexpr size_t HeaderSize = 8;
+constexpr size_t RecordSize = 32;
+
+class CacheIndexTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::remove(path_.c_str());
+    std::remove(tmpPath().c_str());
+  }
+  void TearDown() override {
+    std::remove(path_.c_str());
+    std::remove(absl::StrCat(path_, ".lock").c_str());
+  }
+
+  std::string tmpPath() { return absl::StrCat(path_, ".tmp"); }
+
+  size_t fileSize() { return TestEnvironment::readFileToStringForTest(path_).size(); }
+
+  CacheIndex::Entry entryFor(CacheIndex& index, uint64_t hash) {
+    for (const auto& [h, entry] : index.entries()) {
+      if (h == hash) {
+        return entry;
+      }
+    }
+    ADD_FAILURE() << "no entry for " << hash;
+    return {};
+  }
+
+  const std::string path_ = TestEnvironment::temporaryPath("cache_index_test");
+  const SystemTime t0_{std::chrono::seconds(1000)};
+  const SystemTime t1_{std::chrono::seconds(2000)};
+};
+
+TEST_F(CacheIndexTest, LoadFailsWithoutIndexFile) {
+  CacheIndex index(path_);
+  EXPECT_FALSE(index.load());
+}
+
+TEST_F(CacheIndexTest, LoadFailsWithUnrecognizedHeader) {
+  TestEnvironment::writeStringToFileForTest(path_, "INDX9999", true);
+  CacheIndex index(path_);
+  EXPECT_FALSE(index.load());
+}
+
+TEST_F(CacheIndexTest, FlushedChangesAreLoadedByANewIndex) {
+  {
+    CacheIndex index(path_);
+    index.markComplete();
+    index.add(1, 100, t0_);
+    index.add(2, 200, t0_);
+    ASSERT_TRUE(index.flush().ok());
+    index.remove(1);
+    index.touch(2, t1_);
+    index.add(3, 300, t0_);
+    ASSERT_TRUE(index.flush().ok());
+    ASSERT_TRUE(index.close().ok());
+  }
+  CacheIndex index(path_);
+  ASSERT_TRUE(index.load());
+  EXPECT_EQ(index.count(), 2);
+  EXPECT_EQ(index.bytes(), 500);
+  EXPECT_EQ(entryFor(index, 2).last_touch_, t1_);
+  EXPECT_EQ(entryFor(index, 3).size_, 300);
+}
+
+TEST_F(CacheIndexTest, FirstFlushWritesOnlyLiveEntries) {
+  CacheIndex index(path_);
+  index.add(1, 100, t0_);
+  index.add(2, 200, t0_);
+  index.remove(1);
+  ASSERT_TRUE(index.flush().ok());
+  EXPECT_EQ(fileSize(), HeaderSize + RecordSize);
+}
+
+TEST_F(CacheIndexTest, ChangesBeforeLoadTakePrecedenceOverIndexFile) {
+  {
+    CacheIndex index(path_);
+    index.markComplete();
+    index.add(1, 100, t0_);
+    index.add(2, 200, t0_);
+    ASSERT_TRUE(index.close().ok());
+  }
+  CacheIndex index(path_);
+  index.remove(1);
+  index.add(2, 250, t1_);
+  index.add(3, 300, t1_);
+  ASSERT_TRUE(index.load());
+  EXPECT_EQ(index.count(), 2);
+  EXPECT_EQ(index.bytes(), 550);
+  EXPECT_EQ(entryFor(index, 2).size_, 250);
+}
+
+TEST_F(CacheIndexTest, AddIfUnknownDoesNotOverrideKnownOrRemovedEntries) {
+  CacheIndex index(path_);
+  index.add(1, 100, t1_);
+  index.remove(2);
+  index.addIfUnknown(1, 999, t0_);
+  index.addIfUnknown(2, 200, t0_);
+  index.addIfUnknown(3, 300, t0_);
+  EXPECT_EQ(index.count(), 2);
+  EXPECT_EQ(index.bytes(), 400);
+  EXPECT_EQ(entryFor(index, 1).last_touch_, t1_);
+}
+
+TEST_F(CacheIndexTest, TouchIgnoresUnknownAndOlderTimes) {
+  CacheIndex index(path_);
+  index.add(1, 100, t1_);
+  index.touch(1, t0_);
+  index.touch(2, t1_);
+  EXPECT_EQ(index.count(), 1);
+  EXPECT_EQ(entryFor(index, 1).last_touch_, t1_);
+}
+
+TEST_F(CacheIndexTest, PartialRecordIsIgnoredAndOverwritten) {
+  {
+    CacheIndex index(path_);
+    index.markComplete();
+    index.add(1, 100, t0_);
+    ASSERT_TRUE(index.close().ok());
+  }
+  TestEnvironment::writeStringToFileForTest(
+      path_, TestEnvironment::readFileToStringForTest(path_) + "partial", true);
+  {
+    CacheIndex index(path_);
+    ASSERT_TRUE(index.load());
+    EXPECT_EQ(index.count(), 1);
+    index.add(2, 200, t0_);
+    ASSERT_TRUE(index.close().ok());
+  }
+  EXPECT_EQ(fileSize(), HeaderSize + 2 * RecordSize);
+  CacheIndex index(path_);
+  ASSERT_TRUE(index.load());
+  EXPECT_EQ(index.count(), 2);
+  EXPECT_EQ(index.bytes(), 300);
+}
+
+TEST_F(CacheIndexTest, ManyAppendsCompactTheIndexFile) {
+  CacheIndex index(path_);
+  index.markComplete();
+  index.add(1, 100, t0_);
+  ASSERT_TRUE(index.flush().ok());
+  size_t largest = 0;
+  for (int i = 1; i <= 5000; i++) {
+    index.touch(1, t0_ + std::chrono::seconds(i));
+    ASSERT_TRUE(index.flush().ok());
+    largest = std::max(largest, fileSize());
+  }
+  EXPECT_GT(largest, HeaderSize + 4096 * RecordSize);
+  EXPECT_LT(fileSize(), largest);
+  ASSERT_TRUE(index.close().ok());
+  CacheIndex reloaded(path_);
+  ASSERT_TRUE(reloaded.load());
+  EXPECT_EQ(entryFor(reloaded, 1).last_touch_, t0_ + std::chrono::seconds(5000));
+}
+
+TEST_F(CacheIndexTest, IndexFileIsNotLoadedAfterUncleanShutdown) {
+  {
+    CacheIndex index(path_);
+    index.markComplete();
+    index.add(1, 100, t0_);
+    ASSERT_TRUE(index.close().ok());
+  }
+  {
+    // Destroying the index without closing it is what a crash leaves behind, with any changes
+    // since the last flush missing from the index file.
+    CacheIndex index(path_);
+    ASSERT_TRUE(index.load());
+    index.add(2, 200, t0_);
+    ASSERT_TRUE(index.flush().ok());
+  }
+  CacheIndex index(path_);
+  EXPECT_FALSE(index.load());
+}
+
+TEST_F(CacheIndexTest, IndexThatWasNeitherLoadedNorRebuiltIsNotMarkedClean) {
+  {
+    // Only holds the files added since startup, not those already in the cache directory.
+    CacheIndex index(path_);
+    index.add(1, 100, t0_);
+    ASSERT_TRUE(index.close().ok());
+  }
+  CacheIndex index(path_);
+  EXPECT_FALSE(index.load());
+}
+
+TEST_F(CacheIndexTest, LockIsHeldUntilTheIndexIsDestroyed) {
+  auto index = std::make_unique<CacheIndex>(path_);
+  ASSERT_TRUE(index->lock());
+  EXPECT_TRUE(index->lock());
+  {
+    CacheIndex other(path_);
+    EXPECT_FALSE(other.lock());
+  }
+  ASSERT_TRUE(index->close().ok());
+  CacheIndex other(path_);
+  EXPECT_FALSE(other.lock());
+  index.reset();
+  EXPECT_TRUE(other.lock());
+}
+
+TEST_F(CacheIndexTest, AddAfterCloseDeletesIndexFile) {
+  CacheIndex index(path_);
+  index.markComplete();
+  index.add(1, 100, t0_);
+  ASSERT_TRUE(index.close().ok());
+  ASSERT_TRUE(Filesystem::fileSystemForTest().fileExists(path_));
+  // An insert that completes after close would otherwise be missing from an index file that
+  // the next start trusts.
+  index.add(2, 200, t0_);
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(path_));
+}
+
+TEST_F(CacheIndexTest, TouchAfterCloseKeepsIndexFile) {
+  CacheIndex index(path_);
+  index.markComplete();
+  index.add(1, 100, t0_);
+  ASSERT_TRUE(index.close().ok());
+  index.touch(1, t1_);
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(path_));
+  CacheIndex reloaded(path_);
+  ASSERT_TRUE(reloaded.load());
+  EXPECT_EQ(entryFor(reloaded, 1).last_touch_, t0_);
+}
+
+TEST_F(CacheIndexTest, ConcurrentTouchesKeepTheLatestTime) {
+  CacheIndex index(path_);
+  for (uint64_t hash = 0; hash < 100; hash++) {
+    index.add(hash, 1, t0_);
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&index, t, this]() {
+      for (int i = 0; i < 1000; i++) {
+        index.touch(i % 100, t0_ + std::chrono::seconds(t * 1000 + i));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (uint64_t hash = 0; hash < 100; hash++) {
+    EXPECT_EQ(entryFor(index, hash).last_touch_, t0_ + std::chrono::seconds(3900 + hash));
+  }
+}
+
+TEST_F(CacheIndexTest, FailedRenameIsReportedAndRetried) {
+  CacheIndex index(path_);
+  index.markComplete();
+  index.add(1, 100, t0_);
+  {
+    Api::OsSysCallsImpl real_posix;
+    NiceMock<Api::MockOsSysCalls> posix;
+    TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> injector(&posix);
+    ON_CALL(posix, open(_, _, _))
+        .WillByDefault([&real_posix](const char* pathname, int flags, mode_t mode) {
+          return real_posix.open(pathname, flags, mode);
+        });
+    ON_CALL(posix, pwrite(_, _, _, _))
+        .WillByDefault([&real_posix](int fd, const void* buffer, size_t length, off_t offset) {
+          return real_posix.pwrite(fd, buffer, length, offset);
+        });
+    ON_CALL(posix, fsync(_)).WillByDefault([&real_posix](int fd) {
+      return real_posix.fsync(fd);
+    });
+    ON_CALL(posix, close(_)).WillByDefault([&real_posix](int fd) {
+      return real_posix.close(fd);
+    });
+    ON_CALL(posix, unlink(_)).WillByDefault([&real_posix](const char* pathname) {
+      return real_posix.unlink(pathname);
+    });
+    EXPECT_CALL(posix, rename(_, _)).WillOnce(Return(Api::SysCallIntResult{-1, EACCES}));
+    absl::Status status = index.flush();
+    EXPECT_THAT(status.message(), HasSubstr("failed to replace cache index"));
+  }
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(tmpPath()));
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(path_));
+  // The failed write is retried by the next flush.
+  ASSERT_TRUE(index.close().ok());
+  CacheIndex reloaded(path_);
+  ASSERT_TRUE(reloaded.load());
+  EXPECT_EQ(reloaded.count(), 1);
+}
+
+TEST(HashFromCacheFilenameTest, ParsesCacheFileNames) {
+  EXPECT_EQ(hashFromCacheFilename("cache-123"), 123);
+  EXPECT_EQ(hashFromCacheFilename("/some/path/cache-18446744073709551615"),
+            18446744073709551615ull);
+  EXPECT_FALSE(hashFromCacheFilename("cache-abc").has_value());
+  EXPECT_FALSE(hashFromCacheFilename("fs_cache_index").has_value());
+  EXPECT_FALSE(hashFromCacheFilename("/cache-1/other").has_value());
+}
+
+} // namespace
+
+} // namespace FileSystemHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -15,6 +15,7 @@
 #include "test/extensions/common/async_files/mocks.h"
 #include "test/extensions/filters/http/cache_v2/http_cache_implementation_test_common.h"
 #include "test/extensions/filters/http/cache_v2/mocks.h"
+#include "test/mocks/buffer/mocks.h"
 #include "test/mocks/server/factory_context.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/file_system_for_test.h"
@@ -75,9 +76,10 @@ public:
         .WillByDefault([]() -> Thread::ThreadFactory& { return Thread::threadFactoryForTest(); });
   }
 
-  void initCache() {
-    cache_ =
-        *http_cache_factory_->getCache(cacheConfig(testConfig()), context_.server_factory_context_);
+  void initCache() { initCache(testConfig()); }
+
+  void initCache(ConfigProto cfg) {
+    cache_ = *http_cache_factory_->getCache(cacheConfig(cfg), context_.server_factory_context_);
   }
 
   void waitForEvictionThreadIdle() { cache()->cache_eviction_thread_.waitForIdle(); }
@@ -100,13 +102,14 @@ public:
 protected:
   void deleteCacheFiles(std::string path) {
     for (const auto& it : ::Envoy::Filesystem::Directory(path)) {
-      if (absl::StartsWith(it.name_, "cache-")) {
+      if (absl::StartsWith(it.name_, "cache-") || it.name_ == "fs_cache_index") {
         env_.removePath(absl::StrCat(path, it.name_));
       }
     }
   }
 
   FileSystemHttpCache* cache() { return dynamic_cast<FileSystemHttpCache*>(&cache_->cache()); }
+  CacheShared& shared() { return *cache()->shared_; }
   ::Envoy::TestEnvironment env_;
   std::string cache_path_;
   NiceMock<Server::Configuration::MockFactoryContext> context_;
@@ -193,6 +196,61 @@ TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, EvictsOldestFilesUntilUnderSiz
   EXPECT_EQ(cache()->stats().eviction_runs_.value(), 1);
 }
 
+TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, WarmStartMeasuresCacheFromIndex) {
+  const std::string file_contents = "XXXXX";
+  ConfigProto cfg = testConfig();
+  cfg.mutable_index_checkpoint_interval()->set_seconds(3600);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-1"), file_contents, true);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-2"), file_contents, true);
+  initCache(cfg);
+  waitForEvictionThreadIdle();
+  EXPECT_EQ(cache()->stats().size_bytes_.value(), file_contents.size() * 2);
+  EXPECT_EQ(cache()->stats().size_count_.value(), 2);
+  EXPECT_TRUE(
+      Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "fs_cache_index")));
+  cache_.reset();
+  // A file that is not in the index is not seen by a cache that starts from the index,
+  // which shows that the directory was not scanned.
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-3"), file_contents, true);
+  initCache(cfg);
+  waitForEvictionThreadIdle();
+  EXPECT_EQ(cache()->stats().size_bytes_.value(), file_contents.size() * 2);
+  EXPECT_EQ(cache()->stats().size_count_.value(), 2);
+  cache_.reset();
+  // Removing the index makes the next start rebuild it from the directory.
+  env_.removePath(absl::StrCat(cache_path_, "fs_cache_index"));
+  initCache(cfg);
+  waitForEvictionThreadIdle();
+  EXPECT_EQ(cache()->stats().size_count_.value(), 3);
+}
+
+TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, EvictsLeastRecentlyTouchedFilesFromIndex) {
+  const std::string file_contents = "XXXXX";
+  ConfigProto cfg = testConfig();
+  cfg.mutable_index_checkpoint_interval()->set_seconds(3600);
+  cfg.mutable_max_cache_entry_count()->set_value(2);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-1"), file_contents, true);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-2"), file_contents, true);
+  initCache(cfg);
+  waitForEvictionThreadIdle();
+  EXPECT_EQ(cache()->stats().size_count_.value(), 2);
+  // The index orders files by the times it is given rather than by file timestamps, so
+  // there is no need to wait for the new files to be younger.
+  const SystemTime later = std::chrono::system_clock::now() + std::chrono::hours(1);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-3"), file_contents, true);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-4"), file_contents, true);
+  shared().indexFileAdded(absl::StrCat(cache_path_, "cache-3"), file_contents.size(), later);
+  shared().indexFileAdded(absl::StrCat(cache_path_, "cache-4"), file_contents.size(), later);
+  cache()->trackFileAdded(file_contents.size());
+  cache()->trackFileAdded(file_contents.size());
+  waitForEvictionThreadIdle();
+  EXPECT_EQ(cache()->stats().size_count_.value(), 2);
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-1")));
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-2")));
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-3")));
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-4")));
+}
+
 class FileSystemHttpCacheTest : public FileSystemCacheTestContext, public ::testing::Test {
   void SetUp() override { initCache(); }
 };
@@ -887,6 +945,119 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, InsertSilentlyAbortsOnFailureToWrit
   pumpDispatcher();
 }
 
+class FileSystemHttpCacheTestWithMockFilesAndMappedReads
+    : public FileSystemHttpCacheTestWithMockFiles {
+public:
+  void SetUp() override {
+    ConfigProto cfg = testConfig();
+    cfg.mutable_min_mapped_body_read_bytes()->set_value(8);
+    initCache(cfg);
+  }
+};
+
+TEST_F(FileSystemHttpCacheTestWithMockFilesAndMappedReads, LargeReadOfBodyIsMapped) {
+  setBodySize(10);
+  absl::StatusOr<LookupResult> lookup_result;
+  testSuccessfulLookup(&lookup_result);
+  EXPECT_CALL(*mock_async_file_handle_, readMapped(_, testHeaderBlock().offsetToBody(), 8, _));
+  Buffer::InstancePtr got_body;
+  EndStream got_end_stream = EndStream::Reset;
+  lookup_result.value().cache_reader_->getBody(*dispatcher_, AdjustedByteRange(0, 8),
+                                               [&](Buffer::InstancePtr body, EndStream end_stream) {
+                                                 got_body = std::move(body);
+                                                 got_end_stream = end_stream;
+                                               });
+  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<Buffer::InstancePtr>(
+      std::make_unique<Buffer::OwnedImpl>("abcdefgh")));
+  pumpDispatcher();
+  EXPECT_THAT(got_body, testing::Pointee(BufferString("abcdefgh")));
+  EXPECT_EQ(got_end_stream, EndStream::More);
+  EXPECT_EQ(cache()->stats().body_bytes_read_.value(), 8);
+  EXPECT_EQ(cache()->stats().body_bytes_mapped_.value(), 8);
+}
+
+TEST_F(FileSystemHttpCacheTestWithMockFilesAndMappedReads, SmallReadOfBodyIsCopied) {
+  setBodySize(10);
+  absl::StatusOr<LookupResult> lookup_result;
+  testSuccessfulLookup(&lookup_result);
+  EXPECT_CALL(*mock_async_file_handle_, read(_, testHeaderBlock().offsetToBody(), 7, _));
+  Buffer::InstancePtr got_body;
+  lookup_result.value().cache_reader_->getBody(
+      *dispatcher_, AdjustedByteRange(0, 7),
+      [&](Buffer::InstancePtr body, EndStream) { got_body = std::move(body); });
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>(std::make_unique<Buffer::OwnedImpl>("abcdefg")));
+  pumpDispatcher();
+  EXPECT_THAT(got_body, testing::Pointee(BufferString("abcdefg")));
+  EXPECT_EQ(cache()->stats().body_bytes_read_.value(), 7);
+  EXPECT_EQ(cache()->stats().body_bytes_mapped_.value(), 0);
+}
+
+TEST_F(FileSystemHttpCacheTestWithMockFilesAndMappedReads, FailedMappingOfBodyFallsBackToCopy) {
+  setBodySize(10);
+  absl::StatusOr<LookupResult> lookup_result;
+  testSuccessfulLookup(&lookup_result);
+  EXPECT_CALL(*mock_async_file_handle_, readMapped(_, testHeaderBlock().offsetToBody(), 8, _));
+  EXPECT_CALL(*mock_async_file_handle_, read(_, testHeaderBlock().offsetToBody(), 8, _));
+  Buffer::InstancePtr got_body;
+  lookup_result.value().cache_reader_->getBody(
+      *dispatcher_, AdjustedByteRange(0, 8),
+      [&](Buffer::InstancePtr body, EndStream) { got_body = std::move(body); });
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>(absl::UnavailableError("mmap not supported")));
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>(std::make_unique<Buffer::OwnedImpl>("abcdefgh")));
+  pumpDispatcher();
+  EXPECT_THAT(got_body, testing::Pointee(BufferString("abcdefgh")));
+  EXPECT_EQ(cache()->stats().body_bytes_read_.value(), 8);
+  EXPECT_EQ(cache()->stats().body_bytes_mapped_.value(), 0);
+}
+
+TEST_F(FileSystemHttpCacheTestWithMockFilesAndMappedReads,
+       FailedMappingAfterReaderIsDestroyedFallsBackToCopy) {
+  setBodySize(10);
+  absl::StatusOr<LookupResult> lookup_result;
+  testSuccessfulLookup(&lookup_result);
+  EXPECT_CALL(*mock_async_file_handle_, readMapped(_, testHeaderBlock().offsetToBody(), 8, _));
+  EXPECT_CALL(*mock_async_file_handle_, read(_, testHeaderBlock().offsetToBody(), 8, _));
+  Buffer::InstancePtr got_body;
+  lookup_result.value().cache_reader_->getBody(
+      *dispatcher_, AdjustedByteRange(0, 8),
+      [&](Buffer::InstancePtr body, EndStream) { got_body = std::move(body); });
+  // The mapped read completes after the reader is gone, and the fallback doesn't use it.
+  lookup_result.value().cache_reader_.reset();
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>(absl::UnavailableError("mmap not supported")));
+  pumpDispatcher();
+  // close
+  mock_async_file_manager_->nextActionCompletes(absl::OkStatus());
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>(std::make_unique<Buffer::OwnedImpl>("abcdefgh")));
+  pumpDispatcher();
+  EXPECT_THAT(got_body, testing::Pointee(BufferString("abcdefgh")));
+  EXPECT_EQ(cache()->stats().body_bytes_read_.value(), 8);
+}
+
+TEST_F(FileSystemHttpCacheTestWithMockFilesAndMappedReads, IncompleteMappingOfBodyProvokesReset) {
+  setBodySize(10);
+  absl::StatusOr<LookupResult> lookup_result;
+  testSuccessfulLookup(&lookup_result);
+  EXPECT_CALL(*mock_async_file_handle_, readMapped(_, testHeaderBlock().offsetToBody(), 8, _));
+  Buffer::InstancePtr got_body;
+  EndStream got_end_stream = EndStream::More;
+  lookup_result.value().cache_reader_->getBody(*dispatcher_, AdjustedByteRange(0, 8),
+                                               [&](Buffer::InstancePtr body, EndStream end_stream) {
+                                                 got_body = std::move(body);
+                                                 got_end_stream = end_stream;
+                                               });
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>(undersizedBuffer()));
+  pumpDispatcher();
+  EXPECT_THAT(got_body, IsNull());
+  EXPECT_EQ(got_end_stream, EndStream::Reset);
+}
+
 // For the standard cache tests from http_cache_implementation_test_common.cc
 // These will be run with the real file system, and therefore only cover the
 // "no file errors" paths.
@@ -894,6 +1065,11 @@ class FileSystemHttpCacheTestDelegate : public HttpCacheTestDelegate,
                                         public FileSystemCacheTestContext {
 public:
   FileSystemHttpCacheTestDelegate() { initCache(); }
+  explicit FileSystemHttpCacheTestDelegate(uint64_t min_mapped_body_read_bytes) {
+    ConfigProto cfg = testConfig();
+    cfg.mutable_min_mapped_body_read_bytes()->set_value(min_mapped_body_read_bytes);
+    initCache(cfg);
+  }
   HttpCache& cache() override { return cache_->cache(); }
   void beforePumpingDispatcher() override {
     dynamic_cast<FileSystemHttpCache&>(cache()).drainAsyncFileActionsForTest();
@@ -901,11 +1077,14 @@ public:
 };
 
 // For the standard cache tests from http_cache_implementation_test_common.cc
-INSTANTIATE_TEST_SUITE_P(FileSystemHttpCacheTest, HttpCacheImplementationTest,
-                         testing::Values(std::make_unique<FileSystemHttpCacheTestDelegate>),
-                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
-                           return "FileSystemHttpCache";
-                         });
+INSTANTIATE_TEST_SUITE_P(
+    FileSystemHttpCacheTest, HttpCacheImplementationTest,
+    testing::Values([]() { return std::make_unique<FileSystemHttpCacheTestDelegate>(); },
+                    // Maps every body read.
+                    []() { return std::make_unique<FileSystemHttpCacheTestDelegate>(1); }),
+    [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>& info) {
+      return info.index == 0 ? "FileSystemHttpCache" : "FileSystemHttpCacheWithMappedReads";
+    });
 
 TEST(Registration, GetCacheFromFactory) {
   HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
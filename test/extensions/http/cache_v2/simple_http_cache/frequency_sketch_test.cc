@@ -0,0 +1,47 @@
+#include "source/extensions/http/cache_v2/simple_http_cache/frequency_sketch.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace {
+
+TEST(FrequencySketchTest, CountsIncrements) {
+  FrequencySketch sketch(1024);
+  EXPECT_EQ(0, sketch.frequency(1));
+  for (int i = 0; i < 5; ++i) {
+    sketch.increment(1);
+  }
+  sketch.increment(2);
+  EXPECT_EQ(5, sketch.frequency(1));
+  EXPECT_EQ(1, sketch.frequency(2));
+}
+
+TEST(FrequencySketchTest, SaturatesAtMaxFrequency) {
+  FrequencySketch sketch(1024);
+  for (uint32_t i = 0; i < 2 * FrequencySketch::MaxFrequency; ++i) {
+    sketch.increment(1);
+  }
+  EXPECT_EQ(FrequencySketch::MaxFrequency, sketch.frequency(1));
+}
+
+TEST(FrequencySketchTest, AgesCounters) {
+  // The smallest sketch is sized for 16 entries, and halves its counters after 160 increments.
+  FrequencySketch sketch(1);
+  for (int i = 0; i < 8; ++i) {
+    sketch.increment(1);
+  }
+  EXPECT_EQ(8, sketch.frequency(1));
+  for (uint64_t hash = 2; hash < 2 + 160 - 8; ++hash) {
+    sketch.increment(hash * 0x9e3779b97f4a7c15ULL);
+  }
+  EXPECT_LT(sketch.frequency(1), 8);
+}
+
+} // namespace
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,118 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <memory>
+#include <random>
+#include <string>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/http/cache_v2/cache_progress_receiver.h"
+#include "source/extensions/filters/http/cache_v2/http_source.h"
+#include "source/extensions/http/cache_v2/simple_http_cache/simple_http_cache.h"
+
+#include "test/mocks/event/mocks.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace {
+
+constexpr uint64_t NumKeys = 100000;
+constexpr uint64_t BodySize = 4096;
+// Room for about a fifth of the keys, so that the policy has to choose.
+constexpr uint64_t MaxSizeBytes = NumKeys / 5 * (BodySize + 128);
+
+// Hands out the whole body in one call.
+class StringHttpSource : public HttpSource {
+public:
+  explicit StringHttpSource(const std::string& body) : body_(body) {}
+
+  void getHeaders(GetHeadersCallback&& cb) override { cb(nullptr, EndStream::Reset); }
+  void getBody(AdjustedByteRange, GetBodyCallback&& cb) override {
+    cb(std::make_unique<Buffer::OwnedImpl>(body_), EndStream::End);
+  }
+  void getTrailers(GetTrailersCallback&& cb) override { cb(nullptr, EndStream::End); }
+
+private:
+  const std::string& body_;
+};
+
+class NullProgressReceiver : public CacheProgressReceiver {
+public:
+  void onHeadersInserted(CacheReaderPtr, Http::ResponseHeaderMapPtr, bool) override {}
+  void onBodyInserted(AdjustedByteRange, bool) override {}
+  void onTrailersInserted(Http::ResponseTrailerMapPtr) override {}
+  void onInsertFailed(absl::Status) override {}
+};
+
+// Each thread acts as a worker: it looks up keys with a skewed popularity, reads the body of hits
+// and inserts misses. Measures the contention on the shards and the cost of the admission policy.
+void bmLookupOrInsert(::benchmark::State& state) {
+  // Shared by every benchmark thread. Thread zero builds it before the start barrier that opens the
+  // timed loop, so the other threads observe it safely once inside the loop.
+  static std::unique_ptr<Stats::IsolatedStoreImpl> store;
+  static std::unique_ptr<SimpleHttpCache> cache;
+  static std::unique_ptr<testing::NiceMock<Event::MockDispatcher>> dispatcher;
+  static const std::string body(BodySize, 'x');
+  if (state.thread_index() == 0) {
+    store = std::make_unique<Stats::IsolatedStoreImpl>();
+    SimpleHttpCache::ConfigProto config;
+    config.mutable_max_size_bytes()->set_value(MaxSizeBytes);
+    config.set_shards(state.range(0));
+    cache = std::make_unique<SimpleHttpCache>(config, *store->rootScope());
+    dispatcher = std::make_unique<testing::NiceMock<Event::MockDispatcher>>();
+  }
+
+  std::mt19937_64 rng(state.thread_index());
+  std::uniform_real_distribution<double> uniform;
+  auto progress = std::make_shared<NullProgressReceiver>();
+  uint64_t body_bytes = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    // Squaring a uniform value makes the low keys much more popular than the high ones.
+    const double u = uniform(rng);
+    Key key;
+    key.set_host("example.com");
+    key.set_path(absl::StrCat("/", static_cast<uint64_t>(u * u * NumKeys)));
+    CacheReaderPtr reader;
+    cache->lookup(LookupRequest(Key(key), *dispatcher),
+                  [&reader](absl::StatusOr<LookupResult>&& result) {
+                    reader = std::move(result->cache_reader_);
+                  });
+    if (reader != nullptr) {
+      reader->getBody(*dispatcher, AdjustedByteRange(0, BodySize),
+                      [&body_bytes](Buffer::InstancePtr buffer, EndStream) {
+                        body_bytes += buffer->length();
+                      });
+    } else {
+      cache->insert(*dispatcher, std::move(key), Http::ResponseHeaderMapImpl::create(),
+                    ResponseMetadata{}, std::make_unique<StringHttpSource>(body), progress);
+    }
+  }
+  ::benchmark::DoNotOptimize(body_bytes);
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    const SimpleHttpCacheStats& stats = cache->stats();
+    const double lookups = stats.hits_.value() + stats.misses_.value();
+    state.counters["hit_ratio"] = lookups > 0 ? stats.hits_.value() / lookups : 0;
+    state.counters["evictions"] = stats.evictions_.value();
+    state.counters["admission_rejected"] = stats.admission_rejected_.value();
+    state.counters["size_rejected"] = stats.size_rejected_.value();
+    cache.reset();
+    dispatcher.reset();
+    store.reset();
+  }
+}
+BENCHMARK(bmLookupOrInsert)->Arg(1)->Arg(16)->Arg(64)->ThreadRange(1, 64)->UseRealTime();
+
+} // namespace
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
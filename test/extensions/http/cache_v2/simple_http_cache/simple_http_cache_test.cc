@@ -2,6 +2,7 @@
 #include "envoy/registry/registry.h"
 
 #include "source/common/buffer/buffer_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
 #include "source/extensions/filters/http/cache_v2/cache_entry_utils.h"
 #include "source/extensions/filters/http/cache_v2/cache_headers_utils.h"
 #include "source/extensions/filters/http/cache_v2/cache_sessions.h"
@@ -20,19 +21,170 @@ namespace HttpFilters {
 namespace CacheV2 {
 namespace {
 
+using StatusHelpers::HasStatus;
+
+SimpleHttpCache::ConfigProto boundedConfig(uint64_t max_size_bytes, uint32_t shards) {
+  SimpleHttpCache::ConfigProto config;
+  config.mutable_max_size_bytes()->set_value(max_size_bytes);
+  config.set_shards(shards);
+  return config;
+}
+
 class SimpleHttpCacheTestDelegate : public HttpCacheTestDelegate {
 public:
+  explicit SimpleHttpCacheTestDelegate(const SimpleHttpCache::ConfigProto& config = {})
+      : cache_(config, *store_.rootScope()) {}
   HttpCache& cache() override { return cache_; }
 
 private:
+  Stats::IsolatedStoreImpl store_;
   SimpleHttpCache cache_;
 };
 
-INSTANTIATE_TEST_SUITE_P(SimpleHttpCacheTest, HttpCacheImplementationTest,
-                         testing::Values(std::make_unique<SimpleHttpCacheTestDelegate>),
-                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
-                           return "SimpleHttpCache";
-                         });
+INSTANTIATE_TEST_SUITE_P(
+    SimpleHttpCacheTest, HttpCacheImplementationTest,
+    testing::Values([]() { return std::make_unique<SimpleHttpCacheTestDelegate>(); },
+                    []() {
+                      return std::make_unique<SimpleHttpCacheTestDelegate>(
+                          boundedConfig(1024 * 1024, 4));
+                    }),
+    [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>& info) {
+      return info.index == 0 ? "SimpleHttpCache" : "BoundedShardedSimpleHttpCache";
+    });
+
+// A single shard with room for two of the test responses in its main LRU.
+class SimpleHttpCacheEvictionTest : public HttpCacheImplementationTest {
+protected:
+  const SimpleHttpCacheStats& stats() const {
+    return static_cast<const SimpleHttpCache&>(cache()).stats();
+  }
+
+  void lookupAndInsert(absl::string_view path) {
+    lookup(path);
+    insert(path, response_headers_, body_);
+  }
+
+  bool contains(absl::string_view path) { return lookup(path).cache_reader_ != nullptr; }
+
+  Http::TestResponseHeaderMapImpl response_headers_{
+      {":status", "200"},
+      {"date", formatter_.fromTime(time_system_.systemTime())},
+      {"cache-control", "public,max-age=3600"}};
+  const std::string body_ = std::string(300, 'x');
+};
+
+INSTANTIATE_TEST_SUITE_P(SimpleHttpCacheEvictionTest, SimpleHttpCacheEvictionTest,
+                         testing::Values([]() {
+                           return std::make_unique<SimpleHttpCacheTestDelegate>(
+                               boundedConfig(1000, 1));
+                         }));
+
+TEST_P(SimpleHttpCacheEvictionTest, RejectsEntryLookedUpLessOftenThanVictim) {
+  lookupAndInsert("/a");
+  lookupAndInsert("/b");
+  EXPECT_EQ(2, stats().size_count_.value());
+  const uint64_t size_bytes = stats().size_bytes_.value();
+  EXPECT_GT(size_bytes, 2 * body_.size());
+
+  // Never looked up, so it loses against "/a", which has been looked up once.
+  insert("/c", response_headers_, body_);
+  EXPECT_EQ(1, stats().admission_rejected_.value());
+  EXPECT_EQ(0, stats().evictions_.value());
+  EXPECT_EQ(2, stats().size_count_.value());
+  EXPECT_EQ(size_bytes, stats().size_bytes_.value());
+  EXPECT_FALSE(contains("/c"));
+  EXPECT_TRUE(contains("/a"));
+  EXPECT_TRUE(contains("/b"));
+}
+
+TEST_P(SimpleHttpCacheEvictionTest, EvictsEntryLookedUpLessOftenThanCandidate) {
+  lookupAndInsert("/a");
+  lookupAndInsert("/b");
+  // Makes "/b" the least recently used entry.
+  EXPECT_TRUE(contains("/a"));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(contains("/c"));
+  }
+  insert("/c", response_headers_, body_);
+  EXPECT_EQ(1, stats().evictions_.value());
+  EXPECT_EQ(0, stats().admission_rejected_.value());
+  EXPECT_EQ(2, stats().size_count_.value());
+  EXPECT_FALSE(contains("/b"));
+  EXPECT_TRUE(contains("/a"));
+  EXPECT_TRUE(contains("/c"));
+  EXPECT_EQ(3, stats().hits_.value());
+  EXPECT_EQ(6, stats().misses_.value());
+}
+
+TEST_P(SimpleHttpCacheEvictionTest, RejectedEntryEvictsNothing) {
+  // Never looked up, so "/a" would lose against "/c", but "/b" would not, and evicting "/a"
+  // alone doesn't make room for "/c".
+  insert("/a", response_headers_, body_);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_FALSE(contains("/b"));
+  }
+  insert("/b", response_headers_, body_);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_FALSE(contains("/c"));
+  }
+  insert("/c", response_headers_, std::string(650, 'x'));
+  EXPECT_EQ(1, stats().admission_rejected_.value());
+  EXPECT_EQ(0, stats().evictions_.value());
+  EXPECT_TRUE(contains("/a"));
+  EXPECT_TRUE(contains("/b"));
+  EXPECT_FALSE(contains("/c"));
+}
+
+TEST_P(SimpleHttpCacheEvictionTest, EntryGrownBeyondBudgetByHeaderUpdateIsEvicted) {
+  lookupAndInsert("/a");
+  Http::TestResponseHeaderMapImpl updated_headers = response_headers_;
+  updated_headers.addCopy("x-large", std::string(1000, 'x'));
+  updateHeaders("/a", updated_headers, {time_system_.systemTime()});
+  EXPECT_EQ(1, stats().evictions_.value());
+  EXPECT_EQ(0, stats().size_count_.value());
+  EXPECT_EQ(0, stats().size_bytes_.value());
+  EXPECT_FALSE(contains("/a"));
+}
+
+TEST_P(SimpleHttpCacheEvictionTest, RejectsEntryLargerThanBudget) {
+  CacheReaderPtr reader = insert("/a", response_headers_, std::string(1000, 'x'));
+  EXPECT_EQ(1, stats().size_rejected_.value());
+  EXPECT_EQ(0, stats().admission_rejected_.value());
+  EXPECT_EQ(0, stats().size_count_.value());
+  EXPECT_EQ(0, stats().size_bytes_.value());
+  EXPECT_FALSE(contains("/a"));
+  // The insert in progress can still read what it wrote.
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(std::string(10, 'x'), getBody(*reader, 990, 1000).first);
+}
+
+TEST_P(SimpleHttpCacheEvictionTest, EvictionUpdatesSize) {
+  lookupAndInsert("/a");
+  EXPECT_EQ(1, stats().size_count_.value());
+  evict("/a");
+  EXPECT_EQ(0, stats().size_count_.value());
+  EXPECT_EQ(0, stats().size_bytes_.value());
+  EXPECT_FALSE(contains("/a"));
+}
+
+// Four shards split the same budget, so each test response is larger than its shard's part.
+class SimpleHttpCacheShardedEvictionTest : public SimpleHttpCacheEvictionTest {};
+
+INSTANTIATE_TEST_SUITE_P(SimpleHttpCacheShardedEvictionTest, SimpleHttpCacheShardedEvictionTest,
+                         testing::Values([]() {
+                           return std::make_unique<SimpleHttpCacheTestDelegate>(
+                               boundedConfig(1000, 4));
+                         }));
+
+TEST_P(SimpleHttpCacheShardedEvictionTest, RejectsEntryLargerThanShardBudget) {
+  CacheReaderPtr reader = insert("/a", response_headers_, body_);
+  EXPECT_EQ(1, stats().size_rejected_.value());
+  EXPECT_EQ(0, stats().admission_rejected_.value());
+  EXPECT_EQ(0, stats().size_count_.value());
+  EXPECT_FALSE(contains("/a"));
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(body_, getBody(*reader, 0, body_.size()).first);
+}
 
 TEST(Registration, GetFactory) {
   HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
@@ -46,6 +198,24 @@ TEST(Registration, GetFactory) {
   EXPECT_EQ((*cache)->cacheInfo().name_, "envoy.extensions.http.cache_v2.simple");
 }
 
+TEST(Registration, MismatchedConfigFails) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache_v2.simple_http_cache.v3.SimpleHttpCacheV2Config");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config config;
+  std::ignore = config.mutable_typed_config()->PackFrom(boundedConfig(1024, 2));
+  auto cache = factory->getCache(config, factory_context.server_factory_context_);
+  ASSERT_OK(cache);
+  auto same_cache = factory->getCache(config, factory_context.server_factory_context_);
+  ASSERT_OK(same_cache);
+  EXPECT_EQ(cache->get(), same_cache->get());
+  std::ignore = config.mutable_typed_config()->PackFrom(boundedConfig(2048, 2));
+  EXPECT_THAT(factory->getCache(config, factory_context.server_factory_context_),
+              HasStatus(absl::StatusCode::kInvalidArgument,
+                        testing::HasSubstr("mismatched SimpleHttpCacheV2Config")));
+}
+
 } // namespace
 } // namespace CacheV2
 } // namespace HttpFilters
@@ -0,0 +1,363 @@
+#include "envoy/registry/registry.h"
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/http/cache_v2/cache_sessions.h"
+#include "source/extensions/http/cache_v2/file_system_http_cache/file_system_http_cache.h"
+#include "source/extensions/http/cache_v2/simple_http_cache/simple_http_cache.h"
+#include "source/extensions/http/cache_v2/tiered_http_cache/tiered_http_cache.h"
+
+#include "test/extensions/filters/http/cache_v2/http_cache_implementation_test_common.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/status_utility.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace {
+
+using StatusHelpers::HasStatus;
+
+SimpleHttpCache::ConfigProto boundedConfig(uint64_t max_size_bytes) {
+  SimpleHttpCache::ConfigProto config;
+  config.mutable_max_size_bytes()->set_value(max_size_bytes);
+  config.set_shards(1);
+  return config;
+}
+
+// An in-memory disk tier that can hold the results of lookups back, so that tests can act while a
+// promotion is reading the response from the disk tier.
+class DeferringHttpCache : public HttpCache {
+public:
+  explicit DeferringHttpCache(Stats::Scope& scope)
+      : cache_(SimpleHttpCache::ConfigProto(), scope) {}
+
+  void deferLookups() { defer_lookups_ = true; }
+  void runDeferredLookups() {
+    std::vector<std::pair<LookupCallback, absl::StatusOr<LookupResult>>> lookups =
+        std::move(deferred_lookups_);
+    deferred_lookups_.clear();
+    for (auto& [callback, result] : lookups) {
+      callback(std::move(result));
+    }
+  }
+
+  // HttpCache
+  CacheInfo cacheInfo() const override { return cache_.cacheInfo(); }
+  void lookup(LookupRequest&& request, LookupCallback&& callback) override {
+    if (!defer_lookups_) {
+      cache_.lookup(std::move(request), std::move(callback));
+      return;
+    }
+    // The response is read now, and handed to the callback later.
+    cache_.lookup(std::move(request), [this, callback = std::move(callback)](
+                                          absl::StatusOr<LookupResult>&& result) mutable {
+      deferred_lookups_.emplace_back(std::move(callback), std::move(result));
+    });
+  }
+  void evict(Event::Dispatcher& dispatcher, const Key& key) override {
+    cache_.evict(dispatcher, key);
+  }
+  void touch(const Key& key, SystemTime timestamp) override { cache_.touch(key, timestamp); }
+  void updateHeaders(Event::Dispatcher& dispatcher, const Key& key,
+                     const Http::ResponseHeaderMap& updated_headers,
+                     const ResponseMetadata& updated_metadata) override {
+    cache_.updateHeaders(dispatcher, key, updated_headers, updated_metadata);
+  }
+  void insert(Event::Dispatcher& dispatcher, Key key, Http::ResponseHeaderMapPtr headers,
+              ResponseMetadata metadata, HttpSourcePtr source,
+              std::shared_ptr<CacheProgressReceiver> progress) override {
+    cache_.insert(dispatcher, std::move(key), std::move(headers), std::move(metadata),
+                  std::move(source), std::move(progress));
+  }
+
+private:
+  SimpleHttpCache cache_;
+  bool defer_lookups_{false};
+  std::vector<std::pair<LookupCallback, absl::StatusOr<LookupResult>>> deferred_lookups_;
+};
+
+class TieredHttpCacheTestDelegateBase : public HttpCacheTestDelegate {
+public:
+  HttpCache& cache() override { return *cache_; }
+  SimpleHttpCache& memoryTier() { return *memory_tier_; }
+
+protected:
+  Stats::IsolatedStoreImpl store_;
+  std::shared_ptr<SimpleHttpCache> memory_tier_;
+  std::unique_ptr<TieredHttpCache> cache_;
+};
+
+// Both tiers are in-memory caches, so that the tests can look into each of them.
+class TieredHttpCacheTestDelegate : public TieredHttpCacheTestDelegateBase {
+public:
+  explicit TieredHttpCacheTestDelegate(const SimpleHttpCache::ConfigProto& memory_config = {}) {
+    memory_tier_ = std::make_shared<SimpleHttpCache>(memory_config, *store_.rootScope());
+    cache_ = std::make_unique<TieredHttpCache>(memory_tier_, disk_tier_, 2, *store_.rootScope());
+  }
+  DeferringHttpCache& diskTier() { return *disk_tier_; }
+
+private:
+  std::shared_ptr<DeferringHttpCache> disk_tier_{
+      std::make_shared<DeferringHttpCache>(*store_.rootScope())};
+};
+
+// The disk tier is a file system cache, so that promotions read the response back through its
+// asynchronous CacheReader.
+class TieredFileSystemHttpCacheTestDelegate : public TieredHttpCacheTestDelegateBase {
+public:
+  TieredFileSystemHttpCacheTestDelegate() {
+    ON_CALL(context_.server_factory_context_.api_, threadFactory())
+        .WillByDefault([]() -> Thread::ThreadFactory& { return Thread::threadFactoryForTest(); });
+    const std::string cache_path = TestEnvironment::temporaryPath("tiered_http_cache_test");
+    TestEnvironment::removePath(cache_path);
+    TestEnvironment::createPath(cache_path);
+    FileSystemHttpCache::ConfigProto disk_config;
+    disk_config.set_cache_path(absl::StrCat(cache_path, "/"));
+    disk_config.mutable_manager_config()->mutable_thread_pool()->set_thread_count(1);
+    envoy::extensions::filters::http::cache_v2::v3::CacheV2Config config;
+    std::ignore = config.mutable_typed_config()->PackFrom(disk_config);
+    HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+        "envoy.extensions.http.cache_v2.file_system_http_cache.v3.FileSystemHttpCacheV2Config");
+    disk_sessions_ = *factory->getCache(config, context_.server_factory_context_);
+    memory_tier_ =
+        std::make_shared<SimpleHttpCache>(SimpleHttpCache::ConfigProto(), *store_.rootScope());
+    cache_ = std::make_unique<TieredHttpCache>(
+        memory_tier_, std::shared_ptr<HttpCache>(disk_sessions_, &disk_sessions_->cache()), 2,
+        *store_.rootScope());
+  }
+  // The file system cache must go before the context it was created with.
+  ~TieredFileSystemHttpCacheTestDelegate() override { cache_.reset(); }
+
+  void beforePumpingDispatcher() override {
+    dynamic_cast<FileSystemHttpCache::FileSystemHttpCache&>(disk_sessions_->cache())
+        .drainAsyncFileActionsForTest();
+  }
+
+private:
+  testing::NiceMock<Server::Configuration::MockFactoryContext> context_;
+  std::shared_ptr<CacheSessions> disk_sessions_;
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    TieredHttpCacheTest, HttpCacheImplementationTest,
+    testing::Values([]() { return std::make_unique<TieredHttpCacheTestDelegate>(); },
+                    []() { return std::make_unique<TieredFileSystemHttpCacheTestDelegate>(); }),
+    [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>& info) {
+      return info.index == 0 ? "TieredHttpCache" : "TieredFileSystemHttpCache";
+    });
+
+class TieredHttpCachePromotionTest : public HttpCacheImplementationTest {
+protected:
+  const TieredHttpCacheStats& stats() const {
+    return static_cast<const TieredHttpCache&>(cache()).stats();
+  }
+
+  bool inMemoryTier(absl::string_view path) {
+    return memoryTierLookup(path).cache_reader_ != nullptr;
+  }
+
+  LookupResult memoryTierLookup(absl::string_view path) {
+    LookupResult result;
+    static_cast<TieredHttpCacheTestDelegateBase&>(*delegate_)
+        .memoryTier()
+        .lookup(makeLookupRequest(path), [&result](absl::StatusOr<LookupResult>&& r) {
+          if (r.ok()) {
+            result = std::move(r.value());
+          }
+        });
+    return result;
+  }
+
+  Http::TestResponseHeaderMapImpl response_headers_{
+      {":status", "200"},
+      {"date", formatter_.fromTime(time_system_.systemTime())},
+      {"cache-control", "public,max-age=3600"}};
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    TieredHttpCachePromotionTest, TieredHttpCachePromotionTest,
+    testing::Values([]() { return std::make_unique<TieredHttpCacheTestDelegate>(); },
+                    []() { return std::make_unique<TieredFileSystemHttpCacheTestDelegate>(); }),
+    [](const testing::TestParamInfo<TieredHttpCachePromotionTest::ParamType>& info) {
+      return info.index == 0 ? "InMemoryDiskTier" : "FileSystemDiskTier";
+    });
+
+TEST_P(TieredHttpCachePromotionTest, PromotesAfterRepeatedDiskHits) {
+  insert("/a", response_headers_, "hello", Http::TestResponseTrailerMapImpl{{"why", "not"}});
+  EXPECT_FALSE(inMemoryTier("/a"));
+
+  EXPECT_TRUE(lookup("/a").populated());
+  EXPECT_EQ(1, stats().disk_hits_.value());
+  EXPECT_EQ(0, stats().promotions_.value());
+  EXPECT_FALSE(inMemoryTier("/a"));
+
+  EXPECT_TRUE(lookup("/a").populated());
+  EXPECT_EQ(2, stats().disk_hits_.value());
+  EXPECT_EQ(1, stats().promotions_.value());
+  EXPECT_TRUE(inMemoryTier("/a"));
+
+  LookupResult result = lookup("/a");
+  EXPECT_EQ(1, stats().memory_hits_.value());
+  EXPECT_EQ(2, stats().disk_hits_.value());
+  ASSERT_NE(nullptr, result.cache_reader_);
+  EXPECT_EQ("hello", getBody(*result.cache_reader_, 0, 5).first);
+  const Http::TestResponseTrailerMapImpl trailers{{"why", "not"}};
+  ASSERT_NE(nullptr, result.response_trailers_);
+  EXPECT_THAT(result.response_trailers_, HeaderMapEqualIgnoreOrder(&trailers));
+  EXPECT_EQ(0, stats().promotion_failures_.value());
+}
+
+TEST_P(TieredHttpCachePromotionTest, InsertReplacesPromotedResponse) {
+  insert("/a", response_headers_, "old");
+  lookup("/a");
+  lookup("/a");
+  ASSERT_TRUE(inMemoryTier("/a"));
+
+  insert("/a", response_headers_, "new");
+  EXPECT_FALSE(inMemoryTier("/a"));
+  LookupResult result = lookup("/a");
+  ASSERT_NE(nullptr, result.cache_reader_);
+  EXPECT_EQ("new", getBody(*result.cache_reader_, 0, 3).first);
+  EXPECT_EQ(0, stats().memory_hits_.value());
+}
+
+TEST_P(TieredHttpCachePromotionTest, EvictRemovesBothTiers) {
+  insert("/a", response_headers_, "hello");
+  lookup("/a");
+  lookup("/a");
+  ASSERT_TRUE(inMemoryTier("/a"));
+
+  evict("/a");
+  EXPECT_FALSE(inMemoryTier("/a"));
+  EXPECT_FALSE(lookup("/a").populated());
+  EXPECT_EQ(1, stats().misses_.value());
+}
+
+TEST_P(TieredHttpCachePromotionTest, PromotesBodyLargerThanOneRead) {
+  std::string body;
+  for (int i = 0; body.size() < 100000; ++i) {
+    absl::StrAppend(&body, i, ",");
+  }
+  insert("/a", response_headers_, body);
+  lookup("/a");
+  lookup("/a");
+  EXPECT_EQ(1, stats().promotions_.value());
+  LookupResult result = memoryTierLookup("/a");
+  ASSERT_NE(nullptr, result.cache_reader_);
+  EXPECT_EQ(body.size(), result.body_length_);
+  EXPECT_EQ(body, getBody(*result.cache_reader_, 0, body.size()).first);
+  EXPECT_EQ(0, stats().promotion_failures_.value());
+}
+
+TEST_P(TieredHttpCachePromotionTest, UpdateHeadersForgetsDiskHits) {
+  insert("/a", response_headers_, "hello");
+  lookup("/a");
+  updateHeaders("/a", response_headers_, {time_system_.systemTime()});
+  lookup("/a");
+  EXPECT_EQ(0, stats().promotions_.value());
+  EXPECT_FALSE(inMemoryTier("/a"));
+}
+
+class TieredHttpCacheDeferredPromotionTest : public TieredHttpCachePromotionTest {
+protected:
+  DeferringHttpCache& diskTier() {
+    return static_cast<TieredHttpCacheTestDelegate&>(*delegate_).diskTier();
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(TieredHttpCacheDeferredPromotionTest,
+                         TieredHttpCacheDeferredPromotionTest,
+                         testing::Values([]() {
+                           return std::make_unique<TieredHttpCacheTestDelegate>();
+                         }));
+
+TEST_P(TieredHttpCacheDeferredPromotionTest, UpdateHeadersDuringPromotionDropsPromotedResponse) {
+  insert("/a", response_headers_, "hello");
+  lookup("/a");
+  diskTier().deferLookups();
+  cache().lookup(makeLookupRequest("/a"), [](absl::StatusOr<LookupResult>&&) {});
+  // Completes the lookup, which starts the promotion, whose own lookup result is held back.
+  diskTier().runDeferredLookups();
+  EXPECT_EQ(1, stats().promotions_.value());
+
+  Http::TestResponseHeaderMapImpl updated_headers = response_headers_;
+  updated_headers.setCopy(Http::LowerCaseString("x-updated"), "yes");
+  updateHeaders("/a", updated_headers, {time_system_.systemTime()});
+  diskTier().runDeferredLookups();
+  pumpDispatcher();
+  // The promotion read the response before the update, so its copy is dropped.
+  EXPECT_FALSE(inMemoryTier("/a"));
+}
+
+// The memory tier has room for two of the test responses.
+class TieredHttpCacheAdmissionTest : public TieredHttpCachePromotionTest {};
+
+INSTANTIATE_TEST_SUITE_P(TieredHttpCacheAdmissionTest, TieredHttpCacheAdmissionTest,
+                         testing::Values([]() {
+                           return std::make_unique<TieredHttpCacheTestDelegate>(
+                               boundedConfig(1000));
+                         }));
+
+TEST_P(TieredHttpCacheAdmissionTest, ResponseNotAdmittedByMemoryTierIsAFailedPromotion) {
+  const std::string body(300, 'x');
+  // Two responses fill the memory tier, and are looked up more often than the third.
+  for (absl::string_view path : {"/a", "/b"}) {
+    insert(path, response_headers_, body);
+    for (int i = 0; i < 5; ++i) {
+      lookup(path);
+    }
+    ASSERT_TRUE(inMemoryTier(path));
+  }
+  insert("/c", response_headers_, body);
+  lookup("/c");
+  lookup("/c");
+  EXPECT_EQ(3, stats().promotions_.value());
+  EXPECT_EQ(1, stats().promotion_failures_.value());
+  EXPECT_FALSE(inMemoryTier("/c"));
+  EXPECT_TRUE(inMemoryTier("/a"));
+  EXPECT_TRUE(inMemoryTier("/b"));
+}
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache_v2.tiered_http_cache.v3.TieredHttpCacheV2Config");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TieredHttpCache::ConfigProto tiered_config;
+  std::ignore = tiered_config.mutable_memory_tier()->PackFrom(SimpleHttpCache::ConfigProto());
+  std::ignore = tiered_config.mutable_disk_tier()->PackFrom(SimpleHttpCache::ConfigProto());
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config config;
+  std::ignore = config.mutable_typed_config()->PackFrom(tiered_config);
+  auto cache = factory->getCache(config, factory_context.server_factory_context_);
+  ASSERT_OK(cache);
+  EXPECT_EQ((*cache)->cacheInfo().name_, "envoy.extensions.http.cache_v2.tiered_http_cache");
+  auto same_cache = factory->getCache(config, factory_context.server_factory_context_);
+  ASSERT_OK(same_cache);
+  EXPECT_EQ(cache->get(), same_cache->get());
+}
+
+TEST(Registration, MissingTierFails) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache_v2.tiered_http_cache.v3.TieredHttpCacheV2Config");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TieredHttpCache::ConfigProto tiered_config;
+  std::ignore = tiered_config.mutable_memory_tier()->PackFrom(SimpleHttpCache::ConfigProto());
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config config;
+  std::ignore = config.mutable_typed_config()->PackFrom(tiered_config);
+  EXPECT_THAT(factory->getCache(config, factory_context.server_factory_context_),
+              HasStatus(absl::StatusCode::kInvalidArgument,
+                        testing::HasSubstr("requires both memory_tier and disk_tier")));
+}
+
+} // namespace
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
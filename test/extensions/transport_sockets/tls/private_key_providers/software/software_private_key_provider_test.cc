@@ -0,0 +1,281 @@
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/transport_sockets/tls/private_key_providers/software/v3/software.pb.h"
+
+#include "source/common/event/real_time_system.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/common/thread_local/thread_local_impl.h"
+#include "source/common/tls/private_key/private_key_manager_impl.h"
+#include "source/extensions/transport_sockets/tls/private_key_providers/software/software_private_key_provider.h"
+
+#include "test/mocks/server/server_factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+#include "openssl/rsa.h"
+#include "openssl/ssl.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace Software {
+namespace {
+
+class TestCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  explicit TestCallbacks(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  void onPrivateKeyMethodComplete() override {
+    completions_++;
+    dispatcher_.exit();
+  }
+
+  Event::Dispatcher& dispatcher_;
+  uint32_t completions_{};
+};
+
+class SoftwarePrivateKeyProviderTest : public testing::Test {
+protected:
+  SoftwarePrivateKeyProviderTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        ssl_ctx_(SSL_CTX_new(TLS_method())), ssl_(SSL_new(ssl_ctx_.get())),
+        callbacks_(*dispatcher_) {
+    tls_.registerThread(*dispatcher_, true);
+    ON_CALL(factory_context_.server_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(factory_context_.server_context_, threadLocal()).WillByDefault(ReturnRef(tls_));
+    ON_CALL(factory_context_, statsScope()).WillByDefault(ReturnRef(*store_.rootScope()));
+  }
+
+  ~SoftwarePrivateKeyProviderTest() override {
+    if (provider_ != nullptr) {
+      provider_->unregisterPrivateKeyMethod(ssl_.get());
+    }
+    tls_.shutdownGlobalThreading();
+    tls_.shutdownThread();
+  }
+
+  void createProvider(const std::string& key_file, const std::string& extra_config = "") {
+    const std::string yaml = fmt::format(R"EOF(
+      provider_name: software
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.transport_sockets.tls.private_key_providers.software.v3.SoftwarePrivateKeyMethodConfig
+        private_key: {{ filename: "{{{{ test_rundir }}}}/test/common/tls/test_data/{}" }}
+        {}
+)EOF",
+                                         key_file, extra_config);
+    envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider config;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(yaml), config);
+    provider_ = manager_.createPrivateKeyMethodProvider(config, factory_context_);
+    ASSERT_NE(nullptr, provider_);
+    EXPECT_TRUE(provider_->isAvailable());
+    method_ = provider_->getBoringSslPrivateKeyMethod();
+    ASSERT_NE(nullptr, method_);
+    provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+
+    const std::string pem = TestEnvironment::readFileToStringForTest(
+        TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/" + key_file));
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(pem.data(), pem.size()));
+    pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+    ASSERT_NE(nullptr, pkey_);
+  }
+
+  // Waits for the result to be delivered and completes the operation.
+  ssl_private_key_result_t waitAndComplete(SSL* ssl, TestCallbacks& callbacks) {
+    while (callbacks.completions_ == 0) {
+      dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+    }
+    return method_->complete(ssl, out_, &out_len_, sizeof(out_));
+  }
+
+  bool verify(uint16_t signature_algorithm) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    if (!EVP_DigestVerifyInit(ctx.get(), &pctx,
+                              SSL_get_signature_algorithm_digest(signature_algorithm), nullptr,
+                              pkey_.get())) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+      return false;
+    }
+    return EVP_DigestVerify(ctx.get(), out_, out_len_, in_, sizeof(in_)) == 1;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "software_private_key." + name)->value();
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  ThreadLocal::InstanceImpl tls_;
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  TransportSockets::Tls::PrivateKeyMethodManagerImpl manager_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  bssl::UniquePtr<SSL> ssl_;
+  TestCallbacks callbacks_;
+  Ssl::PrivateKeyMethodProviderSharedPtr provider_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+
+  const uint8_t in_[32] = {0x7f};
+  uint8_t out_[1024] = {0};
+  size_t out_len_{};
+};
+
+TEST_F(SoftwarePrivateKeyProviderTest, EcdsaSign) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  EXPECT_TRUE(provider_->checkFips());
+
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out_, &out_len_, sizeof(out_),
+                          SSL_SIGN_ECDSA_SECP256R1_SHA256, in_, sizeof(in_)));
+  EXPECT_EQ(ssl_private_key_success, waitAndComplete(ssl_.get(), callbacks_));
+  EXPECT_EQ(1, callbacks_.completions_);
+  EXPECT_TRUE(verify(SSL_SIGN_ECDSA_SECP256R1_SHA256));
+  EXPECT_EQ(1, counter("sign"));
+  EXPECT_EQ(0, counter("failed"));
+}
+
+TEST_F(SoftwarePrivateKeyProviderTest, RsaPssSign) {
+  createProvider("san_dns_key.pem", "thread_count: 2");
+
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out_, &out_len_, sizeof(out_), SSL_SIGN_RSA_PSS_RSAE_SHA256,
+                          in_, sizeof(in_)));
+  EXPECT_EQ(ssl_private_key_success, waitAndComplete(ssl_.get(), callbacks_));
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PSS_RSAE_SHA256));
+}
+
+TEST_F(SoftwarePrivateKeyProviderTest, RsaPkcs1Sign) {
+  createProvider("san_dns_key.pem");
+
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out_, &out_len_, sizeof(out_), SSL_SIGN_RSA_PKCS1_SHA256,
+                          in_, sizeof(in_)));
+  EXPECT_EQ(ssl_private_key_success, waitAndComplete(ssl_.get(), callbacks_));
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PKCS1_SHA256));
+}
+
+TEST_F(SoftwarePrivateKeyProviderTest, RsaDecrypt) {
+  createProvider("san_dns_key.pem");
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+  ASSERT_NE(nullptr, rsa);
+
+  // Raw RSA needs an input smaller than the modulus, so keep the leading byte zero.
+  std::vector<uint8_t> plaintext(RSA_size(rsa), 0x5a);
+  plaintext[0] = 0;
+  std::vector<uint8_t> ciphertext(RSA_size(rsa));
+  size_t ciphertext_len;
+  ASSERT_TRUE(RSA_encrypt(rsa, &ciphertext_len, ciphertext.data(), ciphertext.size(),
+                          plaintext.data(), plaintext.size(), RSA_NO_PADDING));
+
+  EXPECT_EQ(ssl_private_key_retry, method_->decrypt(ssl_.get(), out_, &out_len_, sizeof(out_),
+                                                    ciphertext.data(), ciphertext_len));
+  EXPECT_EQ(ssl_private_key_success, waitAndComplete(ssl_.get(), callbacks_));
+  EXPECT_EQ(plaintext, std::vector<uint8_t>(out_, out_ + out_len_));
+  EXPECT_EQ(1, counter("decrypt"));
+}
+
+// A signature algorithm that does not match the key type fails the operation.
+TEST_F(SoftwarePrivateKeyProviderTest, MismatchedSignatureAlgorithm) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out_, &out_len_, sizeof(out_), SSL_SIGN_RSA_PSS_RSAE_SHA256,
+                          in_, sizeof(in_)));
+  EXPECT_EQ(ssl_private_key_failure, waitAndComplete(ssl_.get(), callbacks_));
+  EXPECT_EQ(1, counter("failed"));
+}
+
+// Completion before the result has been delivered on the worker thread asks BoringSSL to retry.
+TEST_F(SoftwarePrivateKeyProviderTest, CompleteBeforeDelivery) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+
+  EXPECT_EQ(ssl_private_key_failure, method_->complete(ssl_.get(), out_, &out_len_, sizeof(out_)));
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out_, &out_len_, sizeof(out_),
+                          SSL_SIGN_ECDSA_SECP256R1_SHA256, in_, sizeof(in_)));
+  EXPECT_EQ(ssl_private_key_retry, method_->complete(ssl_.get(), out_, &out_len_, sizeof(out_)));
+  EXPECT_EQ(ssl_private_key_success, waitAndComplete(ssl_.get(), callbacks_));
+}
+
+// A connection that goes away with an operation in flight is never called back.
+TEST_F(SoftwarePrivateKeyProviderTest, UnregisterWithOperationInFlight) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+
+  bssl::UniquePtr<SSL> other_ssl(SSL_new(ssl_ctx_.get()));
+  TestCallbacks other_callbacks(*dispatcher_);
+  provider_->registerPrivateKeyMethod(other_ssl.get(), other_callbacks, *dispatcher_);
+
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(other_ssl.get(), out_, &out_len_, sizeof(out_),
+                          SSL_SIGN_ECDSA_SECP256R1_SHA256, in_, sizeof(in_)));
+  provider_->unregisterPrivateKeyMethod(other_ssl.get());
+
+  // With a single crypto thread, the results are delivered in submission order, so once the
+  // second operation is complete the first one would have been delivered too.
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out_, &out_len_, sizeof(out_),
+                          SSL_SIGN_ECDSA_SECP256R1_SHA256, in_, sizeof(in_)));
+  EXPECT_EQ(ssl_private_key_success, waitAndComplete(ssl_.get(), callbacks_));
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(0, other_callbacks.completions_);
+}
+
+// Providers with the same queue settings share the queue and its crypto threads.
+TEST_F(SoftwarePrivateKeyProviderTest, QueuesAreSharedBySettings) {
+  Event::RealTimeSystem time_system;
+  KeyOperationQueues queues(tls_, api_->threadFactory(), time_system);
+  KeyOperationQueue& queue = queues.get(1, 32, 0);
+  EXPECT_EQ(&queue, &queues.get(1, 32, 0));
+  EXPECT_NE(&queue, &queues.get(2, 32, 0));
+  EXPECT_NE(&queue, &queues.get(1, 32, 100));
+}
+
+// Once a thread has shut down, results are no longer posted to its dispatcher.
+TEST_F(SoftwarePrivateKeyProviderTest, ClosedPosterDropsResults) {
+  ResultPoster poster(*dispatcher_);
+  uint32_t posts = 0;
+  poster.post([&posts]() { posts++; });
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(1, posts);
+
+  poster.close();
+  poster.post([&posts]() { posts++; });
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(1, posts);
+}
+
+TEST_F(SoftwarePrivateKeyProviderTest, RegisterTwice) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  EXPECT_THROW_WITH_MESSAGE(
+      provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_), EnvoyException,
+      "Not registering the software provider twice for same context");
+}
+
+TEST_F(SoftwarePrivateKeyProviderTest, InvalidKey) {
+  const std::string yaml = R"EOF(
+      provider_name: software
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.transport_sockets.tls.private_key_providers.software.v3.SoftwarePrivateKeyMethodConfig
+        private_key: { inline_string: "not a key" }
+)EOF";
+  envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider config;
+  TestUtility::loadFromYaml(yaml, config);
+  EXPECT_THROW_WITH_MESSAGE(manager_.createPrivateKeyMethodProvider(config, factory_context_),
+                            EnvoyException, "Failed to read private key.");
+}
+
+} // namespace
+} // namespace Software
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -110,6 +110,8 @@ public:
   MOCK_METHOD(SysCallIntResult, open, (const char* pathname, int flags), (const));
   MOCK_METHOD(SysCallIntResult, open, (const char* pathname, int flags, mode_t mode), (const));
   MOCK_METHOD(SysCallIntResult, unlink, (const char* pathname), (const));
+  MOCK_METHOD(SysCallIntResult, rename, (const char* oldpath, const char* newpath), (const));
+  MOCK_METHOD(SysCallIntResult, fsync, (os_fd_t fd), (const));
   MOCK_METHOD(SysCallIntResult, linkat,
               (os_fd_t olddirfd, const char* oldpath, os_fd_t newdirfd, const char* newpath,
                int flags),
@@ -146,6 +148,7 @@ public:
   // Api::LinuxOsSysCalls
   MOCK_METHOD(SysCallIntResult, sched_getaffinity, (pid_t pid, size_t cpusetsize, cpu_set_t* mask));
   MOCK_METHOD(SysCallIntResult, setns, (int fd, int nstype), (const));
+  MOCK_METHOD(SysCallIntResult, sched_getcpu, (), (const));
 };
 #endif
 
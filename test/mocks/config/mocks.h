@@ -102,6 +102,9 @@ public:
 
   MOCK_METHOD(ArenaWrappedProto<Protobuf::Message>, decodeResource,
               (const Protobuf::Any& resource));
+  MOCK_METHOD(ArenaWrappedProto<Protobuf::Message>, decodeResourceWithoutFieldChecks,
+              (const Protobuf::Any& resource));
+  MOCK_METHOD(void, checkUnexpectedFields, (const Protobuf::Message& resource));
   MOCK_METHOD(std::string, resourceName, (const Protobuf::Message& resource));
 };
 
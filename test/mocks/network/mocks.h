@@ -236,6 +236,7 @@ public:
   MOCK_METHOD(void, onAccept_, (ConnectionSocketPtr & socket));
   MOCK_METHOD(void, onReject, (RejectCause), (override));
   MOCK_METHOD(void, recordConnectionsAcceptedOnSocketEvent, (uint32_t), (override));
+  MOCK_METHOD(void, recordIncomingCpuLocality, (bool), (override));
 };
 
 class MockUdpListenerCallbacks : public UdpListenerCallbacks {
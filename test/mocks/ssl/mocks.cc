@@ -54,6 +54,11 @@ MockServerContextConfig::MockServerContextConfig() {
 }
 MockServerContextConfig::~MockServerContextConfig() = default;
 
+MockCertificateValidationContextConfig::MockCertificateValidationContextConfig() {
+  ON_CALL(*this, verificationCache()).WillByDefault(testing::ReturnRef(verification_cache_));
+}
+MockCertificateValidationContextConfig::~MockCertificateValidationContextConfig() = default;
+
 MockPrivateKeyMethodManager::MockPrivateKeyMethodManager() = default;
 MockPrivateKeyMethodManager::~MockPrivateKeyMethodManager() = default;
 
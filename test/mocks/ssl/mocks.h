@@ -135,6 +135,7 @@ public:
   MOCK_METHOD(
       std::optional<envoy::extensions::transport_sockets::tls::v3::TlsParameters::CompliancePolicy>,
       compliancePolicy, (), (const));
+  MOCK_METHOD(bool, kernelTlsEnabled, (), (const));
   MOCK_METHOD(OptRef<Ssl::UpstreamTlsCertificateSelectorFactory>, tlsCertificateSelectorFactory, (),
               (const, override));
   Ssl::HandshakerCapabilities capabilities_;
@@ -184,6 +185,7 @@ public:
   MOCK_METHOD(
       std::optional<envoy::extensions::transport_sockets::tls::v3::TlsParameters::CompliancePolicy>,
       compliancePolicy, (), (const));
+  MOCK_METHOD(bool, kernelTlsEnabled, (), (const));
   MOCK_METHOD(const std::vector<std::string>&, serverNames, (), (const));
 
   Ssl::HandshakerCapabilities capabilities_;
@@ -217,6 +219,9 @@ public:
 
 class MockCertificateValidationContextConfig : public CertificateValidationContextConfig {
 public:
+  MockCertificateValidationContextConfig();
+  ~MockCertificateValidationContextConfig() override;
+
   MOCK_METHOD(const std::string&, caCert, (), (const));
   MOCK_METHOD(const std::string&, caCertPath, (), (const));
   MOCK_METHOD(const std::string&, caCertName, (), (const));
@@ -238,6 +243,13 @@ public:
   MOCK_METHOD(std::optional<uint32_t>, maxVerifyDepth, (), (const));
   MOCK_METHOD(bool, autoSniSanMatch, (), (const));
   MOCK_METHOD(bool, suppressClientCaList, (), (const));
+  MOCK_METHOD(const std::optional<envoy::extensions::transport_sockets::tls::v3::
+                                      CertificateValidationContext::VerificationCache>&,
+              verificationCache, (), (const));
+
+  std::optional<envoy::extensions::transport_sockets::tls::v3::
+                    CertificateValidationContext::VerificationCache>
+      verification_cache_;
 };
 
 class MockPrivateKeyMethodManager : public PrivateKeyMethodManager {